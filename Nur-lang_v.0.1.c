@@ -1,3 +1,4 @@
+#define _GNU_SOURCE // unshare(CLONE_FS): --serve işçilerinin ayrı çalışma dizini
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,10 +7,40 @@
 #include <math.h> 
 #include <stddef.h> 
 #include <limits.h> // For INT_MAX, INT_MIN in string_to_int
+#include <errno.h> // For errno, ERANGE in string_to_int/string_to_float
+#include <pthread.h> // Paralel sıralama (merge path)
+#include <unistd.h> // sysconf: çekirdek sayısı
+#include <dlfcn.h> // --ext ile paylaşımlı kütüphane yükleme
+#include <sys/mman.h> // map_file: dosya destekli diziler
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <time.h> // --batch süre ölçümü
+#include <setjmp.h> // Gömülü kullanımda error() çağırana geri döner
+#include <signal.h>
+#include <sys/wait.h> // --serve: her istek ayrı bir süreçte
+#include <sched.h>
+#include <ucontext.h> // Üreteç yığınları (x86-64 dışı)
+#ifdef __linux__
+#include <linux/futex.h> // Kanal bekleyişleri
+#include <sys/syscall.h>
+#include <sys/epoll.h> // io.* olay döngüsü
+#endif
+#include <sys/socket.h> // io.watch Unix soketleri, --serve / --client
+#include <sys/un.h>
+#include "nur.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h> // AVX2 dizi çekirdekleri; derleme bayrağı gerektirmez, çalışma anında seçilir
+#define NUR_X86_SIMD 1
+#endif
+#if defined(NUR_LIBRARY) && defined(__PIC__)
+#define NUR_TLS_MODEL __attribute__((tls_model("initial-exec"))) // Paylaşımlı kütüphanede __tls_get_addr çağrısını önler
+#else
+#define NUR_TLS_MODEL
+#endif
 
 // --- Yapılandırma ---
 #define MAX_SOURCE_SIZE 10240
-#define MAX_TOKENS 8192 
+#define MAX_TOKENS 16384 // Ana dosya ve içe aktarılan modüller aynı token dizisini paylaşır
 #define MAX_IDENT_LEN 64
 #define MAX_STRING_LEN 256
 #define MAX_VARIABLES 512 
@@ -18,9 +49,41 @@
 #define MAX_IMPORTS 10           
 #define MAX_FILENAME_LEN 256    
 #define MAX_FUNCTIONS 100
-#define MAX_PARAMETERS 10
+#define MAX_PARAMETERS 16 // read_csv gibi sütun listesi alan dahili fonksiyonlar için de üst sınır
 #define MAX_CALL_STACK_DEPTH 100
 #define MAX_SCOPE_DEPTH 100 
+#define MAX_STRUCTS 32
+#define MAX_STRUCT_FIELDS 16
+#define PARALLEL_SORT_MIN 65536 // Bu boyutun üstündeki diziler iş parçacıklarıyla sıralanır
+#define MAX_SORT_THREADS 8
+#define MAX_NATIVE_FUNCTIONS 128
+#define NATIVE_HASH_SIZE 256 // 2'nin kuvveti, MAX_NATIVE_FUNCTIONS'tan büyük
+#define MAX_FILE_HANDLES 64 // Tutamaç değeri yuvayı 8 bitte taşır
+#define FILE_BUFFER_SIZE (1 << 16)
+#define OUT_BUFFER_SIZE (1 << 16) // out.display tamponu; out.flush(), çıkış ve hata anında boşaltılır
+#define IN_BUFFER_SIZE (1 << 20) // stdin tek read() çağrısıyla bu kadar okunur
+#define JSON_MAX_DEPTH 64
+#define MAX_REGEX_CACHE 64 // Derlenmiş desen önbelleği; regex_compile kimlikleri bu tablonun indisleridir
+#define REGEX_MAX_NFA 2048
+#define REGEX_MAX_DFA 512 // Tembel DFA durum önbelleği; dolunca boşaltılıp yeniden kurulur
+#define REGEX_MAX_REPEAT 100
+#define MAX_EXPR_DEPTH 256 // Parantez / tekli operatör iç içeliği (ifade derleyicisinin özyineleme sınırı)
+#define MAX_EXPR_STACK 4096 // İfade değerlendirme yığını (iç içe çağrılar dahil toplam)
+#define MODULE_CACHE_BUCKETS 256 // 2'nin kuvveti
+#define MAX_BATCH_JOBS 256 // --batch --jobs üst sınırı
+#define MAX_PARALLEL_WORKERS 64 // parallel for / par_* işçi sayısı üst sınırı (NUR_THREADS ile düşürülebilir)
+#define PARALLEL_BLOCKS 1024 // Paralel işler en fazla bu kadar bloğa bölünür
+#define PARALLEL_MIN_BLOCK_BYTES 4096 // par_* blokları en az bu kadar dizi belleği kapsar
+#define MAX_PARALLEL_REDUCE 4 // parallel for ... reduce listesindeki değişken sayısı
+#define MAX_CHANNELS 1024 // Bir programda oluşturulabilecek kanal sayısı (kimlikler bu tablonun indisleridir)
+#define MAX_SPAWNED_THREADS 1024 // spawn ile başlatılabilecek iş parçacığı sayısı
+#define CHANNEL_DEFAULT_CAPACITY 64 // Başlangıç değeri verilmeden bildirilen chan<T> değişkenleri
+#define MAX_CHANNEL_CAPACITY (1 << 20)
+#define MAX_GENERATORS 256 // Durum başına askıdaki üreteç sayısı; kimlik yuvayı 8 bitte taşır
+#define GENERATOR_STACK_SIZE (8 << 20) // Üreteç yığını için ayrılan adres aralığı (ana iş parçacığınınki kadar); sayfalar dokunuldukça gelir
+#define GENERATOR_CACHE 8 // Yığını ve tablolarıyla yeniden kullanılmak üzere saklanan bitmiş üreteç sayısı
+#define MAX_IO_SOURCES 64 // io.watch / io.read_async / io.timer kaynakları; kimlik yuvayı 8 bitte taşır
+#define IO_BUFFER_SIZE (1 << 16) // Kaynak başına okuma tamponu; hazır kaynaktan tek read() ile bu kadar okunur
 
 
 // --- Token Türleri ---
@@ -28,12 +91,13 @@ typedef enum {
     TOKEN_EOF, TOKEN_ERROR,
     TOKEN_IDENTIFIER, TOKEN_INT_LITERAL, TOKEN_STRING_LITERAL, TOKEN_FLOAT_LITERAL,
     TOKEN_VAR, TOKEN_INT_TYPE, TOKEN_STRING_TYPE, TOKEN_FLOAT_TYPE, TOKEN_BOOLEAN_TYPE, TOKEN_VOID_TYPE, 
+    TOKEN_I64_TYPE, TOKEN_F32_TYPE, TOKEN_U8_TYPE, TOKEN_HANDLE_TYPE,
     TOKEN_IF, TOKEN_ELSE, TOKEN_WHILE, TOKEN_FOR,
     TOKEN_OUT, TOKEN_DISPLAY, TOKEN_USER, 
     TOKEN_TRUE, TOKEN_FALSE,
     TOKEN_FUN, TOKEN_RETURN, 
     TOKEN_BREAK, TOKEN_CONTINUE,
-    TOKEN_IMPORT, 
+    TOKEN_IMPORT, TOKEN_STRUCT,
     TOKEN_ASSIGN, TOKEN_PLUS, TOKEN_MINUS, TOKEN_MULTIPLY, TOKEN_DIVIDE, TOKEN_MODULO,
     TOKEN_LPAREN, TOKEN_RPAREN, TOKEN_LBRACE, TOKEN_RBRACE,
     TOKEN_LBRACKET, TOKEN_RBRACKET, 
@@ -45,12 +109,13 @@ typedef enum {
 const char* token_type_names[] = {
     "EOF", "ERROR", "IDENTIFIER", "INT_LITERAL", "STRING_LITERAL", "FLOAT_LITERAL",
     "VAR", "INT_TYPE", "STRING_TYPE", "FLOAT_TYPE", "BOOLEAN_TYPE", "VOID_TYPE", 
+    "I64_TYPE", "F32_TYPE", "U8_TYPE", "HANDLE_TYPE",
     "IF", "ELSE", "WHILE", "FOR",
     "OUT", "DISPLAY", "USER",
     "TRUE", "FALSE",
     "FUN", "RETURN",
     "BREAK", "CONTINUE",
-    "IMPORT", 
+    "IMPORT", "STRUCT",
     "ASSIGN", "PLUS", "MINUS", "MULTIPLY", "DIVIDE", "MODULO",
     "LPAREN", "RPAREN", "LBRACE", "RBRACE",
     "LBRACKET", "RBRACKET",
@@ -61,39 +126,56 @@ const char* token_type_names[] = {
 
 // --- Değişken Tipi ve Değer Yapıları ---
 typedef enum {
-    VAL_NULL, VAL_INT, VAL_FLOAT, VAL_STRING, VAL_BOOLEAN, VAL_ARRAY_REF
+    VAL_NULL, VAL_INT, VAL_FLOAT, VAL_STRING, VAL_BOOLEAN, VAL_ARRAY_REF, VAL_STRUCT_REF, VAL_I64, VAL_HANDLE, VAL_MAPPING, VAL_CHANNEL, VAL_GENERATOR
 } ValueType;
 
 typedef enum {
     VAR_NULL_TYPE, 
     VAR_INT, VAR_STRING, VAR_FLOAT, VAR_BOOLEAN,
     VAR_ARRAY,
-    VAR_VOID 
+    VAR_VOID,
+    VAR_STRUCT,
+    VAR_I64, VAR_F32, VAR_U8, // Yoğun sayısal tipler: 8, 4 ve 1 baytlık saklama
+    VAR_HANDLE, // Dosya tutamacı (handle_table girişine işaret eder)
+    VAR_CHANNEL, // chan<T>: spawn grubunun kanal tablosundaki kanalın kimliği
+    VAR_GENERATOR // gen<T>: durumun üreteç tablosundaki üretecin kimliği
 } VarType;
 
 const char* var_type_names_debug[] = {
-    "NULL_TYPE", "INT", "STRING", "FLOAT", "BOOLEAN", "ARRAY", "VOID"
+    "NULL_TYPE", "INT", "STRING", "FLOAT", "BOOLEAN", "ARRAY", "VOID", "STRUCT", "I64", "F32", "U8", "HANDLE", "CHANNEL", "GENERATOR"
 };
 
 typedef struct {
     TokenType type;
     char lexeme[MAX_STRING_LEN]; 
-    int int_value;
+    long long int_value; // int sınırlarını aşan literaller i64 olarak değerlendirilir
     char string_value[MAX_STRING_LEN]; 
     double float_value;
     bool bool_value; 
     int line;
+    // Alan erişimi önbelleği: '.alan' token'ı son hangi struct için hangi alana çözüldü
+    int cache_struct_idx;
+    int cache_field_idx;
+    int cache_native_idx; // Çağrı noktası önbelleği: -2 çözülmedi, -1 dahili değil, >=0 native_table indisi
+    int expr_cache; // Bu token'da başlayan derlenmiş ifade: -1 yok, >=0 nur->exprs indisi
 } Token;
 
 struct Variable; 
 typedef struct Value {
     ValueType type;
+    bool f32; // VAL_FLOAT: değer f32 saklamadan geldi; metne f32 duyarlılığında çevrilir (0.1, 0.10000000149011612 değil)
     union {
         int int_val;
-        double float_val;
+        long long i64_val;
+        double float_val; // float ve f32 değerleri hesaplamada double olarak taşınır
         char string_val[MAX_STRING_LEN];
         bool bool_val;
         struct Variable* array_var; 
+        struct { struct Variable* var; int index; } struct_ref; // index == -1: tekil struct değişkeni
+        int handle; // Nesil << 8 | handle_table yuvası
+        int channel; // Kanal kimliği (1'den başlar; 0: kanal yok)
+        int generator; // Üreteç kimliği: (kuşak << 8) | yuva; 0: üreteç yok
+        struct { void* addr; size_t length; bool writable; } mapping; // map_file sonucu, yalnızca 'T[]' bildirimine bağlanır
     } as;
 } Value;
 
@@ -109,11 +191,24 @@ typedef struct Variable {
         char string_value[MAX_STRING_LEN];
         double float_value;
         bool bool_value;
+        long long i64_value;
+        float f32_value;
+        unsigned char u8_value;
+        int handle_value;
         struct {
             void* data; 
             VarType element_type; 
             int size;             
+            int struct_idx;       // element_type == VAR_STRUCT ise struct_table indisi
+            bool soa;             // struct dizisi sütun sütun (struct-of-arrays) mı saklanıyor
+            bool mapped;          // data malloc değil mmap: kapsam sonunda munmap edilir
+            bool read_only;       // Salt okunur eşleme; yazma girişimi hata verir
+            size_t mapped_length;
         } array;
+        struct {
+            void* data;           // Alanlar ardışık, ofsetler struct tanımında çözülmüş
+            int struct_idx;
+        } record;
     } value;
 } Variable;
 
@@ -127,10 +222,39 @@ typedef struct {
     Parameter params[MAX_PARAMETERS];
     int num_params;
     VarType return_type; 
+    VarType yield_type; // return_type VAR_GENERATOR ise gen<T>'deki T
     int body_start_token_idx;
     // int body_end_token_idx; // Potentially useful for faster skipping in 2nd pass
 } FunctionDefinition;
 
+typedef struct {
+    char name[MAX_IDENT_LEN];
+    VarType type;   // Yalnızca skaler tipler (int, float, string, boolean)
+    size_t offset;  // Kayıt başından bayt ofseti (ayrıştırma anında hesaplanır)
+    size_t size;
+} StructField;
+
+typedef struct {
+    char name[MAX_IDENT_LEN];
+    StructField fields[MAX_STRUCT_FIELDS];
+    int num_fields;
+    size_t size;    // Hizalanmış toplam boyut
+    size_t align;
+} StructDefinition;
+
+// Dahili (C) fonksiyonlar: ad, parametre sayısı, parametre tipleri ve C işlevi ile kaydedilir.
+// Yorumlayıcının kendi dahili fonksiyonları ve --ext ile yüklenen kütüphaneler aynı tabloyu kullanır.
+typedef enum { NARG_ANY, NARG_INT, NARG_NUMBER, NARG_STRING, NARG_BOOL, NARG_ARRAY, NARG_HANDLE, NARG_CHANNEL } NativeArgType;
+typedef Value (*NativeFn)(Value* args, int num_args);
+
+typedef struct {
+    char name[MAX_IDENT_LEN];
+    int arity; // -1: değişken sayıda argüman (işlev kendisi denetler)
+    NativeArgType param_types[MAX_PARAMETERS];
+    NativeFn fn;
+    NurNativeFn ext_fn; // --ext ile yüklenen işlev (fn yerine; argümanlar NurValue'ya çevrilir, bkz. nur.h)
+} NativeFunction;
+
 typedef struct {
     int return_address_token_idx;     
     int symbol_table_scope_start_idx; 
@@ -141,38 +265,108 @@ typedef struct {
 
 
 // --- Global Yorumlayıcı Durumu ---
-char source_code[MAX_SOURCE_SIZE];
-Token tokens[MAX_TOKENS]; 
-int num_tokens = 0;
-int current_token_idx = 0;
-int current_line = 1;
+// Bir betiğin tüm çalışma durumu tek bir NurState'te tutulur; etkin durum iş parçacığına özel 'nur'
+// işaretçisidir. Böylece aynı süreçte her iş parçacığı kendi durumuyla betik çalıştırabilir (bkz. nur.h).
+// Dahili fonksiyon tablosu ve SIMD çekirdek seçimi süreç genelindedir ve bir kez kurulur.
+typedef struct JsonReader JsonReader; // json_next olay akışı (bkz. JSON bölümü)
+typedef struct { FILE* fp; bool in_use; bool writable; unsigned generation; JsonReader* json; } FileHandle;
+typedef struct Regex Regex;
+typedef struct ModuleCache ModuleCache; // --batch işçilerinin paylaştığı modül önbelleği
+typedef struct SpawnGroup SpawnGroup; // bkz. İş Parçacıkları ve Kanallar
+typedef struct Generator Generator; // bkz. Üreteçler
+typedef struct GeneratorTable GeneratorTable;
+typedef struct EventLoop EventLoop; // bkz. Olay Döngüsü
+typedef struct ParallelPool ParallelPool; // bkz. Paralel Yürütme
+typedef struct { unsigned char kind; unsigned char op; int tok; int jump; } ExprNode; // tok: ilgili token; jump: ifade içi kısa devre hedefi
+typedef struct { int first, count, end_token; } CompiledExpr;
+// Modül kaydı: her dosya token dizisinde kendi EOF'uyla biten [first_token, end_token) aralığına bir kez
+// sözcüklere ayrılır. Fonksiyon gövdeleri ve derlenmiş ifadeler bu mutlak indisleri kullanır.
+typedef struct { char name[MAX_FILENAME_LEN]; char key[2 * MAX_FILENAME_LEN]; int first_token, end_token; } LoadedModule;
+typedef struct { ExprNode* nodes; int count, cap; } ExprBuilder;
+
+struct NurState {
+    char source_code[MAX_SOURCE_SIZE];
+    Token tokens[MAX_TOKENS];
+    int num_tokens, current_token_idx, current_line;
 
-Variable symbol_table[MAX_VARIABLES];
-int num_variables = 0;
+    Variable* symbol_table; // Çalışan yürütme bağlamının tabloları (bkz. ExecContext): kendi depoları ya da bir üretecinkiler
+    int num_variables;
+    FunctionDefinition function_table[MAX_FUNCTIONS];
+    int num_functions;
+    StructDefinition struct_table[MAX_STRUCTS];
+    int num_structs;
+    int last_type_struct_idx; // parse_type_specifier VAR_STRUCT döndürdüğünde hangi struct olduğu
+    VarType last_type_elem; // parse_type_specifier VAR_CHANNEL / VAR_GENERATOR döndürdüğünde eleman tipi
 
-FunctionDefinition function_table[MAX_FUNCTIONS];
-int num_functions = 0;
+    CallFrame* call_stack;
+    int call_stack_ptr;
+    int* scope_stack;
+    int scope_stack_ptr;
+    char (*for_loop_vars_stack)[MAX_IDENT_LEN];
+    int for_loop_var_stack_ptr;
+    int loop_depth;
+    Value return_value_holder;
+    bool return_flag;
 
-CallFrame call_stack[MAX_CALL_STACK_DEPTH];
-int call_stack_ptr = -1; 
+    LoadedModule modules[MAX_IMPORTS + 1]; // 0: ana dosya (derlendiyse), ardından içe aktarılanlar
+    int num_modules;
+    char current_file_path_for_errors[MAX_FILENAME_LEN];
 
-int scope_stack[MAX_SCOPE_DEPTH]; 
-int scope_stack_ptr = -1;       
+    // out.display tamponu ve stdin okuyucusu (bkz. Çıktı Tamponu, Girdi Okuyucu)
+    FILE* out;
+    bool out_is_tty; // Terminalde satır sonunda boşaltılır
+    char out_buffer[OUT_BUFFER_SIZE];
+    size_t out_len;
+    int in_fd;
+    bool show_prompts;
+    char in_buffer[IN_BUFFER_SIZE];
+    size_t in_pos, in_len;
+    bool in_eof;
 
-char for_loop_vars_stack[MAX_LOOP_NESTING][MAX_IDENT_LEN];
-int for_loop_var_stack_ptr = -1; 
+    FileHandle handle_table[MAX_FILE_HANDLES];
+    bool inherited_handles[MAX_FILE_HANDLES]; // İşçi / spawn kopyası: üst durumdan gelen tutamaçlar burada kapatılmaz
+    bool mapping_allowed; // map_file yalnızca bildirimin başlatıcısı olarak (doğrudan) çağrılabilir
+    Regex* regex_cache[MAX_REGEX_CACHE];
+    int num_regex;
 
-int loop_depth = 0; 
+    // Derlenmiş ifadeler (bkz. İfade Derleyici)
+    ExprNode* expr_nodes; int num_expr_nodes, expr_nodes_cap;
+    ExprBuilder* expr_builder; // Derlenmekte olan ifade; iç ifadeler (çağrı argümanları) kendi oluşturucularını kullanır
+    CompiledExpr* exprs; int num_exprs, exprs_cap;
+    Value* eval_stack; int eval_sp;
+    int expr_depth;
 
-Value g_return_value_holder; 
-bool g_return_flag = false;    
+    // Gömülü kullanım: error_jmp varsa error() süreci sonlandırmaz, iletiyi saklayıp buraya döner
+    jmp_buf* error_jmp;
+    char error_message[MAX_STRING_LEN + MAX_FILENAME_LEN + 128];
+    char result_text[MAX_STRING_LEN]; // nur_call'ın string dönüş değeri
+    ModuleCache* module_cache; // NULL: önbellek yok (tek betik)
+    bool parallel_worker; // parallel for / par_* işçisi: iç içe paralel bölgeler sırayla çalışır
+    ParallelPool* parallel_pool; // İlk paralel bölgede başlatılan kalıcı işçiler (NULL: henüz yok)
+    unsigned program_serial; // Program sıfırlanınca ya da modül eklenince değişir (bkz. parallel_sync_state)
+    NurState* synced_parent; // Havuz işçisi: program kopyasının alındığı durum (NULL: kopya yok)
+    int synced_num_regex; // Havuz işçisi: üst durumdan gelen düzenli ifadeler; fazlası iş sonunda bırakılır
+    SpawnGroup* spawn_group; // spawn ile başlatılan iş parçacıkları ve kanallar; kopyalar kökünkini paylaşır
+    bool owns_spawn_group;
+    int num_shared_variables; // spawn kopyası: başvurusu alınmış devralınan değişkenler (bkz. clone_share_storage)
+    GeneratorTable* generator_table; // Bu durumda oluşturulan üreteçler; gövdeleri de bu durumda çalışır
+    Generator* running_generator; // Çalışan yürütme bağlamı bir üretecin gövdesiyse o üreteç
+    EventLoop* event_loop; // io.* kaynakları; her durumun (kopyalar dahil) kendi döngüsü vardır
+    bool source_from_file, compiled, ran;
 
-char imported_files[MAX_IMPORTS][MAX_FILENAME_LEN];
-int num_imported_files = 0;
-char current_file_path_for_errors[MAX_FILENAME_LEN];
-char* g_importer_saved_source_code = NULL;
-Token* g_importer_saved_tokens = NULL;
+    Variable symbol_storage[MAX_VARIABLES];
+    CallFrame call_storage[MAX_CALL_STACK_DEPTH];
+    int scope_storage[MAX_SCOPE_DEPTH];
+    char loop_var_storage[MAX_LOOP_NESTING][MAX_IDENT_LEN];
+    Value eval_storage[MAX_EXPR_STACK];
+};
+static __thread NurState* nur NUR_TLS_MODEL;
+static unsigned program_serial_counter; // Tüm durumlarda tekil program_serial değerleri
+static inline void program_changed() { nur->program_serial = __atomic_add_fetch(&program_serial_counter, 1, __ATOMIC_RELAXED); }
 
+NativeFunction native_table[MAX_NATIVE_FUNCTIONS];
+int num_natives = 0;
+short native_hash[NATIVE_HASH_SIZE]; // ad -> native_table indisi + 1 (0: boş)
 
 // --- Fonksiyon İleri Bildirimleri ---
 void parse_statement_list(bool execute, bool* break_flag, bool* continue_flag, bool in_function_body);
@@ -181,23 +375,97 @@ void parse_block(bool execute, bool* break_flag, bool* continue_flag, bool in_fu
 Value evaluate_expression(bool execute);
 Value parse_assignment_rhs(VarType expected_lhs_type, bool execute);
 void parse_import_statement(bool execute); 
-void interpret_current_file_tokens(const char* filepath_display_name);
+void interpret_current_file_tokens(const char* filepath_display_name, bool register_declarations);
 void parse_fun_declaration(); 
+void parse_struct_declaration(bool register_struct);
 VarType parse_type_specifier(); 
-void error(const char* message); 
+VarType parse_type_specifier_ex(bool resolve_struct);
+void error(const char* message) __attribute__((noreturn));
+void raise_error() __attribute__((noreturn));
+void close_all_handles();
+bool channel_element_type_ok(VarType t);
+Value invoke_function(const FunctionDefinition* func_def, Value args[], int num_args_passed);
+Value generator_create(const FunctionDefinition* fd, Value* args, int num_args);
+void generator_table_free(NurState* st);
+void event_loop_free(NurState* st);
+void flush_output();
+int compare_numeric_values(Value l, Value r);
 // Value execute_function_call(const FunctionDefinition* func_def, Value args[], int num_args_passed, bool execute_flag); // OLD
 Value execute_function_call(const FunctionDefinition* func_def, Value args[], int num_args_passed);
 
 
+// --- Paylaşılan Depolama ---
+// spawn ve üreteç kopyaları çağıranın dizi ve struct belleğini paylaşır ve onu oluşturan çerçeveden uzun
+// yaşayabilir. Paylaşılan bellek burada sayılır: her sahip (asıl değişken ve her kopya) bir başvuru tutar,
+// bellek son başvuru bırakılınca serbest kalır. Hiç paylaşım yoksa release_variable_storage kilit almaz.
+#define SHARED_STORAGE_BUCKETS 64
+typedef struct SharedStorage { void* data; int refs; struct SharedStorage* next; } SharedStorage;
+static pthread_mutex_t shared_storage_lock = PTHREAD_MUTEX_INITIALIZER;
+static SharedStorage* shared_storage[SHARED_STORAGE_BUCKETS];
+static int shared_storage_count; // __atomic ile okunur
+
+// strncpy'nin aksine hedefi doldurmaz ve her zaman sonlandırır; cap, sonlandırıcı dahil hedef boyutudur.
+static inline void copy_bounded(char* dst, const char* src, size_t cap) { size_t n = strnlen(src, cap - 1); memcpy(dst, src, n); dst[n] = '\0'; }
+static inline SharedStorage** shared_storage_slot(void* data) {
+    SharedStorage** link = &shared_storage[((uintptr_t)data >> 4) & (SHARED_STORAGE_BUCKETS - 1)];
+    while (*link && (*link)->data != data) link = &(*link)->next;
+    return link;
+}
+void storage_retain(void* data) {
+    pthread_mutex_lock(&shared_storage_lock);
+    SharedStorage** link = shared_storage_slot(data);
+    if (*link) (*link)->refs++;
+    else {
+        SharedStorage* e = malloc(sizeof *e);
+        if (!e) { pthread_mutex_unlock(&shared_storage_lock); error("Paylaşılan bellek kaydı için bellek ayrılamadı."); }
+        e->data = data; e->refs = 2; e->next = NULL; // Asıl sahip ve yeni kopya
+        *link = e;
+        __atomic_add_fetch(&shared_storage_count, 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&shared_storage_lock);
+}
+// Bir başvuruyu bırakır; true: başka sahip kalmadı, çağıran belleği serbest bırakmalı.
+bool storage_release(void* data) {
+    if (__atomic_load_n(&shared_storage_count, __ATOMIC_RELAXED) == 0) return true;
+    pthread_mutex_lock(&shared_storage_lock);
+    SharedStorage** link = shared_storage_slot(data);
+    bool last = true;
+    if (*link && --(*link)->refs > 0) last = false;
+    else if (*link) {
+        SharedStorage* e = *link; *link = e->next; free(e);
+        __atomic_sub_fetch(&shared_storage_count, 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&shared_storage_lock);
+    return last;
+}
+
 // --- Kapsam Yönetimi Yardımcıları ---
+void release_variable_storage(Variable* var) {
+    void* data = var->type == VAR_ARRAY ? var->value.array.data : var->type == VAR_STRUCT ? var->value.record.data : NULL;
+    if (data && !storage_release(data)) { // Başka bir kopya hâlâ kullanıyor
+        if (var->type == VAR_ARRAY) var->value.array.data = NULL; else var->value.record.data = NULL;
+        return;
+    }
+    if (var->type == VAR_ARRAY && var->value.array.data && var->value.array.mapped) {
+        munmap(var->value.array.data, var->value.array.mapped_length);
+        var->value.array.data = NULL;
+    } else if (var->type == VAR_ARRAY && var->value.array.data) {
+        free(var->value.array.data);
+        var->value.array.data = NULL;
+    } else if (var->type == VAR_STRUCT && var->value.record.data) {
+        free(var->value.record.data);
+        var->value.record.data = NULL;
+    }
+}
+
 void enter_scope() {
-    if (scope_stack_ptr + 1 >= MAX_SCOPE_DEPTH) error("Maksimum kapsam derinliği aşıldı.");
-    scope_stack_ptr++;
-    scope_stack[scope_stack_ptr] = num_variables; 
+    if (nur->scope_stack_ptr + 1 >= MAX_SCOPE_DEPTH) error("Maksimum kapsam derinliği aşıldı.");
+    nur->scope_stack_ptr++;
+    nur->scope_stack[nur->scope_stack_ptr] = nur->num_variables; 
 }
 
 void exit_scope() {
-    if (scope_stack_ptr < 0) {
+    if (nur->scope_stack_ptr < 0) {
         // This can happen if exit_scope is called more times than enter_scope,
         // e.g. after an error during function call setup.
         // It's not necessarily a fatal interpreter bug in itself if error handling cleans up.
@@ -205,50 +473,245 @@ void exit_scope() {
         // fprintf(stderr, "Uyarı: exit_scope çağrıldığında kapsam yığını zaten boş.\n");
         return;
     }
-    int scope_start_idx = scope_stack[scope_stack_ptr];
-    for (int i = num_variables - 1; i >= scope_start_idx; i--) {
-        if (symbol_table[i].type == VAR_ARRAY && symbol_table[i].value.array.data) {
-            free(symbol_table[i].value.array.data);
-            symbol_table[i].value.array.data = NULL;
-        }
+    int scope_start_idx = nur->scope_stack[nur->scope_stack_ptr];
+    for (int i = nur->num_variables - 1; i >= scope_start_idx; i--) {
+        release_variable_storage(&nur->symbol_table[i]);
     }
-    num_variables = scope_start_idx; 
-    scope_stack_ptr--;
+    nur->num_variables = scope_start_idx; 
+    nur->scope_stack_ptr--;
 }
 
 int get_current_scope_level() {
-    return scope_stack_ptr; 
+    return nur->scope_stack_ptr; 
 }
 
 // --- Hata Yönetimi ---
+// Komut satırında hata iletisi yazılır ve süreç sonlanır. Gömülü kullanımda (nur->error_jmp) ileti
+// nur->error_message'a yazılır ve denetim çağıran API fonksiyonuna döner; durum geri sarılır (bkz. nur_unwind).
+// Token hangi modülün aralığındaysa onun adı; bulunamazsa o an yorumlanan dosyanınki.
+const char* module_name_for_token(int idx) {
+    for (int i = 0; i < nur->num_modules; ++i)
+        if (idx >= nur->modules[i].first_token && idx < nur->modules[i].end_token) return nur->modules[i].name;
+    return nur->current_file_path_for_errors;
+}
 void error(const char* message) {
-    fprintf(stderr, "Hata (dosya: %s, satır %d, token %d '%s'): %s\n",
-            current_file_path_for_errors,
-            (current_token_idx < num_tokens && current_token_idx >=0) ? tokens[current_token_idx].line : current_line,
-            current_token_idx,
-            (current_token_idx < num_tokens && current_token_idx >=0) ? tokens[current_token_idx].lexeme : "YOK",
+    flush_output(); // Hata mesajı, öncesinde üretilmiş çıktının ardından görünsün
+    bool at_token = nur->current_token_idx < nur->num_tokens && nur->current_token_idx >= 0;
+    snprintf(nur->error_message, sizeof nur->error_message, "Hata (dosya: %s, satır %d, token %d '%s'): %s",
+            at_token ? module_name_for_token(nur->current_token_idx) : nur->current_file_path_for_errors,
+            at_token ? nur->tokens[nur->current_token_idx].line : nur->current_line,
+            nur->current_token_idx,
+            at_token ? nur->tokens[nur->current_token_idx].lexeme : "YOK",
             message);
-    
-    if (g_importer_saved_source_code) { free(g_importer_saved_source_code); g_importer_saved_source_code = NULL; }
-    if (g_importer_saved_tokens) { free(g_importer_saved_tokens); g_importer_saved_tokens = NULL; }
+    raise_error();
+}
+// nur->error_message'daki biçimlenmiş hatayı bildirir (paralel işçiden gelen hatalar için de kullanılır).
+void raise_error() {
+    if (nur->error_jmp) longjmp(*nur->error_jmp, 1);
+    fprintf(stderr, "%s\n", nur->error_message);
     
     // Genel bir temizleme, olası tüm dizi belleklerini serbest bırakmaya çalışır
     // This might be redundant if scope exit handles it, but good for abrupt termination.
-    for (int i = 0; i < num_variables; ++i) {
-        if (symbol_table[i].type == VAR_ARRAY && symbol_table[i].value.array.data != NULL) {
-            free(symbol_table[i].value.array.data);
-            symbol_table[i].value.array.data = NULL;
-        }
+    for (int i = 0; i < nur->num_variables; ++i) {
+        release_variable_storage(&nur->symbol_table[i]);
     }
+    close_all_handles(); // Yazılmış tamponlar kaybolmasın
     exit(1);
 }
 
+// --- Çıktı Tamponu ---
+// out.display çıktısı printf yerine büyük bir tampona biçimlendirilir. Tamsayılar iki basamaklı tabloyla,
+// ondalıklı sayılar en kısa geri-dönüşümlü (round-trip) gösterimle yazılır.
+
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// buf en az 21 bayt olmalı; yazılan uzunluğu döndürür (sonlandırıcı hariç).
+int format_int(char* buf, long long v) {
+    char tmp[24]; char* p = tmp + sizeof tmp;
+    unsigned long long u = v < 0 ? 0ULL - (unsigned long long)v : (unsigned long long)v;
+    while (u >= 100) { unsigned r = (unsigned)(u % 100); u /= 100; p -= 2; memcpy(p, digit_pairs + 2 * r, 2); }
+    if (u >= 10) { p -= 2; memcpy(p, digit_pairs + 2 * u, 2); } else *--p = (char)('0' + u);
+    if (v < 0) *--p = '-';
+    int len = (int)(tmp + sizeof tmp - p);
+    memcpy(buf, p, len); buf[len] = '\0';
+    return len;
+}
+
+// En kısa geri-dönüşümlü ondalık gösterim (buf en az 32 bayt). Hızlı yol: |d| 1e-4..1e15 aralığındaysa
+// d*10^k tam sayısı 10^k'ya bölündüğünde d'yi veren en küçük k aranır (Grisu'nun kesin hızlı yolu gibi);
+// bulunamazsa %.15g/%.16g/%.17g'den geri okunduğunda d'yi veren ilki kullanılır.
+// single_precision: değer f32'den gelir, float duyarlılığında geri dönüşüm yeterlidir.
+int format_double_ex(char* buf, double d, bool single_precision) {
+    static const double pow10[] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+    if (isnan(d)) { strcpy(buf, "nan"); return 3; }
+    if (isinf(d)) { strcpy(buf, d < 0 ? "-inf" : "inf"); return d < 0 ? 4 : 3; }
+    if (d == 0) { strcpy(buf, signbit(d) ? "-0" : "0"); return signbit(d) ? 2 : 1; }
+    double ad = fabs(d);
+    if (ad >= 1e-4 && ad < 1e15) {
+        for (int k = 0; k <= 22; ++k) {
+            double m = ad * pow10[k];
+            if (m >= 9007199254740992.0) break; // 2^53: tam sayı artık kesin değil
+            double r = nearbyint(m);
+            if (single_precision ? (float)(r / pow10[k]) != (float)ad : r / pow10[k] != ad) continue;
+            char digits[24]; int nd = format_int(digits, (long long)r), len = 0;
+            if (d < 0) buf[len++] = '-';
+            if (nd <= k) { // 0.00ddd
+                buf[len++] = '0'; buf[len++] = '.';
+                for (int z = 0; z < k - nd; ++z) buf[len++] = '0';
+                memcpy(buf + len, digits, nd); len += nd;
+            } else {
+                memcpy(buf + len, digits, nd - k); len += nd - k;
+                if (k > 0) { buf[len++] = '.'; memcpy(buf + len, digits + nd - k, k); len += k; }
+            }
+            buf[len] = '\0';
+            return len;
+        }
+    }
+    int len = 0;
+    for (int prec = single_precision ? 6 : 15; prec <= 17; ++prec) {
+        len = snprintf(buf, 32, "%.*g", prec, d);
+        if (single_precision ? strtof(buf, NULL) == (float)d : strtod(buf, NULL) == d) break;
+    }
+    return len;
+}
+
+void flush_output() {
+    if (nur->out_len > 0) { fwrite(nur->out_buffer, 1, nur->out_len, nur->out); nur->out_len = 0; }
+    fflush(nur->out);
+}
+static inline void out_reserve(size_t n) { if (nur->out_len + n > OUT_BUFFER_SIZE) flush_output(); }
+void out_write(const char* s, size_t n) {
+    if (n > OUT_BUFFER_SIZE) { flush_output(); fwrite(s, 1, n, nur->out); return; }
+    out_reserve(n); memcpy(nur->out_buffer + nur->out_len, s, n); nur->out_len += n;
+}
+void out_str(const char* s) { out_write(s, strlen(s)); }
+static inline void out_char(char c) { out_reserve(1); nur->out_buffer[nur->out_len++] = c; }
+static inline void out_int(long long v) { out_reserve(24); nur->out_len += format_int(nur->out_buffer + nur->out_len, v); }
+static inline void out_double(double d, bool single_precision) { out_reserve(32); nur->out_len += format_double_ex(nur->out_buffer + nur->out_len, d, single_precision); }
+void out_newline() { out_char('\n'); if (nur->out_is_tty) flush_output(); }
+
+// --- Girdi Okuyucu ---
+// user.in* ve read_ints/read_floats/read_lines stdin'i stdio yerine büyük bir tampondan okur.
+// İstem ("> ") yalnızca stdin bir terminalse ve --no-prompt verilmemişse yazılır.
+
+static inline int in_peek() {
+    if (nur->in_pos == nur->in_len) {
+        if (nur->in_eof) return EOF;
+        ssize_t n;
+        do n = nur->in_fd < 0 ? 0 : read(nur->in_fd, nur->in_buffer, IN_BUFFER_SIZE); while (n < 0 && errno == EINTR);
+        if (n <= 0) { nur->in_eof = true; return EOF; }
+        nur->in_pos = 0; nur->in_len = (size_t)n;
+    }
+    return (unsigned char)nur->in_buffer[nur->in_pos];
+}
+static inline int in_getc() { int c = in_peek(); if (c != EOF) nur->in_pos++; return c; }
+
+void prompt(const char* text) {
+    if (!nur->show_prompts) return;
+    out_str(text); flush_output();
+}
+
+// Boşlukları atlayıp sonraki boşluksuz kelimeyi okur; veri kalmadıysa false. Kelime buf'a sığmazsa
+// (kısaltılmış hâli geçerli ama yanlış bir sayı olabileceği için) kelime atlanıp hata verilir.
+bool in_read_word(char* buf, size_t cap) {
+    int c;
+    while ((c = in_peek()) != EOF && isspace(c)) nur->in_pos++;
+    if (c == EOF) return false;
+    size_t len = 0, total = 0;
+    while ((c = in_peek()) != EOF && !isspace(c)) { if (len + 1 < cap) buf[len++] = (char)c; total++; nur->in_pos++; }
+    buf[len] = '\0';
+    if (total > len) {
+        char err[150];
+        snprintf(err, sizeof err, "Girdi kelimesi çok uzun: '%.24s...' (%zu karakter, en fazla %zu).", buf, total, cap - 1);
+        error(err);
+    }
+    return true;
+}
+
+// Satır sonu karakteri (ve varsa '\r') atılır; uzun satırlar cap-1 karakterde kesilir. Veri kalmadıysa false.
+bool in_read_line(char* buf, size_t cap) {
+    if (in_peek() == EOF) return false;
+    size_t len = 0; int c;
+    while ((c = in_getc()) != EOF && c != '\n') if (len + 1 < cap) buf[len++] = (char)c;
+    if (len > 0 && buf[len - 1] == '\r') len--;
+    buf[len] = '\0';
+    return true;
+}
+
+void in_skip_line() { int c; while ((c = in_getc()) != EOF && c != '\n'); }
+
+bool parse_int_token(const char* s, long long* out) {
+    const char* p = s; bool neg = false;
+    if (*p == '+' || *p == '-') neg = *p++ == '-';
+    if (!isdigit((unsigned char)*p)) return false;
+    unsigned long long v = 0, limit = neg ? (unsigned long long)LLONG_MAX + 1 : (unsigned long long)LLONG_MAX;
+    for (; isdigit((unsigned char)*p); ++p) {
+        unsigned d = (unsigned)(*p - '0');
+        if (v > (limit - d) / 10) return false; // Taşma
+        v = v * 10 + d;
+    }
+    if (*p) return false;
+    *out = neg ? (long long)(0ULL - v) : (long long)v;
+    return true;
+}
+
+// Hızlı yol: en fazla 15 anlamlı basamak ve |üs| <= 22 ise sonuç tek bir kesin çarpma/bölmeyle
+// doğru yuvarlanır (Clinger). Diğer durumlarda strtod kullanılır.
+bool parse_double_token(const char* s, double* out) {
+    static const double pow10[] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+    const char* p = s; bool neg = false, any = false;
+    if (*p == '+' || *p == '-') neg = *p++ == '-';
+    unsigned long long mant = 0; int digits = 0, exp10 = 0;
+    for (; isdigit((unsigned char)*p); ++p) {
+        any = true;
+        if (digits < 19) { mant = mant * 10 + (unsigned)(*p - '0'); if (mant) digits++; } else { exp10++; digits++; }
+    }
+    if (*p == '.') {
+        for (++p; isdigit((unsigned char)*p); ++p) {
+            any = true;
+            if (digits < 19) { mant = mant * 10 + (unsigned)(*p - '0'); if (mant) digits++; exp10--; } else digits++;
+        }
+    }
+    if (!any) { // strtod gibi nan, inf ve infinity (büyük/küçük harf fark etmez) kabul edilir
+        char w[9]; size_t k = 0;
+        for (; p[k] && k < sizeof w - 1; ++k) w[k] = (char)tolower((unsigned char)p[k]);
+        w[k] = '\0';
+        if (p[k]) return false;
+        if (strcmp(w, "nan") == 0) { *out = neg ? -NAN : NAN; return true; }
+        if (strcmp(w, "inf") == 0 || strcmp(w, "infinity") == 0) { *out = neg ? -INFINITY : INFINITY; return true; }
+        return false;
+    }
+    if (*p == 'e' || *p == 'E') {
+        ++p; bool eneg = false; int e = 0;
+        if (*p == '+' || *p == '-') eneg = *p++ == '-';
+        if (!isdigit((unsigned char)*p)) return false;
+        for (; isdigit((unsigned char)*p); ++p) if (e < 10000) e = e * 10 + (*p - '0');
+        exp10 += eneg ? -e : e;
+    }
+    if (*p) return false;
+    if (digits <= 15 && exp10 >= -22 && exp10 <= 22) {
+        double v = (double)mant;
+        v = exp10 < 0 ? v / pow10[-exp10] : v * pow10[exp10];
+        *out = neg ? -v : v;
+        return true;
+    }
+    char* end; errno = 0;
+    *out = strtod(s, &end);
+    return *end == '\0';
+}
+
 // --- Tip Yardımcıları --- 
 const char* value_type_to_string(ValueType type) {
     switch(type) {
         case VAL_INT: return "tamsayı"; case VAL_FLOAT: return "ondalıklı sayı";
         case VAL_STRING: return "metin"; case VAL_BOOLEAN: return "mantıksal";
-        case VAL_ARRAY_REF: return "dizi referansı"; case VAL_NULL: return "boş";
+        case VAL_ARRAY_REF: return "dizi referansı"; case VAL_STRUCT_REF: return "struct";
+        case VAL_I64: return "i64 tamsayı"; case VAL_HANDLE: return "dosya tutamacı"; case VAL_MAPPING: return "dosya eşlemesi";
+        case VAL_CHANNEL: return "kanal"; case VAL_GENERATOR: return "üreteç";
+        case VAL_NULL: return "boş";
         default: return "bilinmeyen değer tipi";
     }
 }
@@ -257,6 +720,9 @@ const char* var_type_to_string_user(VarType type) {
         case VAR_INT: return "int"; case VAR_STRING: return "string";
         case VAR_FLOAT: return "float"; case VAR_BOOLEAN: return "boolean";
         case VAR_ARRAY: return "array"; case VAR_VOID: return "void";
+        case VAR_STRUCT: return "struct";
+        case VAR_I64: return "i64"; case VAR_F32: return "f32"; case VAR_U8: return "u8";
+        case VAR_HANDLE: return "handle"; case VAR_CHANNEL: return "chan"; case VAR_GENERATOR: return "gen";
         case VAR_NULL_TYPE: return "null_type_internal";
         default: return "bilinmeyen değişken tipi";
     }
@@ -265,34 +731,130 @@ size_t get_sizeof_element_type(VarType type) {
     switch (type) {
         case VAR_INT: return sizeof(int); case VAR_FLOAT: return sizeof(double);
         case VAR_BOOLEAN: return sizeof(bool); case VAR_STRING: return MAX_STRING_LEN; 
+        case VAR_I64: return sizeof(long long); case VAR_F32: return sizeof(float); case VAR_U8: return sizeof(unsigned char);
+        case VAR_HANDLE: case VAR_CHANNEL: case VAR_GENERATOR: return sizeof(int);
         default: error("get_sizeof_element_type: Desteklenmeyen veya uygulanamayan dizi eleman tipi."); return 0;
     }
 }
+size_t get_alignof_element_type(VarType type) {
+    switch (type) {
+        case VAR_INT: return _Alignof(int); case VAR_FLOAT: return _Alignof(double);
+        case VAR_BOOLEAN: return _Alignof(bool); case VAR_STRING: return 1;
+        case VAR_I64: return _Alignof(long long); case VAR_F32: return _Alignof(float); case VAR_U8: return 1;
+        case VAR_HANDLE: case VAR_CHANNEL: case VAR_GENERATOR: return _Alignof(int);
+        default: return 1;
+    }
+}
+// Dizi elemanı bayt boyutu; struct dizilerinde struct tanımındaki hizalanmış boyut kullanılır.
+size_t get_array_element_size(const Variable* arr) {
+    if (arr->value.array.element_type == VAR_STRUCT) return nur->struct_table[arr->value.array.struct_idx].size;
+    return get_sizeof_element_type(arr->value.array.element_type);
+}
+
+// Tipli bir bellek yuvasından (dizi elemanı, struct alanı) değer okuma/yazma.
+// Yazma öncesinde tip uyumluluğu parse_assignment_rhs ile denetlenmiş olmalıdır.
+Value create_value_int(int v); Value create_value_i64(long long v); Value create_value_float(double v); Value create_value_bool(bool v); Value create_value_string(const char* v); Value create_value_null();
+Value load_typed_slot(VarType type, const void* slot) {
+    switch (type) {
+        case VAR_INT: return create_value_int(*(const int*)slot);
+        case VAR_FLOAT: return create_value_float(*(const double*)slot);
+        case VAR_BOOLEAN: return create_value_bool(*(const bool*)slot);
+        case VAR_STRING: return create_value_string((const char*)slot);
+        case VAR_I64: return create_value_i64(*(const long long*)slot);
+        case VAR_F32: { Value v = create_value_float(*(const float*)slot); v.f32 = true; return v; }
+        case VAR_U8: return create_value_int(*(const unsigned char*)slot);
+        case VAR_HANDLE: { Value v = {VAL_HANDLE, false, {0}}; v.as.handle = *(const int*)slot; return v; }
+        case VAR_CHANNEL: { Value v = {VAL_CHANNEL, false, {0}}; v.as.channel = *(const int*)slot; return v; }
+        case VAR_GENERATOR: { Value v = {VAL_GENERATOR, false, {0}}; v.as.generator = *(const int*)slot; return v; }
+        default: error("Desteklenmeyen tipte bellek yuvası (okuma)."); return create_value_int(0);
+    }
+}
+void store_typed_slot(VarType type, void* slot, Value val) {
+    switch (type) {
+        case VAR_INT: *(int*)slot = val.as.int_val; break;
+        case VAR_FLOAT: *(double*)slot = val.as.float_val; break;
+        case VAR_BOOLEAN: *(bool*)slot = val.as.bool_val; break;
+        case VAR_STRING: copy_bounded((char*)slot, val.as.string_val, MAX_STRING_LEN); break;
+        case VAR_I64: *(long long*)slot = val.as.i64_val; break;
+        case VAR_F32: *(float*)slot = (float)val.as.float_val; break;
+        case VAR_U8: *(unsigned char*)slot = (unsigned char)val.as.int_val; break;
+        case VAR_HANDLE: *(int*)slot = val.as.handle; break;
+        case VAR_CHANNEL: *(int*)slot = val.as.channel; break;
+        case VAR_GENERATOR: *(int*)slot = val.as.generator; break;
+        default: error("Desteklenmeyen tipte bellek yuvası (yazma).");
+    }
+}
+// Skaler değişkenin değer yuvası; union'ın tüm üyeleri aynı adresten başlar.
+void* scalar_variable_slot(Variable* var) { return &var->value; }
+
+// Değeri hedef tipin kanonik değer gösterimine dönüştürür (int, u8 -> VAL_INT; i64 -> VAL_I64; float, f32 -> VAL_FLOAT).
+// Tamsayı dönüşümleri kesindir: hedef aralığa sığmayan değer sessizce kırpılmaz, hata verir.
+// Tipler uyumsuzsa false döner; mesajı çağıran üretir.
+bool coerce_value_to_var_type(VarType type, Value* v) {
+    char err[150];
+    switch (type) {
+        case VAR_INT:
+            if (v->type == VAL_INT) return true;
+            if (v->type == VAL_I64) {
+                if (v->as.i64_val < INT_MIN || v->as.i64_val > INT_MAX) { sprintf(err, "i64 değer (%lld) int sınırları dışında.", v->as.i64_val); error(err); }
+                *v = create_value_int((int)v->as.i64_val); return true;
+            }
+            return false;
+        case VAR_I64:
+            if (v->type == VAL_I64) return true;
+            if (v->type == VAL_INT) { *v = create_value_i64(v->as.int_val); return true; }
+            return false;
+        case VAR_U8: {
+            if (v->type != VAL_INT && v->type != VAL_I64) return false;
+            long long x = v->type == VAL_INT ? v->as.int_val : v->as.i64_val;
+            if (x < 0 || x > 255) { sprintf(err, "u8 tipine sığmayan değer: %lld (0-255 bekleniyor).", x); error(err); }
+            *v = create_value_int((int)x); return true;
+        }
+        case VAR_FLOAT: case VAR_F32:
+            if (v->type == VAL_INT) *v = create_value_float((double)v->as.int_val);
+            else if (v->type == VAL_I64) *v = create_value_float((double)v->as.i64_val);
+            else if (v->type != VAL_FLOAT) return false;
+            if (type == VAR_F32) v->as.float_val = (float)v->as.float_val; // f32 dönüş değeri de saklanmış gibi yuvarlanır
+            v->f32 = type == VAR_F32;
+            return true;
+        case VAR_STRING: return v->type == VAL_STRING;
+        case VAR_BOOLEAN: return v->type == VAL_BOOLEAN;
+        case VAR_STRUCT: return v->type == VAL_STRUCT_REF; // Struct adı eşleşmesini çağıran denetler
+        case VAR_HANDLE: return v->type == VAL_HANDLE;
+        case VAR_CHANNEL: return v->type == VAL_CHANNEL;
+        case VAR_GENERATOR: return v->type == VAL_GENERATOR;
+        case VAR_NULL_TYPE: return true; // Internal use, e.g. when LHS type isn't known yet during parsing phase
+        default: return false;
+    }
+}
 
 // --- Lexer (Token Üretici) ---
 bool is_keyword(const char* s, const char* keyword) { return strcmp(s, keyword) == 0; }
 Token create_token(TokenType type, const char* lexeme_val) {
     Token t; t.type = type;
-    if (lexeme_val) { strncpy(t.lexeme, lexeme_val, MAX_STRING_LEN - 1); t.lexeme[MAX_STRING_LEN - 1] = '\0'; }
+    if (lexeme_val) copy_bounded(t.lexeme, lexeme_val, MAX_STRING_LEN);
     else { t.lexeme[0] = '\0'; }
-    t.line = current_line; t.int_value = 0; t.float_value = 0.0; t.bool_value = false;
-    strcpy(t.string_value, ""); 
+    t.line = nur->current_line; t.int_value = 0; t.float_value = 0.0; t.bool_value = false;
+    strcpy(t.string_value, ""); t.cache_struct_idx = -1; t.cache_field_idx = -1; t.cache_native_idx = -2; t.expr_cache = -1;
     return t;
 }
 
-void tokenize() { 
-    int i = 0; num_tokens = 0; current_line = 1;
-    while (source_code[i] != '\0' && num_tokens < MAX_TOKENS) {
-        if (isspace(source_code[i])) { if (source_code[i] == '\n') current_line++; i++; continue; }
-        if ((source_code[i] == '/' && source_code[i+1] == '/')) { while (source_code[i]!='\n'&&source_code[i]!='\0')i++; if(source_code[i]=='\n'){i++; current_line++;} continue; }
-        if (source_code[i] == '#') { while (source_code[i]!='\n'&&source_code[i]!='\0')i++; if(source_code[i]=='\n'){i++; current_line++;} continue; }
-        if (source_code[i] == '/' && source_code[i+1] == '*') { 
-            i+=2; int csl=current_line; while(source_code[i]!='\0'&&(source_code[i]!='*'||source_code[i+1]!='/')){if(source_code[i]=='\n')current_line++;i++;}
-            if(source_code[i]=='*'&&source_code[i+1]=='/'){i+=2;}else{current_line=csl;error("Kapatılmamış blok yorumu");} continue;
+// src'yi token dizisinin sonuna ekler (EOF dahil). Token sayısı ancak sonda güncellenir: sözcük hataları
+// token'a değil, okunan satıra göre bildirilir.
+void tokenize(const char* src) { 
+    int i = 0, n = nur->num_tokens; nur->current_line = 1;
+    while (src[i] != '\0') {
+        if (n >= MAX_TOKENS - 1) error("Token sınırı ('MAX_TOKENS') aşıldı.");
+        if (isspace(src[i])) { if (src[i] == '\n') nur->current_line++; i++; continue; }
+        if ((src[i] == '/' && src[i+1] == '/')) { while (src[i]!='\n'&&src[i]!='\0')i++; if(src[i]=='\n'){i++; nur->current_line++;} continue; }
+        if (src[i] == '#') { while (src[i]!='\n'&&src[i]!='\0')i++; if(src[i]=='\n'){i++; nur->current_line++;} continue; }
+        if (src[i] == '/' && src[i+1] == '*') { 
+            i+=2; int csl=nur->current_line; while(src[i]!='\0'&&(src[i]!='*'||src[i+1]!='/')){if(src[i]=='\n')nur->current_line++;i++;}
+            if(src[i]=='*'&&src[i+1]=='/'){i+=2;}else{nur->current_line=csl;error("Kapatılmamış blok yorumu");} continue;
         }
         char lexeme_buffer[MAX_STRING_LEN]; int k = 0;
-        if (isalpha(source_code[i]) || source_code[i] == '_') {
-            while (isalnum(source_code[i]) || source_code[i] == '_') { if(k<MAX_IDENT_LEN-1)lexeme_buffer[k++]=source_code[i++];else {i++; error("Tanımlayıcı çok uzun.");}} // Added error for too long identifier
+        if (isalpha(src[i]) || src[i] == '_') {
+            while (isalnum(src[i]) || src[i] == '_') { if(k<MAX_IDENT_LEN-1)lexeme_buffer[k++]=src[i++];else {i++; error("Tanımlayıcı çok uzun.");}} // Added error for too long identifier
             lexeme_buffer[k]='\0'; Token t=create_token(TOKEN_IDENTIFIER,lexeme_buffer);
             if (is_keyword(lexeme_buffer,"var"))t.type=TOKEN_VAR; else if(is_keyword(lexeme_buffer,"int"))t.type=TOKEN_INT_TYPE;
             else if(is_keyword(lexeme_buffer,"string"))t.type=TOKEN_STRING_TYPE; else if(is_keyword(lexeme_buffer,"float"))t.type=TOKEN_FLOAT_TYPE;
@@ -304,239 +866,4147 @@ void tokenize() {
             else if(is_keyword(lexeme_buffer,"false")){t.type=TOKEN_FALSE;t.bool_value=false;} else if(is_keyword(lexeme_buffer,"fun"))t.type=TOKEN_FUN;
             else if(is_keyword(lexeme_buffer,"return"))t.type=TOKEN_RETURN; else if(is_keyword(lexeme_buffer,"break"))t.type=TOKEN_BREAK;
             else if(is_keyword(lexeme_buffer,"continue"))t.type=TOKEN_CONTINUE; else if(is_keyword(lexeme_buffer,"import"))t.type=TOKEN_IMPORT;
-            tokens[num_tokens++]=t; continue;
+            else if(is_keyword(lexeme_buffer,"struct"))t.type=TOKEN_STRUCT;
+            else if(is_keyword(lexeme_buffer,"i64"))t.type=TOKEN_I64_TYPE; else if(is_keyword(lexeme_buffer,"f32"))t.type=TOKEN_F32_TYPE;
+            else if(is_keyword(lexeme_buffer,"u8"))t.type=TOKEN_U8_TYPE; else if(is_keyword(lexeme_buffer,"i32"))t.type=TOKEN_INT_TYPE; // i32, int'in eş adı
+            else if(is_keyword(lexeme_buffer,"handle"))t.type=TOKEN_HANDLE_TYPE;
+            nur->tokens[n++]=t; continue;
         }
-        if (isdigit(source_code[i])||(source_code[i]=='.'&&isdigit(source_code[i+1]))){
-            bool isf=false; k=0; if(source_code[i]=='.'){isf=true;if(k<MAX_STRING_LEN-1)lexeme_buffer[k++]=source_code[i++];else {i++; error("Sayı literali çok uzun.");}}
-            while(isdigit(source_code[i])){if(k<MAX_STRING_LEN-1)lexeme_buffer[k++]=source_code[i++];else {i++; error("Sayı literali çok uzun.");}}
-            if(source_code[i]=='.'){if(!isf){isf=true;if(k<MAX_STRING_LEN-1)lexeme_buffer[k++]=source_code[i++];else {i++; error("Sayı literali çok uzun.");}}
-            while(isdigit(source_code[i])){if(k<MAX_STRING_LEN-1)lexeme_buffer[k++]=source_code[i++];else {i++; error("Sayı literali çok uzun.");}}}
+        if (isdigit(src[i])||(src[i]=='.'&&isdigit(src[i+1]))){
+            bool isf=false; k=0; if(src[i]=='.'){isf=true;if(k<MAX_STRING_LEN-1)lexeme_buffer[k++]=src[i++];else {i++; error("Sayı literali çok uzun.");}}
+            while(isdigit(src[i])){if(k<MAX_STRING_LEN-1)lexeme_buffer[k++]=src[i++];else {i++; error("Sayı literali çok uzun.");}}
+            if(src[i]=='.'){if(!isf){isf=true;if(k<MAX_STRING_LEN-1)lexeme_buffer[k++]=src[i++];else {i++; error("Sayı literali çok uzun.");}}
+            while(isdigit(src[i])){if(k<MAX_STRING_LEN-1)lexeme_buffer[k++]=src[i++];else {i++; error("Sayı literali çok uzun.");}}}
             lexeme_buffer[k]='\0'; Token t; if(isf){t=create_token(TOKEN_FLOAT_LITERAL,lexeme_buffer);t.float_value=atof(lexeme_buffer);}
-            else{t=create_token(TOKEN_INT_LITERAL,lexeme_buffer);t.int_value=atoi(lexeme_buffer);} tokens[num_tokens++]=t; continue;
+            else{t=create_token(TOKEN_INT_LITERAL,lexeme_buffer);errno=0;t.int_value=strtoll(lexeme_buffer,NULL,10);if(errno==ERANGE)error("Tamsayı literali i64 sınırlarını aşıyor.");} nur->tokens[n++]=t; continue;
         }
-        if(source_code[i]=='"'){
-            i++;k=0; while(source_code[i]!='"'&&source_code[i]!='\0'){ // Removed k < MAX_STRING_LEN -1 to allow error for too long string
+        if(src[i]=='"'){
+            i++;k=0; while(src[i]!='"'&&src[i]!='\0'){ // Removed k < MAX_STRING_LEN -1 to allow error for too long string
                 if (k >= MAX_STRING_LEN -1) error("String literali çok uzun.");
-                if(source_code[i]=='\\'&&source_code[i+1]!='\0'){i++;
-                    switch(source_code[i]){case'n':lexeme_buffer[k++]='\n';break; case't':lexeme_buffer[k++]='\t';break;
+                if(src[i]=='\\'&&src[i+1]!='\0'){i++;
+                    switch(src[i]){case'n':lexeme_buffer[k++]='\n';break; case't':lexeme_buffer[k++]='\t';break;
                         case'"':lexeme_buffer[k++]='"';break; case'\\':lexeme_buffer[k++]='\\';break;
-                        default:lexeme_buffer[k++]=source_code[i];break;} i++;
-                }else{lexeme_buffer[k++]=source_code[i++];}} lexeme_buffer[k]='\0';
-                if(source_code[i]=='"')i++;else error("Kapatılmamış string literali"); Token t=create_token(TOKEN_STRING_LITERAL,NULL);
-                strncpy(t.string_value,lexeme_buffer,MAX_STRING_LEN-1);t.string_value[MAX_STRING_LEN-1]='\0';
+                        default:lexeme_buffer[k++]=src[i];break;} i++;
+                }else{lexeme_buffer[k++]=src[i++];}} lexeme_buffer[k]='\0';
+                if(src[i]=='"')i++;else error("Kapatılmamış string literali"); Token t=create_token(TOKEN_STRING_LITERAL,NULL);
+                copy_bounded(t.string_value, lexeme_buffer, MAX_STRING_LEN);
             if(strlen(lexeme_buffer)>MAX_IDENT_LEN-3){snprintf(t.lexeme,MAX_STRING_LEN,"\"%.*s...\"",MAX_IDENT_LEN-6,lexeme_buffer);}
-            else{snprintf(t.lexeme,MAX_STRING_LEN,"\"%s\"",lexeme_buffer);} tokens[num_tokens++]=t; continue;
+            else{snprintf(t.lexeme,MAX_STRING_LEN,"\"%s\"",lexeme_buffer);} nur->tokens[n++]=t; continue;
         }
-        k=0; lexeme_buffer[k++]=source_code[i]; TokenType type=TOKEN_ERROR;
-        switch(source_code[i]){
-            case'=':if(source_code[i+1]=='='){type=TOKEN_EQ;i++;lexeme_buffer[k++]='=';}else type=TOKEN_ASSIGN;break;
+        k=0; lexeme_buffer[k++]=src[i]; TokenType type=TOKEN_ERROR;
+        switch(src[i]){
+            case'=':if(src[i+1]=='='){type=TOKEN_EQ;i++;lexeme_buffer[k++]='=';}else type=TOKEN_ASSIGN;break;
             case'+':type=TOKEN_PLUS;break; case'-':type=TOKEN_MINUS;break; case'*':type=TOKEN_MULTIPLY;break;
             case'/':type=TOKEN_DIVIDE;break; case'%':type=TOKEN_MODULO;break; case'(':type=TOKEN_LPAREN;break;
             case')':type=TOKEN_RPAREN;break; case'{':type=TOKEN_LBRACE;break; case'}':type=TOKEN_RBRACE;break;
             case'[':type=TOKEN_LBRACKET;break; case']':type=TOKEN_RBRACKET;break; case':':type=TOKEN_COLON;break;
             case';':type=TOKEN_SEMICOLON;break; case'.':type=TOKEN_DOT;break; case',':type=TOKEN_COMMA;break;
-            case'>':if(source_code[i+1]=='='){type=TOKEN_GTE;i++;lexeme_buffer[k++]='=';}else type=TOKEN_GT;break;
-            case'<':if(source_code[i+1]=='='){type=TOKEN_LTE;i++;lexeme_buffer[k++]='=';}else type=TOKEN_LT;break;
-            case'!':if(source_code[i+1]=='='){type=TOKEN_NEQ;i++;lexeme_buffer[k++]='=';}else type=TOKEN_NOT;break;
-            case'&':if(source_code[i+1]=='&'){type=TOKEN_AND;i++;lexeme_buffer[k++]='&';}else error("Beklenmeyen '&', '&&' mi demek istediniz?");break;
-            case'|':if(source_code[i+1]=='|'){type=TOKEN_OR;i++;lexeme_buffer[k++]='|';}else error("Beklenmeyen '|', '||' mi demek istediniz?");break;
-            default:sprintf(lexeme_buffer,"Bilinmeyen karakter: '%c'",source_code[i]);error(lexeme_buffer);
-        } lexeme_buffer[k]='\0'; tokens[num_tokens++]=create_token(type,lexeme_buffer); i++;
-    } tokens[num_tokens++]=create_token(TOKEN_EOF,"EOF");
+            case'>':if(src[i+1]=='='){type=TOKEN_GTE;i++;lexeme_buffer[k++]='=';}else type=TOKEN_GT;break;
+            case'<':if(src[i+1]=='='){type=TOKEN_LTE;i++;lexeme_buffer[k++]='=';}else type=TOKEN_LT;break;
+            case'!':if(src[i+1]=='='){type=TOKEN_NEQ;i++;lexeme_buffer[k++]='=';}else type=TOKEN_NOT;break;
+            case'&':if(src[i+1]=='&'){type=TOKEN_AND;i++;lexeme_buffer[k++]='&';}else error("Beklenmeyen '&', '&&' mi demek istediniz?");break;
+            case'|':if(src[i+1]=='|'){type=TOKEN_OR;i++;lexeme_buffer[k++]='|';}else error("Beklenmeyen '|', '||' mi demek istediniz?");break;
+            default:sprintf(lexeme_buffer,"Bilinmeyen karakter: '%c'",src[i]);error(lexeme_buffer);
+        } lexeme_buffer[k]='\0'; nur->tokens[n++]=create_token(type,lexeme_buffer); i++;
+    } nur->tokens[n++]=create_token(TOKEN_EOF,"EOF"); nur->num_tokens = n;
+}
+
+// --- Sembol Tablosu Yönetimi --- 
+Variable* find_variable(const char* name) { 
+    for (int i = nur->num_variables - 1; i >= 0; --i) {
+        if (strcmp(nur->symbol_table[i].name, name) == 0) {
+            return &nur->symbol_table[i];
+        }
+    }
+    return NULL;
+}
+Variable* declare_variable(const char* name, VarType type, bool is_loop_var_decl, VarType array_element_type_param, int array_size_param, int struct_idx_param) {
+    if (nur->num_variables >= MAX_VARIABLES) error("Çok fazla değişken tanımlandı (sembol tablosu dolu)");
+    
+    int current_scope_start_idx = (nur->scope_stack_ptr >= 0) ? nur->scope_stack[nur->scope_stack_ptr] : 0;
+    for (int i = nur->num_variables - 1; i >= current_scope_start_idx; --i) {
+        if (strcmp(nur->symbol_table[i].name, name) == 0) {
+            char err[MAX_IDENT_LEN + 100];
+            sprintf(err, "'%s' adlı değişken bu kapsamda zaten tanımlı.", name);
+            error(err);
+        }
+    }
+    
+    Variable* new_var = &nur->symbol_table[nur->num_variables];
+    copy_bounded(new_var->name, name, MAX_IDENT_LEN);
+    new_var->type = type; new_var->is_defined = false; new_var->is_loop_var = is_loop_var_decl;
+    new_var->scope_level = get_current_scope_level();
+    
+    if (type == VAR_ARRAY) {
+        if (array_element_type_param==VAR_NULL_TYPE||array_size_param<=0)error("Geçersiz dizi eleman tipi/boyutu.");
+        new_var->value.array.element_type = array_element_type_param; new_var->value.array.size = array_size_param;
+        new_var->value.array.struct_idx = struct_idx_param; new_var->value.array.soa = false;
+        new_var->value.array.mapped = false; new_var->value.array.read_only = false;
+        size_t element_size = get_array_element_size(new_var);
+        if (element_size == 0) error("Dizi için eleman boyutu sıfır olamaz."); // Should be caught by get_sizeof_element_type
+        new_var->value.array.data = calloc(array_size_param, element_size);
+        if(!new_var->value.array.data)error("Dizi için bellek ayrılamadı.");
+        new_var->is_defined=true; // Array itself is defined, elements are default-initialized
+        if(array_element_type_param==VAR_STRING){for(int k_arr=0;k_arr<array_size_param;k_arr++){((char*)new_var->value.array.data+k_arr*MAX_STRING_LEN)[0]='\0';}}
+    } else if (type == VAR_STRUCT) {
+        if (struct_idx_param < 0 || struct_idx_param >= nur->num_structs) error("Geçersiz struct tipi.");
+        new_var->value.record.struct_idx = struct_idx_param;
+        new_var->value.record.data = calloc(1, nur->struct_table[struct_idx_param].size); // calloc: sayılar 0, string alanları ""
+        if (!new_var->value.record.data) error("Struct için bellek ayrılamadı.");
+        new_var->is_defined = true;
+    }
+    
+    if (is_loop_var_decl) { 
+        if (nur->for_loop_var_stack_ptr + 1 >= MAX_LOOP_NESTING)error("'for' değişkeni için max iç içe geçme aşıldı");
+        nur->for_loop_var_stack_ptr++; copy_bounded(nur->for_loop_vars_stack[nur->for_loop_var_stack_ptr], name, MAX_IDENT_LEN);
+    }
+    nur->num_variables++;
+    return new_var;
+}
+void remove_variable_by_name_from_symbol_table(const char* name_to_remove) { 
+    for (int i = nur->num_variables - 1; i >= 0; i--) { 
+        if (strcmp(nur->symbol_table[i].name, name_to_remove) == 0 && nur->symbol_table[i].is_loop_var) {
+            release_variable_storage(&nur->symbol_table[i]);
+            // Shift remaining elements, not efficient but ok for small number of loop vars
+            for(int j=i;j<nur->num_variables-1;j++)nur->symbol_table[j]=nur->symbol_table[j+1];
+            nur->num_variables--; return; 
+        }
+    }
+}
+
+// --- Fonksiyon Tablosu Yönetimi ---
+FunctionDefinition* find_function(const char* name) {
+    for (int i = 0; i < nur->num_functions; ++i) {
+        if (strcmp(nur->function_table[i].name, name) == 0) {
+            return &nur->function_table[i];
+        }
+    }
+    return NULL;
+}
+
+// --- Dahili Fonksiyon Tablosu ---
+unsigned native_name_hash(const char* name) {
+    unsigned h = 2166136261u; // FNV-1a
+    for (; *name; ++name) h = (h ^ (unsigned char)*name) * 16777619u;
+    return h;
+}
+
+int find_native(const char* name) {
+    for (unsigned h = native_name_hash(name) & (NATIVE_HASH_SIZE - 1); native_hash[h]; h = (h + 1) & (NATIVE_HASH_SIZE - 1))
+        if (strcmp(native_table[native_hash[h] - 1].name, name) == 0) return native_hash[h] - 1;
+    return -1;
+}
+
+// param_types NULL ise tüm parametreler NARG_ANY kabul edilir. Başarıda tablo indisini, hatada -1 döner.
+int native_table_add(const char* name, int arity, const NativeArgType* param_types, NativeFn fn, NurNativeFn ext_fn) {
+    if (!name || strlen(name) >= MAX_IDENT_LEN || arity < -1 || arity > MAX_PARAMETERS) return -1;
+    if (num_natives >= MAX_NATIVE_FUNCTIONS || find_native(name) >= 0) return -1;
+    NativeFunction* nf = &native_table[num_natives];
+    strcpy(nf->name, name); nf->arity = arity; nf->fn = fn; nf->ext_fn = ext_fn;
+    for (int i = 0; i < MAX_PARAMETERS; ++i) nf->param_types[i] = (param_types && i < arity) ? param_types[i] : NARG_ANY;
+    unsigned h = native_name_hash(name) & (NATIVE_HASH_SIZE - 1);
+    while (native_hash[h]) h = (h + 1) & (NATIVE_HASH_SIZE - 1);
+    native_hash[h] = (short)(num_natives + 1);
+    return num_natives++;
+}
+int register_native(const char* name, int arity, const NativeArgType* param_types, NativeFn fn) {
+    return fn ? native_table_add(name, arity, param_types, fn, NULL) : -1;
+}
+// Eklenti arayüzü: NurArgType değerleri iç tiplere eşlenir.
+int ext_register_native(const char* name, int arity, const NurArgType* param_types, NurNativeFn fn) {
+    if (!fn || arity > MAX_PARAMETERS) return -1;
+    NativeArgType types[MAX_PARAMETERS];
+    for (int i = 0; i < arity; ++i) {
+        switch (param_types ? param_types[i] : NUR_ARG_ANY) {
+            case NUR_ARG_ANY: types[i] = NARG_ANY; break; case NUR_ARG_INT: types[i] = NARG_INT; break;
+            case NUR_ARG_NUMBER: types[i] = NARG_NUMBER; break; case NUR_ARG_STRING: types[i] = NARG_STRING; break;
+            case NUR_ARG_BOOL: types[i] = NARG_BOOL; break;
+            default: return -1;
+        }
+    }
+    return native_table_add(name, arity, types, NULL, fn);
+}
+
+const char* native_arg_type_name(NativeArgType t) {
+    switch (t) {
+        case NARG_INT: return "tamsayı"; case NARG_NUMBER: return "sayı (int veya float)"; case NARG_STRING: return "string";
+        case NARG_BOOL: return "boolean"; case NARG_ARRAY: return "dizi"; case NARG_HANDLE: return "dosya tutamacı";
+        case NARG_CHANNEL: return "kanal"; default: return "herhangi";
+    }
+}
+
+// Gömme API'si ve eklentiler için NurValue dönüşümleri. String sonucu v'nin metnini gösterir;
+// false: tip NurValue ile taşınamaz (dizi, struct, tutamaç, ...).
+Value value_from_nur(const NurValue* a) {
+    switch (a->type) {
+        case NUR_VAL_INT: return a->i >= INT_MIN && a->i <= INT_MAX ? create_value_int((int)a->i) : create_value_i64(a->i);
+        case NUR_VAL_FLOAT: return create_value_float(a->f);
+        case NUR_VAL_BOOL: return create_value_bool(a->b);
+        case NUR_VAL_STRING: return create_value_string(a->s);
+        default: return create_value_null();
+    }
+}
+bool value_to_nur(const Value* v, NurValue* out) {
+    memset(out, 0, sizeof *out);
+    switch (v->type) {
+        case VAL_NULL: out->type = NUR_VAL_NULL; return true;
+        case VAL_INT: out->type = NUR_VAL_INT; out->i = v->as.int_val; return true;
+        case VAL_I64: out->type = NUR_VAL_INT; out->i = v->as.i64_val; return true;
+        case VAL_FLOAT: out->type = NUR_VAL_FLOAT; out->f = v->as.float_val; return true;
+        case VAL_BOOLEAN: out->type = NUR_VAL_BOOL; out->b = v->as.bool_val; return true;
+        case VAL_STRING: out->type = NUR_VAL_STRING; out->s = v->as.string_val; return true;
+        default: return false;
+    }
+}
+Value call_extension_native(const NativeFunction* nf, Value* args, int num_args) {
+    NurValue in[MAX_PARAMETERS], out;
+    char err[MAX_IDENT_LEN + 150];
+    if (num_args > MAX_PARAMETERS) { sprintf(err, "'%s' en fazla %d argüman alabilir.", nf->name, MAX_PARAMETERS); error(err); }
+    for (int i = 0; i < num_args; ++i)
+        if (!value_to_nur(&args[i], &in[i])) { sprintf(err, "'%s' %d. argümanı (%s) eklentiye aktarılamaz.", nf->name, i + 1, value_type_to_string(args[i].type)); error(err); }
+    memset(&out, 0, sizeof out);
+    nf->ext_fn(in, num_args, &out);
+    return value_from_nur(&out);
+}
+
+Value call_native(int idx, Value* args, int num_args) {
+    const NativeFunction* nf = &native_table[idx];
+    char err[MAX_IDENT_LEN + 150];
+    if (nf->arity >= 0 && num_args != nf->arity) { sprintf(err, "'%s' %d argüman bekler (%d verildi).", nf->name, nf->arity, num_args); error(err); }
+    for (int i = 0; i < num_args && i < nf->arity; ++i) {
+        ValueType vt = args[i].type; bool ok;
+        switch (nf->param_types[i]) {
+            case NARG_INT: ok = vt == VAL_INT || vt == VAL_I64; break;
+            case NARG_NUMBER: ok = vt == VAL_INT || vt == VAL_I64 || vt == VAL_FLOAT; break;
+            case NARG_STRING: ok = vt == VAL_STRING; break;
+            case NARG_BOOL: ok = vt == VAL_BOOLEAN; break;
+            case NARG_ARRAY: ok = vt == VAL_ARRAY_REF; break;
+            case NARG_HANDLE: ok = vt == VAL_HANDLE; break;
+            case NARG_CHANNEL: ok = vt == VAL_CHANNEL; break;
+            default: ok = true;
+        }
+        if (!ok) { sprintf(err, "'%s' %d. argümanı %s olmalıdır (%s verildi).", nf->name, i + 1, native_arg_type_name(nf->param_types[i]), value_type_to_string(vt)); error(err); }
+    }
+    return nf->ext_fn ? call_extension_native(nf, args, num_args) : nf->fn(args, num_args);
+}
+
+void load_extension(const char* path) {
+    void* handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) { fprintf(stderr, "Eklenti yüklenemedi: %s\n", dlerror()); exit(1); }
+    const int* abi = dlsym(handle, "nur_extension_abi");
+    if (!abi || *abi != NUR_EXT_ABI_VERSION) {
+        fprintf(stderr, "Eklenti '%s' bu yorumlayıcının eklenti ABI sürümüyle (%d) derlenmemiş (nur.h, NUR_EXTENSION_ABI).\n", path, NUR_EXT_ABI_VERSION); exit(1);
+    }
+    int (*init_fn)(const NurExtensionApi*) = (int (*)(const NurExtensionApi*))dlsym(handle, "nur_extension_init");
+    if (!init_fn) { fprintf(stderr, "Eklenti '%s' nur_extension_init sembolünü dışa aktarmıyor.\n", path); exit(1); }
+    static const NurExtensionApi api = { NUR_EXT_ABI_VERSION, ext_register_native, error };
+    if (init_fn(&api) != 0) { fprintf(stderr, "Eklenti '%s' başlatılamadı.\n", path); exit(1); }
+    // Kütüphane süreç boyunca açık kalır: kayıtlı işlev işaretçileri ona ait
+}
+
+// --- Dosya Tutamaçları ---
+// open() ile açılan dosyalar burada tutulur; değer olarak yalnızca yuva + nesil taşınır, böylece
+// kapatılmış bir tutamacın yeniden kullanılan yuvaya erişmesi yakalanır. Her dosya tam tamponludur.
+
+FileHandle* resolve_handle(const char* fname, Value h) {
+    char err[150];
+    if (h.type != VAL_HANDLE) { sprintf(err, "'%s' dosya tutamacı bekler (%s verildi).", fname, value_type_to_string(h.type)); error(err); }
+    int slot = h.as.handle & 0xff;
+    FileHandle* fh = &nur->handle_table[slot];
+    if (slot >= MAX_FILE_HANDLES || !fh->in_use || (unsigned)(h.as.handle >> 8) != fh->generation) {
+        sprintf(err, "'%s': dosya tutamacı kapalı veya geçersiz.", fname); error(err);
+    }
+    return fh;
+}
+
+void close_all_handles() {
+    for (int i = 0; i < MAX_FILE_HANDLES; ++i)
+        if (nur->handle_table[i].in_use) { fclose(nur->handle_table[i].fp); free(nur->handle_table[i].json); nur->handle_table[i].json = NULL; nur->handle_table[i].in_use = false; }
+}
+
+// --- Struct Tablosu Yönetimi ---
+int find_struct(const char* name) {
+    for (int i = 0; i < nur->num_structs; ++i) {
+        if (strcmp(nur->struct_table[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+// Alan adını çözer; sonuç alan token'ında önbelleklenir, böylece tekrar eden
+// erişimler (döngü gövdeleri) isim karşılaştırması yapmadan doğrudan ofsete gider.
+int resolve_struct_field(int struct_idx, int field_token_idx) {
+    Token* ft = &nur->tokens[field_token_idx];
+    if (ft->cache_struct_idx == struct_idx) return ft->cache_field_idx;
+    const StructDefinition* sd = &nur->struct_table[struct_idx];
+    for (int i = 0; i < sd->num_fields; ++i) {
+        if (strcmp(sd->fields[i].name, ft->lexeme) == 0) {
+            ft->cache_struct_idx = struct_idx; ft->cache_field_idx = i;
+            return i;
+        }
+    }
+    char err[2*MAX_IDENT_LEN + 100]; sprintf(err, "'%s' struct'ında '%s' adlı alan yok.", sd->name, ft->lexeme); error(err);
+    return -1;
+}
+// Tekil struct değişkeni (index == -1) veya struct dizisinin index'inci elemanındaki alanın adresi.
+// AoS: data + index*size + offset; SoA: her alan kendi sütununda, data + n*offset + index*alan_boyutu.
+void* struct_field_ptr(Variable* var, int index, int field_idx) {
+    if (var->type == VAR_STRUCT) {
+        return (char*)var->value.record.data + nur->struct_table[var->value.record.struct_idx].fields[field_idx].offset;
+    }
+    const StructDefinition* sd = &nur->struct_table[var->value.array.struct_idx];
+    const StructField* f = &sd->fields[field_idx];
+    if (var->value.array.soa) return (char*)var->value.array.data + (size_t)var->value.array.size * f->offset + (size_t)index * f->size;
+    return (char*)var->value.array.data + (size_t)index * sd->size + f->offset;
+}
+int struct_idx_of_ref(Value ref) {
+    Variable* v = ref.as.struct_ref.var;
+    return v->type == VAR_STRUCT ? v->value.record.struct_idx : v->value.array.struct_idx;
+}
+// Aynı tipteki iki struct arasında alan alan kopyalama (yerleşimden bağımsız).
+void copy_struct_value(Variable* dst, int dst_index, Value src) {
+    int sidx = struct_idx_of_ref(src);
+    const StructDefinition* sd = &nur->struct_table[sidx];
+    for (int i = 0; i < sd->num_fields; ++i) {
+        void* d = struct_field_ptr(dst, dst_index, i);
+        void* s = struct_field_ptr(src.as.struct_ref.var, src.as.struct_ref.index, i);
+        if (d != s) memcpy(d, s, sd->fields[i].size);
+    }
+}
+
+// --- SIMD Dizi Çekirdekleri ---
+// Tipli diziler üzerindeki toplu işlemler (sum, dot, scale...). Her çekirdeğin taşınabilir bir
+// skaler sürümü (derleyicinin SSE2 tabanına göre vektörleştirebileceği düz döngüler) ve bir AVX2
+// sürümü vardır; hangisinin kullanılacağı başlangıçta CPU özelliklerine bakılarak bir kez seçilir.
+typedef struct {
+    long long (*sum_i32)(const int* a, int n);
+    double (*sum_f64)(const double* a, int n);
+    double (*sum_f32)(const float* a, int n);
+    long long (*dot_i32)(const int* a, const int* b, int n);
+    double (*dot_f64)(const double* a, const double* b, int n);
+    double (*dot_f32)(const float* a, const float* b, int n);
+    void (*minmax_i32)(const int* a, int n, int* mn, int* mx);
+    void (*minmax_f64)(const double* a, int n, double* mn, double* mx);
+    void (*scale_f64)(double* a, int n, double k);
+    void (*scale_f32)(float* a, int n, float k);
+    void (*add_f64)(const double* a, const double* b, double* out, int n);
+    void (*add_f32)(const float* a, const float* b, float* out, int n);
+    bool (*add_i32)(const int* a, const int* b, int* out, int n); // true: taşma oldu
+    int (*count_eq_i32)(const int* a, int n, int x);
+    int (*count_eq_f64)(const double* a, int n, double x); // '==' ile aynı epsilon (1e-9)
+    int (*count_eq_u8)(const unsigned char* a, int n, unsigned char x);
+    void (*case_ascii)(char* dst, const char* src, size_t n, bool upper); // dst src ile aynı olabilir
+    bool (*equal_ignore_case)(const char* a, const char* b, size_t n);
+    const char* isa_name;
+} SimdKernels;
+SimdKernels g_simd;
+
+long long sum_i32_scalar(const int* a, int n) { long long s = 0; for (int i = 0; i < n; ++i) s += a[i]; return s; }
+double sum_f64_scalar(const double* a, int n) { double s = 0.0; for (int i = 0; i < n; ++i) s += a[i]; return s; }
+double sum_f32_scalar(const float* a, int n) { double s = 0.0; for (int i = 0; i < n; ++i) s += a[i]; return s; }
+long long dot_i32_scalar(const int* a, const int* b, int n) { long long s = 0; for (int i = 0; i < n; ++i) s += (long long)a[i] * b[i]; return s; }
+double dot_f64_scalar(const double* a, const double* b, int n) { double s = 0.0; for (int i = 0; i < n; ++i) s += a[i] * b[i]; return s; }
+double dot_f32_scalar(const float* a, const float* b, int n) { double s = 0.0; for (int i = 0; i < n; ++i) s += (double)a[i] * b[i]; return s; }
+void minmax_i32_scalar(const int* a, int n, int* mn, int* mx) {
+    int lo = a[0], hi = a[0];
+    for (int i = 1; i < n; ++i) { if (a[i] < lo) lo = a[i]; if (a[i] > hi) hi = a[i]; }
+    *mn = lo; *mx = hi;
+}
+// NaN elemanlar atlanır; yalnızca hepsi NaN ise sonuç NaN olur (AVX2 sürümü de aynı sonucu verir).
+void minmax_f64_scalar(const double* a, int n, double* mn, double* mx) {
+    double lo = a[0], hi = a[0];
+    for (int i = 1; i < n; ++i) { if (a[i] < lo || isnan(lo)) lo = a[i]; if (a[i] > hi || isnan(hi)) hi = a[i]; }
+    *mn = lo; *mx = hi;
+}
+void scale_f64_scalar(double* a, int n, double k) { for (int i = 0; i < n; ++i) a[i] *= k; }
+void scale_f32_scalar(float* a, int n, float k) { for (int i = 0; i < n; ++i) a[i] *= k; }
+void add_f64_scalar(const double* a, const double* b, double* out, int n) { for (int i = 0; i < n; ++i) out[i] = a[i] + b[i]; }
+void add_f32_scalar(const float* a, const float* b, float* out, int n) { for (int i = 0; i < n; ++i) out[i] = a[i] + b[i]; }
+bool add_i32_scalar(const int* a, const int* b, int* out, int n) {
+    bool overflow = false;
+    for (int i = 0; i < n; ++i) { int r; overflow |= __builtin_add_overflow(a[i], b[i], &r); out[i] = r; } // out a/b ile aynı olabilir
+    return overflow;
+}
+int count_eq_i32_scalar(const int* a, int n, int x) { int c = 0; for (int i = 0; i < n; ++i) c += (a[i] == x); return c; }
+int count_eq_f64_scalar(const double* a, int n, double x) { int c = 0; for (int i = 0; i < n; ++i) c += (fabs(a[i] - x) < 1e-9); return c; }
+int count_eq_u8_scalar(const unsigned char* a, int n, unsigned char x) { int c = 0; for (int i = 0; i < n; ++i) c += (a[i] == x); return c; }
+// Büyük/küçük harf yalnızca ASCII harflerinde değişir (C yerel ayarındaki toupper/tolower ile aynı);
+// 0x80 ve üstü baytlar (UTF-8 devamları dahil) olduğu gibi kalır, bu yüzden tablo araması gerekmez.
+static inline char ascii_upper(char c) { return (c >= 'a' && c <= 'z') ? (char)(c - 32) : c; }
+static inline char ascii_lower(char c) { return (c >= 'A' && c <= 'Z') ? (char)(c + 32) : c; }
+void case_ascii_scalar(char* dst, const char* src, size_t n, bool upper) {
+    if (upper) for (size_t i = 0; i < n; ++i) dst[i] = ascii_upper(src[i]);
+    else for (size_t i = 0; i < n; ++i) dst[i] = ascii_lower(src[i]);
+}
+bool equal_ignore_case_scalar(const char* a, const char* b, size_t n) {
+    for (size_t i = 0; i < n; ++i) if (ascii_lower(a[i]) != ascii_lower(b[i])) return false;
+    return true;
+}
+
+#ifdef NUR_X86_SIMD
+#define NUR_AVX2 __attribute__((target("avx2")))
+NUR_AVX2 static long long hsum_epi64_avx2(__m256i v) {
+    long long t[4]; _mm256_storeu_si256((__m256i*)t, v); return t[0] + t[1] + t[2] + t[3];
+}
+NUR_AVX2 static double hsum_pd_avx2(__m256d v) {
+    double t[4]; _mm256_storeu_pd(t, v); return (t[0] + t[1]) + (t[2] + t[3]);
+}
+NUR_AVX2 long long sum_i32_avx2(const int* a, int n) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) { // 8 x i32 -> 2 x (4 x i64), int toplamı taşmaz
+        __m256i v = _mm256_loadu_si256((const __m256i*)(a + i));
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    long long s = hsum_epi64_avx2(_mm256_add_epi64(acc0, acc1));
+    for (; i < n; ++i) s += a[i];
+    return s;
+}
+NUR_AVX2 double sum_f64_avx2(const double* a, int n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(a + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(a + i + 4));
+    }
+    double s = hsum_pd_avx2(_mm256_add_pd(acc0, acc1));
+    for (; i < n; ++i) s += a[i];
+    return s;
+}
+NUR_AVX2 double sum_f32_avx2(const float* a, int n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) { // f32 toplamı double ile biriktirilir
+        __m256 v = _mm256_loadu_ps(a + i);
+        acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+        acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+    }
+    double s = hsum_pd_avx2(_mm256_add_pd(acc0, acc1));
+    for (; i < n; ++i) s += a[i];
+    return s;
+}
+NUR_AVX2 long long dot_i32_avx2(const int* a, const int* b, int n) {
+    __m256i acc = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) { // Çarpımlar i64 şeritlerinde kesin hesaplanır
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i)), vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i lo = _mm256_mul_epi32(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(va)), _mm256_cvtepi32_epi64(_mm256_castsi256_si128(vb)));
+        __m256i hi = _mm256_mul_epi32(_mm256_cvtepi32_epi64(_mm256_extracti128_si256(va, 1)), _mm256_cvtepi32_epi64(_mm256_extracti128_si256(vb, 1)));
+        acc = _mm256_add_epi64(acc, _mm256_add_epi64(lo, hi));
+    }
+    long long s = hsum_epi64_avx2(acc);
+    for (; i < n; ++i) s += (long long)a[i] * b[i];
+    return s;
+}
+NUR_AVX2 double dot_f64_avx2(const double* a, const double* b, int n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    double s = hsum_pd_avx2(_mm256_add_pd(acc0, acc1));
+    for (; i < n; ++i) s += a[i] * b[i];
+    return s;
+}
+NUR_AVX2 double dot_f32_avx2(const float* a, const float* b, int n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 va = _mm256_loadu_ps(a + i), vb = _mm256_loadu_ps(b + i);
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(va)), _mm256_cvtps_pd(_mm256_castps256_ps128(vb))));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(va, 1)), _mm256_cvtps_pd(_mm256_extractf128_ps(vb, 1))));
+    }
+    double s = hsum_pd_avx2(_mm256_add_pd(acc0, acc1));
+    for (; i < n; ++i) s += (double)a[i] * b[i];
+    return s;
+}
+NUR_AVX2 void minmax_i32_avx2(const int* a, int n, int* mn, int* mx) {
+    int lo = a[0], hi = a[0], i = 0;
+    if (n >= 8) {
+        __m256i vlo = _mm256_loadu_si256((const __m256i*)a), vhi = vlo;
+        for (i = 8; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(a + i));
+            vlo = _mm256_min_epi32(vlo, v); vhi = _mm256_max_epi32(vhi, v);
+        }
+        int tl[8], th[8]; _mm256_storeu_si256((__m256i*)tl, vlo); _mm256_storeu_si256((__m256i*)th, vhi);
+        for (int k = 0; k < 8; ++k) { if (tl[k] < lo) lo = tl[k]; if (th[k] > hi) hi = th[k]; }
+    }
+    for (; i < n; ++i) { if (a[i] < lo) lo = a[i]; if (a[i] > hi) hi = a[i]; }
+    *mn = lo; *mx = hi;
+}
+// min_pd/max_pd bir işlenen NaN ise ikincisini döndürür: NaN şeritler biriktiricinin değeriyle değiştirilir,
+// biriktiricideki (ilk yüklemeden gelen) NaN da ilk sayıyla yer değiştirir. Şeritler skaler sürümdeki gibi birleşir.
+NUR_AVX2 void minmax_f64_avx2(const double* a, int n, double* mn, double* mx) {
+    double lo = a[0], hi = a[0]; int i = 0;
+    if (n >= 4) {
+        __m256d vlo = _mm256_loadu_pd(a), vhi = vlo;
+        for (i = 4; i + 4 <= n; i += 4) {
+            __m256d v = _mm256_loadu_pd(a + i);
+            __m256d ord = _mm256_cmp_pd(v, v, _CMP_ORD_Q);
+            vlo = _mm256_min_pd(vlo, _mm256_blendv_pd(vlo, v, ord));
+            vhi = _mm256_max_pd(vhi, _mm256_blendv_pd(vhi, v, ord));
+        }
+        double tl[4], th[4]; _mm256_storeu_pd(tl, vlo); _mm256_storeu_pd(th, vhi);
+        for (int k = 0; k < 4; ++k) { if (tl[k] < lo || isnan(lo)) lo = tl[k]; if (th[k] > hi || isnan(hi)) hi = th[k]; }
+    }
+    for (; i < n; ++i) { if (a[i] < lo || isnan(lo)) lo = a[i]; if (a[i] > hi || isnan(hi)) hi = a[i]; }
+    *mn = lo; *mx = hi;
+}
+NUR_AVX2 void scale_f64_avx2(double* a, int n, double k) {
+    __m256d vk = _mm256_set1_pd(k); int i = 0;
+    for (; i + 4 <= n; i += 4) _mm256_storeu_pd(a + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), vk));
+    for (; i < n; ++i) a[i] *= k;
+}
+NUR_AVX2 void scale_f32_avx2(float* a, int n, float k) {
+    __m256 vk = _mm256_set1_ps(k); int i = 0;
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(a + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), vk));
+    for (; i < n; ++i) a[i] *= k;
+}
+NUR_AVX2 void add_f64_avx2(const double* a, const double* b, double* out, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    for (; i < n; ++i) out[i] = a[i] + b[i];
+}
+NUR_AVX2 void add_f32_avx2(const float* a, const float* b, float* out, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    for (; i < n; ++i) out[i] = a[i] + b[i];
+}
+NUR_AVX2 bool add_i32_avx2(const int* a, const int* b, int* out, int n) {
+    __m256i ovf = _mm256_setzero_si256(); int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i)), vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i r = _mm256_add_epi32(va, vb);
+        // İşaretli taşma: iki operandın işareti aynı, sonucunki farklı
+        ovf = _mm256_or_si256(ovf, _mm256_and_si256(_mm256_xor_si256(va, r), _mm256_xor_si256(vb, r)));
+        _mm256_storeu_si256((__m256i*)(out + i), r);
+    }
+    bool overflow = _mm256_movemask_ps(_mm256_castsi256_ps(ovf)) != 0;
+    for (; i < n; ++i) { int r; overflow |= __builtin_add_overflow(a[i], b[i], &r); out[i] = r; }
+    return overflow;
+}
+NUR_AVX2 int count_eq_i32_avx2(const int* a, int n, int x) {
+    __m256i vx = _mm256_set1_epi32(x); int c = 0, i = 0;
+    for (; i + 8 <= n; i += 8)
+        c += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(a + i)), vx))));
+    for (; i < n; ++i) c += (a[i] == x);
+    return c;
+}
+NUR_AVX2 int count_eq_f64_avx2(const double* a, int n, double x) {
+    __m256d vx = _mm256_set1_pd(x), eps = _mm256_set1_pd(1e-9), sign = _mm256_set1_pd(-0.0);
+    int c = 0, i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d diff = _mm256_andnot_pd(sign, _mm256_sub_pd(_mm256_loadu_pd(a + i), vx)); // |a - x|
+        c += __builtin_popcount(_mm256_movemask_pd(_mm256_cmp_pd(diff, eps, _CMP_LT_OQ)));
+    }
+    for (; i < n; ++i) c += (fabs(a[i] - x) < 1e-9);
+    return c;
+}
+NUR_AVX2 int count_eq_u8_avx2(const unsigned char* a, int n, unsigned char x) {
+    __m256i vx = _mm256_set1_epi8((char)x); int c = 0, i = 0;
+    for (; i + 32 <= n; i += 32)
+        c += __builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + i)), vx)));
+    for (; i < n; ++i) c += (a[i] == x);
+    return c;
+}
+// 32 baytta bir: aralıktaki harflerin maskesiyle 0x20 biti çevrilir. İşaretli karşılaştırma 0x80 ve
+// üstü baytları negatif gördüğünden ASCII dışı baytlar maskeye hiç girmez.
+NUR_AVX2 static inline __m256i case_ascii_vec(__m256i v, __m256i lo, __m256i hi) {
+    __m256i in_range = _mm256_and_si256(_mm256_cmpgt_epi8(v, lo), _mm256_cmpgt_epi8(hi, v));
+    return _mm256_xor_si256(v, _mm256_and_si256(in_range, _mm256_set1_epi8(0x20)));
+}
+NUR_AVX2 void case_ascii_avx2(char* dst, const char* src, size_t n, bool upper) {
+    __m256i lo = _mm256_set1_epi8(upper ? 'a' - 1 : 'A' - 1), hi = _mm256_set1_epi8(upper ? 'z' + 1 : 'Z' + 1);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+        _mm256_storeu_si256((__m256i*)(dst + i), case_ascii_vec(_mm256_loadu_si256((const __m256i*)(src + i)), lo, hi));
+    case_ascii_scalar(dst + i, src + i, n - i, upper);
+}
+NUR_AVX2 bool equal_ignore_case_avx2(const char* a, const char* b, size_t n) {
+    __m256i lo = _mm256_set1_epi8('A' - 1), hi = _mm256_set1_epi8('Z' + 1);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = case_ascii_vec(_mm256_loadu_si256((const __m256i*)(a + i)), lo, hi);
+        __m256i vb = case_ascii_vec(_mm256_loadu_si256((const __m256i*)(b + i)), lo, hi);
+        if ((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)) != 0xffffffffu) return false;
+    }
+    return equal_ignore_case_scalar(a + i, b + i, n - i);
+}
+#endif
+
+void init_simd_kernels() {
+    g_simd = (SimdKernels){ sum_i32_scalar, sum_f64_scalar, sum_f32_scalar, dot_i32_scalar, dot_f64_scalar, dot_f32_scalar,
+        minmax_i32_scalar, minmax_f64_scalar, scale_f64_scalar, scale_f32_scalar, add_f64_scalar, add_f32_scalar, add_i32_scalar,
+        count_eq_i32_scalar, count_eq_f64_scalar, count_eq_u8_scalar, case_ascii_scalar, equal_ignore_case_scalar, "scalar" };
+#ifdef NUR_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && getenv("NUR_NO_SIMD") == NULL) {
+        g_simd = (SimdKernels){ sum_i32_avx2, sum_f64_avx2, sum_f32_avx2, dot_i32_avx2, dot_f64_avx2, dot_f32_avx2,
+            minmax_i32_avx2, minmax_f64_avx2, scale_f64_avx2, scale_f32_avx2, add_f64_avx2, add_f32_avx2, add_i32_avx2,
+            count_eq_i32_avx2, count_eq_f64_avx2, count_eq_u8_avx2, case_ascii_avx2, equal_ignore_case_avx2, "avx2" };
+    }
+#endif
+}
+
+// --- Sıralama ve Arama ---
+// Diziler (anahtar, indis) çiftlerine dönüştürülüp sıralanır, sonra değerler bu permütasyonla yerleştirilir.
+// Sayısal anahtarlar sıralamayı koruyan 64-bit işaretsiz değerlere çevrilir; string anahtarı ilk 8 baytın
+// big-endian önekidir (eşitlikte strcmp). Tamsayı dizileri radix sort, diğerleri introsort ile sıralanır;
+// eşit anahtarlar indis sırasını korur, böylece sıralı ve paralel yol aynı sonucu üretir.
+typedef struct { unsigned long long key; int idx; } SortItem;
+typedef struct { const char* strings; size_t string_slot; } SortContext; // strings NULL ise sayısal
+
+static inline int sort_item_cmp(const SortItem* a, const SortItem* b, const SortContext* c) {
+    if (a->key != b->key) return a->key < b->key ? -1 : 1;
+    if (c->strings) {
+        int r = strcmp(c->strings + (size_t)a->idx * c->string_slot, c->strings + (size_t)b->idx * c->string_slot);
+        if (r != 0) return r;
+    }
+    return (a->idx > b->idx) - (a->idx < b->idx);
+}
+
+unsigned long long sort_key_of(VarType et, const void* slot) {
+    switch (et) {
+        case VAR_INT: return (unsigned long long)(long long)*(const int*)slot ^ (1ULL << 63);
+        case VAR_I64: return (unsigned long long)*(const long long*)slot ^ (1ULL << 63);
+        case VAR_U8: return *(const unsigned char*)slot;
+        case VAR_FLOAT: case VAR_F32: {
+            double d = et == VAR_FLOAT ? *(const double*)slot : (double)*(const float*)slot;
+            unsigned long long b; memcpy(&b, &d, sizeof b);
+            return (b >> 63) ? ~b : b | (1ULL << 63); // Negatifler ters sırada
+        }
+        case VAR_STRING: {
+            const unsigned char* str = slot; unsigned long long k = 0; int i = 0;
+            for (; i < 8 && str[i]; ++i) k = (k << 8) | str[i];
+            return k << (8 * (8 - i));
+        }
+        default: return 0;
+    }
+}
+
+void sort_items_insertion(SortItem* a, int n, const SortContext* c) {
+    for (int i = 1; i < n; ++i) {
+        SortItem x = a[i]; int j = i - 1;
+        while (j >= 0 && sort_item_cmp(&a[j], &x, c) > 0) { a[j + 1] = a[j]; --j; }
+        a[j + 1] = x;
+    }
+}
+
+void sort_items_sift_down(SortItem* a, int root, int n, const SortContext* c) {
+    SortItem x = a[root];
+    for (int child; (child = 2 * root + 1) < n; root = child) {
+        if (child + 1 < n && sort_item_cmp(&a[child], &a[child + 1], c) < 0) child++;
+        if (sort_item_cmp(&x, &a[child], c) >= 0) break;
+        a[root] = a[child];
+    }
+    a[root] = x;
+}
+
+void sort_items_heap(SortItem* a, int n, const SortContext* c) {
+    for (int i = n / 2 - 1; i >= 0; --i) sort_items_sift_down(a, i, n, c);
+    for (int end = n - 1; end > 0; --end) {
+        SortItem t = a[0]; a[0] = a[end]; a[end] = t;
+        sort_items_sift_down(a, 0, end, c);
+    }
+}
+
+void sort_items_intro(SortItem* a, int n, int depth_limit, const SortContext* c) {
+    while (n > 16) {
+        if (depth_limit-- == 0) { sort_items_heap(a, n, c); return; } // Kötü pivot dizisi: heapsort'a düş
+        int m = (n - 1) / 2; SortItem t;
+        // Üçün medyanı: a[0] <= a[m] <= a[n-1]
+        if (sort_item_cmp(&a[m], &a[0], c) < 0) { t = a[m]; a[m] = a[0]; a[0] = t; }
+        if (sort_item_cmp(&a[n - 1], &a[m], c) < 0) { t = a[n - 1]; a[n - 1] = a[m]; a[m] = t;
+            if (sort_item_cmp(&a[m], &a[0], c) < 0) { t = a[m]; a[m] = a[0]; a[0] = t; } }
+        SortItem pivot = a[m];
+        int i = -1, j = n; // Hoare bölümlemesi
+        for (;;) {
+            do ++i; while (sort_item_cmp(&a[i], &pivot, c) < 0);
+            do --j; while (sort_item_cmp(&a[j], &pivot, c) > 0);
+            if (i >= j) break;
+            t = a[i]; a[i] = a[j]; a[j] = t;
+        }
+        int left_n = j + 1;
+        if (left_n < n - left_n) { sort_items_intro(a, left_n, depth_limit, c); a += left_n; n -= left_n; }
+        else { sort_items_intro(a + left_n, n - left_n, depth_limit, c); n = left_n; }
+    }
+    sort_items_insertion(a, n, c);
+}
+
+// LSD radix sort (8 bitlik basamaklar); tüm elemanlarda aynı olan basamaklar atlanır. Kararlıdır.
+// Sıralama iş parçacıklarında da çalışır (nur yok): bellek ayrılamazsa false döner, çağıran introsort'a geçer.
+bool sort_items_radix(SortItem* a, int n) {
+    if (n < 2) return true;
+    static __thread size_t counts[8][256];
+    memset(counts, 0, sizeof counts);
+    unsigned long long varying = 0, first = a[0].key;
+    for (int i = 0; i < n; ++i) {
+        unsigned long long k = a[i].key; varying |= k ^ first;
+        for (int d = 0; d < 8; ++d) counts[d][(k >> (8 * d)) & 0xff]++;
+    }
+    SortItem* tmp = malloc((size_t)n * sizeof(SortItem));
+    if (!tmp) return false;
+    SortItem *src = a, *dst = tmp;
+    for (int d = 0; d < 8; ++d) {
+        if (((varying >> (8 * d)) & 0xff) == 0) continue;
+        size_t pos = 0;
+        for (int b = 0; b < 256; ++b) { size_t cnt = counts[d][b]; counts[d][b] = pos; pos += cnt; }
+        for (int i = 0; i < n; ++i) dst[counts[d][(src[i].key >> (8 * d)) & 0xff]++] = src[i];
+        SortItem* t = src; src = dst; dst = t;
+    }
+    if (src != a) memcpy(a, src, (size_t)n * sizeof(SortItem));
+    free(tmp);
+    return true;
+}
+
+void sort_items_sequential(SortItem* a, int n, bool use_radix, const SortContext* c) {
+    if (use_radix && sort_items_radix(a, n)) return;
+    int depth = 0; for (int k = n; k > 1; k >>= 1) depth += 2;
+    sort_items_intro(a, n, depth, c);
+}
+
+// Merge path: iki sıralı dizinin birleşiminde ilk 'diag' çıktının kaçının A'dan geldiğini bulur.
+int merge_path_split(const SortItem* A, int na, const SortItem* B, int nb, int diag, const SortContext* c) {
+    int lo = diag > nb ? diag - nb : 0, hi = diag < na ? diag : na;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (sort_item_cmp(&A[mid], &B[diag - mid - 1], c) <= 0) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+typedef struct {
+    SortItem* a; int n; bool use_radix; // Parça sıralama görevi
+    const SortItem *A, *B; int na, nb, diag_begin, diag_end; SortItem* out; // Birleştirme görevi
+    const SortContext* c;
+} SortTask;
+
+void* sort_chunk_worker(void* arg) {
+    SortTask* t = arg;
+    sort_items_sequential(t->a, t->n, t->use_radix, t->c);
+    return NULL;
+}
+
+void* merge_segment_worker(void* arg) {
+    SortTask* t = arg;
+    int i = merge_path_split(t->A, t->na, t->B, t->nb, t->diag_begin, t->c), j = t->diag_begin - i;
+    int i_end = merge_path_split(t->A, t->na, t->B, t->nb, t->diag_end, t->c), j_end = t->diag_end - i_end;
+    SortItem* o = t->out + t->diag_begin;
+    while (i < i_end && j < j_end) *o++ = sort_item_cmp(&t->A[i], &t->B[j], t->c) <= 0 ? t->A[i++] : t->B[j++];
+    while (i < i_end) *o++ = t->A[i++];
+    while (j < j_end) *o++ = t->B[j++];
+    return NULL;
+}
+
+int sort_thread_count() {
+    static int cached = 0;
+    if (cached == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        cached = cpus < 1 ? 1 : (cpus > MAX_SORT_THREADS ? MAX_SORT_THREADS : (int)cpus);
+    }
+    return cached;
+}
+
+void run_sort_tasks(SortTask* tasks, int count, void* (*worker)(void*)) {
+    pthread_t th[2 * MAX_SORT_THREADS];
+    bool started[2 * MAX_SORT_THREADS];
+    for (int i = 1; i < count; ++i) started[i] = pthread_create(&th[i], NULL, worker, &tasks[i]) == 0;
+    worker(&tasks[0]); // İlk görev çağıran iş parçacığında
+    for (int i = 1; i < count; ++i) { if (started[i]) pthread_join(th[i], NULL); else worker(&tasks[i]); }
+}
+
+// Büyük dizilerde: parçalar paralel sıralanır, ardından her seviyede parça çiftleri merge path ile
+// eşit çıktı dilimlerine bölünüp paralel birleştirilir.
+void sort_items(SortItem* a, int n, bool use_radix, const SortContext* c) {
+    int threads = sort_thread_count();
+    if (n < PARALLEL_SORT_MIN || threads < 2) { sort_items_sequential(a, n, use_radix, c); return; }
+
+    SortTask tasks[2 * MAX_SORT_THREADS];
+    int bounds[MAX_SORT_THREADS + 1], chunks = threads;
+    for (int k = 0; k <= chunks; ++k) bounds[k] = (int)((long long)n * k / chunks);
+    for (int k = 0; k < chunks; ++k) tasks[k] = (SortTask){ .a = a + bounds[k], .n = bounds[k + 1] - bounds[k], .use_radix = use_radix, .c = c };
+    run_sort_tasks(tasks, chunks, sort_chunk_worker);
+
+    SortItem* buf = malloc((size_t)n * sizeof(SortItem));
+    if (!buf) { sort_items_sequential(a, n, use_radix, c); return; } // Sıralı parçalar yerinde yeniden sıralanır
+    SortItem *src = a, *dst = buf;
+    while (chunks > 1) {
+        int pairs = chunks / 2, per_pair = threads / pairs > 0 ? threads / pairs : 1, num_tasks = 0, new_chunks = 0;
+        int new_bounds[MAX_SORT_THREADS + 1]; new_bounds[0] = 0;
+        for (int p = 0; p < chunks; p += 2) {
+            int b0 = bounds[p], b1 = bounds[p + 1], b2 = p + 1 < chunks ? bounds[p + 2] : b1;
+            int total = b2 - b0, segs = p + 1 < chunks ? per_pair : 1;
+            for (int s = 0; s < segs; ++s)
+                tasks[num_tasks++] = (SortTask){ .A = src + b0, .na = b1 - b0, .B = src + b1, .nb = b2 - b1,
+                    .diag_begin = (int)((long long)total * s / segs), .diag_end = (int)((long long)total * (s + 1) / segs), .out = dst + b0, .c = c };
+            new_bounds[++new_chunks] = b2;
+        }
+        run_sort_tasks(tasks, num_tasks, merge_segment_worker);
+        memcpy(bounds, new_bounds, sizeof(int) * (new_chunks + 1));
+        chunks = new_chunks;
+        SortItem* t = src; src = dst; dst = t;
+    }
+    if (src != a) memcpy(a, src, (size_t)n * sizeof(SortItem));
+    free(buf);
+}
+
+// --- Parser Yardımcıları --- 
+Token consume_token(TokenType expected_type) {
+    if (nur->current_token_idx >= nur->num_tokens) { char err[100]; sprintf(err,"EOF beklenmedik şekilde oluştu, beklenen: %s",token_type_names[expected_type]); error(err); }
+    Token t = nur->tokens[nur->current_token_idx];
+    if (t.type != expected_type) { char err[MAX_STRING_LEN+100];sprintf(err,"Beklenen %s ama %s ('%s') geldi",token_type_names[expected_type],token_type_names[t.type],t.lexeme);error(err);}
+    nur->current_token_idx++; return t;
+}
+Token peek_token() { if (nur->current_token_idx >= nur->num_tokens) return create_token(TOKEN_EOF, "EOF"); return nur->tokens[nur->current_token_idx];}
+Token peek_next_token() { if(nur->current_token_idx+1>=nur->num_tokens)return create_token(TOKEN_EOF,"EOF"); return nur->tokens[nur->current_token_idx + 1]; }
+
+// --- İfade Çözümleme --- 
+Value create_value_int(int v){Value val={VAL_INT,false,{0}};val.as.int_val=v;return val;}
+Value create_value_i64(long long v){Value val={VAL_I64,false,{0}};val.as.i64_val=v;return val;}
+Value create_value_float(double v){Value val={VAL_FLOAT,false,{0}};val.as.float_val=v;return val;}
+Value create_value_bool(bool v){Value val={VAL_BOOLEAN,false,{0}};val.as.bool_val=v;return val;}
+Value create_value_string(const char* v){Value val={VAL_STRING,false,{0}};if(v){copy_bounded(val.as.string_val, v, MAX_STRING_LEN);}else{val.as.string_val[0]='\0';}return val;}
+Value create_value_null(){Value val={VAL_NULL};return val;}
+Value create_value_array_ref(Variable* v){if(!v||v->type!=VAR_ARRAY)error("create_value_array_ref: geçersiz değişken veya değişken array değil.");Value val={VAL_ARRAY_REF,false,{0}};val.as.array_var=v;return val;}
+Value create_value_struct_ref(Variable* v, int index){Value val={VAL_STRUCT_REF,false,{0}};val.as.struct_ref.var=v;val.as.struct_ref.index=index;return val;}
+bool value_is_integer(Value v) { return v.type == VAL_INT || v.type == VAL_I64; }
+bool value_is_numeric(Value v) { return v.type == VAL_INT || v.type == VAL_I64 || v.type == VAL_FLOAT; }
+long long value_as_i64(Value v) { return v.type == VAL_I64 ? v.as.i64_val : (long long)v.as.int_val; }
+double value_as_double(Value v) {
+    if (v.type == VAL_FLOAT) return v.as.float_val;
+    return v.type == VAL_I64 ? (double)v.as.i64_val : (double)v.as.int_val;
+}
+
+// '.alan' erişimi: var tekil struct (index == -1) ya da struct dizisi (index >= 0).
+Value parse_field_access(Variable* var, int index, bool execute) {
+    consume_token(TOKEN_DOT);
+    int field_token_idx = nur->current_token_idx;
+    consume_token(TOKEN_IDENTIFIER);
+    if (!execute) return create_value_null();
+    bool is_struct = index < 0 ? var->type == VAR_STRUCT : (var->type == VAR_ARRAY && var->value.array.element_type == VAR_STRUCT);
+    if (!is_struct) { char msg[150]; sprintf(msg, "'%s' bir struct değil, '.' ile alan erişimi yapılamaz.", var->name); error(msg); }
+    int sidx = var->type == VAR_STRUCT ? var->value.record.struct_idx : var->value.array.struct_idx;
+    int field_idx = resolve_struct_field(sidx, field_token_idx);
+    return load_typed_slot(nur->struct_table[sidx].fields[field_idx].type, struct_field_ptr(var, index, field_idx));
+}
+
+// Üreteç fonksiyonunun çağrısı gövdeyi çalıştırmaz, bir üreteç döndürür (bkz. Üreteçler)
+Value execute_function_call(const FunctionDefinition* func_def, Value args[], int num_args_passed) {
+    if (func_def->return_type == VAR_GENERATOR) return generator_create(func_def, args, num_args_passed);
+    return invoke_function(func_def, args, num_args_passed);
+}
+Value invoke_function(const FunctionDefinition* func_def, Value args[], int num_args_passed) {
+    if (num_args_passed != func_def->num_params) {
+        char err[200]; sprintf(err, "'%s' fonksiyonu %d parametre bekliyor ama %d argüman verildi.", func_def->name, func_def->num_params, num_args_passed);
+        error(err);
+    }
+    
+    if (nur->call_stack_ptr + 1 >= MAX_CALL_STACK_DEPTH) error("Çağrı yığını taştı (Maksimum iç içe fonksiyon).");
+    nur->call_stack_ptr++;
+    CallFrame* frame = &nur->call_stack[nur->call_stack_ptr];
+    frame->return_address_token_idx = nur->current_token_idx; 
+    frame->symbol_table_scope_start_idx = nur->num_variables; 
+    frame->prev_loop_depth = nur->loop_depth; nur->loop_depth = 0; 
+    frame->prev_for_loop_var_stack_ptr = nur->for_loop_var_stack_ptr; nur->for_loop_var_stack_ptr = -1; 
+    frame->func_def = func_def; 
+    
+    enter_scope(); 
+    
+    for (int i = 0; i < func_def->num_params; ++i) {
+        Variable* param_var = declare_variable(func_def->params[i].name, func_def->params[i].type, false, VAR_NULL_TYPE, 0, -1); // Last two args irrelevant for non-arrays
+        Value arg_val = args[i];
+        // Arrays are not directly passable by value in this design, only by reference (which isn't implemented as a parameter type yet)
+        bool type_match = coerce_value_to_var_type(param_var->type, &arg_val);
+        if (type_match) store_typed_slot(param_var->type, scalar_variable_slot(param_var), arg_val);
+        
+        if (!type_match) {
+            char err[250]; sprintf(err, "'%s' fonksiyonunun '%s' parametresine tip uyuşmazlığı: beklenen %s, verilen %s",
+                                   func_def->name, func_def->params[i].name, var_type_to_string_user(param_var->type), value_type_to_string(arg_val.type));
+            // Cleanup before erroring:
+            // Since parameters are declared in a new scope, exit_scope will clean them.
+            // But we need to pop the call frame manually.
+            exit_scope(); 
+            nur->call_stack_ptr--; 
+            error(err);
+        }
+        param_var->is_defined = true;
+    }
+    
+    nur->current_token_idx = func_def->body_start_token_idx;
+    nur->return_flag = false;
+    nur->return_value_holder = create_value_null(); 
+    
+    bool dummy_b = false, dummy_c = false; 
+    // Function body execution scope is managed by enter_scope above and exit_scope below.
+    // parse_block itself should not create another scope if in_function_body is true.
+    // The LBRACE of the function body is at func_def->body_start_token_idx.
+    // We need to parse the block starting from LBRACE.
+    if (nur->tokens[nur->current_token_idx].type != TOKEN_LBRACE) {
+        // This should not happen if parse_fun_declaration is correct
+        error("Fonksiyon gövdesi başlangıcında LBRACE ({) bekleniyordu.");
+    }
+    parse_block(true, &dummy_b, &dummy_c, true); // true for in_function_body
+    
+    Value return_val_from_func = nur->return_value_holder; 
+    bool function_returned = nur->return_flag;
+    nur->return_flag = false; // return, çağıranın deyim akışını kesmemeli
+    if(function_returned == false && func_def->return_type != VAR_VOID && func_def->return_type != VAR_GENERATOR){ 
+        char err[200]; sprintf(err, "'%s' fonksiyonu değer döndürmeliydi (%s) ama return ifadesi bulunamadı (veya gövde sonuna ulaşıldı).", func_def->name, var_type_to_string_user(func_def->return_type));
+        exit_scope(); 
+        nur->loop_depth = frame->prev_loop_depth; 
+        nur->for_loop_var_stack_ptr = frame->prev_for_loop_var_stack_ptr;
+        nur->call_stack_ptr--;
+        error(err);
+    }
+    
+    exit_scope(); 
+    
+    nur->current_token_idx = frame->return_address_token_idx; // Restore token index to after the call
+    nur->loop_depth = frame->prev_loop_depth;
+    nur->for_loop_var_stack_ptr = frame->prev_for_loop_var_stack_ptr;
+    nur->call_stack_ptr--;
+    
+    if (func_def->return_type == VAR_VOID || func_def->return_type == VAR_GENERATOR) {
+        if (function_returned && return_val_from_func.type != VAL_NULL) { 
+            error(func_def->return_type == VAR_VOID ? "Void fonksiyon değer döndüremez (return ifadesiyle bir değer döndürmeye çalıştı)."
+                                                    : "Üreteç fonksiyonu return ile değer döndüremez; değerler 'yield' ile verilir.");
+        }
+        return create_value_null(); 
+    } else { 
+        bool ret_type_match = coerce_value_to_var_type(func_def->return_type, &return_val_from_func);
+        
+        if (!ret_type_match) {
+            char err[250]; sprintf(err, "'%s' fonksiyonunun dönüş tipi uyuşmazlığı: beklenen %s, dönen %s",
+                                   func_def->name, var_type_to_string_user(func_def->return_type), value_type_to_string(return_val_from_func.type));
+            error(err);
+        }
+        return return_val_from_func;
+    }
+}
+
+// --- Dizi Dahili Fonksiyonları ---
+// sum/min/max/dot/fill/scale/add/count_if_eq: tipli diziler üzerinde g_simd çekirdeklerini çağırır.
+// Tamsayı dizilerinin sum/dot sonucu taşmayı önlemek için i64 döner.
+Variable* expect_array_arg(const char* fname, Value v, int pos) {
+    if (v.type != VAL_ARRAY_REF) { char err[150]; sprintf(err, "'%s' %d. argüman olarak dizi bekler.", fname, pos); error(err); }
+    Variable* arr = v.as.array_var;
+    if (arr->value.array.element_type == VAR_STRUCT) { char err[150]; sprintf(err, "'%s' struct dizileri üzerinde çalışmaz.", fname); error(err); }
+    return arr;
+}
+Variable* expect_numeric_array_arg(const char* fname, Value v, int pos) {
+    Variable* arr = expect_array_arg(fname, v, pos);
+    VarType et = arr->value.array.element_type;
+    if (et != VAR_INT && et != VAR_I64 && et != VAR_U8 && et != VAR_FLOAT && et != VAR_F32) {
+        char err[150]; sprintf(err, "'%s' sayısal dizi bekler (%s dizisi verildi).", fname, var_type_to_string_user(et)); error(err);
+    }
+    return arr;
+}
+void expect_writable_array(const char* fname, Variable* arr) {
+    if (arr->value.array.read_only) { char err[150]; sprintf(err, "'%s': '%s' salt okunur eşlenmiş bir dizi.", fname, arr->name); error(err); }
+}
+void expect_same_shape(const char* fname, Variable* a, Variable* b) {
+    if (a->value.array.element_type != b->value.array.element_type) {
+        char err[150]; sprintf(err, "'%s' aynı eleman tipinde diziler bekler (%s / %s).", fname,
+            var_type_to_string_user(a->value.array.element_type), var_type_to_string_user(b->value.array.element_type)); error(err);
+    }
+    if (a->value.array.size != b->value.array.size) {
+        char err[150]; sprintf(err, "'%s' aynı boyutta diziler bekler (%d / %d).", fname, a->value.array.size, b->value.array.size); error(err);
+    }
+}
+
+Value builtin_sum(Variable* arr) {
+    void* d = arr->value.array.data; int n = arr->value.array.size;
+    switch (arr->value.array.element_type) {
+        case VAR_INT: return create_value_i64(g_simd.sum_i32((const int*)d, n));
+        case VAR_FLOAT: return create_value_float(g_simd.sum_f64((const double*)d, n));
+        case VAR_F32: return create_value_float(g_simd.sum_f32((const float*)d, n));
+        case VAR_U8: { long long s = 0; const unsigned char* a = d; for (int i = 0; i < n; ++i) s += a[i]; return create_value_i64(s); }
+        case VAR_I64: {
+            long long s = 0; const long long* a = d;
+            for (int i = 0; i < n; ++i) if (__builtin_add_overflow(s, a[i], &s)) error("Tamsayı taşması: 'sum' sonucu i64 sınırlarını aşıyor.");
+            return create_value_i64(s);
+        }
+        default: return create_value_null();
+    }
+}
+
+Value builtin_min_max(Variable* arr, bool want_max) {
+    void* d = arr->value.array.data; int n = arr->value.array.size;
+    if (n == 0) error(want_max ? "'max' boş dizi üzerinde çağrılamaz." : "'min' boş dizi üzerinde çağrılamaz.");
+    switch (arr->value.array.element_type) {
+        case VAR_INT: { int mn, mx; g_simd.minmax_i32((const int*)d, n, &mn, &mx); return create_value_int(want_max ? mx : mn); }
+        case VAR_FLOAT: { double mn, mx; g_simd.minmax_f64((const double*)d, n, &mn, &mx); return create_value_float(want_max ? mx : mn); }
+        default: { // i64, f32, u8: skaler
+            Value best = load_typed_slot(arr->value.array.element_type, d);
+            size_t es = get_sizeof_element_type(arr->value.array.element_type);
+            for (int i = 1; i < n; ++i) {
+                Value v = load_typed_slot(arr->value.array.element_type, (char*)d + i * es);
+                int c = compare_numeric_values(v, best);
+                if (want_max ? c > 0 : c < 0) best = v;
+            }
+            return best;
+        }
+    }
+}
+
+Value builtin_dot(Variable* a, Variable* b) {
+    expect_same_shape("dot", a, b);
+    void* da = a->value.array.data; void* db = b->value.array.data; int n = a->value.array.size;
+    switch (a->value.array.element_type) {
+        case VAR_INT: return create_value_i64(g_simd.dot_i32((const int*)da, (const int*)db, n));
+        case VAR_FLOAT: return create_value_float(g_simd.dot_f64((const double*)da, (const double*)db, n));
+        case VAR_F32: return create_value_float(g_simd.dot_f32((const float*)da, (const float*)db, n));
+        case VAR_U8: { long long s = 0; const unsigned char *x = da, *y = db; for (int i = 0; i < n; ++i) s += x[i] * y[i]; return create_value_i64(s); }
+        case VAR_I64: {
+            long long s = 0, p; const long long *x = da, *y = db;
+            for (int i = 0; i < n; ++i)
+                if (__builtin_mul_overflow(x[i], y[i], &p) || __builtin_add_overflow(s, p, &s)) error("Tamsayı taşması: 'dot' sonucu i64 sınırlarını aşıyor.");
+            return create_value_i64(s);
+        }
+        default: return create_value_null();
+    }
+}
+
+void builtin_fill(Variable* arr, Value x) {
+    expect_writable_array("fill", arr);
+    VarType et = arr->value.array.element_type;
+    if (!coerce_value_to_var_type(et, &x)) {
+        char err[150]; sprintf(err, "'fill' değeri dizi eleman tipiyle uyumsuz: beklenen %s, verilen %s.", var_type_to_string_user(et), value_type_to_string(x.type)); error(err);
+    }
+    size_t es = get_sizeof_element_type(et), total = es * (size_t)arr->value.array.size;
+    if (total == 0) return;
+    char* d = arr->value.array.data;
+    store_typed_slot(et, d, x);
+    for (size_t filled = es; filled < total; filled *= 2) // İlk elemanı ikiye katlayarak kopyala (memcpy vektörleştirilmiş)
+        memcpy(d + filled, d, filled < total - filled ? filled : total - filled);
+}
+
+void builtin_scale(Variable* arr, Value k) {
+    expect_writable_array("scale", arr);
+    VarType et = arr->value.array.element_type; void* d = arr->value.array.data; int n = arr->value.array.size;
+    if (!value_is_numeric(k)) error("'scale' çarpanı sayısal olmalıdır.");
+    if (et == VAR_FLOAT) { g_simd.scale_f64((double*)d, n, value_as_double(k)); return; }
+    if (et == VAR_F32) { g_simd.scale_f32((float*)d, n, (float)value_as_double(k)); return; }
+    if (!value_is_integer(k)) error("Tamsayı dizisi 'scale' ile yalnızca tamsayı çarpanla ölçeklenebilir.");
+    long long kk = value_as_i64(k);
+    for (int i = 0; i < n; ++i) { // Tamsayı dizileri: taşma denetimli skaler döngü
+        Value v = load_typed_slot(et, (char*)d + i * get_sizeof_element_type(et));
+        long long r;
+        if (__builtin_mul_overflow(value_as_i64(v), kk, &r)) error("Tamsayı taşması: 'scale' sonucu i64 sınırlarını aşıyor.");
+        Value rv = create_value_i64(r);
+        coerce_value_to_var_type(et, &rv); // int/u8 sınır denetimi burada yapılır
+        store_typed_slot(et, (char*)d + i * get_sizeof_element_type(et), rv);
+    }
+}
+
+void builtin_add(Variable* a, Variable* b, Variable* out) {
+    expect_same_shape("add", a, b); expect_same_shape("add", a, out); expect_writable_array("add", out);
+    VarType et = a->value.array.element_type; int n = a->value.array.size;
+    void *da = a->value.array.data, *db = b->value.array.data, *dout = out->value.array.data;
+    switch (et) {
+        case VAR_FLOAT: g_simd.add_f64((const double*)da, (const double*)db, (double*)dout, n); return;
+        case VAR_F32: g_simd.add_f32((const float*)da, (const float*)db, (float*)dout, n); return;
+        case VAR_INT:
+            if (g_simd.add_i32((const int*)da, (const int*)db, (int*)dout, n)) error("Tamsayı taşması: 'add' sonucu int sınırlarını aşıyor (i64 kullanın).");
+            return;
+        case VAR_I64: {
+            const long long *x = da, *y = db; long long* o = dout;
+            for (int i = 0; i < n; ++i) { long long r; if (__builtin_add_overflow(x[i], y[i], &r)) error("Tamsayı taşması: 'add' sonucu i64 sınırlarını aşıyor."); o[i] = r; }
+            return;
+        }
+        case VAR_U8: {
+            const unsigned char *x = da, *y = db; unsigned char* o = dout;
+            for (int i = 0; i < n; ++i) { int r = x[i] + y[i]; if (r > 255) error("'add' sonucu u8 sınırlarını aşıyor (0-255)."); o[i] = (unsigned char)r; }
+            return;
+        }
+        default: return;
+    }
+}
+
+Value builtin_count_if_eq(Variable* arr, Value x) {
+    VarType et = arr->value.array.element_type; void* d = arr->value.array.data; int n = arr->value.array.size;
+    if (et == VAR_INT && value_is_integer(x)) {
+        long long v = value_as_i64(x);
+        return create_value_int((v < INT_MIN || v > INT_MAX) ? 0 : g_simd.count_eq_i32((const int*)d, n, (int)v));
+    }
+    if (et == VAR_U8 && value_is_integer(x)) {
+        long long v = value_as_i64(x);
+        return create_value_int((v < 0 || v > 255) ? 0 : g_simd.count_eq_u8((const unsigned char*)d, n, (unsigned char)v));
+    }
+    if (et == VAR_FLOAT && value_is_numeric(x)) return create_value_int(g_simd.count_eq_f64((const double*)d, n, value_as_double(x)));
+    int count = 0; size_t es = get_sizeof_element_type(et);
+    for (int i = 0; i < n; ++i) { // Diğer tipler: '==' ile aynı kurallarla skaler karşılaştırma
+        Value v = load_typed_slot(et, (char*)d + i * es);
+        if (value_is_numeric(v) && value_is_numeric(x)) {
+            if (v.type == VAL_FLOAT || x.type == VAL_FLOAT) count += fabs(value_as_double(v) - value_as_double(x)) < 1e-9;
+            else count += value_as_i64(v) == value_as_i64(x);
+        }
+        else if (v.type == VAL_STRING && x.type == VAL_STRING) count += strcmp(v.as.string_val, x.as.string_val) == 0;
+        else if (v.type == VAL_BOOLEAN && x.type == VAL_BOOLEAN) count += v.as.bool_val == x.as.bool_val;
+        else { char err[150]; sprintf(err, "'count_if_eq' karşılaştırma tipi uyumsuz: %s dizisi, %s değer.", var_type_to_string_user(et), value_type_to_string(x.type)); error(err); }
+    }
+    return create_value_int(count);
+}
+
+SortItem* build_sort_items(const char* fname, Variable* arr, SortContext* ctx, bool* use_radix) {
+    VarType et = arr->value.array.element_type;
+    if (et != VAR_INT && et != VAR_I64 && et != VAR_U8 && et != VAR_FLOAT && et != VAR_F32 && et != VAR_STRING) {
+        char err[150]; sprintf(err, "'%s' int, float veya string dizisi bekler (%s dizisi verildi).", fname, var_type_to_string_user(et)); error(err);
+    }
+    int n = arr->value.array.size; size_t es = get_sizeof_element_type(et);
+    SortItem* items = malloc((size_t)(n > 0 ? n : 1) * sizeof(SortItem));
+    if (!items) error("Sıralama için bellek ayrılamadı.");
+    const char* d = arr->value.array.data;
+    for (int i = 0; i < n; ++i) { items[i].key = sort_key_of(et, d + i * es); items[i].idx = i; }
+    ctx->strings = et == VAR_STRING ? d : NULL; ctx->string_slot = es;
+    *use_radix = et == VAR_INT || et == VAR_I64 || et == VAR_U8;
+    return items;
+}
+
+void builtin_sort(Variable* arr, bool descending) {
+    expect_writable_array(descending ? "sort_desc" : "sort", arr);
+    SortContext ctx; bool use_radix;
+    SortItem* items = build_sort_items(descending ? "sort_desc" : "sort", arr, &ctx, &use_radix);
+    int n = arr->value.array.size; size_t es = get_sizeof_element_type(arr->value.array.element_type);
+    sort_items(items, n, use_radix, &ctx);
+    char* d = arr->value.array.data; char* tmp = malloc((size_t)n * es + 1);
+    if (!tmp) { free(items); error("Sıralama için bellek ayrılamadı."); }
+    memcpy(tmp, d, (size_t)n * es);
+    for (int i = 0; i < n; ++i) memcpy(d + i * es, tmp + (size_t)items[descending ? n - 1 - i : i].idx * es, es);
+    free(tmp); free(items);
+}
+
+void builtin_argsort(Variable* arr, Variable* idx_arr) {
+    if (idx_arr->value.array.element_type != VAR_INT) error("'argsort' 2. argüman olarak int dizisi bekler.");
+    expect_writable_array("argsort", idx_arr);
+    if (idx_arr->value.array.size != arr->value.array.size) {
+        char err[150]; sprintf(err, "'argsort' indis dizisi kaynak diziyle aynı boyutta olmalı (%d / %d).", idx_arr->value.array.size, arr->value.array.size); error(err);
+    }
+    SortContext ctx; bool use_radix;
+    SortItem* items = build_sort_items("argsort", arr, &ctx, &use_radix);
+    sort_items(items, arr->value.array.size, use_radix, &ctx);
+    int* out = idx_arr->value.array.data;
+    for (int i = 0; i < arr->value.array.size; ++i) out[i] = items[i].idx;
+    free(items);
+}
+
+// Artan sıralı dizide x'in ilk geçtiği indisi döndürür, yoksa -1.
+Value builtin_binary_search(Variable* arr, Value x) {
+    VarType et = arr->value.array.element_type; size_t es = get_sizeof_element_type(et);
+    bool is_string = et == VAR_STRING;
+    if (is_string ? x.type != VAL_STRING : !value_is_numeric(x) || !(et == VAR_INT || et == VAR_I64 || et == VAR_U8 || et == VAR_FLOAT || et == VAR_F32)) {
+        char err[150]; sprintf(err, "'binary_search' aranan değer tipi uyumsuz: %s dizisi, %s değer.", var_type_to_string_user(et), value_type_to_string(x.type)); error(err);
+    }
+    const char* d = arr->value.array.data;
+    int lo = 0, hi = arr->value.array.size;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        int c = is_string ? strcmp(d + mid * es, x.as.string_val) : compare_numeric_values(load_typed_slot(et, d + mid * es), x);
+        if (c < 0) lo = mid + 1; else hi = mid;
+    }
+    if (lo < arr->value.array.size) {
+        int c = is_string ? strcmp(d + lo * es, x.as.string_val) : compare_numeric_values(load_typed_slot(et, d + lo * es), x);
+        if (c == 0) return create_value_int(lo);
+    }
+    return create_value_int(-1);
+}
+
+// --- Dahili Fonksiyonlar ---
+// Her dahili fonksiyon NativeFn imzasına sahiptir ve register_core_natives() ile tabloya kaydedilir.
+// Parametre sayısı ve tablo tipleri call_native tarafından denetlenir.
+Value native_length(Value* args, int num_args) {
+    (void)num_args;
+    if (args[0].type == VAL_STRING) return create_value_int(strlen(args[0].as.string_val));
+    if (args[0].type == VAL_ARRAY_REF) return create_value_int(args[0].as.array_var->value.array.size);
+    error("'length' string veya dizi argüman bekler.");
+    return create_value_null();
+}
+Value native_int_to_string(Value* args, int num_args) {
+    (void)num_args;
+    char buf[MAX_STRING_LEN]; sprintf(buf, "%lld", value_as_i64(args[0])); return create_value_string(buf);
+}
+Value native_concat(Value* args, int num_args) {
+    (void)num_args;
+    Value v = args[0]; // Sığmayan kısım kesilir
+    size_t ln = strlen(v.as.string_val), rn = strnlen(args[1].as.string_val, MAX_STRING_LEN - 1 - ln);
+    memcpy(v.as.string_val + ln, args[1].as.string_val, rn); v.as.string_val[ln + rn] = '\0';
+    return v;
+}
+Value native_sqrt(Value* args, int num_args) {
+    (void)num_args;
+    if (value_is_integer(args[0]) && value_as_i64(args[0]) < 0) error("'sqrt' negatif tamsayı alamaz.");
+    if (args[0].type == VAL_FLOAT && args[0].as.float_val < 0.0) error("'sqrt' negatif ondalıklı sayı alamaz.");
+    return create_value_float(sqrt(value_as_double(args[0])));
+}
+// Argüman zaten kopya olduğundan dönüşüm onun üzerinde yerinde yapılır.
+Value native_to_upper(Value* args, int num_args) {
+    (void)num_args;
+    g_simd.case_ascii(args[0].as.string_val, args[0].as.string_val, strlen(args[0].as.string_val), true); return args[0];
+}
+Value native_to_lower(Value* args, int num_args) {
+    (void)num_args;
+    g_simd.case_ascii(args[0].as.string_val, args[0].as.string_val, strlen(args[0].as.string_val), false); return args[0];
+}
+Value native_read_file_text(Value* args, int num_args) {
+    (void)num_args;
+    FILE* file_ptr = fopen(args[0].as.string_val, "rb"); 
+    if (!file_ptr) {
+        char err_msg[MAX_STRING_LEN + 100];
+        sprintf(err_msg, "Dosya okunamadı veya bulunamadı: %s", args[0].as.string_val);
+        error(err_msg);
+    }
+    fseek(file_ptr, 0, SEEK_END); long file_size = ftell(file_ptr); fseek(file_ptr, 0, SEEK_SET);
+    if (file_size >= MAX_SOURCE_SIZE) { fclose(file_ptr); char e[MAX_STRING_LEN+100];sprintf(e,"Dosya '%s' okunacak buffer'dan (%ld bayt) büyük (max %d).",args[0].as.string_val, file_size, MAX_SOURCE_SIZE-1);error(e); } 
+    
+    char* file_content_buffer = (char*) malloc(file_size + 1);
+    if (!file_content_buffer) { fclose(file_ptr); error("read_file_text için bellek ayrılamadı.");}
+    size_t read_size = fread(file_content_buffer, 1, file_size, file_ptr);
+    file_content_buffer[read_size] = '\0'; fclose(file_ptr); Value result_val = create_value_string(file_content_buffer);
+    free(file_content_buffer); return result_val;
+}
+Value native_write_file_text(Value* args, int num_args) {
+    (void)num_args;
+    FILE* file_ptr = fopen(args[0].as.string_val, "w");
+    if (!file_ptr) { // Could not open file for writing
+        char err_msg[MAX_STRING_LEN + 100];
+        sprintf(err_msg, "Dosya '%s' yazılamadı.", args[0].as.string_val);
+        error(err_msg); // More informative to error out than return false
+    }
+    fprintf(file_ptr, "%s", args[1].as.string_val); fclose(file_ptr); return create_value_bool(true); 
+}
+Value native_substring(Value* args, int num_args) {
+    (void)num_args;
+    if (args[1].type != VAL_INT) error("'substring' ikinci argümanı (baslangic_indisi) tamsayı olmalıdır.");
+    if (args[2].type != VAL_INT) error("'substring' üçüncü argümanı (uzunluk) tamsayı olmalıdır.");
+    
+    const char* str = args[0].as.string_val;
+    int start = args[1].as.int_val;
+    int len_req = args[2].as.int_val;
+    int str_len_actual = strlen(str);
+    
+    if (start < 0 || start > str_len_actual || len_req < 0) {
+        char err_msg[200];
+        sprintf(err_msg, "'substring' geçersiz başlangıç (%d) veya uzunluk (%d) (string uzunluğu: %d).", start, len_req, str_len_actual);
+        error(err_msg);
+    }
+    
+    int actual_len_to_copy = len_req;
+    if (start + len_req > str_len_actual) {
+        actual_len_to_copy = str_len_actual - start;
+    }
+    if (actual_len_to_copy < 0) actual_len_to_copy = 0; // if start is at str_len_actual
+    
+    char sub[MAX_STRING_LEN];
+    if (actual_len_to_copy > 0 && actual_len_to_copy < MAX_STRING_LEN) {
+        strncpy(sub, str + start, actual_len_to_copy);
+    } else if (actual_len_to_copy >= MAX_STRING_LEN) {
+        error("'substring' sonucu MAX_STRING_LEN'den büyük olamaz.");
+    }
+    sub[actual_len_to_copy] = '\0';
+    return create_value_string(sub);
+}
+Value native_string_to_int(Value* args, int num_args) {
+    (void)num_args;
+    char* endptr;
+    const char* str_to_convert = args[0].as.string_val;
+    errno = 0; // For overflow/underflow detection with strtol
+    long val = strtol(str_to_convert, &endptr, 10);
+    
+    // Check for various conversion errors
+    if (endptr == str_to_convert) { // No digits were found
+        char err_msg[MAX_STRING_LEN + 100];
+        sprintf(err_msg, "'string_to_int': '%s' string'i tamsayıya dönüştürülemedi (sayı bulunamadı).", str_to_convert);
+        error(err_msg);
+    } else if (*endptr != '\0' && !isspace((unsigned char)*endptr)) { // Extra characters after number
+        char err_msg[MAX_STRING_LEN + 100];
+        sprintf(err_msg, "'string_to_int': '%s' string'inde sayıdan sonra geçersiz karakterler var.", str_to_convert);
+        error(err_msg);
+    } else if (errno == ERANGE || val > INT_MAX || val < INT_MIN) {
+        error("'string_to_int': Değer tamsayı sınırları dışında.");
+    }
+    return create_value_int((int)val);
+}
+Value native_string_to_float(Value* args, int num_args) {
+    (void)num_args;
+    char* endptr;
+    const char* str_to_convert = args[0].as.string_val;
+    errno = 0; // For overflow/underflow detection with strtod
+    double val = strtod(str_to_convert, &endptr);
+    
+    if (endptr == str_to_convert) {
+        char err_msg[MAX_STRING_LEN + 100];
+        sprintf(err_msg, "'string_to_float': '%s' string'i ondalıklı sayıya dönüştürülemedi (sayı bulunamadı).", str_to_convert);
+        error(err_msg);
+    } else if (*endptr != '\0' && !isspace((unsigned char)*endptr)) {
+        char err_msg[MAX_STRING_LEN + 100];
+        sprintf(err_msg, "'string_to_float': '%s' string'inde sayıdan sonra geçersiz karakterler var.", str_to_convert);
+        error(err_msg);
+    } else if (errno == ERANGE) {
+        error("'string_to_float': Değer ondalıklı sayı sınırları dışında.");
+    }
+    return create_value_float(val);
+}
+Value native_type_of(Value* args, int num_args) {
+    (void)num_args;
+    switch(args[0].type) {
+        case VAL_INT: return create_value_string("int");
+        case VAL_I64: return create_value_string("i64");
+        case VAL_HANDLE: return create_value_string("handle");
+        case VAL_CHANNEL: return create_value_string("chan");
+        case VAL_GENERATOR: return create_value_string("gen");
+        case VAL_FLOAT: return create_value_string("float");
+        case VAL_STRING: return create_value_string("string");
+        case VAL_BOOLEAN: return create_value_string("boolean");
+        case VAL_ARRAY_REF: return create_value_string("array");
+        case VAL_STRUCT_REF: return create_value_string(nur->struct_table[struct_idx_of_ref(args[0])].name);
+        case VAL_NULL: return create_value_string("null");
+        default: return create_value_string("unknown");
+    }
+}
+Value native_pow(Value* args, int num_args) { (void)num_args; return create_value_float(pow(value_as_double(args[0]), value_as_double(args[1]))); }
+Value native_sum(Value* args, int num_args) { (void)num_args; return builtin_sum(expect_numeric_array_arg("sum", args[0], 1)); }
+Value native_min(Value* args, int num_args) { (void)num_args; return builtin_min_max(expect_numeric_array_arg("min", args[0], 1), false); }
+Value native_max(Value* args, int num_args) { (void)num_args; return builtin_min_max(expect_numeric_array_arg("max", args[0], 1), true); }
+Value native_dot(Value* args, int num_args) { (void)num_args; return builtin_dot(expect_numeric_array_arg("dot", args[0], 1), expect_numeric_array_arg("dot", args[1], 2)); }
+Value native_fill(Value* args, int num_args) { (void)num_args; builtin_fill(expect_array_arg("fill", args[0], 1), args[1]); return create_value_null(); }
+Value native_scale(Value* args, int num_args) { (void)num_args; builtin_scale(expect_numeric_array_arg("scale", args[0], 1), args[1]); return create_value_null(); }
+Value native_add(Value* args, int num_args) {
+    (void)num_args;
+    builtin_add(expect_numeric_array_arg("add", args[0], 1), expect_numeric_array_arg("add", args[1], 2), expect_numeric_array_arg("add", args[2], 3));
+    return create_value_null();
+}
+Value native_count_if_eq(Value* args, int num_args) { (void)num_args; return builtin_count_if_eq(expect_array_arg("count_if_eq", args[0], 1), args[1]); }
+Value native_sort(Value* args, int num_args) { (void)num_args; builtin_sort(expect_array_arg("sort", args[0], 1), false); return create_value_null(); }
+Value native_sort_desc(Value* args, int num_args) { (void)num_args; builtin_sort(expect_array_arg("sort_desc", args[0], 1), true); return create_value_null(); }
+Value native_argsort(Value* args, int num_args) { (void)num_args; builtin_argsort(expect_array_arg("argsort", args[0], 1), expect_array_arg("argsort", args[1], 2)); return create_value_null(); }
+Value native_binary_search(Value* args, int num_args) { (void)num_args; return builtin_binary_search(expect_array_arg("binary_search", args[0], 1), args[1]); }
+
+Value native_open(Value* args, int num_args) {
+    (void)num_args;
+    const char* mode = args[1].as.string_val; const char* fmode;
+    if (strcmp(mode, "r") == 0) fmode = "rb"; else if (strcmp(mode, "w") == 0) fmode = "wb"; else if (strcmp(mode, "a") == 0) fmode = "ab";
+    else { char err[MAX_STRING_LEN + 80]; sprintf(err, "'open' geçersiz kip: '%s' (\"r\", \"w\" veya \"a\" bekleniyor).", mode); error(err); return create_value_null(); }
+    int slot = 0;
+    while (slot < MAX_FILE_HANDLES && nur->handle_table[slot].in_use) slot++;
+    if (slot == MAX_FILE_HANDLES) error("Maksimum açık dosya sayısına ulaşıldı.");
+    FILE* fp = fopen(args[0].as.string_val, fmode);
+    if (!fp) { char err[MAX_STRING_LEN + 80]; sprintf(err, "Dosya açılamadı: %s (%s)", args[0].as.string_val, strerror(errno)); error(err); }
+    setvbuf(fp, NULL, _IOFBF, FILE_BUFFER_SIZE);
+    FileHandle* fh = &nur->handle_table[slot];
+    nur->inherited_handles[slot] = false;
+    fh->fp = fp; fh->in_use = true; fh->writable = fmode[0] != 'r'; fh->generation = (fh->generation + 1) & 0x7fffff;
+    Value v = {VAL_HANDLE, false, {0}}; v.as.handle = (int)(fh->generation << 8) | slot;
+    return v;
+}
+// json_next dosyayı kendi tamponuna parça parça okur; tampondaki veri satır/bayt okumalarına görünmez.
+// Bu yüzden json_next başladıktan sonra tutamaç close'a kadar yalnızca json_* ile okunur.
+static void expect_not_json(const char* fname, const FileHandle* fh) {
+    if (!fh->json) return;
+    char err[200]; sprintf(err, "'%s': bu tutamaç json_next ile okunuyor; json_next ile satır/bayt okumaları karıştırılamaz.", fname); error(err);
+}
+// Sonraki satırı satır sonu olmadan döndürür; dosya sonunda "" döner (eof() ile ayırt edilir).
+Value native_read_line(Value* args, int num_args) {
+    (void)num_args;
+    FileHandle* fh = resolve_handle("read_line", args[0]);
+    expect_not_json("read_line", fh);
+    char buf[MAX_STRING_LEN];
+    if (!fgets(buf, sizeof buf, fh->fp)) return create_value_string("");
+    size_t len = strlen(buf);
+    if (len > 0 && buf[len - 1] == '\n') buf[--len] = '\0';
+    else if (len == MAX_STRING_LEN - 1 && !feof(fh->fp)) {
+        int c = getc(fh->fp);
+        if (c != '\n' && c != EOF) { char err[120]; sprintf(err, "'read_line': satır %d karakter sınırını aşıyor.", MAX_STRING_LEN - 1); error(err); }
+    }
+    if (len > 0 && buf[len - 1] == '\r') buf[--len] = '\0';
+    return create_value_string(buf);
+}
+Value native_read_bytes(Value* args, int num_args) {
+    (void)num_args;
+    FileHandle* fh = resolve_handle("read_bytes", args[0]);
+    expect_not_json("read_bytes", fh);
+    long long n = value_as_i64(args[1]);
+    if (n < 0 || n >= MAX_STRING_LEN) { char err[120]; sprintf(err, "'read_bytes' bayt sayısı 0-%d aralığında olmalı.", MAX_STRING_LEN - 1); error(err); }
+    char buf[MAX_STRING_LEN];
+    size_t got = fread(buf, 1, (size_t)n, fh->fp);
+    buf[got] = '\0';
+    return create_value_string(buf);
+}
+Value native_write(Value* args, int num_args) {
+    (void)num_args;
+    FileHandle* fh = resolve_handle("write", args[0]);
+    if (!fh->writable) error("'write': dosya okuma kipinde açılmış.");
+    Value v = args[1]; int rc;
+    switch (v.type) {
+        case VAL_STRING: rc = fputs(v.as.string_val, fh->fp); break;
+        case VAL_INT: rc = fprintf(fh->fp, "%d", v.as.int_val); break;
+        case VAL_I64: rc = fprintf(fh->fp, "%lld", v.as.i64_val); break;
+        case VAL_FLOAT: { char nb[32]; format_double_ex(nb, v.as.float_val, v.f32); rc = fputs(nb, fh->fp); break; }
+        case VAL_BOOLEAN: rc = fputs(v.as.bool_val ? "true" : "false", fh->fp); break;
+        default: { char err[120]; sprintf(err, "'write' bu tipi yazamaz: %s.", value_type_to_string(v.type)); error(err); return create_value_null(); }
+    }
+    if (rc < 0) { char err[150]; sprintf(err, "'write' başarısız: %s", strerror(errno)); error(err); }
+    return create_value_null();
+}
+Value native_flush(Value* args, int num_args) {
+    (void)num_args;
+    FileHandle* fh = resolve_handle("flush", args[0]);
+    if (fflush(fh->fp) != 0) { char err[150]; sprintf(err, "'flush' başarısız: %s", strerror(errno)); error(err); }
+    return create_value_null();
+}
+Value channel_close_value(Value c);
+Value generator_close_value(Value g);
+Value native_close(Value* args, int num_args) {
+    (void)num_args;
+    if (args[0].type == VAL_CHANNEL) return channel_close_value(args[0]);
+    if (args[0].type == VAL_GENERATOR) return generator_close_value(args[0]);
+    FileHandle* fh = resolve_handle("close", args[0]);
+    if (nur->inherited_handles[fh - nur->handle_table]) error("'close': bu tutamaç üst iş parçacığına ait, burada kapatılamaz.");
+    fh->in_use = false; free(fh->json); fh->json = NULL;
+    if (fclose(fh->fp) != 0) { char err[150]; sprintf(err, "'close' başarısız: %s", strerror(errno)); error(err); }
+    return create_value_null();
+}
+bool json_reader_buffered(const JsonReader* r);
+Value native_eof(Value* args, int num_args) {
+    (void)num_args;
+    FileHandle* fh = resolve_handle("eof", args[0]);
+    if (fh->json && json_reader_buffered(fh->json)) return create_value_bool(false); // json_next tamponunda veri var
+    int c = getc(fh->fp); // Bir sonraki okumanın veri döndürüp döndürmeyeceğine bak
+    if (c == EOF) return create_value_bool(true);
+    ungetc(c, fh->fp);
+    return create_value_bool(false);
+}
+
+// map_file(yol [, "r" | "rw" [, "sequential" | "random" | "willneed" | "normal"]])
+// Yalnızca 'var a: T[] = map_file(...)' başlatıcısında çağrılabilir; eşleme bildirimle diziye bağlanır.
+Value native_map_file(Value* args, int num_args) {
+    if (!nur->mapping_allowed) error("'map_file' yalnızca 'var a: T[] = map_file(...)' bildiriminde kullanılabilir.");
+    if (num_args < 1 || num_args > 3) error("'map_file' 1-3 argüman bekler (yol, kip, erişim ipucu).");
+    for (int i = 0; i < num_args; ++i) if (args[i].type != VAL_STRING) error("'map_file' argümanları string olmalıdır.");
+    bool writable = false; int advice = MADV_NORMAL;
+    if (num_args >= 2) {
+        if (strcmp(args[1].as.string_val, "rw") == 0) writable = true;
+        else if (strcmp(args[1].as.string_val, "r") != 0) error("'map_file' kipi \"r\" veya \"rw\" olmalıdır.");
+    }
+    if (num_args == 3) {
+        const char* h = args[2].as.string_val;
+        if (strcmp(h, "sequential") == 0) advice = MADV_SEQUENTIAL; else if (strcmp(h, "random") == 0) advice = MADV_RANDOM;
+        else if (strcmp(h, "willneed") == 0) advice = MADV_WILLNEED; else if (strcmp(h, "normal") != 0) error("'map_file' erişim ipucu sequential, random, willneed veya normal olmalıdır.");
+    }
+    char err[MAX_STRING_LEN + 100];
+    int fd = open(args[0].as.string_val, writable ? O_RDWR : O_RDONLY);
+    if (fd < 0) { sprintf(err, "Dosya eşlenemedi: %s (%s)", args[0].as.string_val, strerror(errno)); error(err); }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); sprintf(err, "Dosya eşlenemedi: %s (boş veya okunamıyor)", args[0].as.string_val); error(err); }
+    void* addr = mmap(NULL, (size_t)st.st_size, PROT_READ | (writable ? PROT_WRITE : 0), writable ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+    close(fd); // Eşleme dosya tanımlayıcısından bağımsız yaşar
+    if (addr == MAP_FAILED) { sprintf(err, "mmap başarısız: %s (%s)", args[0].as.string_val, strerror(errno)); error(err); }
+    if (advice != MADV_NORMAL) madvise(addr, (size_t)st.st_size, advice);
+    Value v = {VAL_MAPPING, false, {0}};
+    v.as.mapping.addr = addr; v.as.mapping.length = (size_t)st.st_size; v.as.mapping.writable = writable;
+    return v;
+}
+
+// Eşlemeyi yeni bir dizi değişkenine bağlar; dizi değişkeni eşlemenin sahibi olur.
+Variable* declare_mapped_array(const char* name, VarType element_type, Value mapping, bool is_loop_var) {
+    if (mapping.type != VAL_MAPPING) error("Boyutsuz dizi ('T[]') bir map_file(...) ile başlatılmalıdır.");
+    size_t es = get_sizeof_element_type(element_type), count = mapping.as.mapping.length / es;
+    if (mapping.as.mapping.length % es != 0 || count > INT_MAX) {
+        munmap(mapping.as.mapping.addr, mapping.as.mapping.length);
+        char err[200]; sprintf(err, "Eşlenen dosya boyutu (%zu bayt) %s dizisine uymuyor (eleman boyutu %zu, en fazla %d eleman).",
+            mapping.as.mapping.length, var_type_to_string_user(element_type), es, INT_MAX); error(err);
+    }
+    Variable* var = declare_variable(name, VAR_ARRAY, is_loop_var, element_type, 1, -1);
+    free(var->value.array.data);
+    var->value.array.data = mapping.as.mapping.addr; var->value.array.size = (int)count;
+    var->value.array.mapped = true; var->value.array.read_only = !mapping.as.mapping.writable;
+    var->value.array.mapped_length = mapping.as.mapping.length;
+    return var;
+}
+
+// read_ints/read_floats/read_lines: diziyi stdin'den doldurur, okunan eleman sayısını döndürür
+// (girdi erken biterse dizinin boyutundan az olabilir).
+Value native_read_ints(Value* args, int num_args) {
+    (void)num_args;
+    Variable* arr = expect_array_arg("read_ints", args[0], 1); expect_writable_array("read_ints", arr);
+    VarType et = arr->value.array.element_type;
+    if (et != VAR_INT && et != VAR_I64 && et != VAR_U8) error("'read_ints' int, i64 veya u8 dizisi bekler.");
+    char word[64]; int n = 0; size_t es = get_sizeof_element_type(et);
+    for (; n < arr->value.array.size && in_read_word(word, sizeof word); ++n) {
+        long long v;
+        if (!parse_int_token(word, &v)) { char err[150]; sprintf(err, "'read_ints': geçersiz tamsayı girişi: '%s'.", word); error(err); }
+        Value val = create_value_i64(v);
+        coerce_value_to_var_type(et, &val); // int/u8 sınır denetimi
+        store_typed_slot(et, (char*)arr->value.array.data + n * es, val);
+    }
+    return create_value_int(n);
+}
+Value native_read_floats(Value* args, int num_args) {
+    (void)num_args;
+    Variable* arr = expect_array_arg("read_floats", args[0], 1); expect_writable_array("read_floats", arr);
+    VarType et = arr->value.array.element_type;
+    if (et != VAR_FLOAT && et != VAR_F32) error("'read_floats' float veya f32 dizisi bekler.");
+    char word[128]; int n = 0;
+    for (; n < arr->value.array.size && in_read_word(word, sizeof word); ++n) {
+        double v;
+        if (!parse_double_token(word, &v)) { char err[200]; sprintf(err, "'read_floats': geçersiz sayı girişi: '%s'.", word); error(err); }
+        if (et == VAR_FLOAT) ((double*)arr->value.array.data)[n] = v; else ((float*)arr->value.array.data)[n] = (float)v;
+    }
+    return create_value_int(n);
+}
+Value native_read_lines(Value* args, int num_args) {
+    (void)num_args;
+    Variable* arr = expect_array_arg("read_lines", args[0], 1);
+    if (arr->value.array.element_type != VAR_STRING) error("'read_lines' string dizisi bekler.");
+    int n = 0;
+    while (n < arr->value.array.size && in_read_line((char*)arr->value.array.data + (size_t)n * MAX_STRING_LEN, MAX_STRING_LEN)) n++;
+    return create_value_int(n);
+}
+
+// --- Metin Arama ---
+// index_of, split, replace... için ortak arama. Tek baytlık iğnede memchr (glibc'de SIMD), kısa iğnelerde
+// ilk bayt memchr + memcmp; 4 bayt ve üstü iğnelerde Boyer-Moore-Horspool atlama tablosu kullanılır.
+const char* str_find(const char* h, size_t hn, const char* n, size_t nn) {
+    if (nn == 0) return h;
+    if (nn > hn) return NULL;
+    if (nn == 1) return memchr(h, n[0], hn);
+    if (nn < 4) {
+        for (const char *p = h, *last = h + hn - nn; p <= last; ++p) {
+            p = memchr(p, n[0], (size_t)(last - p) + 1);
+            if (!p) return NULL;
+            if (memcmp(p + 1, n + 1, nn - 1) == 0) return p;
+        }
+        return NULL;
+    }
+    size_t skip[256];
+    for (int i = 0; i < 256; ++i) skip[i] = nn;
+    for (size_t i = 0; i + 1 < nn; ++i) skip[(unsigned char)n[i]] = nn - 1 - i;
+    unsigned char lastc = (unsigned char)n[nn - 1];
+    for (size_t pos = 0; pos + nn <= hn; pos += skip[(unsigned char)h[pos + nn - 1]])
+        if ((unsigned char)h[pos + nn - 1] == lastc && memcmp(h + pos, n, nn - 1) == 0) return h + pos;
+    return NULL;
+}
+const char* str_find_last(const char* h, size_t hn, const char* n, size_t nn) {
+    if (nn > hn) return NULL;
+    for (const char* p = h + hn - nn; ; --p) {
+        if (*p == n[0] && memcmp(p, n, nn) == 0) return p;
+        if (p == h) return NULL;
+    }
+}
+static inline bool str_is_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v'; }
+
+Value native_index_of(Value* args, int num_args) {
+    (void)num_args;
+    const char* s = args[0].as.string_val;
+    const char* p = str_find(s, strlen(s), args[1].as.string_val, strlen(args[1].as.string_val));
+    return create_value_int(p ? (int)(p - s) : -1);
+}
+Value native_last_index_of(Value* args, int num_args) {
+    (void)num_args;
+    const char* s = args[0].as.string_val; size_t nn = strlen(args[1].as.string_val);
+    const char* p = nn ? str_find_last(s, strlen(s), args[1].as.string_val, nn) : s + strlen(s);
+    return create_value_int(p ? (int)(p - s) : -1);
+}
+Value native_contains(Value* args, int num_args) {
+    (void)num_args;
+    return create_value_bool(str_find(args[0].as.string_val, strlen(args[0].as.string_val), args[1].as.string_val, strlen(args[1].as.string_val)) != NULL);
+}
+Value native_starts_with(Value* args, int num_args) {
+    (void)num_args;
+    size_t n = strlen(args[1].as.string_val);
+    return create_value_bool(strncmp(args[0].as.string_val, args[1].as.string_val, n) == 0);
+}
+Value native_ends_with(Value* args, int num_args) {
+    (void)num_args;
+    size_t sn = strlen(args[0].as.string_val), n = strlen(args[1].as.string_val);
+    return create_value_bool(n <= sn && memcmp(args[0].as.string_val + sn - n, args[1].as.string_val, n) == 0);
+}
+// split(metin, ayırıcı, dizi): parçalar string dizisine yazılır, parça sayısı döner. Ardışık ayırıcılar boş parça üretir.
+Value native_split(Value* args, int num_args) {
+    (void)num_args;
+    Variable* arr = expect_array_arg("split", args[2], 3);
+    expect_writable_array("split", arr);
+    if (arr->value.array.element_type != VAR_STRING) error("'split' üçüncü argümanı string dizisi olmalıdır.");
+    const char *s = args[0].as.string_val, *sep = args[1].as.string_val;
+    size_t sn = strlen(s), pn = strlen(sep);
+    if (pn == 0) error("'split' ayırıcısı boş olamaz.");
+    char (*out)[MAX_STRING_LEN] = arr->value.array.data;
+    int count = 0;
+    for (const char* end = s + sn; ; ) {
+        const char* q = str_find(s, (size_t)(end - s), sep, pn);
+        const char* part_end = q ? q : end;
+        if (count >= arr->value.array.size) { char err[120]; sprintf(err, "'split': parça sayısı dizi kapasitesini (%d) aşıyor.", arr->value.array.size); error(err); }
+        memcpy(out[count], s, (size_t)(part_end - s)); out[count][part_end - s] = '\0';
+        count++;
+        if (!q) break;
+        s = q + pn;
+    }
+    return create_value_int(count);
+}
+// replace(metin, eski, yeni): tüm örnekler değiştirilir.
+Value native_replace(Value* args, int num_args) {
+    (void)num_args;
+    const char *s = args[0].as.string_val, *from = args[1].as.string_val, *to = args[2].as.string_val;
+    size_t sn = strlen(s), fn = strlen(from), tn = strlen(to), len = 0;
+    if (fn == 0) error("'replace' aranan metin boş olamaz.");
+    Value result = {VAL_STRING, false, {0}};
+    char* out = result.as.string_val;
+    for (const char *end = s + sn, *q; ; s = q + fn) {
+        q = str_find(s, (size_t)(end - s), from, fn);
+        size_t keep = (size_t)((q ? q : end) - s);
+        if (len + keep + (q ? tn : 0) >= MAX_STRING_LEN) { char err[100]; sprintf(err, "'replace' sonucu %d karakter sınırını aşıyor.", MAX_STRING_LEN - 1); error(err); }
+        memcpy(out + len, s, keep); len += keep;
+        if (!q) break;
+        memcpy(out + len, to, tn); len += tn;
+    }
+    out[len] = '\0';
+    return result;
+}
+// Metni yerinde kırpar, yeni uzunluğu döndürür.
+size_t str_trim_in_place(char* s) {
+    size_t n = strlen(s), start = 0;
+    while (n > 0 && str_is_space(s[n - 1])) n--;
+    while (start < n && str_is_space(s[start])) start++;
+    if (start) memmove(s, s + start, n - start);
+    s[n - start] = '\0';
+    return n - start;
+}
+Value native_trim(Value* args, int num_args) { (void)num_args; str_trim_in_place(args[0].as.string_val); return args[0]; }
+Value native_compare(Value* args, int num_args) {
+    (void)num_args;
+    int c = strcmp(args[0].as.string_val, args[1].as.string_val);
+    return create_value_int((c > 0) - (c < 0));
+}
+Value native_equals_ignore_case(Value* args, int num_args) {
+    (void)num_args;
+    size_t n = strlen(args[0].as.string_val);
+    return create_value_bool(n == strlen(args[1].as.string_val) && g_simd.equal_ignore_case(args[0].as.string_val, args[1].as.string_val, n));
+}
+// String dizileri üzerinde yerinde toplu dönüşümler: eleman başına kopya yapılmaz.
+Variable* expect_string_array(const char* fname, Value v) {
+    Variable* arr = expect_array_arg(fname, v, 1);
+    expect_writable_array(fname, arr);
+    if (arr->value.array.element_type != VAR_STRING) { char err[100]; sprintf(err, "'%s' string dizisi bekler.", fname); error(err); }
+    return arr;
+}
+void builtin_case_all(Variable* arr, bool upper) {
+    char (*s)[MAX_STRING_LEN] = arr->value.array.data;
+    for (int i = 0; i < arr->value.array.size; ++i) g_simd.case_ascii(s[i], s[i], strlen(s[i]), upper);
+}
+Value native_to_upper_all(Value* args, int num_args) { (void)num_args; builtin_case_all(expect_string_array("to_upper_all", args[0]), true); return create_value_null(); }
+Value native_to_lower_all(Value* args, int num_args) { (void)num_args; builtin_case_all(expect_string_array("to_lower_all", args[0]), false); return create_value_null(); }
+Value native_trim_all(Value* args, int num_args) {
+    (void)num_args;
+    Variable* arr = expect_string_array("trim_all", args[0]);
+    char (*s)[MAX_STRING_LEN] = arr->value.array.data;
+    for (int i = 0; i < arr->value.array.size; ++i) str_trim_in_place(s[i]);
+    return create_value_null();
+}
+
+// --- Düzenli İfadeler ---
+// Desen önce sözdizimi ağacına, sonra Thompson NFA'sına derlenir; eşleme NFA üzerinde değil, ihtiyaç
+// duyuldukça kurulan bir DFA üzerinde yapılır (her DFA durumu bir NFA durum kümesi, geçişler ilk
+// kullanıldıklarında hesaplanır). Geri izleme yoktur: metnin her baytı en fazla bir geçiş hesabı yapar.
+// DFA durum sayısı REGEX_MAX_DFA'yı aşarsa önbellek boşaltılıp yeniden kurulur, bellek sınırlı kalır.
+// Desteklenen sözdizimi: . [abc] [^a-z] \d \w \s (ve büyük harfli tersleri) * + ? {m} {m,} {m,n} | ( )
+// ile desenin başında ^ ve sonunda $. Derlenen desenler kaynak metinleriyle önbelleklenir.
+enum { RX_LIT, RX_CAT, RX_ALT, RX_STAR, RX_PLUS, RX_QUEST, RX_REPEAT, RX_EMPTY };
+typedef struct { unsigned char kind; int a, b; int min, max; unsigned char set[32]; } RxNode;
+enum { RX_NFA_CLASS, RX_NFA_SPLIT, RX_NFA_MATCH };
+typedef struct { unsigned char kind; int out, out1; unsigned char set[32]; } RxNfaState;
+typedef struct { int* ids; int n; unsigned hash; bool match; int next[256]; } RxDfaState; // next: -1 hesaplanmadı
+typedef struct { RxDfaState* states; int num, cap; int* table; int table_size; int start; } RxDfa;
+
+struct Regex {
+    char pattern[MAX_STRING_LEN];
+    bool bol, eol;          // ^ ve $ çapaları
+    RxNfaState* nfa; int nfa_count, nfa_start;
+    RxDfa dfa[2];           // [0] çapalı (yalnızca başlangıç konumundan), [1] çapasız (her konumda yeniden başlar)
+    int* mark; int mark_gen; int* stack; int* scratch; // Kapanış hesabı için yığın ve geçici küme
+    int* threads;           // rx_leftmost_longest: iki iş parçacığı listesi ve başlangıçları (4 * nfa_count)
+};
+
+typedef struct { const char* src; int pos, len; RxNode* nodes; int num_nodes; Regex* re; } RxParser;
+__attribute__((noreturn)) void rx_fail(RxParser* p, const char* msg) {
+    char err[MAX_STRING_LEN + 150]; sprintf(err, "Düzenli ifade '%s' (konum %d): %s", p->src, p->pos, msg); error(err);
+}
+int rx_node(RxParser* p, int kind, int a, int b) {
+    if (p->num_nodes >= REGEX_MAX_NFA) rx_fail(p, "desen çok karmaşık.");
+    RxNode* n = &p->nodes[p->num_nodes]; memset(n, 0, sizeof *n);
+    n->kind = (unsigned char)kind; n->a = a; n->b = b;
+    return p->num_nodes++;
+}
+static inline void rx_set_add(unsigned char* set, int c) { set[c >> 3] |= (unsigned char)(1 << (c & 7)); }
+static inline bool rx_set_has(const unsigned char* set, int c) { return set[c >> 3] & (1 << (c & 7)); }
+// \d \w \s ve tersleri; diğer kaçışlar tek bir bayttır. Sınıf kaçışıysa true döner.
+bool rx_escape(RxParser* p, unsigned char* set, int* single) {
+    if (p->pos >= p->len) rx_fail(p, "desen '\\' ile bitiyor.");
+    char e = p->src[p->pos++];
+    unsigned char tmp[32] = {0}; bool negate = isupper((unsigned char)e);
+    switch (tolower((unsigned char)e)) {
+        case 'd': for (int c = '0'; c <= '9'; ++c) rx_set_add(tmp, c); break;
+        case 'w': for (int c = 0; c < 256; ++c) if (isalnum(c) || c == '_') rx_set_add(tmp, c); break;
+        case 's': for (const char* s = " \t\n\r\f\v"; *s; ++s) rx_set_add(tmp, *s); break;
+        default:
+            *single = e == 'n' ? '\n' : e == 't' ? '\t' : e == 'r' ? '\r' : (unsigned char)e;
+            if (isalnum((unsigned char)e) && !strchr("ntr", e)) rx_fail(p, "bilinmeyen kaçış dizisi.");
+            return false;
+    }
+    for (int i = 0; i < 32; ++i) set[i] |= negate ? (unsigned char)~tmp[i] : tmp[i];
+    return true;
+}
+int rx_parse_class(RxParser* p) { // '[' tüketilmiş
+    int id = rx_node(p, RX_LIT, 0, 0);
+    unsigned char set[32] = {0};
+    bool negate = p->pos < p->len && p->src[p->pos] == '^';
+    if (negate) p->pos++;
+    bool first = true;
+    while (p->pos < p->len && (p->src[p->pos] != ']' || first)) {
+        first = false;
+        int lo;
+        if (p->src[p->pos] == '\\') { p->pos++; if (rx_escape(p, set, &lo)) continue; }
+        else lo = (unsigned char)p->src[p->pos++];
+        int hi = lo;
+        if (p->pos + 1 < p->len && p->src[p->pos] == '-' && p->src[p->pos + 1] != ']') {
+            p->pos++;
+            if (p->src[p->pos] == '\\') { p->pos++; if (rx_escape(p, set, &hi)) rx_fail(p, "aralık sınırı sınıf olamaz."); }
+            else hi = (unsigned char)p->src[p->pos++];
+            if (hi < lo) rx_fail(p, "ters karakter aralığı.");
+        }
+        for (int c = lo; c <= hi; ++c) rx_set_add(set, c);
+    }
+    if (p->pos >= p->len) rx_fail(p, "kapanmamış '['.");
+    p->pos++;
+    for (int i = 0; i < 32; ++i) p->nodes[id].set[i] = negate ? (unsigned char)~set[i] : set[i];
+    return id;
+}
+int rx_parse_alt(RxParser* p);
+int rx_parse_atom(RxParser* p) {
+    char c = p->src[p->pos++];
+    int id;
+    switch (c) {
+        case '(': id = rx_parse_alt(p); if (p->pos >= p->len || p->src[p->pos] != ')') rx_fail(p, "kapanmamış '('."); p->pos++; return id;
+        case '[': return rx_parse_class(p);
+        case '.': id = rx_node(p, RX_LIT, 0, 0); memset(p->nodes[id].set, 0xff, 32); p->nodes[id].set['\n' >> 3] &= (unsigned char)~(1 << ('\n' & 7)); return id;
+        case '\\': { id = rx_node(p, RX_LIT, 0, 0); int single; if (!rx_escape(p, p->nodes[id].set, &single)) rx_set_add(p->nodes[id].set, single); return id; }
+        case '*': case '+': case '?': case '{': p->pos--; rx_fail(p, "tekrar işaretinden önce ifade yok.");
+        case '^': case '$': p->pos--; rx_fail(p, "'^' yalnızca desenin başında, '$' yalnızca sonunda kullanılabilir.");
+        default: id = rx_node(p, RX_LIT, 0, 0); rx_set_add(p->nodes[id].set, (unsigned char)c); return id;
+    }
+}
+int rx_parse_number(RxParser* p) {
+    if (p->pos >= p->len || !isdigit((unsigned char)p->src[p->pos])) rx_fail(p, "'{' içinde sayı bekleniyordu.");
+    int v = 0;
+    while (p->pos < p->len && isdigit((unsigned char)p->src[p->pos])) { v = v * 10 + (p->src[p->pos++] - '0'); if (v > REGEX_MAX_REPEAT) rx_fail(p, "tekrar sayısı çok büyük."); }
+    return v;
+}
+int rx_parse_repeat(RxParser* p) {
+    int id = rx_parse_atom(p);
+    while (p->pos < p->len) {
+        char c = p->src[p->pos];
+        if (c == '*') id = rx_node(p, RX_STAR, id, 0);
+        else if (c == '+') id = rx_node(p, RX_PLUS, id, 0);
+        else if (c == '?') id = rx_node(p, RX_QUEST, id, 0);
+        else if (c == '{') {
+            p->pos++;
+            int mn = rx_parse_number(p), mx = mn;
+            if (p->pos < p->len && p->src[p->pos] == ',') { p->pos++; mx = (p->pos < p->len && p->src[p->pos] == '}') ? -1 : rx_parse_number(p); }
+            if (p->pos >= p->len || p->src[p->pos] != '}') rx_fail(p, "'}' bekleniyordu.");
+            if (mx >= 0 && mx < mn) rx_fail(p, "{m,n} içinde n < m.");
+            id = rx_node(p, RX_REPEAT, id, 0); p->nodes[id].min = mn; p->nodes[id].max = mx;
+        } else break;
+        p->pos++;
+    }
+    return id;
+}
+int rx_parse_cat(RxParser* p) {
+    int id = -1;
+    while (p->pos < p->len && p->src[p->pos] != '|' && p->src[p->pos] != ')') {
+        if (p->src[p->pos] == '$' && p->pos == p->len - 1) { p->re->eol = true; p->pos++; break; }
+        int r = rx_parse_repeat(p);
+        id = id < 0 ? r : rx_node(p, RX_CAT, id, r);
+    }
+    return id < 0 ? rx_node(p, RX_EMPTY, 0, 0) : id;
+}
+int rx_parse_alt(RxParser* p) {
+    int id = rx_parse_cat(p);
+    while (p->pos < p->len && p->src[p->pos] == '|') { p->pos++; id = rx_node(p, RX_ALT, id, rx_parse_cat(p)); }
+    return id;
+}
+
+int rx_nfa_state(Regex* re, int kind, int out, int out1) {
+    if (re->nfa_count >= REGEX_MAX_NFA) error("Düzenli ifade çok büyük (NFA durum sınırı aşıldı).");
+    RxNfaState* s = &re->nfa[re->nfa_count];
+    s->kind = (unsigned char)kind; s->out = out; s->out1 = out1;
+    return re->nfa_count++;
+}
+// Düğümü 'next' devam durumuna bağlanacak şekilde sondan başa derler; başlangıç durumunu döndürür.
+// {m,n} tekrarları ağaç alt düğümü yeniden derlenerek açılır.
+int rx_compile_node(Regex* re, const RxNode* nodes, int id, int next) {
+    const RxNode* n = &nodes[id];
+    int s, cur;
+    switch (n->kind) {
+        case RX_LIT: s = rx_nfa_state(re, RX_NFA_CLASS, next, -1); memcpy(re->nfa[s].set, n->set, 32); return s;
+        case RX_CAT: return rx_compile_node(re, nodes, n->a, rx_compile_node(re, nodes, n->b, next));
+        case RX_ALT: { int a = rx_compile_node(re, nodes, n->a, next), b = rx_compile_node(re, nodes, n->b, next); return rx_nfa_state(re, RX_NFA_SPLIT, a, b); }
+        case RX_QUEST: return rx_nfa_state(re, RX_NFA_SPLIT, rx_compile_node(re, nodes, n->a, next), next);
+        case RX_STAR: s = rx_nfa_state(re, RX_NFA_SPLIT, -1, next); re->nfa[s].out = rx_compile_node(re, nodes, n->a, s); return s;
+        case RX_PLUS: s = rx_nfa_state(re, RX_NFA_SPLIT, -1, next); return re->nfa[s].out = rx_compile_node(re, nodes, n->a, s);
+        case RX_REPEAT:
+            cur = next;
+            if (n->max < 0) { s = rx_nfa_state(re, RX_NFA_SPLIT, -1, next); re->nfa[s].out = rx_compile_node(re, nodes, n->a, s); cur = s; }
+            else for (int i = n->min; i < n->max; ++i) cur = rx_nfa_state(re, RX_NFA_SPLIT, rx_compile_node(re, nodes, n->a, cur), next);
+            for (int i = 0; i < n->min; ++i) cur = rx_compile_node(re, nodes, n->a, cur);
+            return cur;
+        default: return next; // RX_EMPTY
+    }
+}
+
+// ids kümesine s'den epsilon ile ulaşılan durumları ekler (mark ile tekrar eklenmez).
+void rx_closure(Regex* re, int s, int* ids, int* n) {
+    int* stack = re->stack; int sp = 0;
+    stack[sp++] = s;
+    while (sp) {
+        int x = stack[--sp];
+        if (x < 0 || re->mark[x] == re->mark_gen) continue;
+        re->mark[x] = re->mark_gen;
+        if (re->nfa[x].kind == RX_NFA_SPLIT) { stack[sp++] = re->nfa[x].out1; stack[sp++] = re->nfa[x].out; }
+        else ids[(*n)++] = x;
+    }
+}
+int rx_int_cmp(const void* a, const void* b) { return *(const int*)a - *(const int*)b; }
+void rx_dfa_reset(RxDfa* d) {
+    for (int i = 0; i < d->num; ++i) free(d->states[i].ids);
+    d->num = 0; d->start = -1;
+    if (d->table) for (int i = 0; i < d->table_size; ++i) d->table[i] = -1;
+}
+// Sıralı NFA kümesinin DFA durumunu bulur veya ekler. Önbellek doluysa boşaltılır; çağıranın elindeki
+// eski durum indisleri bu durumda geçersizdir (*flushed true olur).
+int rx_dfa_intern(Regex* re, RxDfa* d, int* ids, int n, bool* flushed) {
+    qsort(ids, (size_t)n, sizeof(int), rx_int_cmp);
+    unsigned h = 2166136261u;
+    for (int i = 0; i < n; ++i) h = (h ^ (unsigned)ids[i]) * 16777619u;
+    int mask = d->table_size - 1, slot = (int)(h & (unsigned)mask);
+    for (; d->table[slot] >= 0; slot = (slot + 1) & mask) {
+        RxDfaState* st = &d->states[d->table[slot]];
+        if (st->hash == h && st->n == n && memcmp(st->ids, ids, (size_t)n * sizeof(int)) == 0) return d->table[slot];
+    }
+    if (d->num >= REGEX_MAX_DFA) {
+        rx_dfa_reset(d); if (flushed) *flushed = true;
+        slot = (int)(h & (unsigned)mask);
+    }
+    if (d->num == d->cap) {
+        d->cap = d->cap ? d->cap * 2 : 16;
+        d->states = realloc(d->states, (size_t)d->cap * sizeof(RxDfaState));
+        if (!d->states) error("Düzenli ifade DFA'sı için bellek ayrılamadı.");
+    }
+    RxDfaState* st = &d->states[d->num];
+    st->ids = malloc((size_t)(n ? n : 1) * sizeof(int));
+    if (!st->ids) error("Düzenli ifade DFA'sı için bellek ayrılamadı.");
+    memcpy(st->ids, ids, (size_t)n * sizeof(int));
+    st->n = n; st->hash = h; st->match = false;
+    for (int i = 0; i < n; ++i) if (re->nfa[ids[i]].kind == RX_NFA_MATCH) st->match = true;
+    for (int c = 0; c < 256; ++c) st->next[c] = -1;
+    d->table[slot] = d->num;
+    return d->num++;
+}
+int rx_dfa_start(Regex* re, RxDfa* d) {
+    if (d->start < 0) {
+        int n = 0; re->mark_gen++;
+        rx_closure(re, re->nfa_start, re->scratch, &n);
+        d->start = rx_dfa_intern(re, d, re->scratch, n, NULL);
+    }
+    return d->start;
+}
+static inline int rx_step(Regex* re, RxDfa* d, bool unanchored, int s, unsigned char c) {
+    int t = d->states[s].next[c];
+    if (t >= 0) return t;
+    int* ids = re->scratch; int n = 0;
+    re->mark_gen++;
+    const RxDfaState* st = &d->states[s];
+    for (int i = 0; i < st->n; ++i) {
+        const RxNfaState* x = &re->nfa[st->ids[i]];
+        if (x->kind == RX_NFA_CLASS && rx_set_has(x->set, c)) rx_closure(re, x->out, ids, &n);
+    }
+    if (unanchored) rx_closure(re, re->nfa_start, ids, &n); // Eşleşme her konumda yeniden başlayabilir
+    bool flushed = false;
+    t = rx_dfa_intern(re, d, ids, n, &flushed);
+    if (!flushed) d->states[s].next[c] = t; // Boşaltıldıysa s artık geçersiz; başlangıç ilk ihtiyaçta yeniden kurulur
+    return t;
+}
+
+void regex_free(Regex* re) {
+    for (int k = 0; k < 2; ++k) { rx_dfa_reset(&re->dfa[k]); free(re->dfa[k].states); free(re->dfa[k].table); }
+    free(re->nfa); free(re->mark); free(re->stack); free(re->scratch); free(re->threads); free(re);
+}
+Regex* regex_compile_pattern(const char* pattern) {
+    for (int i = 0; i < nur->num_regex; ++i) if (strcmp(nur->regex_cache[i]->pattern, pattern) == 0) return nur->regex_cache[i];
+    if (nur->num_regex >= MAX_REGEX_CACHE) error("Maksimum derlenmiş düzenli ifade sayısına ulaşıldı.");
+    Regex* re = calloc(1, sizeof(Regex));
+    RxNode* nodes = malloc(REGEX_MAX_NFA * sizeof(RxNode));
+    if (!re || !nodes) { free(re); free(nodes); error("Düzenli ifade için bellek ayrılamadı."); }
+    // Geçersiz desen hatası yarım derlenmiş ifadeyi bırakıp yayılır
+    jmp_buf env;
+    jmp_buf* prev_jmp = nur->error_jmp;
+    if (setjmp(env) != 0) { nur->error_jmp = prev_jmp; free(nodes); regex_free(re); raise_error(); }
+    nur->error_jmp = &env;
+    re->nfa = malloc(REGEX_MAX_NFA * sizeof(RxNfaState));
+    if (!re->nfa) error("Düzenli ifade için bellek ayrılamadı.");
+    strcpy(re->pattern, pattern);
+    RxParser p = { pattern, 0, (int)strlen(pattern), nodes, 0, re };
+    if (p.len > 0 && pattern[0] == '^') { re->bol = true; p.pos = 1; }
+    int root = rx_parse_alt(&p);
+    if (p.pos < p.len) rx_fail(&p, "eşleşmeyen ')'.");
+    if ((re->bol || re->eol) && nodes[root].kind == RX_ALT) rx_fail(&p, "'^'/'$' üst düzey '|' ile kullanılamaz, alternatifleri gruplayın: ^(a|b)$");
+    re->nfa_start = rx_compile_node(re, nodes, root, rx_nfa_state(re, RX_NFA_MATCH, -1, -1));
+    re->mark = calloc((size_t)re->nfa_count, sizeof(int));
+    re->stack = malloc((size_t)(2 * re->nfa_count + 1) * sizeof(int)); // Her durum en fazla iki kez itilir
+    re->scratch = malloc((size_t)re->nfa_count * sizeof(int));
+    re->threads = malloc((size_t)re->nfa_count * 4 * sizeof(int));
+    if (!re->mark || !re->stack || !re->scratch || !re->threads) error("Düzenli ifade için bellek ayrılamadı.");
+    for (int k = 0; k < 2; ++k) {
+        RxDfa* d = &re->dfa[k];
+        d->table_size = 2 * REGEX_MAX_DFA; d->table = malloc((size_t)d->table_size * sizeof(int));
+        if (!d->table) error("Düzenli ifade için bellek ayrılamadı.");
+        rx_dfa_reset(d);
+    }
+    nur->error_jmp = prev_jmp;
+    free(nodes);
+    return nur->regex_cache[nur->num_regex++] = re;
+}
+// Desen string olarak ya da regex_compile'ın döndürdüğü kimlikle verilebilir.
+Regex* regex_arg(const char* fname, Value v) {
+    if (v.type == VAL_STRING) return regex_compile_pattern(v.as.string_val);
+    if (v.type == VAL_INT && v.as.int_val >= 0 && v.as.int_val < nur->num_regex) return nur->regex_cache[v.as.int_val];
+    char err[150]; sprintf(err, "'%s' ilk argümanı desen (string) veya regex_compile kimliği olmalıdır.", fname); error(err);
+    return NULL;
+}
+// from konumundan itibaren çapasız tarama: ilk eşleşmenin bittiği konum, yoksa -1.
+int rx_first_match_end(Regex* re, const char* s, int len, int from) {
+    RxDfa* d = &re->dfa[re->bol ? 0 : 1];
+    if (re->bol && from > 0) return -1;
+    int st = rx_dfa_start(re, d);
+    if (d->states[st].match && (!re->eol || from == len)) return from;
+    for (int i = from; i < len; ++i) {
+        st = rx_step(re, d, !re->bol, st, (unsigned char)s[i]);
+        if (d->states[st].n == 0) return -1;
+        if (d->states[st].match && (!re->eol || i + 1 == len)) return i + 1;
+    }
+    return -1;
+}
+// from konumundan itibaren en soldaki-en uzun eşleşme (Pike VM): her iş parçacığı başlangıç konumunu taşır.
+// Listeler başlangıca göre sıralı kalır ve aynı NFA durumuna ulaşan iş parçacıklarından daha erken başlayan
+// tutulur (gelecekleri aynıdır). Eşleşme bulunduktan sonra yeni başlangıç eklenmez; daha geç başlayanlar
+// bırakılır, daha erken başlayanlar ölene kadar sürer. Metin tek geçişte taranır. Bulunamazsa false.
+bool rx_leftmost_longest(Regex* re, const char* s, int len, int from, int* start, int* end) {
+    int* ids[2] = { re->threads, re->threads + re->nfa_count };
+    int* starts[2] = { re->threads + 2 * re->nfa_count, re->threads + 3 * re->nfa_count };
+    int n = 0, cur = 0, best_start = -1, best_end = -1;
+    re->mark_gen++;
+    for (int i = from; ; ++i) {
+        if (best_start < 0 && (!re->bol || i == 0)) {
+            int n0 = n;
+            rx_closure(re, re->nfa_start, ids[cur], &n);
+            for (int k = n0; k < n; ++k) starts[cur][k] = i;
+        }
+        if (!re->eol || i == len) {
+            for (int k = 0; k < n; ++k) {
+                if (re->nfa[ids[cur][k]].kind != RX_NFA_MATCH) continue;
+                if (best_start < 0 || starts[cur][k] < best_start || (starts[cur][k] == best_start && i > best_end)) { best_start = starts[cur][k]; best_end = i; }
+                break; // Sıralı listede ilk eşleşen en erken başlayandır
+            }
+        }
+        if (i == len || (n == 0 && (best_start >= 0 || re->bol))) break;
+        unsigned char c = (unsigned char)s[i];
+        int nn = 0, nxt = cur ^ 1;
+        re->mark_gen++;
+        for (int k = 0; k < n; ++k) {
+            const RxNfaState* x = &re->nfa[ids[cur][k]];
+            if (x->kind != RX_NFA_CLASS || !rx_set_has(x->set, c)) continue;
+            if (best_start >= 0 && starts[cur][k] > best_start) break;
+            int n0 = nn;
+            rx_closure(re, x->out, ids[nxt], &nn);
+            for (int j = n0; j < nn; ++j) starts[nxt][j] = starts[cur][k];
+        }
+        cur = nxt; n = nn;
+    }
+    *start = best_start; *end = best_end;
+    return best_start >= 0;
+}
+
+Value native_regex_compile(Value* args, int num_args) {
+    (void)num_args;
+    Regex* re = regex_compile_pattern(args[0].as.string_val);
+    for (int i = 0; i < nur->num_regex; ++i) if (nur->regex_cache[i] == re) return create_value_int(i);
+    return create_value_int(-1);
+}
+// Metnin herhangi bir yerinde eşleşme var mı (tüm metin için ^...$ kullanın).
+Value native_regex_match(Value* args, int num_args) {
+    (void)num_args;
+    if (args[1].type != VAL_STRING) error("'regex_match' ikinci argümanı string olmalıdır.");
+    Regex* re = regex_arg("regex_match", args[0]);
+    return create_value_bool(rx_first_match_end(re, args[1].as.string_val, (int)strlen(args[1].as.string_val), 0) >= 0);
+}
+// Çakışmayan en soldaki-en uzun eşleşmeleri string dizisine yazar, sayısını döndürür; boş eşleşmeler atlanır.
+Value native_regex_find_all(Value* args, int num_args) {
+    (void)num_args;
+    if (args[1].type != VAL_STRING) error("'regex_find_all' ikinci argümanı string olmalıdır.");
+    Regex* re = regex_arg("regex_find_all", args[0]);
+    Variable* arr = expect_array_arg("regex_find_all", args[2], 3);
+    expect_writable_array("regex_find_all", arr);
+    if (arr->value.array.element_type != VAR_STRING) error("'regex_find_all' üçüncü argümanı string dizisi olmalıdır.");
+    const char* s = args[1].as.string_val; int len = (int)strlen(s), count = 0;
+    char (*out)[MAX_STRING_LEN] = arr->value.array.data;
+    // DFA, eşleşme kalmadığını tek geçişte söyler; eşleşmenin kendisi Pike VM ile bulunur.
+    for (int pos = 0, start, end; pos <= len && rx_first_match_end(re, s, len, pos) >= 0 && rx_leftmost_longest(re, s, len, pos, &start, &end); ) {
+        if (end > start) {
+            if (count >= arr->value.array.size) { char err[120]; sprintf(err, "'regex_find_all': eşleşme sayısı dizi kapasitesini (%d) aşıyor.", arr->value.array.size); error(err); }
+            memcpy(out[count], s + start, (size_t)(end - start)); out[count][end - start] = '\0';
+            count++; pos = end;
+        } else pos = start + 1;
+        if (re->bol) break;
+    }
+    return create_value_int(count);
+}
+
+// --- CSV Okuyucu ---
+// read_csv(yol, ayırıcı, tırnak, başlık_var, sütun1, sütun2, ...): dosya eşlenip (mmap) tek geçişte taranır,
+// her kayıttaki alanlar sırasıyla verilen tipli sütun dizilerine yazılır; okunan satır sayısı döner.
+// Tırnaklı alanlar RFC 4180'e uyar ("" -> "); tırnak "" verilirse tırnak işlenmez. Fazla sütunlar yok sayılır.
+// Boş sayısal alanlar int tiplerinde 0, float tiplerinde nan olur.
+// Tırnaksız alan sonu (ayırıcı, \n, \r) SSE2 ile 16 baytlık bloklarda aranır.
+static inline const char* csv_find_field_end(const char* p, const char* end, char delim) {
+#if defined(NUR_X86_SIMD) && defined(__SSE2__)
+    __m128i vd = _mm_set1_epi8(delim), vn = _mm_set1_epi8('\n'), vr = _mm_set1_epi8('\r');
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        int m = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, vd), _mm_cmpeq_epi8(v, vn)), _mm_cmpeq_epi8(v, vr)));
+        if (m) return p + __builtin_ctz(m);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != delim && *p != '\n' && *p != '\r') p++;
+    return p;
+}
+
+void csv_store_field(Variable* col, int row, const char* f, size_t len, int line, int field) {
+    VarType et = col->value.array.element_type;
+    char* slot = (char*)col->value.array.data + (size_t)row * get_sizeof_element_type(et);
+    char buf[MAX_STRING_LEN], err[MAX_STRING_LEN + 150];
+    if (et != VAR_STRING) { while (len > 0 && (*f == ' ' || *f == '\t')) { f++; len--; } while (len > 0 && (f[len - 1] == ' ' || f[len - 1] == '\t')) len--; }
+    if (len >= MAX_STRING_LEN) { sprintf(err, "'read_csv' satır %d, sütun %d: alan %d karakter sınırını aşıyor.", line, field + 1, MAX_STRING_LEN - 1); error(err); }
+    memcpy(buf, f, len); buf[len] = '\0';
+    switch (et) {
+        case VAR_STRING: memcpy(slot, buf, len + 1); return;
+        case VAR_BOOLEAN:
+            if (strcmp(buf, "true") == 0 || strcmp(buf, "1") == 0) *(bool*)slot = true;
+            else if (strcmp(buf, "false") == 0 || strcmp(buf, "0") == 0 || len == 0) *(bool*)slot = false;
+            else break;
+            return;
+        case VAR_INT: case VAR_I64: case VAR_U8: {
+            long long v = 0;
+            if (len > 0 && !parse_int_token(buf, &v)) break;
+            Value val = create_value_i64(v);
+            if (!((et == VAR_INT && v >= INT_MIN && v <= INT_MAX) || et == VAR_I64 || (et == VAR_U8 && v >= 0 && v <= 255))) break;
+            coerce_value_to_var_type(et, &val); store_typed_slot(et, slot, val);
+            return;
+        }
+        case VAR_FLOAT: case VAR_F32: {
+            double v = NAN;
+            if (len > 0 && !parse_double_token(buf, &v)) break;
+            if (et == VAR_FLOAT) *(double*)slot = v; else *(float*)slot = (float)v;
+            return;
+        }
+        default: break;
+    }
+    sprintf(err, "'read_csv' satır %d, sütun %d: '%s' değeri %s sütununa dönüştürülemedi.", line, field + 1, buf, var_type_to_string_user(et));
+    error(err);
+}
+
+// cols NULL ise yalnızca veri satırları sayılır (csv_row_count).
+int csv_parse(const char* path, char delim, char quote, bool header, Variable** cols, int ncols) {
+    char err[MAX_STRING_LEN + 150];
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) { sprintf(err, "CSV dosyası açılamadı: %s (%s)", path, strerror(errno)); error(err); }
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); sprintf(err, "CSV dosyası okunamadı: %s", path); error(err); }
+    if (st.st_size == 0) { close(fd); return 0; }
+    size_t len = (size_t)st.st_size;
+    const char* data = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) { sprintf(err, "CSV dosyası eşlenemedi: %s (%s)", path, strerror(errno)); error(err); }
+    madvise((void*)data, len, MADV_SEQUENTIAL);
+    // Ayrıştırma hatası (burada ya da csv_store_field'da) eşlemeyi bırakıp yayılır
+    jmp_buf env;
+    jmp_buf* prev_jmp = nur->error_jmp;
+    if (setjmp(env) != 0) { nur->error_jmp = prev_jmp; munmap((void*)data, len); raise_error(); }
+    nur->error_jmp = &env;
+
+    int capacity = INT_MAX;
+    for (int c = 0; c < ncols; ++c) if (cols[c]->value.array.size < capacity) capacity = cols[c]->value.array.size;
+    const char *p = data, *end = data + len;
+    int rows = 0, line = 1; bool in_header = header;
+    char qbuf[MAX_STRING_LEN];
+    while (p < end) {
+        if (*p == '\n' || *p == '\r') { if (*p == '\n') line++; p++; continue; } // Boş satırlar atlanır
+        if (!in_header && cols && rows >= capacity) {
+            sprintf(err, "'read_csv': dosyada sütun dizilerinin kapasitesinden (%d) fazla satır var (csv_row_count ile boyutlandırın).", capacity); error(err);
+        }
+        int record_line = line, field = 0;
+        for (;;) {
+            const char* f; size_t flen;
+            if (quote && *p == quote) { // Tırnaklı alan: kapanış tırnağına kadar, "" bir tırnak sayılır
+                size_t n = 0; p++;
+                for (;;) {
+                    const char* q = memchr(p, quote, end - p);
+                    if (!q) { sprintf(err, "'read_csv' satır %d: kapanmamış tırnak.", record_line); error(err); }
+                    for (const char* c = p; c < q; ++c) { if (*c == '\n') line++; if (n + 1 < sizeof qbuf) qbuf[n] = *c; n++; }
+                    p = q + 1;
+                    if (p < end && *p == quote) { if (n + 1 < sizeof qbuf) qbuf[n] = quote; n++; p++; continue; }
+                    break;
+                }
+                if (n >= sizeof qbuf) n = sizeof qbuf; // csv_store_field uzunluk hatasını verir
+                f = qbuf; flen = n;
+                if (p < end && *p != delim && *p != '\n' && *p != '\r') {
+                    sprintf(err, "'read_csv' satır %d: kapanış tırnağından sonra beklenmeyen karakter.", record_line); error(err);
+                }
+            } else {
+                const char* q = csv_find_field_end(p, end, delim);
+                f = p; flen = (size_t)(q - p); p = q;
+            }
+            if (!in_header && cols && field < ncols) csv_store_field(cols[field], rows, f, flen, record_line, field);
+            field++;
+            if (p < end && *p == delim) { p++; continue; }
+            if (p < end && *p == '\r') p++;
+            if (p < end && *p == '\n') { p++; line++; }
+            break;
+        }
+        if (in_header) { in_header = false; continue; }
+        if (cols && field < ncols) {
+            sprintf(err, "'read_csv' satır %d: %d sütun bekleniyordu, %d bulundu.", record_line, ncols, field); error(err);
+        }
+        rows++;
+    }
+    nur->error_jmp = prev_jmp;
+    munmap((void*)data, len);
+    return rows;
+}
+
+char csv_single_char_arg(const char* fname, Value v, bool allow_empty, const char* what) {
+    size_t n = strlen(v.as.string_val);
+    if (n == 1 || (allow_empty && n == 0)) return v.as.string_val[0];
+    char err[150]; sprintf(err, "'%s' %s tek karakterlik bir string olmalıdır.", fname, what); error(err);
+    return 0;
+}
+
+Value native_read_csv(Value* args, int num_args) {
+    if (num_args < 5) error("'read_csv' en az 5 argüman bekler (yol, ayırıcı, tırnak, başlık_var, sütun...).");
+    if (args[0].type != VAL_STRING || args[1].type != VAL_STRING || args[2].type != VAL_STRING || args[3].type != VAL_BOOLEAN)
+        error("'read_csv' argümanları: yol (string), ayırıcı (string), tırnak (string), başlık_var (boolean), ardından sütun dizileri.");
+    char delim = csv_single_char_arg("read_csv", args[1], false, "ayırıcı"), quote = csv_single_char_arg("read_csv", args[2], true, "tırnak");
+    Variable* cols[MAX_PARAMETERS]; int ncols = num_args - 4;
+    for (int c = 0; c < ncols; ++c) {
+        cols[c] = expect_array_arg("read_csv", args[4 + c], 5 + c);
+        expect_writable_array("read_csv", cols[c]);
+        if (cols[c]->value.array.element_type == VAR_HANDLE || cols[c]->value.array.element_type == VAR_CHANNEL || cols[c]->value.array.element_type == VAR_GENERATOR) error("'read_csv' handle, chan veya gen dizisine yazamaz.");
+    }
+    return create_value_int(csv_parse(args[0].as.string_val, delim, quote, args[3].as.bool_val, cols, ncols));
+}
+Value native_csv_row_count(Value* args, int num_args) {
+    (void)num_args;
+    char delim = csv_single_char_arg("csv_row_count", args[1], false, "ayırıcı"), quote = csv_single_char_arg("csv_row_count", args[2], true, "tırnak");
+    return create_value_int(csv_parse(args[0].as.string_val, delim, quote, args[3].as.bool_val, NULL, 0));
+}
+
+// --- JSON ---
+// Okuyucu çekme (pull) tarzındadır: json_next_event her çağrıda bir olay (nesne/dizi başı-sonu, anahtar,
+// skaler) üretir ve sözdizimini (virgül, iki nokta, parantez eşleşmesi) yol üstünde denetler.
+// Aynı okuyucu hem eşlenmiş belgeyi (json_decode) hem de tutamaçtan parça parça okunan dosyayı (json_next) tarar.
+// Anahtar ve string metinleri kaçışları çözülmüş olarak 'text'e yazılır; sınırı aşanlar yalnızca
+// kullanılmak istendiğinde hata verir, böylece atlanan uzun değerler sorun çıkarmaz.
+typedef enum { JSON_EV_END, JSON_EV_BEGIN_OBJECT, JSON_EV_END_OBJECT, JSON_EV_BEGIN_ARRAY, JSON_EV_END_ARRAY,
+               JSON_EV_KEY, JSON_EV_STRING, JSON_EV_NUMBER, JSON_EV_TRUE, JSON_EV_FALSE, JSON_EV_NULL } JsonEvent;
+const char* json_event_names[] = { "end", "begin_object", "end_object", "begin_array", "end_array", "key", "string", "number", "true", "false", "null" };
+
+struct JsonReader {
+    FILE* fp;               // NULL: tüm belge bellekte [p, end)
+    const char* p; const char* end;
+    char* chunk;            // fp okuma tamponu (FILE_BUFFER_SIZE)
+    int line, depth;
+    char stack[JSON_MAX_DEPTH];
+    bool need_comma, after_key, done, is_int;
+    JsonEvent last;
+    char text[MAX_STRING_LEN];
+    size_t text_len;        // > MAX_STRING_LEN - 1 ise metin kesildi
+};
+
+void json_fail(JsonReader* r, const char* msg) {
+    char err[MAX_STRING_LEN + 100]; sprintf(err, "JSON satır %d: %s", r->line, msg); error(err);
+}
+static bool json_refill(JsonReader* r) {
+    if (!r->fp) return false;
+    size_t n = fread(r->chunk, 1, FILE_BUFFER_SIZE, r->fp);
+    r->p = r->chunk; r->end = r->chunk + n;
+    return n > 0;
+}
+bool json_reader_buffered(const JsonReader* r) { return r->p < r->end; }
+static inline int json_peek(JsonReader* r) { if (r->p == r->end && !json_refill(r)) return EOF; return (unsigned char)*r->p; }
+static inline int json_getc(JsonReader* r) { int c = json_peek(r); if (c != EOF) r->p++; return c; }
+static inline void json_text_put(JsonReader* r, char c) { if (r->text_len < MAX_STRING_LEN - 1) r->text[r->text_len] = c; r->text_len++; }
+static void json_skip_ws(JsonReader* r) {
+    for (int c; (c = json_peek(r)) == ' ' || c == '\t' || c == '\n' || c == '\r'; r->p++) if (c == '\n') r->line++;
+}
+static unsigned json_read_hex4(JsonReader* r) {
+    unsigned v = 0;
+    for (int i = 0; i < 4; ++i) {
+        int c = json_getc(r);
+        if (!isxdigit(c)) json_fail(r, "\\u kaçışı dört onaltılık basamak bekler.");
+        v = v * 16 + (unsigned)(isdigit(c) ? c - '0' : (c | 0x20) - 'a' + 10);
+    }
+    return v;
+}
+static void json_put_utf8(JsonReader* r, unsigned cp) {
+    if (cp < 0x80) json_text_put(r, (char)cp);
+    else if (cp < 0x800) { json_text_put(r, (char)(0xC0 | cp >> 6)); json_text_put(r, (char)(0x80 | (cp & 0x3F))); }
+    else if (cp < 0x10000) { json_text_put(r, (char)(0xE0 | cp >> 12)); json_text_put(r, (char)(0x80 | ((cp >> 6) & 0x3F))); json_text_put(r, (char)(0x80 | (cp & 0x3F))); }
+    else { json_text_put(r, (char)(0xF0 | cp >> 18)); json_text_put(r, (char)(0x80 | ((cp >> 12) & 0x3F))); json_text_put(r, (char)(0x80 | ((cp >> 6) & 0x3F))); json_text_put(r, (char)(0x80 | (cp & 0x3F))); }
+}
+// Açılış tırnağı tüketilmiş olmalı. Kaçış içermeyen kısımlar tampondan toplu kopyalanır.
+static void json_read_string(JsonReader* r) {
+    r->text_len = 0;
+    for (;;) {
+        const char* s = r->p;
+        while (s < r->end && *s != '"' && *s != '\\' && (unsigned char)*s >= 0x20) s++;
+        size_t n = (size_t)(s - r->p);
+        if (n) {
+            if (r->text_len < MAX_STRING_LEN - 1) memcpy(r->text + r->text_len, r->p, n < MAX_STRING_LEN - 1 - r->text_len ? n : MAX_STRING_LEN - 1 - r->text_len);
+            r->text_len += n; r->p = s;
+        }
+        int c = json_getc(r);
+        if (c == '"') break;
+        if (c == EOF) json_fail(r, "kapanmamış string.");
+        if (c < 0x20) json_fail(r, "string içinde kaçışsız kontrol karakteri.");
+        if (c != '\\') { json_text_put(r, (char)c); continue; } // Okuma tamponu sınırında kalan sıradan bayt
+        switch (c = json_getc(r)) {
+            case '"': case '\\': case '/': json_text_put(r, (char)c); break;
+            case 'b': json_text_put(r, '\b'); break; case 'f': json_text_put(r, '\f'); break;
+            case 'n': json_text_put(r, '\n'); break; case 'r': json_text_put(r, '\r'); break; case 't': json_text_put(r, '\t'); break;
+            case 'u': {
+                unsigned cp = json_read_hex4(r);
+                if (cp >= 0xD800 && cp <= 0xDBFF) { // Vekil çifti
+                    if (json_getc(r) != '\\' || json_getc(r) != 'u') json_fail(r, "eşi olmayan UTF-16 vekil karakteri.");
+                    unsigned lo = json_read_hex4(r);
+                    if (lo < 0xDC00 || lo > 0xDFFF) json_fail(r, "geçersiz UTF-16 vekil çifti.");
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                } else if (cp >= 0xDC00 && cp <= 0xDFFF) json_fail(r, "eşi olmayan UTF-16 vekil karakteri.");
+                json_put_utf8(r, cp);
+                break;
+            }
+            default: json_fail(r, "geçersiz kaçış dizisi.");
+        }
+    }
+    r->text[r->text_len < MAX_STRING_LEN ? r->text_len : MAX_STRING_LEN - 1] = '\0';
+}
+// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+static void json_read_number(JsonReader* r) {
+    r->text_len = 0; r->is_int = true;
+    int c = json_peek(r);
+    if (c == '-') { json_text_put(r, '-'); r->p++; c = json_peek(r); }
+    if (!isdigit(c)) json_fail(r, "geçersiz sayı.");
+    if (c == '0') { json_text_put(r, '0'); r->p++; if (isdigit(json_peek(r))) json_fail(r, "sayılar 0 ile başlayamaz."); }
+    else while (isdigit(c = json_peek(r))) { json_text_put(r, (char)c); r->p++; }
+    if (json_peek(r) == '.') {
+        json_text_put(r, '.'); r->p++; r->is_int = false;
+        if (!isdigit(json_peek(r))) json_fail(r, "ondalık noktadan sonra basamak bekleniyordu.");
+        while (isdigit(c = json_peek(r))) { json_text_put(r, (char)c); r->p++; }
+    }
+    if ((c = json_peek(r)) == 'e' || c == 'E') {
+        json_text_put(r, 'e'); r->p++; r->is_int = false;
+        if ((c = json_peek(r)) == '+' || c == '-') { json_text_put(r, (char)c); r->p++; }
+        if (!isdigit(json_peek(r))) json_fail(r, "üs kısmında basamak bekleniyordu.");
+        while (isdigit(c = json_peek(r))) { json_text_put(r, (char)c); r->p++; }
+    }
+    if (r->text_len >= MAX_STRING_LEN) json_fail(r, "sayı çok uzun.");
+    r->text[r->text_len] = '\0';
+}
+static void json_expect_literal(JsonReader* r, const char* lit) {
+    for (const char* l = lit; *l; ++l) if (json_getc(r) != *l) json_fail(r, "beklenmedik karakter.");
+}
+static inline void json_after_value(JsonReader* r) { if (r->depth) r->need_comma = true; else r->done = true; }
+
+JsonEvent json_next_event(JsonReader* r) {
+    json_skip_ws(r);
+    int c = json_peek(r);
+    if (r->done) { if (c != EOF) json_fail(r, "belge sonundan sonra fazladan veri."); return r->last = JSON_EV_END; }
+    if (c == EOF) json_fail(r, r->depth ? "belge beklenmedik şekilde bitti." : "boş belge.");
+    char top = r->depth ? r->stack[r->depth - 1] : 0;
+    if ((c == '}' || c == ']') && !r->after_key) {
+        if (c != (top == '{' ? '}' : top == '[' ? ']' : 0)) json_fail(r, "eşleşmeyen kapanış parantezi.");
+        r->p++; r->depth--; json_after_value(r);
+        return r->last = c == '}' ? JSON_EV_END_OBJECT : JSON_EV_END_ARRAY;
+    }
+    if (r->need_comma) {
+        if (c != ',') json_fail(r, top == '{' ? "',' veya '}' bekleniyordu." : "',' veya ']' bekleniyordu.");
+        r->p++; r->need_comma = false;
+        json_skip_ws(r); c = json_peek(r);
+        if (c == '}' || c == ']') json_fail(r, "kapanıştan önce fazladan virgül.");
+    }
+    if (top == '{' && !r->after_key) {
+        if (c != '"') json_fail(r, "nesne anahtarı (string) bekleniyordu.");
+        r->p++; json_read_string(r);
+        json_skip_ws(r);
+        if (json_getc(r) != ':') json_fail(r, "anahtardan sonra ':' bekleniyordu.");
+        r->after_key = true;
+        return r->last = JSON_EV_KEY;
+    }
+    r->after_key = false;
+    JsonEvent ev;
+    switch (c) {
+        case '{': case '[':
+            if (r->depth == JSON_MAX_DEPTH) json_fail(r, "iç içe geçme derinliği sınırı aşıldı.");
+            r->p++; r->stack[r->depth++] = (char)c;
+            return r->last = c == '{' ? JSON_EV_BEGIN_OBJECT : JSON_EV_BEGIN_ARRAY;
+        case '"': r->p++; json_read_string(r); ev = JSON_EV_STRING; break;
+        case 't': json_expect_literal(r, "true"); ev = JSON_EV_TRUE; break;
+        case 'f': json_expect_literal(r, "false"); ev = JSON_EV_FALSE; break;
+        case 'n': json_expect_literal(r, "null"); ev = JSON_EV_NULL; break;
+        default:
+            if (c != '-' && !isdigit(c)) json_fail(r, "beklenmedik karakter.");
+            json_read_number(r); ev = JSON_EV_NUMBER;
+    }
+    json_after_value(r);
+    return r->last = ev;
+}
+// ev bir nesne/dizi başlangıcıysa eşleşen kapanışa kadar tüketir; skalerlerde bir şey yapmaz.
+void json_skip_value(JsonReader* r, JsonEvent ev) {
+    if (ev != JSON_EV_BEGIN_OBJECT && ev != JSON_EV_BEGIN_ARRAY) return;
+    int target = r->depth - 1;
+    while (r->depth > target) json_next_event(r);
+}
+const char* json_checked_text(JsonReader* r) {
+    if (r->text_len > MAX_STRING_LEN - 1) { char msg[100]; sprintf(msg, "string %d karakter sınırını aşıyor.", MAX_STRING_LEN - 1); json_fail(r, msg); }
+    return r->text;
+}
+Value json_number_value(JsonReader* r) {
+    long long iv; double dv;
+    if (r->is_int && parse_int_token(r->text, &iv)) return (iv >= INT_MIN && iv <= INT_MAX) ? create_value_int((int)iv) : create_value_i64(iv);
+    parse_double_token(r->text, &dv);
+    return create_value_float(dv);
+}
+
+// Skaler olayı tipli yuvaya yazar; null yuvayı değiştirmez. Sayılar Value'ya sarılmadan doğrudan yazılır.
+void json_store_scalar(JsonReader* r, JsonEvent ev, VarType t, void* slot, const char* what) {
+    if (ev == JSON_EV_NULL) return;
+    long long iv; double dv;
+    switch (t) {
+        case VAR_STRING: if (ev == JSON_EV_STRING) { memcpy(slot, json_checked_text(r), strlen(r->text) + 1); return; } break;
+        case VAR_BOOLEAN: if (ev == JSON_EV_TRUE || ev == JSON_EV_FALSE) { *(bool*)slot = ev == JSON_EV_TRUE; return; } break;
+        case VAR_INT: case VAR_I64: case VAR_U8:
+            if (ev != JSON_EV_NUMBER || !r->is_int || !parse_int_token(r->text, &iv)) break;
+            if (t == VAR_I64) { *(long long*)slot = iv; return; }
+            if (t == VAR_INT && iv >= INT_MIN && iv <= INT_MAX) { *(int*)slot = (int)iv; return; }
+            if (t == VAR_U8 && iv >= 0 && iv <= 255) { *(unsigned char*)slot = (unsigned char)iv; return; }
+            break;
+        case VAR_FLOAT: case VAR_F32:
+            if (ev != JSON_EV_NUMBER || !parse_double_token(r->text, &dv)) break;
+            if (t == VAR_FLOAT) *(double*)slot = dv; else *(float*)slot = (float)dv;
+            return;
+        default: break;
+    }
+    char msg[MAX_IDENT_LEN + 100];
+    sprintf(msg, "'%s' için %s değeri bekleniyordu, %s bulundu.", what, var_type_to_string_user(t), json_event_names[ev]);
+    json_fail(r, msg);
+}
+void json_decode_struct(JsonReader* r, JsonEvent ev, Variable* var, int index) {
+    int sidx = var->type == VAR_STRUCT ? var->value.record.struct_idx : var->value.array.struct_idx;
+    const StructDefinition* sd = &nur->struct_table[sidx];
+    if (ev != JSON_EV_BEGIN_OBJECT) { char msg[MAX_IDENT_LEN + 60]; sprintf(msg, "'%s' için nesne bekleniyordu, %s bulundu.", sd->name, json_event_names[ev]); json_fail(r, msg); }
+    while (json_next_event(r) == JSON_EV_KEY) {
+        int f = 0;
+        while (f < sd->num_fields && (r->text_len > MAX_STRING_LEN - 1 || strcmp(sd->fields[f].name, r->text) != 0)) f++;
+        JsonEvent vev = json_next_event(r);
+        if (f == sd->num_fields) { json_skip_value(r, vev); continue; } // Bilinmeyen anahtar
+        json_store_scalar(r, vev, sd->fields[f].type, struct_field_ptr(var, index, f), sd->fields[f].name);
+    }
+}
+// Hedef: tekil struct (veya struct dizisi elemanı) ya da dizi. Doldurulan eleman sayısını döndürür.
+int json_decode_into(JsonReader* r, const char* fname, Value target) {
+    JsonEvent ev = json_next_event(r);
+    int count = 1;
+    if (target.type == VAL_STRUCT_REF) json_decode_struct(r, ev, target.as.struct_ref.var, target.as.struct_ref.index);
+    else if (target.type == VAL_ARRAY_REF) {
+        Variable* arr = target.as.array_var;
+        expect_writable_array(fname, arr);
+        VarType et = arr->value.array.element_type;
+        if (et == VAR_HANDLE || et == VAR_CHANNEL || et == VAR_GENERATOR) { char err[100]; sprintf(err, "'%s' handle, chan veya gen dizisine yazamaz.", fname); error(err); }
+        if (ev != JSON_EV_BEGIN_ARRAY) { char msg[80]; sprintf(msg, "dizi bekleniyordu, %s bulundu.", json_event_names[ev]); json_fail(r, msg); }
+        size_t es = et == VAR_STRUCT ? 0 : get_sizeof_element_type(et);
+        count = 0;
+        while ((ev = json_next_event(r)) != JSON_EV_END_ARRAY) {
+            if (count >= arr->value.array.size) { char msg[100]; sprintf(msg, "dizide hedef dizinin kapasitesinden (%d) fazla eleman var.", arr->value.array.size); json_fail(r, msg); }
+            if (et == VAR_STRUCT) json_decode_struct(r, ev, arr, count);
+            else json_store_scalar(r, ev, et, (char*)arr->value.array.data + (size_t)count * es, "dizi elemanı");
+            count++;
+        }
+    } else { char err[150]; sprintf(err, "'%s' hedefi struct veya dizi olmalıdır (%s verildi).", fname, value_type_to_string(target.type)); error(err); }
+    json_next_event(r); // Belge sonu: fazladan veri varsa hata
+    return count;
+}
+void json_reader_init(JsonReader* r, FILE* fp, const char* data, size_t len) {
+    memset(r, 0, sizeof *r);
+    r->fp = fp; r->p = data; r->end = data + len; r->line = 1; r->last = JSON_EV_END;
+}
+
+// json_decode(yol, hedef): dosya eşlenir ve tek geçişte hedefe çözülür.
+Value native_json_decode(Value* args, int num_args) {
+    (void)num_args;
+    char err[MAX_STRING_LEN + 100];
+    int fd = open(args[0].as.string_val, O_RDONLY);
+    if (fd < 0) { sprintf(err, "JSON dosyası açılamadı: %s (%s)", args[0].as.string_val, strerror(errno)); error(err); }
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); sprintf(err, "JSON dosyası okunamadı: %s", args[0].as.string_val); error(err); }
+    size_t len = (size_t)st.st_size;
+    const char* data = len ? mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0) : "";
+    close(fd);
+    if (data == MAP_FAILED) { sprintf(err, "JSON dosyası eşlenemedi: %s (%s)", args[0].as.string_val, strerror(errno)); error(err); }
+    if (len) madvise((void*)data, len, MADV_SEQUENTIAL);
+    // Çözümleme hatası eşlemeyi bırakıp yayılır
+    jmp_buf env;
+    jmp_buf* prev_jmp = nur->error_jmp;
+    if (setjmp(env) != 0) { nur->error_jmp = prev_jmp; if (len) munmap((void*)data, len); raise_error(); }
+    nur->error_jmp = &env;
+    JsonReader r; json_reader_init(&r, NULL, data, len);
+    int count = json_decode_into(&r, "json_decode", args[1]);
+    nur->error_jmp = prev_jmp;
+    if (len) munmap((void*)data, len);
+    return create_value_int(count);
+}
+Value native_json_parse(Value* args, int num_args) {
+    (void)num_args;
+    JsonReader r; json_reader_init(&r, NULL, args[0].as.string_val, strlen(args[0].as.string_val));
+    return create_value_int(json_decode_into(&r, "json_parse", args[1]));
+}
+// Tutamaç üzerinden olay akışı: okuyucu ilk json_next çağrısında oluşturulur ve close ile bırakılır.
+JsonReader* handle_json_reader(const char* fname, Value h) {
+    FileHandle* fh = resolve_handle(fname, h);
+    if (fh->writable) { char err[100]; sprintf(err, "'%s': dosya yazma kipinde açılmış.", fname); error(err); }
+    if (!fh->json) {
+        fh->json = malloc(sizeof(JsonReader) + FILE_BUFFER_SIZE);
+        if (!fh->json) error("JSON okuyucusu için bellek ayrılamadı.");
+        json_reader_init(fh->json, fh->fp, NULL, 0);
+        fh->json->chunk = (char*)(fh->json + 1);
+    }
+    return fh->json;
+}
+Value native_json_next(Value* args, int num_args) {
+    (void)num_args;
+    return create_value_string(json_event_names[json_next_event(handle_json_reader("json_next", args[0]))]);
+}
+Value native_json_text(Value* args, int num_args) {
+    (void)num_args;
+    JsonReader* r = handle_json_reader("json_text", args[0]);
+    if (r->last != JSON_EV_KEY && r->last != JSON_EV_STRING && r->last != JSON_EV_NUMBER) error("'json_text' yalnızca key, string veya number olayından sonra çağrılabilir.");
+    return create_value_string(json_checked_text(r));
+}
+Value native_json_number(Value* args, int num_args) {
+    (void)num_args;
+    JsonReader* r = handle_json_reader("json_number", args[0]);
+    if (r->last != JSON_EV_NUMBER) error("'json_number' yalnızca number olayından sonra çağrılabilir.");
+    return json_number_value(r);
+}
+Value native_json_skip(Value* args, int num_args) {
+    (void)num_args;
+    JsonReader* r = handle_json_reader("json_skip", args[0]);
+    json_skip_value(r, r->last == JSON_EV_KEY ? json_next_event(r) : r->last); // Anahtardan sonra: değerini atla
+    return create_value_null();
+}
+
+// Yazıcı: FILE tamponuna (json_write) veya sabit boyutlu string tamponuna (json_stringify) doğrudan yazar.
+typedef struct { FILE* fp; char buf[MAX_STRING_LEN]; size_t len; bool overflow; } JsonSink;
+static void json_emit(JsonSink* s, const char* p, size_t n) {
+    if (s->fp) { fwrite(p, 1, n, s->fp); return; }
+    if (s->len + n >= MAX_STRING_LEN) { s->overflow = true; return; }
+    memcpy(s->buf + s->len, p, n); s->len += n;
+}
+void json_emit_string(JsonSink* s, const char* str) {
+    static const char hex[] = "0123456789abcdef";
+    json_emit(s, "\"", 1);
+    const char* run = str;
+    for (const char* p = str; ; ++p) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        json_emit(s, run, (size_t)(p - run));
+        if (!c) break;
+        char esc[6] = { '\\', 0 }; size_t n = 2;
+        switch (c) {
+            case '"': esc[1] = '"'; break; case '\\': esc[1] = '\\'; break; case '\n': esc[1] = 'n'; break;
+            case '\r': esc[1] = 'r'; break; case '\t': esc[1] = 't'; break; case '\b': esc[1] = 'b'; break; case '\f': esc[1] = 'f'; break;
+            default: memcpy(esc + 1, "u00", 3); esc[4] = hex[c >> 4]; esc[5] = hex[c & 15]; n = 6;
+        }
+        json_emit(s, esc, n);
+        run = p + 1;
+    }
+    json_emit(s, "\"", 1);
+}
+void json_emit_scalar(JsonSink* s, Value v) {
+    char nb[32];
+    switch (v.type) {
+        case VAL_INT: case VAL_I64: json_emit(s, nb, (size_t)format_int(nb, value_as_i64(v))); break;
+        case VAL_FLOAT: if (isfinite(v.as.float_val)) json_emit(s, nb, (size_t)format_double_ex(nb, v.as.float_val, v.f32)); else json_emit(s, "null", 4); break;
+        case VAL_STRING: json_emit_string(s, v.as.string_val); break;
+        case VAL_BOOLEAN: if (v.as.bool_val) json_emit(s, "true", 4); else json_emit(s, "false", 5); break;
+        case VAL_NULL: json_emit(s, "null", 4); break;
+        default: { char err[100]; sprintf(err, "JSON'a yazılamayan tip: %s.", value_type_to_string(v.type)); error(err); }
+    }
+}
+void json_emit_struct(JsonSink* s, Variable* var, int index) {
+    int sidx = var->type == VAR_STRUCT ? var->value.record.struct_idx : var->value.array.struct_idx;
+    const StructDefinition* sd = &nur->struct_table[sidx];
+    json_emit(s, "{", 1);
+    for (int f = 0; f < sd->num_fields; ++f) {
+        if (f) json_emit(s, ",", 1);
+        json_emit_string(s, sd->fields[f].name);
+        json_emit(s, ":", 1);
+        json_emit_scalar(s, load_typed_slot(sd->fields[f].type, struct_field_ptr(var, index, f)));
+    }
+    json_emit(s, "}", 1);
+}
+void json_emit_value(JsonSink* s, Value v) {
+    if (v.type == VAL_STRUCT_REF) { json_emit_struct(s, v.as.struct_ref.var, v.as.struct_ref.index); return; }
+    if (v.type != VAL_ARRAY_REF) { json_emit_scalar(s, v); return; }
+    Variable* arr = v.as.array_var;
+    VarType et = arr->value.array.element_type;
+    size_t es = et == VAR_STRUCT ? 0 : get_sizeof_element_type(et);
+    json_emit(s, "[", 1);
+    for (int i = 0; i < arr->value.array.size; ++i) {
+        if (i) json_emit(s, ",", 1);
+        if (et == VAR_STRUCT) json_emit_struct(s, arr, i);
+        else json_emit_scalar(s, load_typed_slot(et, (char*)arr->value.array.data + (size_t)i * es));
+    }
+    json_emit(s, "]", 1);
+}
+Value native_json_write(Value* args, int num_args) {
+    (void)num_args;
+    FileHandle* fh = resolve_handle("json_write", args[0]);
+    if (!fh->writable) error("'json_write': dosya okuma kipinde açılmış.");
+    JsonSink s = { fh->fp, {0}, 0, false };
+    json_emit_value(&s, args[1]);
+    if (ferror(fh->fp)) { char err[150]; sprintf(err, "'json_write' başarısız: %s", strerror(errno)); error(err); }
+    return create_value_null();
+}
+Value native_json_stringify(Value* args, int num_args) {
+    (void)num_args;
+    JsonSink s = { NULL, {0}, 0, false };
+    json_emit_value(&s, args[0]);
+    if (s.overflow) { char err[120]; sprintf(err, "'json_stringify' sonucu %d karakter sınırını aşıyor (json_write kullanın).", MAX_STRING_LEN - 1); error(err); }
+    s.buf[s.len] = '\0';
+    return create_value_string(s.buf);
+}
+
+// --- Paralel Yürütme ---
+// 'parallel for' ve par_* dahili fonksiyonları için. İş count öğedir ve sabit boyutlu bloklara bölünür
+// (blok sınırları iş parçacığı sayısından bağımsızdır, böylece blok sırasıyla birleştirilen sonuçlar
+// deterministiktir). Her işçi başta ardışık bir blok aralığı alır, kendi aralığının önünden birer blok
+// işler; aralığı biterse diğer işçilerin aralığının arka yarısını çalar (iş çalma).
+// İşçiler ilk paralel bölgede bir kez başlatılır ve işler arasında koşul değişkeninde bekler (ParallelPool).
+// Her işçinin yeniden kullanılan kendi NurState'i vardır: token'lar, fonksiyon/struct tabloları ve derlenmiş
+// ifadeler yalnızca program değiştiyse kopyalanır; değişkenler her işte kopyalanır ama dizi/struct belleği
+// paylaşılır, yani farklı dizi elemanlarına yazmak kilit gerektirmez. Skaler değişkenlere yazılanlar işçiye özeldir.
+typedef struct ParallelJob ParallelJob;
+typedef void (*ParallelBlockFn)(ParallelJob* job, int block, long long lo, long long hi); // nur: işçinin durumu
+typedef struct { pthread_mutex_t lock; int lo, hi; } ParallelRange; // Kalan bloklar [lo, hi)
+struct ParallelJob {
+    long long count, grain;
+    int num_blocks, num_workers;
+    ParallelBlockFn run_block;
+    void* ctx;
+    NurState* parent;
+    NurState* workers[MAX_PARALLEL_WORKERS]; // Havuzun durumları; tek işçide workers[0] üst durumun kendisidir
+    ParallelRange ranges[MAX_PARALLEL_WORKERS];
+    int stop, failed_worker; // __atomic ile güncellenir
+    void* scratch; // İşe ait geçici bellek; parallel_finish bırakır (hata yolunda da)
+    Variable* saved_scalars; // Tek işçide bloklar öncesi sembol tablosu (bkz. parallel_run_sequential)
+    int num_saved;
+};
+void parallel_finish(ParallelJob* job);
+
+int parallel_thread_count() {
+    static int cached = 0; // Birden çok durum aynı anda hesaplayabilir; sonuç aynıdır
+    int n = __atomic_load_n(&cached, __ATOMIC_RELAXED);
+    if (n == 0) {
+        const char* env = getenv("NUR_THREADS"); // Test ve sınırlama için
+        long want = env && atoi(env) > 0 ? atoi(env) : sysconf(_SC_NPROCESSORS_ONLN);
+        n = want < 1 ? 1 : (want > MAX_PARALLEL_WORKERS ? MAX_PARALLEL_WORKERS : (int)want);
+        __atomic_store_n(&cached, n, __ATOMIC_RELAXED);
+    }
+    return n;
+}
+static inline bool parallel_stopped(const ParallelJob* job) { return __atomic_load_n(&job->stop, __ATOMIC_RELAXED) != 0; }
+
+SpawnGroup* spawn_group_get(NurState* st);
+// İşçi durumu: üst durumun çalışma anı görüntüsü. Kopyalanan değişkenler kapsam 0'ın altında kalır,
+// exit_scope onları hiçbir zaman bırakmaz; devralınan dosya tutamaçları da işçi tarafından kapatılmaz.
+NurState* parallel_clone_state(NurState* parent) {
+    NurState* st = nur_create();
+    if (!st) error("Paralel işçi durumu için bellek ayrılamadı.");
+    memcpy(st->tokens, parent->tokens, (size_t)parent->num_tokens * sizeof(Token));
+    st->num_tokens = parent->num_tokens;
+    st->current_token_idx = parent->current_token_idx; st->current_line = parent->current_line; // Hata konumu için
+    memcpy(st->symbol_table, parent->symbol_table, (size_t)parent->num_variables * sizeof(Variable));
+    st->num_variables = parent->num_variables;
+    st->scope_stack_ptr = 0; st->scope_stack[0] = parent->num_variables;
+    memcpy(st->modules, parent->modules, (size_t)parent->num_modules * sizeof(LoadedModule));
+    st->num_modules = parent->num_modules;
+    memcpy(st->function_table, parent->function_table, (size_t)parent->num_functions * sizeof(FunctionDefinition));
+    st->num_functions = parent->num_functions;
+    memcpy(st->struct_table, parent->struct_table, (size_t)parent->num_structs * sizeof(StructDefinition));
+    st->num_structs = parent->num_structs;
+    st->expr_nodes = malloc(((size_t)parent->num_expr_nodes + 1) * sizeof(ExprNode));
+    st->exprs = malloc(((size_t)parent->num_exprs + 1) * sizeof(CompiledExpr));
+    if (!st->expr_nodes || !st->exprs) { free(st->expr_nodes); free(st->exprs); free(st); error("Paralel işçi durumu için bellek ayrılamadı."); }
+    memcpy(st->expr_nodes, parent->expr_nodes, (size_t)parent->num_expr_nodes * sizeof(ExprNode));
+    memcpy(st->exprs, parent->exprs, (size_t)parent->num_exprs * sizeof(CompiledExpr));
+    st->num_expr_nodes = st->expr_nodes_cap = parent->num_expr_nodes;
+    st->num_exprs = st->exprs_cap = parent->num_exprs;
+    memcpy(st->handle_table, parent->handle_table, sizeof st->handle_table);
+    for (int i = 0; i < MAX_FILE_HANDLES; ++i) st->inherited_handles[i] = parent->handle_table[i].in_use;
+    st->spawn_group = spawn_group_get(parent); // Kanal kimlikleri tüm kopyalarda aynı tabloyu gösterir
+    strcpy(st->current_file_path_for_errors, parent->current_file_path_for_errors);
+    st->out = parent->out; st->out_is_tty = parent->out_is_tty;
+    st->in_fd = -1; // user.in* paralel gövdede girdi görmez
+    st->parallel_worker = true;
+    st->compiled = st->ran = true;
+    NurState* prev_state = nur; nur = st;
+    for (int i = 0; i < parent->num_regex; ++i) regex_compile_pattern(parent->regex_cache[i]->pattern); // Kimlikler aynı kalır
+    nur = prev_state;
+    return st;
+}
+// spawn kopyaları ve üreteçler: devralınan dizi ve struct belleğine başvuru alır (bkz. Paylaşılan Depolama).
+// parallel for işçileri döngü bitmeden bırakıldığından başvuru almaz.
+void retain_variable_storage(const Variable* vars, int n) {
+    for (int i = 0; i < n; ++i) {
+        const Variable* v = &vars[i];
+        void* data = v->type == VAR_ARRAY ? v->value.array.data : v->type == VAR_STRUCT ? v->value.record.data : NULL;
+        if (data) storage_retain(data);
+    }
+}
+void clone_share_storage(NurState* st) {
+    retain_variable_storage(st->symbol_table, st->num_variables);
+    st->num_shared_variables = st->num_variables;
+}
+void parallel_pool_free(NurState* owner);
+void parallel_release_state(NurState* st) {
+    parallel_pool_free(st); // spawn kopyasının kendi paralel bölgeleri
+    NurState* prev_state = nur; nur = st;
+    generator_table_free(st);
+    event_loop_free(st);
+    flush_output();
+    while (st->scope_stack_ptr >= 0) exit_scope();
+    for (int i = 0; i < st->num_shared_variables; ++i) release_variable_storage(&st->symbol_table[i]);
+    for (int i = 0; i < MAX_FILE_HANDLES; ++i) {
+        FileHandle* fh = &st->handle_table[i];
+        if (fh->in_use && !st->inherited_handles[i]) { fclose(fh->fp); free(fh->json); }
+    }
+    for (int i = 0; i < st->num_regex; ++i) regex_free(st->regex_cache[i]);
+    free(st->expr_nodes); free(st->exprs);
+    nur = prev_state;
+    free(st);
+}
+
+// Sıradaki bloğu alır: önce kendi aralığının önünden, yoksa başka bir işçinin aralığının arka yarısından.
+bool parallel_next_block(ParallelJob* job, int w, int* block) {
+    ParallelRange* own = &job->ranges[w];
+    pthread_mutex_lock(&own->lock);
+    bool got = own->lo < own->hi;
+    if (got) *block = own->lo++;
+    pthread_mutex_unlock(&own->lock);
+    if (got) return true;
+    for (int k = 1; k < job->num_workers; ++k) {
+        ParallelRange* victim = &job->ranges[(w + k) % job->num_workers];
+        pthread_mutex_lock(&victim->lock);
+        int lo = victim->lo, hi = victim->hi, mid = lo + (hi - lo) / 2;
+        if (lo < hi) victim->hi = mid; // Tek blok kaldıysa (mid == lo) onu alır
+        pthread_mutex_unlock(&victim->lock);
+        if (lo >= hi) continue;
+        *block = mid;
+        if (mid + 1 < hi) { pthread_mutex_lock(&own->lock); own->lo = mid + 1; own->hi = hi; pthread_mutex_unlock(&own->lock); }
+        return true;
+    }
+    return false;
+}
+void parallel_run_blocks(ParallelJob* job, int w) {
+    int block;
+    while (!parallel_stopped(job) && parallel_next_block(job, w, &block)) {
+        long long lo = (long long)block * job->grain, hi = lo + job->grain < job->count ? lo + job->grain : job->count;
+        job->run_block(job, block, lo, hi);
+    }
+}
+// İşçi durumunu işe hazırlar. Program (token'lar, modüller, fonksiyon ve struct tabloları, derlenmiş ifadeler,
+// düzenli ifadeler) yalnızca üst durum ya da programı değiştiyse yeniden kopyalanır; sonraki işlerde işçi kendi
+// derlediği ifadeleri kullanmaya devam eder. Değişkenler, dosya tutamaçları ve çıktı her işte üst durumdan alınır.
+void parallel_sync_state(NurState* st, NurState* parent) {
+    if (st->synced_parent != parent || st->program_serial != parent->program_serial || st->num_tokens != parent->num_tokens ||
+        st->num_functions != parent->num_functions || st->num_structs != parent->num_structs) {
+        st->synced_parent = NULL; // Kopya yarıda kalırsa sonraki iş yeniden dener
+        for (int i = 0; i < st->num_regex; ++i) regex_free(st->regex_cache[i]);
+        st->num_regex = 0;
+        memcpy(st->tokens, parent->tokens, (size_t)parent->num_tokens * sizeof(Token));
+        st->num_tokens = parent->num_tokens;
+        memcpy(st->modules, parent->modules, (size_t)parent->num_modules * sizeof(LoadedModule));
+        st->num_modules = parent->num_modules;
+        memcpy(st->function_table, parent->function_table, (size_t)parent->num_functions * sizeof(FunctionDefinition));
+        st->num_functions = parent->num_functions;
+        memcpy(st->struct_table, parent->struct_table, (size_t)parent->num_structs * sizeof(StructDefinition));
+        st->num_structs = parent->num_structs;
+        if (st->expr_nodes_cap < parent->num_expr_nodes + 1) {
+            ExprNode* nodes = realloc(st->expr_nodes, ((size_t)parent->num_expr_nodes + 1) * sizeof(ExprNode));
+            if (!nodes) error("Paralel işçi durumu için bellek ayrılamadı.");
+            st->expr_nodes = nodes; st->expr_nodes_cap = parent->num_expr_nodes + 1;
+        }
+        if (st->exprs_cap < parent->num_exprs + 1) {
+            CompiledExpr* exprs = realloc(st->exprs, ((size_t)parent->num_exprs + 1) * sizeof(CompiledExpr));
+            if (!exprs) error("Paralel işçi durumu için bellek ayrılamadı.");
+            st->exprs = exprs; st->exprs_cap = parent->num_exprs + 1;
+        }
+        memcpy(st->expr_nodes, parent->expr_nodes, (size_t)parent->num_expr_nodes * sizeof(ExprNode));
+        memcpy(st->exprs, parent->exprs, (size_t)parent->num_exprs * sizeof(CompiledExpr));
+        st->num_expr_nodes = parent->num_expr_nodes; st->num_exprs = parent->num_exprs;
+        st->program_serial = parent->program_serial;
+        st->synced_parent = parent;
+    }
+    for (int i = st->num_regex; i < parent->num_regex; ++i) regex_compile_pattern(parent->regex_cache[i]->pattern); // Kimlikler aynı kalır
+    st->synced_num_regex = st->num_regex;
+    st->current_token_idx = parent->current_token_idx; st->current_line = parent->current_line; // Hata konumu için
+    memcpy(st->symbol_table, parent->symbol_table, (size_t)parent->num_variables * sizeof(Variable));
+    st->num_variables = parent->num_variables;
+    st->scope_stack_ptr = 0; st->scope_stack[0] = parent->num_variables;
+    memcpy(st->handle_table, parent->handle_table, sizeof st->handle_table);
+    for (int i = 0; i < MAX_FILE_HANDLES; ++i) st->inherited_handles[i] = parent->handle_table[i].in_use;
+    st->spawn_group = parent->spawn_group; // parallel_start kurar; kanal kimlikleri tüm işçilerde aynı tabloyu gösterir
+    strcpy(st->current_file_path_for_errors, parent->current_file_path_for_errors);
+    st->out = parent->out; st->out_is_tty = parent->out_is_tty;
+    st->error_message[0] = '\0';
+}
+// İş bittikten sonra işçi durumunu bir sonraki işe hazır bırakır: çıktısı boşaltılır, kendi bildirdiği
+// değişkenler, açtığı dosyalar ve derlediği düzenli ifadeler bırakılır. Program kopyası korunur.
+void parallel_reset_worker(NurState* st) {
+    NurState* prev_state = nur; nur = st;
+    generator_table_free(st);
+    event_loop_free(st);
+    flush_output();
+    while (st->scope_stack_ptr >= 0) exit_scope();
+    st->call_stack_ptr = -1; st->loop_depth = 0; st->for_loop_var_stack_ptr = -1;
+    st->return_flag = false; st->eval_sp = 0; st->expr_depth = 0; st->expr_builder = NULL; st->mapping_allowed = false;
+    for (int i = 0; i < MAX_FILE_HANDLES; ++i) {
+        FileHandle* fh = &st->handle_table[i];
+        if (fh->in_use && !st->inherited_handles[i]) { fclose(fh->fp); free(fh->json); }
+        fh->in_use = false;
+    }
+    int keep = st->synced_parent ? st->synced_num_regex : 0;
+    for (int i = keep; i < st->num_regex; ++i) regex_free(st->regex_cache[i]);
+    st->num_regex = keep;
+    nur = prev_state;
+}
+
+// Bir işçinin bloklarını kendi durumunda çalıştırır. Hata işi durdurur; ilk hata veren işçi kaydedilir.
+void parallel_worker_main(ParallelJob* job, int w) {
+    NurState* st = job->workers[w];
+    NurState* prev_state = nur;
+    nur = st;
+    jmp_buf env;
+    if (setjmp(env) == 0) {
+        st->error_jmp = &env;
+        parallel_sync_state(st, job->parent);
+        parallel_run_blocks(job, w);
+    } else {
+        __atomic_store_n(&job->stop, 1, __ATOMIC_RELAXED);
+        int none = -1;
+        __atomic_compare_exchange_n(&job->failed_worker, &none, w, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+    }
+    st->error_jmp = NULL;
+    nur = prev_state;
+}
+
+// Kalıcı işçi havuzu. states[0] çağıran iş parçacığının payını çalıştırır; 1..num_threads yardımcı iş
+// parçacıklarıdır. Bir işte yalnızca ilk job->num_workers işçi çalışır; çağıran hepsi bitene kadar bekler.
+// Havuz sahibi durumun iş parçacığında kullanılır (iç içe bölgeler sırayla çalıştığından aynı anda tek iş).
+struct ParallelPool {
+    pthread_mutex_t lock;
+    pthread_cond_t wake, done;
+    ParallelJob* job;
+    unsigned round; // Her işte artar; yardımcılar yeni turu bekler
+    int pending; // İşini bitirmemiş yardımcı sayısı
+    bool shutdown;
+    int num_threads;
+    pthread_t threads[MAX_PARALLEL_WORKERS];
+    NurState* states[MAX_PARALLEL_WORKERS];
+    struct ParallelPoolArg { struct ParallelPool* pool; int index; } args[MAX_PARALLEL_WORKERS];
+};
+void* parallel_pool_thread(void* arg) {
+    struct ParallelPoolArg* a = arg;
+    ParallelPool* p = a->pool;
+    unsigned seen = 0;
+    pthread_mutex_lock(&p->lock);
+    for (;;) {
+        while (!p->shutdown && p->round == seen) pthread_cond_wait(&p->wake, &p->lock);
+        if (p->shutdown) break;
+        seen = p->round;
+        ParallelJob* job = p->job;
+        if (a->index >= job->num_workers) continue;
+        pthread_mutex_unlock(&p->lock);
+        parallel_worker_main(job, a->index);
+        pthread_mutex_lock(&p->lock);
+        if (--p->pending == 0) pthread_cond_signal(&p->done);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+NurState* parallel_pool_state() {
+    NurState* st = nur_create();
+    if (!st) return NULL;
+    st->in_fd = -1; // user.in* paralel gövdede girdi görmez
+    st->parallel_worker = true;
+    st->compiled = st->ran = true;
+    return st;
+}
+// Başlatılamayan iş parçacıkları havuzu küçültür; hiç yardımcı yoksa NULL (bloklar sırayla çalışır).
+ParallelPool* parallel_pool_get(NurState* owner) {
+    if (owner->parallel_pool) return owner->parallel_pool;
+    int want = parallel_thread_count() - 1;
+    if (want < 1) return NULL;
+    ParallelPool* p = calloc(1, sizeof *p);
+    if (!p || !(p->states[0] = parallel_pool_state())) { free(p); error("Paralel işçi durumu için bellek ayrılamadı."); }
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->wake, NULL); pthread_cond_init(&p->done, NULL);
+    for (int i = 1; i <= want; ++i) {
+        p->states[i] = parallel_pool_state();
+        p->args[i] = (struct ParallelPoolArg){ p, i };
+        if (!p->states[i] || pthread_create(&p->threads[i], NULL, parallel_pool_thread, &p->args[i]) != 0) { free(p->states[i]); p->states[i] = NULL; break; }
+        p->num_threads = i;
+    }
+    if (p->num_threads == 0) { free(p->states[0]); pthread_mutex_destroy(&p->lock); pthread_cond_destroy(&p->wake); pthread_cond_destroy(&p->done); free(p); return NULL; }
+    owner->parallel_pool = p;
+    return p;
+}
+void parallel_pool_free(NurState* owner) {
+    ParallelPool* p = owner->parallel_pool;
+    if (!p) return;
+    owner->parallel_pool = NULL;
+    pthread_mutex_lock(&p->lock);
+    p->shutdown = true;
+    pthread_cond_broadcast(&p->wake);
+    pthread_mutex_unlock(&p->lock);
+    for (int i = 1; i <= p->num_threads; ++i) pthread_join(p->threads[i], NULL);
+    for (int i = 0; i <= p->num_threads; ++i) parallel_release_state(p->states[i]);
+    pthread_mutex_destroy(&p->lock); pthread_cond_destroy(&p->wake); pthread_cond_destroy(&p->done);
+    free(p);
+}
+
+// Bloklar üst durumda çalışır; işçi kopyalarındaki gibi skaler değişkenlere yazılanlar sonra geri alınır,
+// böylece sonuç işçi sayısından bağımsızdır. Dizi ve struct değişkenlerinin belleği zaten paylaşılır.
+void parallel_run_sequential(ParallelJob* job) {
+    job->num_saved = nur->num_variables;
+    job->saved_scalars = malloc(((size_t)job->num_saved + 1) * sizeof(Variable));
+    if (!job->saved_scalars) error("Paralel bölge için bellek ayrılamadı.");
+    memcpy(job->saved_scalars, nur->symbol_table, (size_t)job->num_saved * sizeof(Variable));
+    for (int b = 0; b < job->num_blocks; ++b) {
+        long long lo = (long long)b * job->grain;
+        job->run_block(job, b, lo, lo + job->grain < job->count ? lo + job->grain : job->count);
+    }
+    for (int i = 0; i < job->num_saved; ++i) {
+        Variable* v = &nur->symbol_table[i];
+        if (v->type != VAR_ARRAY && v->type != VAR_STRUCT) *v = job->saved_scalars[i];
+    }
+    free(job->saved_scalars); job->saved_scalars = NULL;
+}
+// body'yi üst durumda çalıştırır; hata olursa önce parallel_finish ile iş bırakılır, sonra hata yeniden yükseltilir.
+void parallel_guarded(ParallelJob* job, void (*body)(ParallelJob*)) {
+    NurState* st = job->parent;
+    jmp_buf env;
+    jmp_buf* prev_jmp = st->error_jmp;
+    if (setjmp(env) == 0) {
+        st->error_jmp = &env;
+        body(job);
+        st->error_jmp = prev_jmp;
+        return;
+    }
+    st->error_jmp = prev_jmp;
+    parallel_finish(job);
+    raise_error();
+}
+
+// job->count, grain ve run_block doldurulmuş olmalı. İşçi sayısını belirler, havuzun durumlarını hazırlar ve bloklar
+// bitene kadar çalıştırır. Tek işçide (ya da iç içe paralel bölgede) bloklar üst durumda sırayla çalışır.
+// Dönüşte job->workers birleştirme için hâlâ geçerlidir; ardından parallel_finish çağrılmalıdır.
+void parallel_start(ParallelJob* job) {
+    job->parent = nur;
+    job->num_blocks = (int)((job->count + job->grain - 1) / job->grain);
+    ParallelPool* pool = nur->parallel_worker ? NULL : parallel_pool_get(nur);
+    job->num_workers = pool ? pool->num_threads + 1 : 1;
+    if (job->num_workers > job->num_blocks) job->num_workers = job->num_blocks;
+    job->stop = 0; job->failed_worker = -1;
+    if (job->num_workers <= 1) {
+        job->num_workers = 1; job->workers[0] = nur;
+        parallel_guarded(job, parallel_run_sequential);
+        return;
+    }
+    flush_output(); // Döngüden önceki çıktı önce görünsün
+    spawn_group_get(nur); // İşçiler eşitlenirken aynı anda oluşturmasın
+    for (int w = 0; w < job->num_workers; ++w) {
+        job->workers[w] = pool->states[w];
+        pthread_mutex_init(&job->ranges[w].lock, NULL);
+        job->ranges[w].lo = (int)((long long)job->num_blocks * w / job->num_workers);
+        job->ranges[w].hi = (int)((long long)job->num_blocks * (w + 1) / job->num_workers);
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->job = job; pool->pending = job->num_workers - 1; pool->round++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    parallel_worker_main(job, 0); // İlk işçi çağıran iş parçacığında
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) pthread_cond_wait(&pool->done, &pool->lock);
+    pool->job = NULL;
+    pthread_mutex_unlock(&pool->lock);
+    for (int w = 0; w < job->num_workers; ++w) pthread_mutex_destroy(&job->ranges[w].lock);
+    if (job->failed_worker >= 0) {
+        strcpy(job->parent->error_message, job->workers[job->failed_worker]->error_message);
+        parallel_finish(job);
+        raise_error();
+    }
+}
+void parallel_finish(ParallelJob* job) {
+    if (job->num_workers > 1)
+        for (int w = 0; w < job->num_workers; ++w) { parallel_reset_worker(job->workers[w]); job->workers[w] = NULL; }
+    job->num_workers = 0;
+    free(job->scratch); job->scratch = NULL;
+    free(job->saved_scalars); job->saved_scalars = NULL;
+    nur = job->parent;
+}
+
+// par_map(dizi, "fn", çıktı), par_filter(dizi, "fn", çıktı), par_reduce(dizi, "fn", başlangıç):
+// fn her eleman için işçilerde çağrılır. Bloklar en az PARALLEL_MIN_BLOCK_BYTES kapsar; böylece işçiler aynı
+// önbellek satırlarına yazmaz. Sonuç sırası ve par_reduce'un birleştirme sırası işçi sayısından bağımsızdır.
+typedef struct {
+    const char* fname;
+    int fn_idx; // function_table indisi; her işçinin kendi kopyasında aynıdır
+    const char* src; VarType src_type; size_t src_size;
+    char* dst; VarType dst_type; size_t dst_size;
+    long long dst_len;
+    Value* partials;     // par_reduce: blok başına sonuç
+    unsigned char* keep; // par_filter: eleman başına sonuç
+    Value result;        // par_reduce sonucu (başlangıç değeriyle başlar) / par_filter'da tutulan sayısı
+} ParallelArrayCtx;
+
+void par_map_block(ParallelJob* job, int block, long long lo, long long hi) {
+    (void)block;
+    ParallelArrayCtx* c = job->ctx;
+    const FunctionDefinition* fd = &nur->function_table[c->fn_idx];
+    for (long long i = lo; i < hi && !parallel_stopped(job); ++i) {
+        Value v = load_typed_slot(c->src_type, c->src + i * c->src_size);
+        Value r = execute_function_call(fd, &v, 1);
+        if (!coerce_value_to_var_type(c->dst_type, &r)) {
+            char e[200 + MAX_IDENT_LEN]; sprintf(e, "par_map: '%s' fonksiyonunun sonucu (%s) çıktı dizisinin tipine (%s) uymuyor.", fd->name, value_type_to_string(r.type), var_type_to_string_user(c->dst_type)); error(e);
+        }
+        store_typed_slot(c->dst_type, c->dst + i * c->dst_size, r);
+    }
+}
+void par_filter_block(ParallelJob* job, int block, long long lo, long long hi) {
+    (void)block;
+    ParallelArrayCtx* c = job->ctx;
+    const FunctionDefinition* fd = &nur->function_table[c->fn_idx];
+    for (long long i = lo; i < hi && !parallel_stopped(job); ++i) {
+        Value v = load_typed_slot(c->src_type, c->src + i * c->src_size);
+        Value r = execute_function_call(fd, &v, 1);
+        if (r.type != VAL_BOOLEAN) { char e[150 + MAX_IDENT_LEN]; sprintf(e, "par_filter: '%s' fonksiyonu boolean döndürmelidir.", fd->name); error(e); }
+        c->keep[i] = r.as.bool_val;
+    }
+}
+void par_reduce_block(ParallelJob* job, int block, long long lo, long long hi) {
+    ParallelArrayCtx* c = job->ctx;
+    const FunctionDefinition* fd = &nur->function_table[c->fn_idx];
+    Value args[2];
+    args[0] = load_typed_slot(c->src_type, c->src + lo * c->src_size);
+    for (long long i = lo + 1; i < hi && !parallel_stopped(job); ++i) {
+        args[1] = load_typed_slot(c->src_type, c->src + i * c->src_size);
+        args[0] = execute_function_call(fd, args, 2);
+    }
+    c->partials[block] = args[0];
+}
+
+// Dizi argümanını ve fonksiyon adını doğrular, işi blok boyutuyla hazırlar.
+void par_prepare(ParallelJob* job, ParallelArrayCtx* c, const char* fname, const Value* args, int fn_arity, ParallelBlockFn run_block) {
+    memset(job, 0, sizeof *job); memset(c, 0, sizeof *c);
+    c->fname = fname;
+    Variable* src = expect_array_arg(fname, args[0], 1);
+    const FunctionDefinition* fd = find_function(args[1].as.string_val);
+    if (!fd) { char e[100 + MAX_STRING_LEN]; sprintf(e, "%s: '%s' adlı fonksiyon bulunamadı.", fname, args[1].as.string_val); error(e); }
+    if (fd->num_params != fn_arity) { char e[150 + MAX_IDENT_LEN]; sprintf(e, "%s: '%s' fonksiyonu %d parametre almalıdır.", fname, fd->name, fn_arity); error(e); }
+    c->fn_idx = (int)(fd - nur->function_table);
+    c->src = src->value.array.data; c->src_type = src->value.array.element_type; c->src_size = get_array_element_size(src);
+    job->count = src->value.array.size;
+    job->grain = (job->count + PARALLEL_BLOCKS - 1) / PARALLEL_BLOCKS;
+    long long min_grain = PARALLEL_MIN_BLOCK_BYTES / (long long)c->src_size;
+    if (job->grain < min_grain) job->grain = min_grain;
+    if (job->grain < 1) job->grain = 1;
+    job->run_block = run_block;
+    job->ctx = c;
+}
+void par_set_output(ParallelArrayCtx* c, Value v) {
+    Variable* out = expect_array_arg(c->fname, v, 3);
+    expect_writable_array(c->fname, out);
+    c->dst = out->value.array.data; c->dst_type = out->value.array.element_type; c->dst_size = get_array_element_size(out);
+    c->dst_len = out->value.array.size;
+}
+
+// Tutulan elemanları sırasıyla çıktıya yazar. Çıktı girdiyle aynı dizi olabilir (yazma konumu okumanın gerisindedir).
+void par_filter_compact(ParallelJob* job) {
+    ParallelArrayCtx* c = job->ctx;
+    long long kept = 0;
+    for (long long i = 0; i < job->count; ++i) {
+        if (!c->keep[i]) continue;
+        if (kept >= c->dst_len) error("par_filter: çıktı dizisi tutulan elemanlar için yetersiz.");
+        Value v = load_typed_slot(c->src_type, c->src + i * c->src_size);
+        if (!coerce_value_to_var_type(c->dst_type, &v)) error("par_filter: girdi elemanları çıktı dizisinin tipine uymuyor.");
+        store_typed_slot(c->dst_type, c->dst + kept * c->dst_size, v);
+        kept++;
+    }
+    c->result = create_value_int((int)kept);
+}
+void par_reduce_combine(ParallelJob* job) {
+    ParallelArrayCtx* c = job->ctx;
+    const FunctionDefinition* fd = &nur->function_table[c->fn_idx];
+    Value call_args[2];
+    call_args[0] = c->result;
+    for (int b = 0; b < job->num_blocks; ++b) { call_args[1] = c->partials[b]; call_args[0] = execute_function_call(fd, call_args, 2); }
+    c->result = call_args[0];
+}
+
+Value native_par_map(Value* args, int num_args) {
+    (void)num_args;
+    ParallelJob job; ParallelArrayCtx c;
+    par_prepare(&job, &c, "par_map", args, 1, par_map_block);
+    par_set_output(&c, args[2]);
+    if (c.dst_len < job.count) error("par_map: çıktı dizisi girdi dizisinden kısa olamaz.");
+    if (job.count == 0) return create_value_null();
+    parallel_start(&job);
+    parallel_finish(&job);
+    return create_value_null();
+}
+// Tutulan eleman sayısını döndürür
+Value native_par_filter(Value* args, int num_args) {
+    (void)num_args;
+    ParallelJob job; ParallelArrayCtx c;
+    par_prepare(&job, &c, "par_filter", args, 1, par_filter_block);
+    par_set_output(&c, args[2]);
+    if (job.count == 0) return create_value_int(0);
+    job.scratch = c.keep = malloc((size_t)job.count);
+    if (!c.keep) error("par_filter için bellek ayrılamadı.");
+    parallel_start(&job);
+    parallel_guarded(&job, par_filter_compact);
+    parallel_finish(&job);
+    return c.result;
+}
+// fn(birikim, eleman) birleşme özelliğine sahip olmalıdır (ör. toplama, max): her blok kendi elemanlarını
+// katlar, blok sonuçları başlangıç değerinden itibaren blok sırasıyla fn ile birleştirilir.
+Value native_par_reduce(Value* args, int num_args) {
+    (void)num_args;
+    ParallelJob job; ParallelArrayCtx c;
+    par_prepare(&job, &c, "par_reduce", args, 2, par_reduce_block);
+    if (job.count == 0) return args[2];
+    c.result = args[2];
+    int num_blocks = (int)((job.count + job.grain - 1) / job.grain);
+    job.scratch = c.partials = malloc((size_t)num_blocks * sizeof(Value));
+    if (!c.partials) error("par_reduce için bellek ayrılamadı.");
+    parallel_start(&job);
+    parallel_guarded(&job, par_reduce_combine);
+    parallel_finish(&job);
+    return c.result;
+}
+
+
+// --- İş Parçacıkları ve Kanallar ---
+// spawn f(a, b) kullanıcı fonksiyonunu yeni bir iş parçacığında, çağıran durumun bir kopyasında başlatır
+// (bkz. parallel_clone_state) ve bir kimlik döndürür; join(kimlik) bitmesini bekler ve dönüş değerini verir.
+// chan<T> sınırlı bir çok üretici / çok tüketicili halkadır: her hücre bir sıra numarası taşır, üreticiler ve
+// tüketiciler konumları CAS ile ayırır (kilit yok). Dolu ya da boş kanalda bekleyen iş parçacığı futex üzerinde
+// uyur; karşı taraf yalnızca bekleyen varsa uyandırır. İş parçacıkları ve kanallar kök durumun SpawnGroup'undadır;
+// program sonunda beklenmemiş iş parçacıkları beklenir ve ilk hatası programın hatası olur.
+typedef struct {
+    VarType elem_type;        // VAR_NULL_TYPE: henüz bağlanmadı (ilk chan<T> bildirimi ya da ilk send bağlar)
+    size_t elem_size;
+    unsigned long capacity, mask; // capacity ikinin kuvveti
+    unsigned long* seq;       // Hücre sıra numaraları
+    char* data;
+    _Alignas(64) unsigned long head; // Sonraki okunacak konum (üretici ve tüketici sayaçları ayrı önbellek satırlarında)
+    _Alignas(64) unsigned long tail; // Sonraki yazılacak konum
+    _Alignas(64) int not_empty, not_full; // futex sözcükleri: her uyandırmada artan olay sayaçları
+    int recv_waiters, send_waiters;
+    int closed;
+} Channel;
+
+typedef struct {
+    NurState* state; // İş parçacığı bitince bırakılır
+    pthread_t thread;
+    int fn_idx, num_args;
+    Value args[MAX_PARAMETERS];
+    Value result;
+    char error_message[sizeof ((NurState*)0)->error_message];
+    bool failed, claimed; // claimed: join (ya da program sonu bekleyişi) bu iş parçacığını üstlendi
+} SpawnedThread;
+
+struct SpawnGroup {
+    pthread_mutex_t lock;
+    Channel* channels[MAX_CHANNELS]; int num_channels;
+    SpawnedThread* threads[MAX_SPAWNED_THREADS]; int num_threads;
+};
+
+SpawnGroup* spawn_group_get(NurState* st) {
+    if (!st->spawn_group) {
+        SpawnGroup* g = calloc(1, sizeof(SpawnGroup));
+        if (!g) error("İş parçacığı grubu için bellek ayrılamadı.");
+        pthread_mutex_init(&g->lock, NULL);
+        st->spawn_group = g; st->owns_spawn_group = true;
+    }
+    return st->spawn_group;
+}
+
+static void futex_wait_word(int* word, int seen) {
+#ifdef __linux__
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, seen, NULL, NULL, 0);
+#else
+    (void)word; (void)seen; sched_yield();
+#endif
+}
+static void futex_wake_word(int* word, int count) {
+#ifdef __linux__
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+#else
+    (void)word; (void)count;
+#endif
+}
+// Durum değişikliğinden sonra çağrılır. Bekleyen, sayacı okuduktan sonra durumu yeniden denetler; bu yüzden
+// çit + bekleyen sayısı okuması uyandırmanın kaçırılmasını önler.
+static void channel_notify(int* word, int* waiters) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(waiters, __ATOMIC_RELAXED) > 0) { __atomic_add_fetch(word, 1, __ATOMIC_SEQ_CST); futex_wake_word(word, 1); }
+}
+
+bool channel_element_type_ok(VarType t) {
+    return t == VAR_INT || t == VAR_I64 || t == VAR_U8 || t == VAR_FLOAT || t == VAR_F32 || t == VAR_STRING || t == VAR_BOOLEAN;
+}
+
+// Eleman tipi ilk kullanımda bir kez belirlenir ve hücre belleği o zaman ayrılır.
+void channel_bind(Channel* ch, VarType t) {
+    VarType cur = __atomic_load_n(&ch->elem_type, __ATOMIC_ACQUIRE);
+    if (cur == VAR_NULL_TYPE) {
+        SpawnGroup* g = nur->spawn_group;
+        pthread_mutex_lock(&g->lock);
+        if (ch->elem_type == VAR_NULL_TYPE) {
+            size_t size = get_sizeof_element_type(t);
+            ch->data = calloc(ch->capacity, size);
+            if (ch->data) { ch->elem_size = size; __atomic_store_n(&ch->elem_type, t, __ATOMIC_RELEASE); }
+        }
+        cur = ch->elem_type;
+        pthread_mutex_unlock(&g->lock);
+        if (cur == VAR_NULL_TYPE) error("Kanal için bellek ayrılamadı.");
+    }
+    if (cur != t) {
+        char e[150]; sprintf(e, "Kanal tipi uyuşmazlığı: chan<%s> kanalı chan<%s> olarak kullanılamaz.", var_type_to_string_user(cur), var_type_to_string_user(t)); error(e);
+    }
+}
+
+Value channel_create(long long capacity, VarType elem_type) {
+    if (capacity < 1 || capacity > MAX_CHANNEL_CAPACITY) { char e[100]; sprintf(e, "Kanal kapasitesi 1-%d aralığında olmalıdır.", MAX_CHANNEL_CAPACITY); error(e); }
+    SpawnGroup* g = spawn_group_get(nur);
+    unsigned long cap = 2; // Sıra numarası düzeni en az iki hücre gerektirir
+    while (cap < (unsigned long)capacity) cap <<= 1;
+    Channel* ch = aligned_alloc(64, sizeof(Channel)); // Sayaçların önbellek satırı hizası korunsun
+    unsigned long* seq = malloc(cap * sizeof(unsigned long));
+    if (!ch || !seq) { free(ch); free(seq); error("Kanal için bellek ayrılamadı."); }
+    memset(ch, 0, sizeof(Channel));
+    for (unsigned long i = 0; i < cap; ++i) seq[i] = i;
+    ch->seq = seq; ch->capacity = cap; ch->mask = cap - 1; ch->elem_type = VAR_NULL_TYPE;
+    pthread_mutex_lock(&g->lock);
+    int id = g->num_channels;
+    if (id < MAX_CHANNELS) { g->channels[id] = ch; __atomic_store_n(&g->num_channels, id + 1, __ATOMIC_RELEASE); }
+    pthread_mutex_unlock(&g->lock);
+    if (id >= MAX_CHANNELS) { free(seq); free(ch); error("Maksimum kanal sayısına ulaşıldı."); }
+    Value v = {VAL_CHANNEL, false, {0}}; v.as.channel = id + 1;
+    if (elem_type != VAR_NULL_TYPE) channel_bind(ch, elem_type);
+    return v;
+}
+
+Channel* resolve_channel(const char* fname, Value c) {
+    char err[150];
+    if (c.type != VAL_CHANNEL) { sprintf(err, "'%s' kanal bekler (%s verildi).", fname, value_type_to_string(c.type)); error(err); }
+    SpawnGroup* g = nur->spawn_group;
+    int n = g ? __atomic_load_n(&g->num_channels, __ATOMIC_ACQUIRE) : 0;
+    if (c.as.channel < 1 || c.as.channel > n) { sprintf(err, "'%s': kanal tanımsız veya geçersiz.", fname); error(err); }
+    return g->channels[c.as.channel - 1];
+}
+
+bool channel_try_push(Channel* ch, const Value* v) {
+    unsigned long pos = __atomic_load_n(&ch->tail, __ATOMIC_RELAXED);
+    for (;;) {
+        unsigned long* cell = &ch->seq[pos & ch->mask];
+        long dif = (long)(__atomic_load_n(cell, __ATOMIC_ACQUIRE) - pos);
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&ch->tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                store_typed_slot(ch->elem_type, ch->data + (pos & ch->mask) * ch->elem_size, *v);
+                __atomic_store_n(cell, pos + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+        } else if (dif < 0) return false; // Dolu
+        else pos = __atomic_load_n(&ch->tail, __ATOMIC_RELAXED);
+    }
+}
+bool channel_try_pop(Channel* ch, Value* out) {
+    unsigned long pos = __atomic_load_n(&ch->head, __ATOMIC_RELAXED);
+    for (;;) {
+        unsigned long* cell = &ch->seq[pos & ch->mask];
+        long dif = (long)(__atomic_load_n(cell, __ATOMIC_ACQUIRE) - (pos + 1));
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&ch->head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *out = load_typed_slot(ch->elem_type, ch->data + (pos & ch->mask) * ch->elem_size);
+                __atomic_store_n(cell, pos + ch->capacity, __ATOMIC_RELEASE);
+                return true;
+            }
+        } else if (dif < 0) return false; // Boş
+        else pos = __atomic_load_n(&ch->head, __ATOMIC_RELAXED);
+    }
+}
+
+void channel_send(Channel* ch, Value v) {
+    VarType et = __atomic_load_n(&ch->elem_type, __ATOMIC_ACQUIRE);
+    if (et == VAR_NULL_TYPE) {
+        et = v.type == VAL_INT ? VAR_INT : v.type == VAL_I64 ? VAR_I64 : v.type == VAL_FLOAT ? VAR_FLOAT : v.type == VAL_STRING ? VAR_STRING : v.type == VAL_BOOLEAN ? VAR_BOOLEAN : VAR_NULL_TYPE;
+        if (et == VAR_NULL_TYPE) { char e[120]; sprintf(e, "'send': %s değeri kanala gönderilemez.", value_type_to_string(v.type)); error(e); }
+        channel_bind(ch, et);
+        et = ch->elem_type;
+    }
+    if (!coerce_value_to_var_type(et, &v)) {
+        char e[150]; sprintf(e, "'send': değer (%s) kanal tipine (chan<%s>) uymuyor.", value_type_to_string(v.type), var_type_to_string_user(et)); error(e);
+    }
+    for (;;) {
+        if (__atomic_load_n(&ch->closed, __ATOMIC_ACQUIRE)) error("'send': kanal kapalı.");
+        if (channel_try_push(ch, &v)) break;
+        __atomic_add_fetch(&ch->send_waiters, 1, __ATOMIC_SEQ_CST);
+        int seen = __atomic_load_n(&ch->not_full, __ATOMIC_SEQ_CST);
+        bool pushed = channel_try_push(ch, &v);
+        if (!pushed && !__atomic_load_n(&ch->closed, __ATOMIC_ACQUIRE)) futex_wait_word(&ch->not_full, seen);
+        __atomic_sub_fetch(&ch->send_waiters, 1, __ATOMIC_SEQ_CST);
+        if (pushed) break;
+    }
+    channel_notify(&ch->not_empty, &ch->recv_waiters);
+}
+// false: kanal kapalı ve boş (block) ya da şu an boş (!block). Kapanmadan önce gönderilenler yine alınır.
+bool channel_recv(Channel* ch, Value* out, bool block) {
+    for (;;) {
+        if (channel_try_pop(ch, out)) break;
+        if (!block) return false;
+        if (__atomic_load_n(&ch->closed, __ATOMIC_ACQUIRE)) {
+            if (channel_try_pop(ch, out)) break;
+            return false;
+        }
+        __atomic_add_fetch(&ch->recv_waiters, 1, __ATOMIC_SEQ_CST);
+        int seen = __atomic_load_n(&ch->not_empty, __ATOMIC_SEQ_CST);
+        bool popped = channel_try_pop(ch, out);
+        if (!popped && !__atomic_load_n(&ch->closed, __ATOMIC_ACQUIRE)) futex_wait_word(&ch->not_empty, seen);
+        __atomic_sub_fetch(&ch->recv_waiters, 1, __ATOMIC_SEQ_CST);
+        if (popped) break;
+    }
+    channel_notify(&ch->not_full, &ch->send_waiters);
+    return true;
+}
+void channel_shut(Channel* ch) {
+    __atomic_store_n(&ch->closed, 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&ch->not_empty, 1, __ATOMIC_SEQ_CST); futex_wake_word(&ch->not_empty, INT_MAX);
+    __atomic_add_fetch(&ch->not_full, 1, __ATOMIC_SEQ_CST); futex_wake_word(&ch->not_full, INT_MAX);
+}
+Value channel_close_value(Value c) {
+    Channel* ch = resolve_channel("close", c);
+    if (__atomic_load_n(&ch->closed, __ATOMIC_ACQUIRE)) error("'close': kanal zaten kapalı.");
+    channel_shut(ch);
+    return create_value_null();
+}
+// Alınan değeri kutu dizisinin ilk elemanına yazar
+void box_store(const char* fname, Value box_val, Value v) {
+    Variable* box = expect_array_arg(fname, box_val, 2);
+    expect_writable_array(fname, box);
+    VarType et = box->value.array.element_type;
+    if (!coerce_value_to_var_type(et, &v)) {
+        char e[150]; sprintf(e, "'%s': alınan değer (%s) dizinin eleman tipine (%s) uymuyor.", fname, value_type_to_string(v.type), var_type_to_string_user(et)); error(e);
+    }
+    store_typed_slot(et, box->value.array.data, v);
+}
+
+Value native_channel(Value* args, int num_args) { (void)num_args; return channel_create(value_as_i64(args[0]), VAR_NULL_TYPE); }
+Value native_send(Value* args, int num_args) {
+    (void)num_args;
+    Channel* ch = resolve_channel("send", args[0]);
+    flush_output(); // Bloklanmadan önce kendi çıktısı görünsün
+    channel_send(ch, args[1]);
+    return create_value_null();
+}
+// recv(c): değeri döndürür (kanal kapalı ve boşsa hata). recv(c, kutu): kutu[0]'a yazar, kapalı ve boşsa false döner.
+Value native_recv(Value* args, int num_args) {
+    if (num_args != 1 && num_args != 2) error("'recv' 1 veya 2 argüman bekler: recv(kanal) ya da recv(kanal, kutu).");
+    Channel* ch = resolve_channel("recv", args[0]);
+    Value v;
+    flush_output();
+    bool got = channel_recv(ch, &v, true);
+    if (num_args == 1) {
+        if (!got) error("'recv': kanal kapalı ve boş.");
+        return v;
+    }
+    if (got) box_store("recv", args[1], v);
+    return create_value_bool(got);
+}
+Value native_try_recv(Value* args, int num_args) {
+    (void)num_args;
+    Value v;
+    bool got = channel_recv(resolve_channel("try_recv", args[0]), &v, false);
+    if (got) box_store("try_recv", args[1], v);
+    return create_value_bool(got);
+}
+
+void* spawn_thread_main(void* arg) {
+    SpawnedThread* t = arg;
+    NurState* st = t->state;
+    nur = st;
+    jmp_buf env;
+    if (setjmp(env) == 0) {
+        st->error_jmp = &env;
+        t->result = execute_function_call(&st->function_table[t->fn_idx], t->args, t->num_args);
+    } else {
+        strcpy(t->error_message, st->error_message);
+        t->failed = true;
+    }
+    st->error_jmp = NULL;
+    parallel_release_state(st); // Çıktıyı boşaltır, kendi açtığı dosyaları kapatır
+    t->state = NULL;
+    nur = NULL;
+    return NULL;
+}
+
+Value spawn_function(const char* name, Value* args, int num_args) {
+    const FunctionDefinition* fd = find_function(name);
+    if (!fd) { char e[100 + MAX_IDENT_LEN]; sprintf(e, "spawn: '%s' adlı kullanıcı fonksiyonu bulunamadı.", name); error(e); }
+    if (fd->num_params != num_args) { char e[150 + MAX_IDENT_LEN]; sprintf(e, "spawn: '%s' fonksiyonu %d parametre bekliyor ama %d argüman verildi.", fd->name, fd->num_params, num_args); error(e); }
+    if (fd->return_type == VAR_GENERATOR) { char e[100 + MAX_IDENT_LEN]; sprintf(e, "spawn: '%s' bir üreteç fonksiyonu; ayrı iş parçacığında başlatılamaz.", fd->name); error(e); }
+    SpawnGroup* g = spawn_group_get(nur);
+    SpawnedThread* t = calloc(1, sizeof(SpawnedThread));
+    if (!t) error("spawn için bellek ayrılamadı.");
+    flush_output(); // Çağıranın önceki çıktısı iş parçacığınınkinden önce görünsün
+    t->state = parallel_clone_state(nur);
+    clone_share_storage(t->state); // Çağıran çerçeve iş parçacığından önce bitebilir
+    t->state->parallel_worker = false; // İş parçacığı kendi parallel for'larını paralel çalıştırabilir
+    t->fn_idx = (int)(fd - nur->function_table);
+    t->num_args = num_args;
+    memcpy(t->args, args, (size_t)num_args * sizeof(Value));
+    pthread_mutex_lock(&g->lock);
+    int id = g->num_threads;
+    bool started = id < MAX_SPAWNED_THREADS && pthread_create(&t->thread, NULL, spawn_thread_main, t) == 0;
+    if (started) g->threads[g->num_threads++] = t;
+    pthread_mutex_unlock(&g->lock);
+    if (!started) {
+        parallel_release_state(t->state); free(t);
+        error(id < MAX_SPAWNED_THREADS ? "spawn: iş parçacığı başlatılamadı." : "spawn: maksimum iş parçacığı sayısına ulaşıldı.");
+    }
+    return create_value_int(id + 1);
+}
+// spawn ad(argümanlar)
+Value parse_spawn_expression(bool execute) {
+    consume_token(TOKEN_IDENTIFIER); // spawn
+    Token fn = consume_token(TOKEN_IDENTIFIER);
+    consume_token(TOKEN_LPAREN);
+    Value args[MAX_PARAMETERS];
+    int num_args = 0;
+    if (peek_token().type != TOKEN_RPAREN) {
+        do {
+            if (num_args >= MAX_PARAMETERS) error("Fonksiyon çağrısında maksimum argüman sayısı aşıldı.");
+            args[num_args++] = evaluate_expression(execute);
+            if (peek_token().type == TOKEN_COMMA) consume_token(TOKEN_COMMA); else break;
+        } while (true);
+    }
+    consume_token(TOKEN_RPAREN);
+    return execute ? spawn_function(fn.lexeme, args, num_args) : create_value_null();
+}
+
+SpawnedThread* spawn_lookup(int id) {
+    SpawnGroup* g = nur->spawn_group;
+    SpawnedThread* t = NULL;
+    if (g) { pthread_mutex_lock(&g->lock); if (id >= 1 && id <= g->num_threads) t = g->threads[id - 1]; pthread_mutex_unlock(&g->lock); }
+    if (!t) error("join: geçersiz iş parçacığı kimliği.");
+    return t;
+}
+Value native_join(Value* args, int num_args) {
+    (void)num_args;
+    SpawnedThread* t = spawn_lookup((int)value_as_i64(args[0]));
+    if (__atomic_exchange_n(&t->claimed, true, __ATOMIC_ACQ_REL)) error("join: bu iş parçacığı zaten beklendi.");
+    flush_output();
+    pthread_join(t->thread, NULL);
+    if (t->failed) { strcpy(nur->error_message, t->error_message); raise_error(); }
+    return t->result;
 }
 
-// --- Sembol Tablosu Yönetimi --- 
-Variable* find_variable(const char* name) { 
-    for (int i = num_variables - 1; i >= 0; --i) {
-        if (strcmp(symbol_table[i].name, name) == 0) {
-            return &symbol_table[i];
+// Program sonu: beklenmemiş iş parçacıklarını bekler; biri hatayla bittiyse kanallar kapatılır ve ilk hata yükseltilir.
+void spawn_wait_all() {
+    SpawnGroup* g = nur->spawn_group;
+    if (!g || !nur->owns_spawn_group) return;
+    flush_output();
+    SpawnedThread* failed = NULL;
+    for (int i = 0; ; ++i) {
+        pthread_mutex_lock(&g->lock);
+        SpawnedThread* t = i < g->num_threads ? g->threads[i] : NULL;
+        pthread_mutex_unlock(&g->lock);
+        if (!t) break;
+        if (__atomic_exchange_n(&t->claimed, true, __ATOMIC_ACQ_REL)) continue;
+        pthread_join(t->thread, NULL);
+        if (t->failed && !failed) { // Kalanlar hata sonrası bir kanalda sonsuza dek beklemesin
+            failed = t;
+            for (int c = 0; c < __atomic_load_n(&g->num_channels, __ATOMIC_ACQUIRE); ++c) channel_shut(g->channels[c]);
         }
     }
-    return NULL;
+    if (failed) { strcpy(nur->error_message, failed->error_message); raise_error(); }
 }
-Variable* declare_variable(const char* name, VarType type, bool is_loop_var_decl, VarType array_element_type_param, int array_size_param) {
-    if (num_variables >= MAX_VARIABLES) error("Çok fazla değişken tanımlandı (sembol tablosu dolu)");
-    
-    int current_scope_start_idx = (scope_stack_ptr >= 0) ? scope_stack[scope_stack_ptr] : 0;
-    for (int i = num_variables - 1; i >= current_scope_start_idx; --i) {
-        if (strcmp(symbol_table[i].name, name) == 0) {
-            char err[MAX_IDENT_LEN + 100];
-            sprintf(err, "'%s' adlı değişken bu kapsamda zaten tanımlı.", name);
-            error(err);
-        }
+// Durum atılırken: kanallar kapatılır (bekleyenler uyanır), kalan iş parçacıkları beklenir, bellek bırakılır.
+// Sonsuz döngüdeki bir iş parçacığı burada beklemeye yol açar.
+void spawn_group_free(NurState* st) {
+    SpawnGroup* g = st->spawn_group;
+    st->spawn_group = NULL;
+    if (!g || !st->owns_spawn_group) return;
+    st->owns_spawn_group = false;
+    for (int i = 0; i < g->num_channels; ++i) channel_shut(g->channels[i]);
+    for (int i = 0; ; ++i) {
+        pthread_mutex_lock(&g->lock);
+        SpawnedThread* t = i < g->num_threads ? g->threads[i] : NULL;
+        pthread_mutex_unlock(&g->lock);
+        if (!t) break;
+        if (!__atomic_exchange_n(&t->claimed, true, __ATOMIC_ACQ_REL)) pthread_join(t->thread, NULL);
     }
-    
-    Variable* new_var = &symbol_table[num_variables];
-    strncpy(new_var->name, name, MAX_IDENT_LEN - 1); new_var->name[MAX_IDENT_LEN-1] = '\0';
-    new_var->type = type; new_var->is_defined = false; new_var->is_loop_var = is_loop_var_decl;
-    new_var->scope_level = get_current_scope_level();
-    
-    if (type == VAR_ARRAY) {
-        if (array_element_type_param==VAR_NULL_TYPE||array_size_param<=0)error("Geçersiz dizi eleman tipi/boyutu.");
-        new_var->value.array.element_type = array_element_type_param; new_var->value.array.size = array_size_param;
-        size_t element_size = get_sizeof_element_type(array_element_type_param);
-        if (element_size == 0) error("Dizi için eleman boyutu sıfır olamaz."); // Should be caught by get_sizeof_element_type
-        new_var->value.array.data = calloc(array_size_param, element_size);
-        if(!new_var->value.array.data)error("Dizi için bellek ayrılamadı."); new_var->is_defined=true; // Array itself is defined, elements are default-initialized
-        if(array_element_type_param==VAR_STRING){for(int k_arr=0;k_arr<array_size_param;k_arr++){((char*)new_var->value.array.data+k_arr*MAX_STRING_LEN)[0]='\0';}}
+    for (int i = 0; i < g->num_threads; ++i) free(g->threads[i]);
+    for (int i = 0; i < g->num_channels; ++i) { free(g->channels[i]->seq); free(g->channels[i]->data); free(g->channels[i]); }
+    pthread_mutex_destroy(&g->lock);
+    free(g);
+}
+
+// --- Üreteçler ---
+// ': gen<T>' dönüş tipli bir fonksiyonun çağrısı gövdeyi çalıştırmaz; bir üreteç döndürür. next(g) gövdeyi bir
+// sonraki 'yield'e kadar sürdürür. Gövde üreteci oluşturan durumda çalışır; üretecin yalnızca kendi yürütme
+// bağlamı (değişken dilimi, kapsam, çağrı ve ifade yığınları; bkz. ExecContext) ve kendi C yığını vardır, 'yield'
+// iç içe çağrılardan da yapılabilir. Geçiş, x86-64'te yalnızca çağrılan-korunan yazmaçları saklayan bir yığın
+// değişimidir (sistem çağrısı yok); diğer mimarilerde ve sanitizer derlemelerinde ucontext kullanılır. Yığınlar
+// MAP_NORESERVE ile ayrılır, küçük başlar ve sayfalar kullanıldıkça büyür; bitmiş üreteçlerinkiler yeniden kullanılır.
+#if defined(__x86_64__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+typedef struct { void* sp; } CoroContext;
+void nur_coro_switch(void** save_sp, void* new_sp);
+__asm__(
+    ".text\n.globl nur_coro_switch\n.hidden nur_coro_switch\n.type nur_coro_switch,@function\n"
+    "nur_coro_switch:\n"
+    "  pushq %rbp\n  pushq %rbx\n  pushq %r12\n  pushq %r13\n  pushq %r14\n  pushq %r15\n"
+    "  subq $8, %rsp\n  stmxcsr (%rsp)\n  fnstcw 4(%rsp)\n"
+    "  movq %rsp, (%rdi)\n  movq %rsi, %rsp\n"
+    "  ldmxcsr (%rsp)\n  fldcw 4(%rsp)\n  addq $8, %rsp\n"
+    "  popq %r15\n  popq %r14\n  popq %r13\n  popq %r12\n  popq %rbx\n  popq %rbp\n  ret\n"
+    ".size nur_coro_switch, .-nur_coro_switch\n");
+// İlk geçişte nur_coro_switch'in 'ret'i entry'ye döner; entry'ye girerken rsp ≡ 8 (mod 16) olmalıdır.
+static void coro_prepare(CoroContext* c, char* stack, size_t size, void (*entry)(void)) {
+    unsigned long* top = (unsigned long*)(((unsigned long)(stack + size)) & ~15UL);
+    *--top = 0; // Sahte dönüş adresi
+    *--top = (unsigned long)entry;
+    for (int i = 0; i < 6; ++i) *--top = 0; // rbp, rbx, r12-r15
+    *--top = 0x037F00001F80UL; // Varsayılan MXCSR ve x87 denetim sözcüğü
+    c->sp = top;
+}
+static inline void coro_switch(CoroContext* from, CoroContext* to) { nur_coro_switch(&from->sp, to->sp); }
+static inline void coro_started(CoroContext* caller) { (void)caller; }
+static inline void coro_exit(CoroContext* from, CoroContext* to) { coro_switch(from, to); }
+#define CORO_STACK_RELEASED(stack, size) ((void)0)
+#else
+// AddressSanitizer yığın değişimlerinden haberdar edilir; aksi halde longjmp sonrası yanlış hata bildirir.
+#ifdef __SANITIZE_ADDRESS__
+void __sanitizer_start_switch_fiber(void** fake_stack_save, const void* bottom, size_t size);
+void __sanitizer_finish_switch_fiber(void* fake_stack_save, const void** bottom_old, size_t* size_old);
+void __asan_unpoison_memory_region(const volatile void* addr, size_t size);
+#define CORO_START_SWITCH(save, c) __sanitizer_start_switch_fiber(save, (c)->stack, (c)->size)
+#define CORO_FINISH_SWITCH(save, c) __sanitizer_finish_switch_fiber(save, &(c)->stack, &(c)->size)
+#define CORO_STACK_RELEASED(stack, size) __asan_unpoison_memory_region((char*)(stack) + 4096, (size) - 4096) // Bitmemiş çerçevelerin gölge işaretleri kalmasın
+#else
+#define CORO_START_SWITCH(save, c) ((void)(save))
+#define CORO_FINISH_SWITCH(save, c) ((void)(save))
+#define CORO_STACK_RELEASED(stack, size) ((void)0)
+#endif
+typedef struct { ucontext_t uc; const void* stack; size_t size; } CoroContext;
+static void coro_prepare(CoroContext* c, char* stack, size_t size, void (*entry)(void)) {
+    getcontext(&c->uc);
+    c->uc.uc_stack.ss_sp = stack; c->uc.uc_stack.ss_size = size; c->uc.uc_link = NULL;
+    c->stack = stack; c->size = size;
+    makecontext(&c->uc, entry, 0);
+}
+// Geri dönüldüğünde 'to' bu bağlama geçen bağlamdır (üreteç için: onu sürdüren çağıran).
+static inline void coro_switch(CoroContext* from, CoroContext* to) {
+    void* fake_stack = NULL;
+    CORO_START_SWITCH(&fake_stack, to);
+    swapcontext(&from->uc, &to->uc);
+    CORO_FINISH_SWITCH(fake_stack, to);
+}
+static inline void coro_started(CoroContext* caller) { CORO_FINISH_SWITCH(NULL, caller); }
+static inline void coro_exit(CoroContext* from, CoroContext* to) { CORO_START_SWITCH(NULL, to); swapcontext(&from->uc, &to->uc); }
+#endif
+
+// Yürütme bağlamı: durumun bir gövdeyi çalıştırırken kullandığı tablolar ve sayaçlar. Üreteç sürdürülürken
+// durumdakiler üretecinkilerle takas edilir (exec_swap); token'lar, fonksiyon ve struct tabloları, derlenmiş
+// ifadeler, dosya tutamaçları, düzenli ifadeler ve çıktı tamponu çağıranla paylaşılır.
+typedef struct {
+    Variable* symbol_table; int num_variables;
+    int* scope_stack; int scope_stack_ptr;
+    CallFrame* call_stack; int call_stack_ptr;
+    char (*for_loop_vars_stack)[MAX_IDENT_LEN]; int for_loop_var_stack_ptr;
+    int loop_depth;
+    Value return_value_holder; bool return_flag;
+    Value* eval_stack; int eval_sp, expr_depth;
+    ExprBuilder* expr_builder;
+    int current_token_idx, current_line;
+    jmp_buf* error_jmp;
+    Generator* running_generator;
+    bool mapping_allowed;
+} ExecContext;
+#define EXEC_SWAP(field) do { __typeof__(st->field) t_ = st->field; st->field = c->field; c->field = t_; } while (0)
+static void exec_swap(NurState* st, ExecContext* c) {
+    EXEC_SWAP(symbol_table); EXEC_SWAP(num_variables); EXEC_SWAP(scope_stack); EXEC_SWAP(scope_stack_ptr);
+    EXEC_SWAP(call_stack); EXEC_SWAP(call_stack_ptr); EXEC_SWAP(for_loop_vars_stack); EXEC_SWAP(for_loop_var_stack_ptr);
+    EXEC_SWAP(loop_depth); EXEC_SWAP(return_value_holder); EXEC_SWAP(return_flag);
+    EXEC_SWAP(eval_stack); EXEC_SWAP(eval_sp); EXEC_SWAP(expr_depth); EXEC_SWAP(expr_builder);
+    EXEC_SWAP(current_token_idx); EXEC_SWAP(current_line); EXEC_SWAP(error_jmp); EXEC_SWAP(running_generator);
+    EXEC_SWAP(mapping_allowed);
+}
+#undef EXEC_SWAP
+
+enum { GEN_NEW, GEN_SUSPENDED, GEN_RUNNING, GEN_DONE };
+struct Generator {
+    NurState* state;    // Gövdenin çalıştığı durum (üreteci oluşturan)
+    GeneratorTable* table;
+    int slot, fn_idx, num_args;
+    Value args[MAX_PARAMETERS];
+    VarType elem_type;
+    ExecContext exec;   // Askıdayken üretecin bağlamı, çalışırken onu sürdürenin bağlamı
+    int num_shared_variables; // Değişken diliminin başındaki, oluşturulurken devralınan değişkenler
+    Variable* variables; // MAX_VARIABLES; ayrılır ama yalnızca kullanılan kısmı belleğe dokunur
+    Value* eval_stack;   // MAX_EXPR_STACK
+    CallFrame call_stack[MAX_CALL_STACK_DEPTH];
+    int scope_stack[MAX_SCOPE_DEPTH];
+    char for_loop_vars_stack[MAX_LOOP_NESTING][MAX_IDENT_LEN];
+    char* stack;
+    CoroContext ctx, caller;
+    Value value; bool has_value;
+    int status;
+    bool failed;
+    Generator* next_free;
+};
+
+static void generator_entry(void) {
+    Generator* g = nur->running_generator;
+    coro_started(&g->caller);
+    jmp_buf env;
+    if (setjmp(env) == 0) {
+        nur->error_jmp = &env;
+        invoke_function(&nur->function_table[g->fn_idx], g->args, g->num_args);
+    } else {
+        g->failed = true; // İleti durumun error_message'ında kalır
     }
-    
-    if (is_loop_var_decl) { 
-        if (for_loop_var_stack_ptr + 1 >= MAX_LOOP_NESTING)error("'for' değişkeni için max iç içe geçme aşıldı");
-        for_loop_var_stack_ptr++; strncpy(for_loop_vars_stack[for_loop_var_stack_ptr], name, MAX_IDENT_LEN -1);
-        for_loop_vars_stack[for_loop_var_stack_ptr][MAX_IDENT_LEN-1]='\0';
+    nur->error_jmp = NULL;
+    g->status = GEN_DONE; g->has_value = false;
+    coro_exit(&g->ctx, &g->caller); // Bir daha sürdürülmez
+}
+
+// Kimlikler (kuşak << 8) | yuva biçimindedir; yuva ancak üreteç bitince ya da kapatılınca yeniden kullanılır,
+// bu yüzden eski kuşaktan bir kimlik her zaman bitmiş bir üreteci gösterir. Bitmiş üreteçler (yığınları ve
+// tablolarıyla) GENERATOR_CACHE kadar saklanır; yenileri önce bunlardan alınır.
+struct GeneratorTable {
+    Generator* slots[MAX_GENERATORS];
+    unsigned generation[MAX_GENERATORS];
+    Generator* free_list; int num_free;
+};
+GeneratorTable* generator_table_get(NurState* st) {
+    if (!st->generator_table) {
+        st->generator_table = calloc(1, sizeof(GeneratorTable));
+        if (!st->generator_table) error("Üreteç tablosu için bellek ayrılamadı.");
     }
-    num_variables++;
-    return new_var;
+    return st->generator_table;
 }
-void remove_variable_by_name_from_symbol_table(const char* name_to_remove) { 
-    for (int i = num_variables - 1; i >= 0; i--) { 
-        if (strcmp(symbol_table[i].name, name_to_remove) == 0 && symbol_table[i].is_loop_var) {
-            if(symbol_table[i].type==VAR_ARRAY&&symbol_table[i].value.array.data)free(symbol_table[i].value.array.data);
-            // Shift remaining elements, not efficient but ok for small number of loop vars
-            for(int j=i;j<num_variables-1;j++)symbol_table[j]=symbol_table[j+1];
-            num_variables--; return; 
-        }
+static void generator_release_memory(Generator* g) {
+    if (g->stack) { CORO_STACK_RELEASED(g->stack, GENERATOR_STACK_SIZE); munmap(g->stack, GENERATOR_STACK_SIZE); }
+    free(g->variables); free(g->eval_stack);
+    free(g);
+}
+static Generator* generator_alloc(GeneratorTable* table) {
+    Generator* g = table->free_list;
+    if (g) { table->free_list = g->next_free; table->num_free--; return g; }
+    g = calloc(1, sizeof(Generator));
+    if (!g) return NULL;
+    g->variables = malloc(MAX_VARIABLES * sizeof(Variable));
+    g->eval_stack = malloc(MAX_EXPR_STACK * sizeof(Value));
+    g->stack = mmap(NULL, GENERATOR_STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (g->stack == MAP_FAILED) g->stack = NULL;
+    if (!g->variables || !g->eval_stack || !g->stack) { generator_release_memory(g); return NULL; }
+    mprotect(g->stack, 4096, PROT_NONE); // Taşma koruma sayfası
+    return g;
+}
+// Üretecin kapsamları ve devraldığı depolama bırakılır; yığını çalıştırılmadan atılır.
+void generator_free(Generator* g) {
+    NurState* st = g->state, *prev_state = nur; nur = st;
+    GeneratorTable* table = g->table;
+    table->slots[g->slot] = NULL;
+    exec_swap(st, &g->exec);
+    while (st->scope_stack_ptr >= 0) exit_scope();
+    for (int i = 0; i < g->num_shared_variables; ++i) release_variable_storage(&st->symbol_table[i]);
+    exec_swap(st, &g->exec);
+    nur = prev_state;
+    if (table->num_free < GENERATOR_CACHE) {
+        CORO_STACK_RELEASED(g->stack, GENERATOR_STACK_SIZE);
+        g->next_free = table->free_list; table->free_list = g; table->num_free++;
+    } else {
+        generator_release_memory(g);
     }
 }
+// Durum bırakılırken askıdaki üreteçler de bırakılır.
+void generator_table_free(NurState* st) {
+    GeneratorTable* t = st->generator_table;
+    if (!t) return;
+    for (int i = 0; i < MAX_GENERATORS; ++i) if (t->slots[i]) generator_free(t->slots[i]);
+    for (Generator* g = t->free_list, *next; g; g = next) { next = g->next_free; generator_release_memory(g); }
+    st->generator_table = NULL;
+    free(t);
+}
 
-// --- Fonksiyon Tablosu Yönetimi ---
-FunctionDefinition* find_function(const char* name) {
-    for (int i = 0; i < num_functions; ++i) {
-        if (strcmp(function_table[i].name, name) == 0) {
-            return &function_table[i];
+Value generator_create(const FunctionDefinition* fd, Value* args, int num_args) {
+    if (fd->num_params != num_args) { char e[200]; sprintf(e, "'%s' fonksiyonu %d parametre bekliyor ama %d argüman verildi.", fd->name, fd->num_params, num_args); error(e); }
+    Value checked[MAX_PARAMETERS];
+    for (int i = 0; i < num_args; ++i) { // Tip hataları gövde ilk sürdürüldüğünde değil, çağrı noktasında görünsün
+        checked[i] = args[i];
+        if (!coerce_value_to_var_type(fd->params[i].type, &checked[i])) {
+            char e[250]; sprintf(e, "'%s' fonksiyonunun '%s' parametresine tip uyuşmazlığı: beklenen %s, verilen %s",
+                fd->name, fd->params[i].name, var_type_to_string_user(fd->params[i].type), value_type_to_string(args[i].type)); error(e);
         }
     }
+    GeneratorTable* table = generator_table_get(nur);
+    int slot = 0;
+    while (slot < MAX_GENERATORS && table->slots[slot]) slot++;
+    if (slot == MAX_GENERATORS) error("Maksimum askıdaki üreteç sayısına ulaşıldı (bitmemiş üreteçleri close ile kapatın).");
+    Generator* g = generator_alloc(table);
+    if (!g) error("Üreteç için bellek ayrılamadı.");
+    // Değişken dilimi çağıranın o anki değişkenleriyle başlar; bunlar kapsam 0'ın altında kalır. Üreteç, onu
+    // oluşturan fonksiyon döndükten sonra da çalışabileceğinden dizi ve struct belleğine başvuru alınır.
+    int n = nur->num_variables;
+    memcpy(g->variables, nur->symbol_table, (size_t)n * sizeof(Variable));
+    retain_variable_storage(g->variables, n);
+    g->num_shared_variables = n;
+    g->scope_stack[0] = n;
+    g->exec = (ExecContext){ .symbol_table = g->variables, .num_variables = n, .scope_stack = g->scope_stack, .scope_stack_ptr = 0,
+        .call_stack = g->call_stack, .call_stack_ptr = -1, .for_loop_vars_stack = g->for_loop_vars_stack, .for_loop_var_stack_ptr = -1,
+        .eval_stack = g->eval_stack, .current_token_idx = nur->current_token_idx, .current_line = nur->current_line, .running_generator = g };
+    g->state = nur; g->table = table; g->slot = slot;
+    g->fn_idx = (int)(fd - nur->function_table);
+    g->elem_type = fd->yield_type;
+    g->num_args = num_args;
+    memcpy(g->args, checked, (size_t)num_args * sizeof(Value));
+    g->status = GEN_NEW; g->has_value = false; g->failed = false;
+    coro_prepare(&g->ctx, g->stack, GENERATOR_STACK_SIZE, generator_entry);
+    table->slots[slot] = g;
+    unsigned generation = ++table->generation[slot];
+    Value v = {VAL_GENERATOR, false, {0}}; v.as.generator = (int)((generation << 8) | (unsigned)slot);
+    return v;
+}
+
+// NULL: üreteç bitmiş (kimliği eski bir kuşaktan). Geçersiz kimlik hata verir.
+Generator* resolve_generator(const char* fname, Value v) {
+    char err[150];
+    if (v.type != VAL_GENERATOR) { sprintf(err, "'%s' üreteç bekler (%s verildi).", fname, value_type_to_string(v.type)); error(err); }
+    int slot = v.as.generator & 0xff;
+    unsigned generation = (unsigned)v.as.generator >> 8;
+    GeneratorTable* t = nur->generator_table;
+    Generator* g = t ? t->slots[slot] : NULL;
+    if (g && generation == t->generation[slot]) return g;
+    if (t && generation >= 1 && generation <= t->generation[slot]) return NULL;
+    sprintf(err, "'%s': üreteç tanımsız veya bu durumda oluşturulmamış.", fname); error(err);
     return NULL;
 }
 
-// --- Parser Yardımcıları --- 
-Token consume_token(TokenType expected_type) {
-    if (current_token_idx >= num_tokens) { char err[100]; sprintf(err,"EOF beklenmedik şekilde oluştu, beklenen: %s",token_type_names[expected_type]); error(err); }
-    Token t = tokens[current_token_idx];
-    if (t.type != expected_type) { char err[MAX_STRING_LEN+100];sprintf(err,"Beklenen %s ama %s ('%s') geldi",token_type_names[expected_type],token_type_names[t.type],t.lexeme);error(err);}
-    current_token_idx++; return t;
+// Gövdeyi bir sonraki yield'e ya da sonuna kadar çalıştırır. Değer üretildiyse true.
+bool generator_resume(Generator* g, Value* out) {
+    if (g->status == GEN_RUNNING) error("Üreteç çalışırken kendisi sürdürülemez.");
+    g->status = GEN_RUNNING;
+    exec_swap(nur, &g->exec);
+    coro_switch(&g->caller, &g->ctx);
+    exec_swap(nur, &g->exec);
+    if (g->status != GEN_DONE) { *out = g->value; return true; }
+    bool failed = g->failed;
+    generator_free(g);
+    if (failed) raise_error();
+    return false;
 }
-Token peek_token() { if (current_token_idx >= num_tokens) return create_token(TOKEN_EOF, "EOF"); return tokens[current_token_idx];}
-Token peek_next_token() { if(current_token_idx+1>=num_tokens)return create_token(TOKEN_EOF,"EOF"); return tokens[current_token_idx + 1]; }
 
-// --- İfade Çözümleme --- 
-Value create_value_int(int v){Value val={VAL_INT};val.as.int_val=v;return val;}
-Value create_value_float(double v){Value val={VAL_FLOAT};val.as.float_val=v;return val;}
-Value create_value_bool(bool v){Value val={VAL_BOOLEAN};val.as.bool_val=v;return val;}
-Value create_value_string(const char* v){Value val={VAL_STRING};if(v){strncpy(val.as.string_val,v,MAX_STRING_LEN-1);val.as.string_val[MAX_STRING_LEN-1]='\0';}else{val.as.string_val[0]='\0';}return val;}
-Value create_value_null(){Value val={VAL_NULL};return val;}
-Value create_value_array_ref(Variable* v){if(!v||v->type!=VAR_ARRAY)error("create_value_array_ref: geçersiz değişken veya değişken array değil.");Value val={VAL_ARRAY_REF};val.as.array_var=v;return val;}
+// yield ifade; — çalışan üreteci askıya alır, değeri next'e verir.
+void parse_yield_statement(bool execute) {
+    consume_token(TOKEN_IDENTIFIER); // yield
+    Generator* g = nur->running_generator;
+    if (execute && !g) error("'yield' yalnızca bir üreteç fonksiyonunun (': gen<T>') içinde kullanılabilir.");
+    Value v = evaluate_expression(execute);
+    consume_token(TOKEN_SEMICOLON);
+    if (!execute) return;
+    if (!coerce_value_to_var_type(g->elem_type, &v)) {
+        char e[150]; sprintf(e, "'yield': değer (%s) üretecin tipine (gen<%s>) uymuyor.", value_type_to_string(v.type), var_type_to_string_user(g->elem_type)); error(e);
+    }
+    g->value = v; g->has_value = true;
+    g->status = GEN_SUSPENDED;
+    coro_switch(&g->ctx, &g->caller);
+}
 
-Value execute_function_call(const FunctionDefinition* func_def, Value args[], int num_args_passed) {
-    if (num_args_passed != func_def->num_params) {
-        char err[200]; sprintf(err, "'%s' fonksiyonu %d parametre bekliyor ama %d argüman verildi.", func_def->name, func_def->num_params, num_args_passed);
-        error(err);
+// next(g): sonraki değer (üreteç bittiyse hata). next(g, kutu): kutu[0]'a yazar, bittiyse false döner.
+Value native_next(Value* args, int num_args) {
+    if (num_args != 1 && num_args != 2) error("'next' 1 veya 2 argüman bekler: next(üreteç) ya da next(üreteç, kutu).");
+    Generator* g = resolve_generator("next", args[0]);
+    Value v;
+    bool got = g && generator_resume(g, &v);
+    if (num_args == 1) {
+        if (!got) error("'next': üreteç tükendi.");
+        return v;
     }
-    
-    if (call_stack_ptr + 1 >= MAX_CALL_STACK_DEPTH) error("Çağrı yığını taştı (Maksimum iç içe fonksiyon).");
-    call_stack_ptr++;
-    CallFrame* frame = &call_stack[call_stack_ptr];
-    frame->return_address_token_idx = current_token_idx; 
-    frame->symbol_table_scope_start_idx = num_variables; 
-    frame->prev_loop_depth = loop_depth; loop_depth = 0; 
-    frame->prev_for_loop_var_stack_ptr = for_loop_var_stack_ptr; for_loop_var_stack_ptr = -1; 
-    frame->func_def = func_def; 
-    
-    enter_scope(); 
-    
-    for (int i = 0; i < func_def->num_params; ++i) {
-        Variable* param_var = declare_variable(func_def->params[i].name, func_def->params[i].type, false, VAR_NULL_TYPE, 0); // Last two args irrelevant for non-arrays
-        Value arg_val = args[i];
-        bool type_match = false;
-        if (param_var->type == VAR_INT && arg_val.type == VAL_INT) { param_var->value.int_value = arg_val.as.int_val; type_match=true;}
-        else if (param_var->type == VAR_FLOAT && arg_val.type == VAL_FLOAT) { param_var->value.float_value = arg_val.as.float_val; type_match=true;}
-        else if (param_var->type == VAR_FLOAT && arg_val.type == VAL_INT) { param_var->value.float_value = (double)arg_val.as.int_val; type_match=true;} 
-        else if (param_var->type == VAR_STRING && arg_val.type == VAL_STRING) { strncpy(param_var->value.string_value, arg_val.as.string_val, MAX_STRING_LEN-1);param_var->value.string_value[MAX_STRING_LEN-1]='\0'; type_match=true;}
-        else if (param_var->type == VAR_BOOLEAN && arg_val.type == VAL_BOOLEAN) { param_var->value.bool_value = arg_val.as.bool_val; type_match=true;}
-        // Arrays are not directly passable by value in this design, only by reference (which isn't implemented as a parameter type yet)
-        
-        if (!type_match) {
-            char err[250]; sprintf(err, "'%s' fonksiyonunun '%s' parametresine tip uyuşmazlığı: beklenen %s, verilen %s",
-                                   func_def->name, func_def->params[i].name, var_type_to_string_user(param_var->type), value_type_to_string(arg_val.type));
-            // Cleanup before erroring:
-            // Since parameters are declared in a new scope, exit_scope will clean them.
-            // But we need to pop the call frame manually.
-            exit_scope(); 
-            call_stack_ptr--; 
-            error(err);
+    if (got) box_store("next", args[1], v);
+    return create_value_bool(got);
+}
+Value generator_close_value(Value v) {
+    Generator* g = resolve_generator("close", v);
+    if (g) {
+        if (g->status == GEN_RUNNING) error("'close': çalışan üreteç kapatılamaz.");
+        generator_free(g);
+    }
+    return create_value_null();
+}
+
+// --- Olay Döngüsü ---
+// io.watch / io.read_async / io.timer bir kaynak kaydeder ve kimliğini döndürür; io.run kaynak kalmayana kadar
+// epoll ile bekler ve hazır kaynakların geri çağrılarını çalıştırır. Geri çağrı bir kullanıcı fonksiyonunun adı
+// ya da bir üreteçtir: fonksiyon (kimlik, veri) ile çağrılır (zamanlayıcıda yalnızca kimlik); üreteç her olayda
+// bir kez sürdürülür, olayın verisini io.data() ile okur ve bittiğinde kaynağı da kapanır.
+// Kaynak "-" (standart girdi), FIFO, Unix soketi (yola bağlanılır) veya normal dosya olabilir. epoll normal
+// dosyaları desteklemez; onlar her turda hazır sayılır ve sırayla okunur. io.watch satır satır, io.read_async
+// gelen veriyi en fazla MAX_STRING_LEN - 1 baytlık parçalar halinde ve sonda bir kez "" ile teslim eder.
+// MAX_STRING_LEN - 1 bayta sığmayan satır parçalar halinde gelir; son parça dışındakilerde io.partial() true döner.
+// FIFO'nun yazma ucu da kaynakta açık tutulur: yazanlar gelip gitse de kaynak io.cancel'a kadar açık kalır.
+#ifdef __linux__
+enum { IO_WATCH, IO_READ, IO_TIMER };
+typedef struct {
+    bool in_use, owns_fd, always_ready, pending; // pending: kayıtta devralınmış, henüz teslim edilmemiş veri var
+    int kind, fd, hold_fd; // hold_fd: FIFO'nun kendi açtığımız yazma ucu (-1: yok)
+    unsigned generation;
+    int fn_idx; Value generator; // fn_idx < 0: geri çağrı üreteçtir
+    char* buf; size_t start, len, cap; // Okunmuş ama henüz teslim edilmemiş veri
+    long long due_ns, interval_ns; // Zamanlayıcı; interval_ns == 0: tek sefer
+} IoSource;
+struct EventLoop {
+    int epfd, active;
+    bool running;
+    IoSource sources[MAX_IO_SOURCES];
+    char data[MAX_STRING_LEN]; // io.data(): dağıtılmakta olan olayın verisi
+    bool partial; // io.partial(): olay uzun bir satırın son olmayan parçası
+};
+
+static long long monotonic_ns() { struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts); return ts.tv_sec * 1000000000LL + ts.tv_nsec; }
+static inline int io_source_id(const EventLoop* loop, const IoSource* s) { return (int)(s->generation << 8) | (int)(s - loop->sources); }
+
+EventLoop* event_loop_get(NurState* st) {
+    if (!st->event_loop) {
+        EventLoop* loop = calloc(1, sizeof(EventLoop));
+        if (!loop) error("Olay döngüsü için bellek ayrılamadı.");
+        loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+        if (loop->epfd < 0) { char e[150]; sprintf(e, "Olay döngüsü oluşturulamadı: %s", strerror(errno)); free(loop); error(e); }
+        st->event_loop = loop;
+    }
+    return st->event_loop;
+}
+static void io_source_release(EventLoop* loop, IoSource* s) {
+    if (s->fd >= 0) {
+        if (!s->always_ready) epoll_ctl(loop->epfd, EPOLL_CTL_DEL, s->fd, NULL);
+        if (s->owns_fd) close(s->fd);
+    }
+    if (s->hold_fd >= 0) close(s->hold_fd);
+    free(s->buf); s->buf = NULL;
+    s->in_use = false;
+    loop->active--;
+}
+static void io_release_all(EventLoop* loop) {
+    for (int i = 0; i < MAX_IO_SOURCES; ++i) if (loop->sources[i].in_use) io_source_release(loop, &loop->sources[i]);
+}
+void event_loop_free(NurState* st) {
+    EventLoop* loop = st->event_loop;
+    st->event_loop = NULL;
+    if (!loop) return;
+    io_release_all(loop);
+    close(loop->epfd);
+    free(loop);
+}
+
+// Geri çağrıyı kayıt anında doğrular: fonksiyon adı ve parametre sayısı ya da bitmemiş bir üreteç.
+static void io_set_callback(const char* fname, IoSource* s, Value cb, int arity) {
+    char e[200 + MAX_STRING_LEN];
+    if (cb.type == VAL_STRING) {
+        const FunctionDefinition* fd = find_function(cb.as.string_val);
+        if (!fd) { sprintf(e, "%s: '%s' adlı fonksiyon bulunamadı.", fname, cb.as.string_val); error(e); }
+        if (fd->num_params != arity) { sprintf(e, "%s: '%s' fonksiyonu %d parametre almalıdır (%s).", fname, fd->name, arity, arity == 1 ? "kimlik" : "kimlik, veri"); error(e); }
+        if (fd->return_type == VAR_GENERATOR) { sprintf(e, "%s: '%s' bir üreteç fonksiyonu; üreteci oluşturup onu verin.", fname, fd->name); error(e); }
+        s->fn_idx = (int)(fd - nur->function_table);
+    } else if (cb.type == VAL_GENERATOR) {
+        if (!resolve_generator(fname, cb)) { sprintf(e, "%s: üreteç zaten bitmiş.", fname); error(e); }
+        s->fn_idx = -1; s->generator = cb;
+    } else {
+        sprintf(e, "%s: geri çağrı fonksiyon adı (string) veya üreteç olmalıdır (%s verildi).", fname, value_type_to_string(cb.type)); error(e);
+    }
+}
+static IoSource* io_source_new(const char* fname, EventLoop* loop, int kind, Value cb, int arity) {
+    int slot = 0;
+    while (slot < MAX_IO_SOURCES && loop->sources[slot].in_use) slot++;
+    if (slot == MAX_IO_SOURCES) { char e[150]; sprintf(e, "%s: maksimum olay kaynağı sayısına ulaşıldı (%d).", fname, MAX_IO_SOURCES); error(e); }
+    IoSource* s = &loop->sources[slot];
+    unsigned generation = s->generation;
+    memset(s, 0, sizeof *s);
+    s->kind = kind; s->fd = -1; s->hold_fd = -1; s->generation = generation;
+    io_set_callback(fname, s, cb, arity);
+    s->generation = (generation + 1) & 0x7fffff;
+    return s;
+}
+// Kaynak ancak burada etkin olur; kurulum sırasında hata olursa yuva boş kalır.
+static int io_source_commit(EventLoop* loop, IoSource* s) { s->in_use = true; loop->active++; return io_source_id(loop, s); }
+
+// Yolu okumak için açar. Standart girdide Girdi Okuyucu'nun tamponunda bekleyen veri kaynağa aktarılır.
+static void io_open_path(const char* fname, IoSource* s, const char* path) {
+    char e[MAX_STRING_LEN + 150];
+    s->cap = IO_BUFFER_SIZE;
+    if (strcmp(path, "-") == 0) {
+        if (nur->in_fd < 0) { sprintf(e, "%s: bu durumda standart girdi yok.", fname); error(e); }
+        size_t pending = nur->in_len - nur->in_pos;
+        s->cap += pending;
+        if (!(s->buf = malloc(s->cap))) { sprintf(e, "%s: okuma tamponu ayrılamadı.", fname); error(e); }
+        memcpy(s->buf, nur->in_buffer + nur->in_pos, pending);
+        s->len = pending; s->pending = pending > 0; nur->in_pos = nur->in_len;
+        s->fd = nur->in_fd; // Kapatılmaz; O_NONBLOCK da verilmez (dosya tanımı üst süreçle paylaşılıyor olabilir)
+        return;
+    }
+    struct stat sb;
+    if (stat(path, &sb) != 0) { sprintf(e, "%s: '%s' açılamadı: %s", fname, path, strerror(errno)); error(e); }
+    int fd;
+    if (S_ISSOCK(sb.st_mode)) {
+        struct sockaddr_un addr = { .sun_family = AF_UNIX };
+        if (strlen(path) >= sizeof addr.sun_path) { sprintf(e, "%s: soket yolu çok uzun: '%s'", fname, path); error(e); }
+        strcpy(addr.sun_path, path);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr*)&addr, sizeof addr) != 0) { int saved = errno; close(fd); fd = -1; errno = saved; }
+        if (fd >= 0) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    } else {
+        fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC); // FIFO yazan olmadan da açılır
+    }
+    if (fd < 0) { sprintf(e, "%s: '%s' açılamadı: %s", fname, path, strerror(errno)); error(e); }
+    if (!(s->buf = malloc(s->cap))) { close(fd); sprintf(e, "%s: okuma tamponu ayrılamadı.", fname); error(e); }
+    s->fd = fd; s->owns_fd = true;
+    if (S_ISFIFO(sb.st_mode)) s->hold_fd = open(path, O_WRONLY | O_NONBLOCK | O_CLOEXEC); // Son yazan çıkınca EOF gelmesin
+}
+static Value io_add_reader(const char* fname, int kind, Value* args) {
+    EventLoop* loop = event_loop_get(nur);
+    IoSource* s = io_source_new(fname, loop, kind, args[1], 2);
+    io_open_path(fname, s, args[0].as.string_val);
+    struct epoll_event ev = { .events = EPOLLIN };
+    ev.data.u64 = (unsigned)io_source_id(loop, s);
+    if (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, s->fd, &ev) != 0) {
+        if (errno == EPERM) s->always_ready = true; // Normal dosya
+        else {
+            char e[MAX_STRING_LEN + 150]; sprintf(e, "%s: '%s' izlenemiyor: %s", fname, args[0].as.string_val, strerror(errno));
+            if (s->owns_fd) close(s->fd);
+            if (s->hold_fd >= 0) close(s->hold_fd);
+            free(s->buf); s->buf = NULL;
+            error(e);
         }
-        param_var->is_defined = true;
     }
-    
-    int previous_body_start_token_idx = current_token_idx; // Save current token index before jumping
-    current_token_idx = func_def->body_start_token_idx;
-    g_return_flag = false;
-    g_return_value_holder = create_value_null(); 
-    
-    bool dummy_b = false, dummy_c = false; 
-    // Function body execution scope is managed by enter_scope above and exit_scope below.
-    // parse_block itself should not create another scope if in_function_body is true.
-    // The LBRACE of the function body is at func_def->body_start_token_idx.
-    // We need to parse the block starting from LBRACE.
-    if (tokens[current_token_idx].type != TOKEN_LBRACE) {
-        // This should not happen if parse_fun_declaration is correct
-        error("Fonksiyon gövdesi başlangıcında LBRACE ({) bekleniyordu.");
+    return create_value_int(io_source_commit(loop, s));
+}
+Value native_io_watch(Value* args, int num_args) { (void)num_args; return io_add_reader("io.watch", IO_WATCH, args); }
+Value native_io_read_async(Value* args, int num_args) { (void)num_args; return io_add_reader("io.read_async", IO_READ, args); }
+Value native_io_timer(Value* args, int num_args) {
+    if (num_args != 2 && num_args != 3) error("'io.timer' 2 veya 3 argüman bekler: io.timer(ms, geri_çağrı [, tekrar]).");
+    if (!value_is_numeric(args[0]) || value_as_double(args[0]) < 0) error("'io.timer' süresi negatif olmayan bir sayı (milisaniye) olmalıdır.");
+    if (num_args == 3 && args[2].type != VAL_BOOLEAN) error("'io.timer' 3. argümanı boolean olmalıdır.");
+    long long ns = (long long)(value_as_double(args[0]) * 1e6);
+    bool repeat = num_args == 3 && args[2].as.bool_val;
+    if (repeat && ns <= 0) error("'io.timer': tekrarlanan zamanlayıcının süresi sıfırdan büyük olmalıdır.");
+    EventLoop* loop = event_loop_get(nur);
+    IoSource* s = io_source_new("io.timer", loop, IO_TIMER, args[1], 1);
+    s->due_ns = monotonic_ns() + ns;
+    s->interval_ns = repeat ? ns : 0;
+    return create_value_int(io_source_commit(loop, s));
+}
+
+// NULL: kimlik bitmiş bir kaynağa ait. Bu durumda hiç verilmemiş kimlik hata verir.
+static IoSource* io_resolve(EventLoop* loop, int id) {
+    int slot = id & 0xff;
+    unsigned generation = (unsigned)id >> 8;
+    IoSource* s = loop && slot < MAX_IO_SOURCES ? &loop->sources[slot] : NULL;
+    if (s && s->in_use && s->generation == generation) return s;
+    if (!s || generation == 0 || generation > s->generation) error("'io': geçersiz olay kaynağı kimliği.");
+    return NULL;
+}
+Value native_io_cancel(Value* args, int num_args) {
+    (void)num_args;
+    EventLoop* loop = nur->event_loop;
+    IoSource* s = io_resolve(loop, (int)value_as_i64(args[0]));
+    if (s) io_source_release(loop, s);
+    return create_value_bool(s != NULL);
+}
+Value native_io_data(Value* args, int num_args) {
+    (void)args; (void)num_args;
+    return create_value_string(nur->event_loop ? nur->event_loop->data : "");
+}
+Value native_io_partial(Value* args, int num_args) {
+    (void)args; (void)num_args;
+    return create_value_bool(nur->event_loop && nur->event_loop->partial);
+}
+
+// Olayı geri çağrıya teslim eder. false: kaynak bu sırada kapandı (io.cancel veya üreteç bitti).
+static bool io_dispatch(EventLoop* loop, IoSource* s, const char* data, size_t n, bool partial) {
+    unsigned generation = s->generation;
+    int id = io_source_id(loop, s);
+    memcpy(loop->data, data, n); loop->data[n] = '\0';
+    loop->partial = partial;
+    if (s->fn_idx >= 0) {
+        Value args[2] = { create_value_int(id), create_value_string(loop->data) };
+        invoke_function(&nur->function_table[s->fn_idx], args, s->kind == IO_TIMER ? 1 : 2);
+    } else {
+        Generator* g = resolve_generator("io.run", s->generator);
+        Value ignored;
+        bool alive = g && generator_resume(g, &ignored);
+        if (!alive && s->in_use && s->generation == generation) io_source_release(loop, s);
     }
-    parse_block(true, &dummy_b, &dummy_c, true); // true for in_function_body
-    
-    Value return_val_from_func = g_return_value_holder; 
-    if(g_return_flag == false && func_def->return_type != VAR_VOID){ 
-        char err[200]; sprintf(err, "'%s' fonksiyonu değer döndürmeliydi (%s) ama return ifadesi bulunamadı (veya gövde sonuna ulaşıldı).", func_def->name, var_type_to_string_user(func_def->return_type));
-        exit_scope(); 
-        loop_depth = frame->prev_loop_depth; 
-        for_loop_var_stack_ptr = frame->prev_for_loop_var_stack_ptr;
-        call_stack_ptr--;
-        error(err);
+    return s->in_use && s->generation == generation;
+}
+// Tampondaki tamamlanan satırları (io.watch) ya da parçaları (io.read_async) teslim eder; eof'ta kaynak kapanır.
+static void io_deliver(EventLoop* loop, IoSource* s, bool eof) {
+    while (s->len > 0) {
+        char* p = s->buf + s->start;
+        size_t n, used;
+        bool partial = false;
+        if (s->kind == IO_WATCH) {
+            char* nl = memchr(p, '\n', s->len);
+            if (!nl && !eof && s->len < MAX_STRING_LEN) break; // Satırın kalanı bekleniyor
+            n = nl ? (size_t)(nl - p) : s->len;
+            if (n > MAX_STRING_LEN - 1) { // Uzun satırın bir parçası; UTF-8 karakteri ortadan bölünmez
+                partial = true;
+                n = MAX_STRING_LEN - 1;
+                for (int k = 0; k < 3 && ((unsigned char)p[n] & 0xC0) == 0x80; ++k) n--;
+                used = n;
+            } else {
+                used = nl ? n + 1 : n;
+                if (n > 0 && p[n - 1] == '\r') n--;
+            }
+        } else {
+            n = used = s->len < MAX_STRING_LEN - 1 ? s->len : MAX_STRING_LEN - 1;
+        }
+        s->start += used; s->len -= used;
+        if (!io_dispatch(loop, s, p, n, partial)) return;
     }
-    
-    exit_scope(); 
-    
-    current_token_idx = frame->return_address_token_idx; // Restore token index to after the call
-    loop_depth = frame->prev_loop_depth;
-    for_loop_var_stack_ptr = frame->prev_for_loop_var_stack_ptr;
-    call_stack_ptr--;
-    
-    if (func_def->return_type == VAR_VOID) {
-        if (g_return_flag && return_val_from_func.type != VAL_NULL) { 
-            error("Void fonksiyon değer döndüremez (return ifadesiyle bir değer döndürmeye çalıştı).");
+    if (!eof) return;
+    if (s->kind == IO_READ && !io_dispatch(loop, s, "", 0, false)) return;
+    io_source_release(loop, s);
+}
+// Hazır kaynaktan tek read() yapar. Teslim edilmemiş veri her zaman MAX_STRING_LEN'den azdır, tampon dolmaz.
+static void io_read_ready(EventLoop* loop, IoSource* s) {
+    if (s->start > 0) { memmove(s->buf, s->buf + s->start, s->len); s->start = 0; }
+    ssize_t got = read(s->fd, s->buf + s->len, s->cap - s->len);
+    if (got < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return;
+        char e[150]; sprintf(e, "io: okuma hatası: %s", strerror(errno)); error(e);
+    }
+    s->len += (size_t)got;
+    io_deliver(loop, s, got == 0);
+}
+
+// io.run(): kaynak kalmayana kadar olayları dağıtır. Geri çağrıda oluşan hata döngüyü durdurur, kalan
+// kaynakları kapatır (yarım kalmış bir olay sonraki io.run'da tekrarlanmasın) ve yayılır.
+Value native_io_run(Value* args, int num_args) {
+    (void)args; (void)num_args;
+    EventLoop* loop = nur->event_loop;
+    if (!loop) return create_value_null();
+    if (loop->running) error("io.run: olay döngüsü zaten çalışıyor (geri çağrı içinden çağrılamaz).");
+    jmp_buf env;
+    jmp_buf* prev_jmp = nur->error_jmp;
+    if (setjmp(env) != 0) { nur->error_jmp = prev_jmp; loop->running = false; io_release_all(loop); raise_error(); }
+    nur->error_jmp = &env;
+    loop->running = true;
+    struct epoll_event events[MAX_IO_SOURCES];
+    while (loop->active > 0) {
+        long long now = monotonic_ns(), next_due = LLONG_MAX;
+        bool files_ready = false;
+        for (int i = 0; i < MAX_IO_SOURCES; ++i) {
+            const IoSource* s = &loop->sources[i];
+            if (!s->in_use) continue;
+            if (s->kind == IO_TIMER && s->due_ns < next_due) next_due = s->due_ns;
+            if (s->always_ready || s->pending) files_ready = true;
         }
-        return create_value_null(); 
-    } else { 
-        bool ret_type_match = false;
-        if (func_def->return_type == VAR_INT && return_val_from_func.type == VAL_INT) ret_type_match = true;
-        else if (func_def->return_type == VAR_FLOAT && return_val_from_func.type == VAL_FLOAT) ret_type_match = true;
-        else if (func_def->return_type == VAR_FLOAT && return_val_from_func.type == VAL_INT) { 
-            return_val_from_func = create_value_float((double)return_val_from_func.as.int_val);
-            ret_type_match = true;
-        }
-        else if (func_def->return_type == VAR_STRING && return_val_from_func.type == VAL_STRING) ret_type_match = true;
-        else if (func_def->return_type == VAR_BOOLEAN && return_val_from_func.type == VAL_BOOLEAN) ret_type_match = true;
-        
-        if (!ret_type_match) {
-            char err[250]; sprintf(err, "'%s' fonksiyonunun dönüş tipi uyuşmazlığı: beklenen %s, dönen %s",
-                                   func_def->name, var_type_to_string_user(func_def->return_type), value_type_to_string(return_val_from_func.type));
-            error(err);
+        int timeout = -1;
+        if (files_ready || next_due <= now) timeout = 0;
+        else if (next_due != LLONG_MAX) timeout = (next_due - now + 999999) / 1000000 > INT_MAX ? INT_MAX : (int)((next_due - now + 999999) / 1000000);
+        if (timeout != 0) flush_output(); // Beklerken önceki çıktı görünsün
+        int n = epoll_wait(loop->epfd, events, MAX_IO_SOURCES, timeout);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            char e[150]; sprintf(e, "io.run: epoll_wait başarısız: %s", strerror(errno)); error(e);
+        }
+        for (int i = 0; i < n; ++i) {
+            IoSource* s = io_resolve(loop, (int)events[i].data.u64);
+            if (s) io_read_ready(loop, s); // Önceki geri çağrı kapattıysa olay atılır
+        }
+        for (int i = 0; i < MAX_IO_SOURCES; ++i) {
+            IoSource* s = &loop->sources[i];
+            if (s->in_use && s->pending) { s->pending = false; io_deliver(loop, s, false); }
+            if (s->in_use && s->always_ready) io_read_ready(loop, s);
+        }
+        now = monotonic_ns();
+        for (int i = 0; i < MAX_IO_SOURCES; ++i) {
+            IoSource* s = &loop->sources[i];
+            if (!s->in_use || s->kind != IO_TIMER || s->due_ns > now) continue;
+            if (s->interval_ns) { s->due_ns += s->interval_ns; if (s->due_ns <= now) s->due_ns = now + s->interval_ns; } // Kaçırılan turlar atlanır
+            if (io_dispatch(loop, s, "", 0, false) && !s->interval_ns) io_source_release(loop, s);
         }
-        return return_val_from_func;
     }
+    loop->running = false;
+    nur->error_jmp = prev_jmp;
+    return create_value_null();
+}
+#else
+void event_loop_free(NurState* st) { (void)st; }
+static Value io_unsupported(Value* args, int num_args) { error("io.* olay döngüsü yalnızca Linux'ta (epoll) kullanılabilir."); return create_value_null(); }
+#define native_io_watch io_unsupported
+#define native_io_read_async io_unsupported
+#define native_io_timer io_unsupported
+#define native_io_cancel io_unsupported
+#define native_io_run io_unsupported
+#define native_io_data io_unsupported
+#define native_io_partial io_unsupported
+#endif
+
+void register_core_natives() {
+    static const struct { const char* name; int arity; NativeArgType types[4]; NativeFn fn; } core[] = {
+        {"length", 1, {NARG_ANY}, native_length},
+        {"int_to_string", 1, {NARG_INT}, native_int_to_string},
+        {"concat", 2, {NARG_STRING, NARG_STRING}, native_concat},
+        {"sqrt", 1, {NARG_NUMBER}, native_sqrt},
+        {"to_upper", 1, {NARG_STRING}, native_to_upper},
+        {"to_lower", 1, {NARG_STRING}, native_to_lower},
+        {"read_file_text", 1, {NARG_STRING}, native_read_file_text},
+        {"write_file_text", 2, {NARG_STRING, NARG_STRING}, native_write_file_text},
+        {"substring", 3, {NARG_STRING, NARG_INT, NARG_INT}, native_substring},
+        {"string_to_int", 1, {NARG_STRING}, native_string_to_int},
+        {"string_to_float", 1, {NARG_STRING}, native_string_to_float},
+        {"type_of", 1, {NARG_ANY}, native_type_of},
+        {"pow", 2, {NARG_NUMBER, NARG_NUMBER}, native_pow},
+        {"index_of", 2, {NARG_STRING, NARG_STRING}, native_index_of},
+        {"last_index_of", 2, {NARG_STRING, NARG_STRING}, native_last_index_of},
+        {"contains", 2, {NARG_STRING, NARG_STRING}, native_contains},
+        {"starts_with", 2, {NARG_STRING, NARG_STRING}, native_starts_with},
+        {"ends_with", 2, {NARG_STRING, NARG_STRING}, native_ends_with},
+        {"split", 3, {NARG_STRING, NARG_STRING, NARG_ARRAY}, native_split},
+        {"replace", 3, {NARG_STRING, NARG_STRING, NARG_STRING}, native_replace},
+        {"trim", 1, {NARG_STRING}, native_trim},
+        {"compare", 2, {NARG_STRING, NARG_STRING}, native_compare},
+        {"equals_ignore_case", 2, {NARG_STRING, NARG_STRING}, native_equals_ignore_case},
+        {"to_upper_all", 1, {NARG_ARRAY}, native_to_upper_all},
+        {"to_lower_all", 1, {NARG_ARRAY}, native_to_lower_all},
+        {"trim_all", 1, {NARG_ARRAY}, native_trim_all},
+        {"regex_compile", 1, {NARG_STRING}, native_regex_compile},
+        {"regex_match", 2, {NARG_ANY, NARG_STRING}, native_regex_match},
+        {"regex_find_all", 3, {NARG_ANY, NARG_STRING, NARG_ARRAY}, native_regex_find_all},
+        {"sum", 1, {NARG_ARRAY}, native_sum},
+        {"min", 1, {NARG_ARRAY}, native_min},
+        {"max", 1, {NARG_ARRAY}, native_max},
+        {"dot", 2, {NARG_ARRAY, NARG_ARRAY}, native_dot},
+        {"fill", 2, {NARG_ARRAY, NARG_ANY}, native_fill},
+        {"scale", 2, {NARG_ARRAY, NARG_NUMBER}, native_scale},
+        {"add", 3, {NARG_ARRAY, NARG_ARRAY, NARG_ARRAY}, native_add},
+        {"count_if_eq", 2, {NARG_ARRAY, NARG_ANY}, native_count_if_eq},
+        {"sort", 1, {NARG_ARRAY}, native_sort},
+        {"sort_desc", 1, {NARG_ARRAY}, native_sort_desc},
+        {"argsort", 2, {NARG_ARRAY, NARG_ARRAY}, native_argsort},
+        {"binary_search", 2, {NARG_ARRAY, NARG_ANY}, native_binary_search},
+        {"par_map", 3, {NARG_ARRAY, NARG_STRING, NARG_ARRAY}, native_par_map},
+        {"par_filter", 3, {NARG_ARRAY, NARG_STRING, NARG_ARRAY}, native_par_filter},
+        {"par_reduce", 3, {NARG_ARRAY, NARG_STRING, NARG_ANY}, native_par_reduce},
+        {"channel", 1, {NARG_INT}, native_channel}, // Tipi ilk send ile belirlenir
+        {"send", 2, {NARG_CHANNEL, NARG_ANY}, native_send},
+        {"recv", -1, {NARG_CHANNEL, NARG_ARRAY}, native_recv},
+        {"try_recv", 2, {NARG_CHANNEL, NARG_ARRAY}, native_try_recv},
+        {"join", 1, {NARG_INT}, native_join},
+        {"next", -1, {NARG_ANY}, native_next}, // next(g) veya next(g, kutu)
+        {"io.watch", 2, {NARG_STRING, NARG_ANY}, native_io_watch},
+        {"io.read_async", 2, {NARG_STRING, NARG_ANY}, native_io_read_async},
+        {"io.timer", -1, {NARG_ANY}, native_io_timer}, // io.timer(ms, geri_çağrı [, tekrar])
+        {"io.cancel", 1, {NARG_INT}, native_io_cancel},
+        {"io.run", 0, {NARG_ANY}, native_io_run},
+        {"io.data", 0, {NARG_ANY}, native_io_data},
+        {"io.partial", 0, {NARG_ANY}, native_io_partial},
+        {"open", 2, {NARG_STRING, NARG_STRING}, native_open},
+        {"read_line", 1, {NARG_HANDLE}, native_read_line},
+        {"read_bytes", 2, {NARG_HANDLE, NARG_INT}, native_read_bytes},
+        {"write", 2, {NARG_HANDLE, NARG_ANY}, native_write},
+        {"flush", 1, {NARG_HANDLE}, native_flush},
+        {"close", 1, {NARG_ANY}, native_close}, // Dosya tutamacı, kanal veya üreteç
+        {"eof", 1, {NARG_HANDLE}, native_eof},
+        {"map_file", -1, {NARG_ANY}, native_map_file},
+        {"read_ints", 1, {NARG_ARRAY}, native_read_ints},
+        {"read_floats", 1, {NARG_ARRAY}, native_read_floats},
+        {"read_lines", 1, {NARG_ARRAY}, native_read_lines},
+        {"read_csv", -1, {NARG_ANY}, native_read_csv},
+        {"csv_row_count", 4, {NARG_STRING, NARG_STRING, NARG_STRING, NARG_BOOL}, native_csv_row_count},
+        {"json_decode", 2, {NARG_STRING, NARG_ANY}, native_json_decode},
+        {"json_parse", 2, {NARG_STRING, NARG_ANY}, native_json_parse},
+        {"json_next", 1, {NARG_HANDLE}, native_json_next},
+        {"json_text", 1, {NARG_HANDLE}, native_json_text},
+        {"json_number", 1, {NARG_HANDLE}, native_json_number},
+        {"json_skip", 1, {NARG_HANDLE}, native_json_skip},
+        {"json_write", 2, {NARG_HANDLE, NARG_ANY}, native_json_write},
+        {"json_stringify", 1, {NARG_ANY}, native_json_stringify},
+    };
+    for (size_t i = 0; i < sizeof(core) / sizeof(core[0]); ++i)
+        register_native(core[i].name, core[i].arity, core[i].types, core[i].fn);
 }
 
+Value load_variable_value(Variable* var) {
+    if(!var->is_defined && var->type != VAR_ARRAY) { char msg[150]; sprintf(msg, "'%s' değişkeni atanmadan kullanıldı", var->name); error(msg); }
+    switch(var->type){
+        case VAR_INT: return create_value_int(var->value.int_value); case VAR_FLOAT: return create_value_float(var->value.float_value);
+        case VAR_STRING: return create_value_string(var->value.string_value); case VAR_BOOLEAN: return create_value_bool(var->value.bool_value);
+        case VAR_I64: case VAR_F32: case VAR_U8: case VAR_HANDLE: case VAR_CHANNEL: case VAR_GENERATOR: return load_typed_slot(var->type, scalar_variable_slot(var));
+        case VAR_ARRAY: return create_value_array_ref(var); // Return reference to the array itself
+        case VAR_STRUCT: return create_value_struct_ref(var, -1);
+        default: error("İfadede bilinmeyen değişken tipi.");
+    }
+    return create_value_null();
+}
 Value parse_primary_expression(bool execute) {
     Token t = peek_token();
-    if (t.type == TOKEN_INT_LITERAL) { consume_token(TOKEN_INT_LITERAL); return execute ? create_value_int(t.int_value) : create_value_null(); }
+    if (t.type == TOKEN_INT_LITERAL) { consume_token(TOKEN_INT_LITERAL); if (!execute) return create_value_null(); return (t.int_value > INT_MAX) ? create_value_i64(t.int_value) : create_value_int((int)t.int_value); }
     if (t.type == TOKEN_FLOAT_LITERAL) { consume_token(TOKEN_FLOAT_LITERAL); return execute ? create_value_float(t.float_value) : create_value_null(); }
     if (t.type == TOKEN_STRING_LITERAL) { consume_token(TOKEN_STRING_LITERAL); return execute ? create_value_string(t.string_value) : create_value_null(); }
     if (t.type == TOKEN_TRUE) { consume_token(TOKEN_TRUE); return execute ? create_value_bool(true) : create_value_null(); }
     if (t.type == TOKEN_FALSE) { consume_token(TOKEN_FALSE); return execute ? create_value_bool(false) : create_value_null(); }
     
+    if (t.type == TOKEN_IDENTIFIER && is_keyword(t.lexeme, "spawn") && peek_next_token().type == TOKEN_IDENTIFIER) return parse_spawn_expression(execute);
     if (t.type == TOKEN_IDENTIFIER) {
         Token id_token = consume_token(TOKEN_IDENTIFIER);
+        int id_token_idx = nur->current_token_idx - 1;
+        // io.ad(...): ad alanlı dahili fonksiyon (bkz. Olay Döngüsü); io adlı bir struct'ın alanı çağrılamayacağı için çakışmaz
+        if (is_keyword(id_token.lexeme, "io") && id_token_idx + 3 < nur->num_tokens && nur->tokens[id_token_idx + 1].type == TOKEN_DOT
+            && nur->tokens[id_token_idx + 2].type == TOKEN_IDENTIFIER && nur->tokens[id_token_idx + 3].type == TOKEN_LPAREN) {
+            consume_token(TOKEN_DOT);
+            Token member = consume_token(TOKEN_IDENTIFIER);
+            snprintf(id_token.lexeme, sizeof id_token.lexeme, "io.%.*s", MAX_IDENT_LEN, member.lexeme); // Tanımlayıcılar MAX_IDENT_LEN ile sınırlı
+        }
         
         if (peek_token().type == TOKEN_LPAREN) { // Possible function call
             consume_token(TOKEN_LPAREN); 
@@ -554,369 +5024,356 @@ Value parse_primary_expression(bool execute) {
             
             if (!execute) return create_value_null(); // If not executing expression containing this call, just return null.
             
-            // Dahili Fonksiyonlar
-            if (is_keyword(id_token.lexeme, "length")) {
-                if (num_args_passed != 1) error("'length' 1 argüman bekler.");
-                if (args[0].type == VAL_STRING) return create_value_int(strlen(args[0].as.string_val));
-                if (args[0].type == VAL_ARRAY_REF) return create_value_int(args[0].as.array_var->value.array.size);
-                error("'length' string veya dizi argüman bekler.");
-            } else if (is_keyword(id_token.lexeme, "int_to_string")) {
-                if(num_args_passed!=1) error("'int_to_string' 1 argüman bekler."); if(args[0].type!=VAL_INT)error("'int_to_string' tamsayı argüman bekler.");
-                char buf[MAX_STRING_LEN];sprintf(buf,"%d",args[0].as.int_val);return create_value_string(buf);
-            } else if (is_keyword(id_token.lexeme, "concat")) {
-                if(num_args_passed!=2) error("'concat' 2 argüman bekler."); if(args[0].type!=VAL_STRING||args[1].type!=VAL_STRING)error("'concat' iki string argüman bekler.");
-                char buf[MAX_STRING_LEN];snprintf(buf,MAX_STRING_LEN,"%s%s",args[0].as.string_val,args[1].as.string_val); return create_value_string(buf);
-            } else if (is_keyword(id_token.lexeme, "sqrt")) { 
-                if (num_args_passed != 1) error("'sqrt' 1 argüman bekler.");
-                if (args[0].type == VAL_INT) {
-                    if (args[0].as.int_val < 0) error("'sqrt' negatif tamsayı alamaz.");
-                    return create_value_float(sqrt((double)args[0].as.int_val));
-                } else if (args[0].type == VAL_FLOAT) {
-                    if (args[0].as.float_val < 0.0) error("'sqrt' negatif ondalıklı sayı alamaz.");
-                    return create_value_float(sqrt(args[0].as.float_val));
-                } else {
-                    error("'sqrt' sayısal bir argüman (int veya float) bekler.");
-                }
-            } else if (is_keyword(id_token.lexeme, "to_upper")) { 
-                if(num_args_passed!=1)error("'to_upper' 1 argüman bekler."); if(args[0].type!=VAL_STRING)error("'to_upper' string argüman bekler.");
-                char res[MAX_STRING_LEN]; strncpy(res,args[0].as.string_val,MAX_STRING_LEN-1); res[MAX_STRING_LEN-1]='\0';
-                for(int i_upper=0;res[i_upper];i_upper++) res[i_upper]=toupper((unsigned char)res[i_upper]); return create_value_string(res);
-            } else if (is_keyword(id_token.lexeme, "to_lower")) { 
-                if(num_args_passed!=1)error("'to_lower' 1 argüman bekler."); if(args[0].type!=VAL_STRING)error("'to_lower' string argüman bekler.");
-                char res[MAX_STRING_LEN]; strncpy(res,args[0].as.string_val,MAX_STRING_LEN-1); res[MAX_STRING_LEN-1]='\0';
-                for(int i_lower=0;res[i_lower];i_lower++) res[i_lower]=tolower((unsigned char)res[i_lower]); return create_value_string(res);
-            } else if (is_keyword(id_token.lexeme, "read_file_text")) { 
-                if (num_args_passed != 1) error("'read_file_text' 1 argüman (dosyayolu string) bekler.");
-                if (args[0].type != VAL_STRING) error("'read_file_text' dosyayolu string olmalıdır.");
-                FILE* file_ptr = fopen(args[0].as.string_val, "rb"); 
-                if (!file_ptr) {
-                    char err_msg[MAX_STRING_LEN + 100];
-                    sprintf(err_msg, "Dosya okunamadı veya bulunamadı: %s", args[0].as.string_val);
-                    error(err_msg);
-                }
-                fseek(file_ptr, 0, SEEK_END); long file_size = ftell(file_ptr); fseek(file_ptr, 0, SEEK_SET);
-                if (file_size >= MAX_SOURCE_SIZE) { fclose(file_ptr); char e[MAX_STRING_LEN+100];sprintf(e,"Dosya '%s' okunacak buffer'dan (%ld bayt) büyük (max %d).",args[0].as.string_val, file_size, MAX_SOURCE_SIZE-1);error(e); } 
-                
-                char* file_content_buffer = (char*) malloc(file_size + 1);
-                if (!file_content_buffer) { fclose(file_ptr); error("read_file_text için bellek ayrılamadı.");}
-                size_t read_size = fread(file_content_buffer, 1, file_size, file_ptr);
-                file_content_buffer[read_size] = '\0'; fclose(file_ptr); Value result_val = create_value_string(file_content_buffer);
-                free(file_content_buffer); return result_val;
-            } else if (is_keyword(id_token.lexeme, "write_file_text")) { 
-                if (num_args_passed != 2) error("'write_file_text' 2 argüman (dosyayolu string, içerik string) bekler.");
-                if (args[0].type != VAL_STRING || args[1].type != VAL_STRING) error("'write_file_text' argümanları string olmalıdır.");
-                FILE* file_ptr = fopen(args[0].as.string_val, "w");
-                if (!file_ptr) { // Could not open file for writing
-                    char err_msg[MAX_STRING_LEN + 100];
-                    sprintf(err_msg, "Dosya '%s' yazılamadı.", args[0].as.string_val);
-                    error(err_msg); // More informative to error out than return false
-                    // return create_value_bool(false); 
-                }
-                fprintf(file_ptr, "%s", args[1].as.string_val); fclose(file_ptr); return create_value_bool(true); 
-            }
-            // --- YENİ DAHİLİ FONKSİYONLAR ---
-            else if (is_keyword(id_token.lexeme, "substring")) {
-                if (num_args_passed != 3) error("'substring' 3 argüman bekler (string, baslangic_indisi, uzunluk).");
-                if (args[0].type != VAL_STRING) error("'substring' ilk argümanı string olmalıdır.");
-                if (args[1].type != VAL_INT) error("'substring' ikinci argümanı (baslangic_indisi) tamsayı olmalıdır.");
-                if (args[2].type != VAL_INT) error("'substring' üçüncü argümanı (uzunluk) tamsayı olmalıdır.");
-                
-                const char* str = args[0].as.string_val;
-                int start = args[1].as.int_val;
-                int len_req = args[2].as.int_val;
-                int str_len_actual = strlen(str);
-                
-                if (start < 0 || start > str_len_actual || len_req < 0) {
-                    char err_msg[200];
-                    sprintf(err_msg, "'substring' geçersiz başlangıç (%d) veya uzunluk (%d) (string uzunluğu: %d).", start, len_req, str_len_actual);
-                    error(err_msg);
-                }
-                
-                int actual_len_to_copy = len_req;
-                if (start + len_req > str_len_actual) {
-                    actual_len_to_copy = str_len_actual - start;
-                }
-                if (actual_len_to_copy < 0) actual_len_to_copy = 0; // if start is at str_len_actual
-                
-                char sub[MAX_STRING_LEN];
-                if (actual_len_to_copy > 0 && actual_len_to_copy < MAX_STRING_LEN) {
-                    strncpy(sub, str + start, actual_len_to_copy);
-                } else if (actual_len_to_copy >= MAX_STRING_LEN) {
-                    error("'substring' sonucu MAX_STRING_LEN'den büyük olamaz.");
-                }
-                sub[actual_len_to_copy] = '\0';
-                return create_value_string(sub);
-            } else if (is_keyword(id_token.lexeme, "string_to_int")) {
-                if (num_args_passed != 1) error("'string_to_int' 1 argüman bekler (string).");
-                if (args[0].type != VAL_STRING) error("'string_to_int' argümanı string olmalıdır.");
-                char* endptr;
-                const char* str_to_convert = args[0].as.string_val;
-                errno = 0; // For overflow/underflow detection with strtol
-                long val = strtol(str_to_convert, &endptr, 10);
-                
-                // Check for various conversion errors
-                if (endptr == str_to_convert) { // No digits were found
-                    char err_msg[MAX_STRING_LEN + 100];
-                    sprintf(err_msg, "'string_to_int': '%s' string'i tamsayıya dönüştürülemedi (sayı bulunamadı).", str_to_convert);
-                    error(err_msg);
-                } else if (*endptr != '\0' && !isspace((unsigned char)*endptr)) { // Extra characters after number
-                    char err_msg[MAX_STRING_LEN + 100];
-                    sprintf(err_msg, "'string_to_int': '%s' string'inde sayıdan sonra geçersiz karakterler var.", str_to_convert);
-                    error(err_msg);
-                } else if (errno == ERANGE || val > INT_MAX || val < INT_MIN) {
-                    error("'string_to_int': Değer tamsayı sınırları dışında.");
-                }
-                return create_value_int((int)val);
-            } else if (is_keyword(id_token.lexeme, "string_to_float")) {
-                if (num_args_passed != 1) error("'string_to_float' 1 argüman bekler (string).");
-                if (args[0].type != VAL_STRING) error("'string_to_float' argümanı string olmalıdır.");
-                char* endptr;
-                const char* str_to_convert = args[0].as.string_val;
-                errno = 0; // For overflow/underflow detection with strtod
-                double val = strtod(str_to_convert, &endptr);
-                
-                if (endptr == str_to_convert) {
-                    char err_msg[MAX_STRING_LEN + 100];
-                    sprintf(err_msg, "'string_to_float': '%s' string'i ondalıklı sayıya dönüştürülemedi (sayı bulunamadı).", str_to_convert);
-                    error(err_msg);
-                } else if (*endptr != '\0' && !isspace((unsigned char)*endptr)) {
-                    char err_msg[MAX_STRING_LEN + 100];
-                    sprintf(err_msg, "'string_to_float': '%s' string'inde sayıdan sonra geçersiz karakterler var.", str_to_convert);
-                    error(err_msg);
-                } else if (errno == ERANGE) {
-                    error("'string_to_float': Değer ondalıklı sayı sınırları dışında.");
-                }
-                return create_value_float(val);
-            } else if (is_keyword(id_token.lexeme, "type_of")) {
-                if (num_args_passed != 1) error("'type_of' 1 argüman bekler.");
-                switch(args[0].type) {
-                    case VAL_INT: return create_value_string("int");
-                    case VAL_FLOAT: return create_value_string("float");
-                    case VAL_STRING: return create_value_string("string");
-                    case VAL_BOOLEAN: return create_value_string("boolean");
-                    case VAL_ARRAY_REF: return create_value_string("array");
-                    case VAL_NULL: return create_value_string("null");
-                    default: return create_value_string("unknown");
-                }
-            } else if (is_keyword(id_token.lexeme, "pow")) {
-                if (num_args_passed != 2) error("'pow' 2 argüman bekler (taban, üs).");
-                double base_val, exponent_val;
-                if (args[0].type == VAL_INT) base_val = (double)args[0].as.int_val;
-                else if (args[0].type == VAL_FLOAT) base_val = args[0].as.float_val;
-                else error("'pow' tabanı sayısal olmalıdır (int veya float).");
-                
-                if (args[1].type == VAL_INT) exponent_val = (double)args[1].as.int_val;
-                else if (args[1].type == VAL_FLOAT) exponent_val = args[1].as.float_val;
-                else error("'pow' üssü sayısal olmalıdır (int veya float).");
-                
-                return create_value_float(pow(base_val, exponent_val));
-            }
+            // Dahili Fonksiyonlar: ad çözümlemesi çağrı noktası token'ında önbelleklenir
+            Token* call_tok = &nur->tokens[id_token_idx];
+            if (call_tok->cache_native_idx == -2) call_tok->cache_native_idx = find_native(id_token.lexeme);
+            if (call_tok->cache_native_idx >= 0) return call_native(call_tok->cache_native_idx, args, num_args_passed);
             // Kullanıcı Tanımlı Fonksiyon Çağrısı
-            else {
-                FunctionDefinition* func_to_call = find_function(id_token.lexeme);
-                if (!func_to_call) { 
-                    char err[MAX_IDENT_LEN + 100]; 
-                    sprintf(err, "'%s' adlı fonksiyon veya dahili komut bulunamadı.", id_token.lexeme); 
-                    error(err); 
-                }
-                return execute_function_call(func_to_call, args, num_args_passed);
+            FunctionDefinition* func_to_call = find_function(id_token.lexeme);
+            if (!func_to_call) { 
+                char err[MAX_STRING_LEN + 100]; 
+                sprintf(err, "'%s' adlı fonksiyon veya dahili komut bulunamadı.", id_token.lexeme); 
+                error(err); 
             }
+            return execute_function_call(func_to_call, args, num_args_passed);
         }
         // Dizi Elemanı Erişimi veya Değişken
         else {
             Variable* var = execute ? find_variable(id_token.lexeme) : NULL; 
-            if (execute && !var) { char msg[150]; sprintf(msg, "'%s' adlı değişken/dizi bulunamadı", id_token.lexeme); error(msg); }
+            if (execute && !var) { char msg[MAX_STRING_LEN + 100]; sprintf(msg, "'%s' adlı değişken/dizi bulunamadı", id_token.lexeme); error(msg); }
             
             if (peek_token().type == TOKEN_LBRACKET) { 
-                if (execute && var->type != VAR_ARRAY) { char msg[150]; sprintf(msg, "'%s' bir dizi değil, indisle erişilemez.", id_token.lexeme); error(msg); }
+                if (execute && var->type != VAR_ARRAY) { char msg[MAX_STRING_LEN + 100]; sprintf(msg, "'%s' bir dizi değil, indisle erişilemez.", id_token.lexeme); error(msg); }
                 consume_token(TOKEN_LBRACKET); Value idx_val=evaluate_expression(execute); consume_token(TOKEN_RBRACKET);
                 if (execute) { 
-                    if (idx_val.type != VAL_INT) error("Dizi indisi tamsayı olmalı."); int idx = idx_val.as.int_val;
-                    if (idx<0 || idx>=var->value.array.size){ char msg[200]; sprintf(msg,"Dizi sınırları dışında erişim: %s[%d] (boyut: %d)",id_token.lexeme,idx, var->value.array.size);error(msg);}
+                    if (idx_val.type != VAL_INT) error("Dizi indisi tamsayı olmalı.");
+                    int idx = idx_val.as.int_val;
+                    if (idx<0 || idx>=var->value.array.size){ char msg[MAX_STRING_LEN + 100]; sprintf(msg,"Dizi sınırları dışında erişim: %s[%d] (boyut: %d)",id_token.lexeme,idx, var->value.array.size);error(msg);}
                     
+                    if (var->value.array.element_type == VAR_STRUCT) { // arr[i].alan veya arr[i] (struct referansı)
+                        if (peek_token().type == TOKEN_DOT) return parse_field_access(var, idx, true);
+                        return create_value_struct_ref(var, idx);
+                    }
                     size_t element_s = get_sizeof_element_type(var->value.array.element_type);
                     if(element_s == 0) error("Dizi eleman boyutu sıfır (okuma).");
                     void* el_ptr =(char*)var->value.array.data + idx * element_s;
-                    
-                    switch(var->value.array.element_type){
-                        case VAR_INT: return create_value_int(*(int*)el_ptr); 
-                        case VAR_FLOAT: return create_value_float(*(double*)el_ptr);
-                        case VAR_BOOLEAN: return create_value_bool(*(bool*)el_ptr); 
-                        case VAR_STRING: return create_value_string((char*)el_ptr);
-                        default: error("Dizi elemanı için desteklenmeyen tip (okuma).");
-                    }
+                    if (peek_token().type == TOKEN_DOT) parse_field_access(var, idx, true); // Hata: eleman struct değil
+                    return load_typed_slot(var->value.array.element_type, el_ptr);
                 }
+                if (peek_token().type == TOKEN_DOT) parse_field_access(NULL, -1, false);
                 return create_value_null(); 
+            } else if (peek_token().type == TOKEN_DOT) { // Struct alanı: p.alan
+                return parse_field_access(var, -1, execute);
             } else { // Normal değişken
-                if (execute) { 
-                    if(!var->is_defined && var->type != VAR_ARRAY) { char msg[150]; sprintf(msg, "'%s' değişkeni atanmadan kullanıldı", id_token.lexeme); error(msg); }
-                    switch(var->type){
-                        case VAR_INT: return create_value_int(var->value.int_value); case VAR_FLOAT: return create_value_float(var->value.float_value);
-                        case VAR_STRING: return create_value_string(var->value.string_value); case VAR_BOOLEAN: return create_value_bool(var->value.bool_value);
-                        case VAR_ARRAY: return create_value_array_ref(var); // Return reference to the array itself
-                        default: error("İfadede bilinmeyen değişken tipi.");
-                    }
-                }
-                return create_value_null(); 
+                return execute ? load_variable_value(var) : create_value_null();
             }
         }
     }
     else if (t.type == TOKEN_LPAREN) { consume_token(TOKEN_LPAREN); Value v=evaluate_expression(execute); consume_token(TOKEN_RPAREN); return v;}
     else if (t.type == TOKEN_USER) {  
         consume_token(TOKEN_USER); consume_token(TOKEN_DOT); Token im=consume_token(TOKEN_IDENTIFIER);
+        if(peek_token().type==TOKEN_LPAREN){consume_token(TOKEN_LPAREN);consume_token(TOKEN_RPAREN);} // user.in() ve user.in aynı
         if(execute){ char ib[MAX_STRING_LEN];
-            if(is_keyword(im.lexeme,"in")){int v_in;printf("> ");fflush(stdout);if(scanf("%d",&v_in)!=1){while(getchar()!='\n');error("Geçersiz int girişi.");}int c; while((c=getchar())!='\n'&&c!=EOF);return create_value_int(v_in);}
-            else if(is_keyword(im.lexeme,"in_float")){double v_f;printf("> ");fflush(stdout);if(scanf("%lf",&v_f)!=1){while(getchar()!='\n');error("Geçersiz float girişi.");}int c; while((c=getchar())!='\n'&&c!=EOF);return create_value_float(v_f);}
-            else if(is_keyword(im.lexeme,"in_string")){printf("> ");fflush(stdout);if(!fgets(ib,MAX_STRING_LEN,stdin))error("String okuma hatası.");ib[strcspn(ib,"\n")]=0;return create_value_string(ib);}
-            else if(is_keyword(im.lexeme,"in_boolean")){printf("(true/false)> ");fflush(stdout);if(!fgets(ib,sizeof(ib),stdin))error("Bool okuma hatası.");ib[strcspn(ib,"\n")]=0;
-                if(is_keyword(ib,"true"))return create_value_bool(true);if(is_keyword(ib,"false"))return create_value_bool(false);error("Geçersiz bool girişi. 'true' veya 'false' bekleniyor.");}
-                else{char err[100+MAX_IDENT_LEN];sprintf(err,"Bilinmeyen kullanıcı giriş komutu: user.%s",im.lexeme);error(err);}}
-                return create_value_null();
-    }
-    else { char err[100];sprintf(err,"İfadede beklenmedik token (primary): %s ('%s')",token_type_names[t.type],t.lexeme);error(err);return create_value_null();}
-}
-
-Value parse_unary_expression(bool execute) { 
-    if(peek_token().type==TOKEN_NOT){consume_token(TOKEN_NOT);Value o=parse_unary_expression(execute);if(execute){if(o.type!=VAL_BOOLEAN)error("'!' (NOT) operatörü mantıksal (boolean) bir değer bekler.");return create_value_bool(!o.as.bool_val);}return create_value_null();}
-    else if(peek_token().type==TOKEN_MINUS){consume_token(TOKEN_MINUS);Value o=parse_unary_expression(execute);if(execute){if(o.type==VAL_INT)return create_value_int(-o.as.int_val);if(o.type==VAL_FLOAT)return create_value_float(-o.as.float_val);error("'-' (unary minus) operatörü sayısal bir değer (int veya float) bekler.");}return create_value_null();}
-    return parse_primary_expression(execute);
-}
-Value parse_multiplicative_expression(bool execute) { 
-    Value l=parse_unary_expression(execute); while(peek_token().type==TOKEN_MULTIPLY||peek_token().type==TOKEN_DIVIDE||peek_token().type==TOKEN_MODULO){
-        Token op=consume_token(peek_token().type);Value r=parse_unary_expression(execute);if(execute){
-            if(!((l.type==VAL_INT||l.type==VAL_FLOAT)&&(r.type==VAL_INT||r.type==VAL_FLOAT))){char e[200];sprintf(e,"'%s' operatörü sayısal olmayan operandlarla (%s, %s) kullanılamaz.",op.lexeme, value_type_to_string(l.type), value_type_to_string(r.type));error(e);}
-            double lv=(l.type==VAL_INT)?(double)l.as.int_val:l.as.float_val; double rv=(r.type==VAL_INT)?(double)r.as.int_val:r.as.float_val; // Promote to double for calculation
-            if(op.type==TOKEN_MULTIPLY){bool result_is_float=(l.type==VAL_FLOAT||r.type==VAL_FLOAT);l=result_is_float?create_value_float(lv*rv):create_value_int((int)(lv*rv));}
-            else if(op.type==TOKEN_DIVIDE){if(rv==0.0)error("Sıfıra bölme hatası.");if(l.type==VAL_INT&&r.type==VAL_INT && (int)lv % (int)rv == 0)l=create_value_int((int)(lv/rv));else l=create_value_float(lv/rv);} // Prefer int if exact int division
-            else if(op.type==TOKEN_MODULO){if(l.type!=VAL_INT||r.type!=VAL_INT)error("'%' (modulo) operatörü tamsayı operandlar gerektirir.");if(r.as.int_val==0)error("Sıfıra mod alma hatası.");l=create_value_int(l.as.int_val%r.as.int_val);}}
-            else l=create_value_null(); /* For !execute, just parse and return null */ }return l;
-}
-Value parse_additive_expression(bool execute) { 
-    Value l=parse_multiplicative_expression(execute); while(peek_token().type==TOKEN_PLUS||peek_token().type==TOKEN_MINUS){
-        Token op=consume_token(peek_token().type);Value r=parse_multiplicative_expression(execute);if(execute){
-            if(op.type==TOKEN_PLUS&&(l.type==VAL_STRING||r.type==VAL_STRING)){ // String concatenation
-                char sl_buf[MAX_STRING_LEN], sr_buf[MAX_STRING_LEN]; // Buffers for string representations
-                
-                // Convert left operand to string if not already
-                if(l.type==VAL_STRING) strncpy(sl_buf,l.as.string_val,MAX_STRING_LEN-1);
-                else if(l.type==VAL_INT) snprintf(sl_buf,MAX_STRING_LEN,"%d",l.as.int_val);
-                else if(l.type==VAL_FLOAT) snprintf(sl_buf,MAX_STRING_LEN,"%g",l.as.float_val);
-                else if(l.type==VAL_BOOLEAN) strncpy(sl_buf,l.as.bool_val?"true":"false",MAX_STRING_LEN-1);
-                else if(l.type==VAL_NULL) strncpy(sl_buf,"null",MAX_STRING_LEN-1);
-                else { char e[200]; sprintf(e, "String ile '+' operatörünün sol tarafı birleştirilemeyen tipte: %s", value_type_to_string(l.type)); error(e); }
-                sl_buf[MAX_STRING_LEN-1] = '\0';
-                
-                // Convert right operand to string if not already
-                if(r.type==VAL_STRING) strncpy(sr_buf,r.as.string_val,MAX_STRING_LEN-1);
-                else if(r.type==VAL_INT) snprintf(sr_buf,MAX_STRING_LEN,"%d",r.as.int_val);
-                else if(r.type==VAL_FLOAT) snprintf(sr_buf,MAX_STRING_LEN,"%g",r.as.float_val);
-                else if(r.type==VAL_BOOLEAN) strncpy(sr_buf,r.as.bool_val?"true":"false",MAX_STRING_LEN-1);
-                else if(r.type==VAL_NULL) strncpy(sr_buf,"null",MAX_STRING_LEN-1);
-                else { char e[200]; sprintf(e, "String ile '+' operatörünün sağ tarafı birleştirilemeyen tipte: %s", value_type_to_string(r.type)); error(e); }
-                sr_buf[MAX_STRING_LEN-1] = '\0';
-                
-                if (strlen(sl_buf) + strlen(sr_buf) >= MAX_STRING_LEN) {
-                    error("String birleştirme sonucu MAX_STRING_LEN sınırını aşıyor.");
-                }
-                char result_buf[MAX_STRING_LEN];
-                strcpy(result_buf, sl_buf); // Use strcpy then strcat to avoid snprintf complexities with existing content
-                strcat(result_buf, sr_buf);
-                l=create_value_string(result_buf);}
-                else if((l.type==VAL_INT||l.type==VAL_FLOAT)&&(r.type==VAL_INT||r.type==VAL_FLOAT)){ // Numeric addition/subtraction
-                    double lv=(l.type==VAL_INT)?(double)l.as.int_val:l.as.float_val;double rv=(r.type==VAL_INT)?(double)r.as.int_val:r.as.float_val;
-                    bool result_is_float=(l.type==VAL_FLOAT||r.type==VAL_FLOAT);
-                    if(op.type==TOKEN_PLUS)l=result_is_float?create_value_float(lv+rv):create_value_int((int)(lv+rv));
-                    else if(op.type==TOKEN_MINUS)l=result_is_float?create_value_float(lv-rv):create_value_int((int)(lv-rv));}
-                    else{char e[200];sprintf(e,"'%s' operatörü uyumsuz tiplerle (%s, %s) kullanılamaz (sayısal veya string birleştirme bekleniyor).",op.lexeme,value_type_to_string(l.type),value_type_to_string(r.type));error(e);}}
-                    else l=create_value_null(); /* For !execute */ }return l;
-}
-Value parse_relational_expression(bool execute) { 
-    Value l=parse_additive_expression(execute); while(peek_token().type==TOKEN_GT||peek_token().type==TOKEN_LT||peek_token().type==TOKEN_GTE||peek_token().type==TOKEN_LTE){
-        Token op=consume_token(peek_token().type);Value r=parse_additive_expression(execute);if(execute){bool res=false;
-            if((l.type==VAL_INT||l.type==VAL_FLOAT)&&(r.type==VAL_INT||r.type==VAL_FLOAT)){ // Numeric comparison
-                double lv=(l.type==VAL_INT)?(double)l.as.int_val:l.as.float_val;double rv=(r.type==VAL_INT)?(double)r.as.int_val:r.as.float_val;
-                if(op.type==TOKEN_GT)res=lv>rv;else if(op.type==TOKEN_LT)res=lv<rv;else if(op.type==TOKEN_GTE)res=lv>=rv;else if(op.type==TOKEN_LTE)res=lv<=rv;}
-                else if(l.type==VAL_STRING&&r.type==VAL_STRING){ // String comparison
-                    int cr=strcmp(l.as.string_val,r.as.string_val);
-                    if(op.type==TOKEN_GT)res=cr>0;else if(op.type==TOKEN_LT)res=cr<0;else if(op.type==TOKEN_GTE)res=cr>=0;else if(op.type==TOKEN_LTE)res=cr<=0;}
-                    else{char e[250];sprintf(e,"Karşılaştırma operatörleri ('%s') sayısal veya metin tipleri arasında uygulanabilir. Alınan: %s ve %s.",op.lexeme,value_type_to_string(l.type),value_type_to_string(r.type));error(e);}
-                    l=create_value_bool(res);}else l=create_value_null(); /* For !execute */ }return l;
-}
-Value parse_equality_expression(bool execute) { 
-    Value l=parse_relational_expression(execute);while(peek_token().type==TOKEN_EQ||peek_token().type==TOKEN_NEQ){
-        Token op=consume_token(peek_token().type);Value r=parse_relational_expression(execute);if(execute){bool res=false;
-            if(l.type==r.type){ // Same type comparison
-                switch(l.type){
-                    case VAL_INT:res=(l.as.int_val==r.as.int_val);break;
-                    case VAL_FLOAT:res=(fabs(l.as.float_val-r.as.float_val)<1e-9);break; // Epsilon comparison for floats
-                    case VAL_STRING:res=(strcmp(l.as.string_val,r.as.string_val)==0);break;
-                    case VAL_BOOLEAN:res=(l.as.bool_val==r.as.bool_val);break;
-                    case VAL_NULL:res=true;break; // null == null is true
-                    case VAL_ARRAY_REF: res=(l.as.array_var == r.as.array_var); break; // Array comparison by reference
-                    default:res=false; // Should not happen for known types
-                }
-            } else { // Different types, generally false, except for int/float
-                if((l.type==VAL_INT&&r.type==VAL_FLOAT))res=(fabs((double)l.as.int_val-r.as.float_val)<1e-9);
-                else if((l.type==VAL_FLOAT&&r.type==VAL_INT))res=(fabs(l.as.float_val-(double)r.as.int_val)<1e-9);
-                // null can be compared with other types, it's always false unless other is also null (handled above)
-                else if (l.type == VAL_NULL || r.type == VAL_NULL) res = false;
-                else res=false; // All other different type comparisons are false
-            }
-            if(op.type==TOKEN_NEQ)res=!res; l=create_value_bool(res);}else l=create_value_null(); /* For !execute */ }return l;
+            if(is_keyword(im.lexeme,"in")){long long v_in;prompt("> ");if(!in_read_word(ib,sizeof(ib))||!parse_int_token(ib,&v_in)||v_in<INT_MIN||v_in>INT_MAX){in_skip_line();error("Geçersiz int girişi.");}in_skip_line();return create_value_int((int)v_in);}
+            else if(is_keyword(im.lexeme,"in_float")){double v_f;prompt("> ");if(!in_read_word(ib,sizeof(ib))||!parse_double_token(ib,&v_f)){in_skip_line();error("Geçersiz float girişi.");}in_skip_line();return create_value_float(v_f);}
+            else if(is_keyword(im.lexeme,"in_string")){prompt("> ");if(!in_read_line(ib,MAX_STRING_LEN))error("String okuma hatası.");return create_value_string(ib);}
+            else if(is_keyword(im.lexeme,"in_boolean")){prompt("(true/false)> ");if(!in_read_line(ib,sizeof(ib)))error("Bool okuma hatası.");
+                if(is_keyword(ib,"true"))return create_value_bool(true);
+                if(is_keyword(ib,"false"))return create_value_bool(false);
+                error("Geçersiz bool girişi. 'true' veya 'false' bekleniyor.");}
+            else{char err[100+MAX_STRING_LEN];sprintf(err,"Bilinmeyen kullanıcı giriş komutu: user.%s",im.lexeme);error(err);}}
+        return create_value_null();
+    }
+    else { char err[100+MAX_STRING_LEN];sprintf(err,"İfadede beklenmedik token (primary): %s ('%s')",token_type_names[t.type],t.lexeme);error(err);return create_value_null();}
 }
-Value parse_logical_and_expression(bool execute) { 
-    Value l=parse_equality_expression(execute);while(peek_token().type==TOKEN_AND){
-        consume_token(TOKEN_AND);
-        bool execute_rhs = execute; // Default: execute RHS if overall expression is executed
-        if(execute && l.type==VAL_BOOLEAN && !l.as.bool_val) { // Short-circuit: if LHS is false, no need to eval RHS
-            execute_rhs = false;
+
+// --- Sayısal Aritmetik Kuralları ---
+// int ve u8 değerleri VAL_INT, i64 değerleri VAL_I64, float ve f32 değerleri VAL_FLOAT olarak taşınır.
+// Operandlardan biri float ise işlem double ile yapılır. Aksi halde işlem 64 bit tamsayıyla ve kesin yapılır:
+// operandlardan biri i64 ise sonuç i64, değilse int olur; taşma sessizce sarmaz, hata verir.
+// Bölme: i64 içeren bölme sıfıra doğru kırpılan tamsayı bölmesidir (2^63 üzeri değerler double'a düşüp
+// hassasiyet kaybetmesin diye); int / int tam bölünüyorsa int, bölünmüyorsa ondalıklı sonuç verir.
+Value make_integer_result(long long x, bool wide) {
+    if (wide) return create_value_i64(x);
+    if (x < INT_MIN || x > INT_MAX) error("Tamsayı taşması: sonuç int sınırlarını aşıyor (i64 kullanın).");
+    return create_value_int((int)x);
+}
+// + - * / % için; operandların sayısal olduğu çağıran tarafından denetlenmiş olmalıdır.
+Value apply_numeric_operator(TokenType op, Value l, Value r) {
+    if (l.type == VAL_FLOAT || r.type == VAL_FLOAT) {
+        double lv = value_as_double(l), rv = value_as_double(r);
+        switch (op) {
+            case TOKEN_PLUS: return create_value_float(lv + rv);
+            case TOKEN_MINUS: return create_value_float(lv - rv);
+            case TOKEN_MULTIPLY: return create_value_float(lv * rv);
+            case TOKEN_DIVIDE: if (rv == 0.0) error("Sıfıra bölme hatası."); return create_value_float(lv / rv);
+            default: error("'%' (modulo) operatörü tamsayı operandlar gerektirir."); return create_value_null();
         }
-        Value r=parse_equality_expression(execute_rhs);
-        if(execute){
-            if(l.type!=VAL_BOOLEAN||r.type!=VAL_BOOLEAN)error("'&&' (AND) operatörü mantıksal (boolean) operandlar bekler.");
-            if(!execute_rhs) { // if RHS was short-circuited
-                l=create_value_bool(false); // Result is false
-            } else {
-                l=create_value_bool(l.as.bool_val&&r.as.bool_val);
-            }
+    }
+    bool wide = (l.type == VAL_I64 || r.type == VAL_I64);
+    long long a = value_as_i64(l), b = value_as_i64(r), res = 0;
+    bool overflow = false;
+    switch (op) {
+        case TOKEN_PLUS: overflow = __builtin_add_overflow(a, b, &res); break;
+        case TOKEN_MINUS: overflow = __builtin_sub_overflow(a, b, &res); break;
+        case TOKEN_MULTIPLY: overflow = __builtin_mul_overflow(a, b, &res); break;
+        case TOKEN_DIVIDE:
+            if (b == 0) error("Sıfıra bölme hatası.");
+            if (b == -1 && a == LLONG_MIN) { overflow = true; break; }
+            if (!wide && a % b != 0) return create_value_float((double)a / (double)b); // Prefer int if exact int division
+            res = a / b; break;
+        case TOKEN_MODULO:
+            if (b == 0) error("Sıfıra mod alma hatası.");
+            res = (b == -1) ? 0 : a % b; break;
+        default: error("Bilinmeyen aritmetik operatör.");
+    }
+    if (overflow) error("Tamsayı taşması: sonuç i64 sınırlarını aşıyor.");
+    return make_integer_result(res, wide);
+}
+// Sayısal karşılaştırma: iki tamsayı kesin (64 bit) karşılaştırılır, float varsa double ile.
+int compare_numeric_values(Value l, Value r) {
+    if (value_is_integer(l) && value_is_integer(r)) {
+        long long a = value_as_i64(l), b = value_as_i64(r);
+        return (a > b) - (a < b);
+    }
+    double a = value_as_double(l), b = value_as_double(r);
+    return (a > b) - (a < b);
+}
+
+// --- İfade Derleyici (Pratt) ---
+// Bir ifade ilk karşılaşıldığında tek bir öncelik tablosu üzerinden (precedence climbing) sıkıştırılmış
+// son ek (postfix) düğüm dizisine derlenir; düğümler ifadenin ilk token'ında önbelleklenir ve sonraki
+// değerlendirmeler token'ları yeniden ayrıştırmadan düğümleri açık bir değer yığınında çalıştırır.
+// Uzun operatör zincirleri döngüyle derlenir; yalnızca parantez ve tekli operatör iç içeliği özyinelemeye
+// yol açar ve MAX_EXPR_DEPTH ile sınırlıdır. Çağrı, dizi elemanı, alan erişimi ve user.* gibi karmaşık
+// birincil ifadeler PRIMARY düğümü olarak kalır ve parse_primary_expression ile değerlendirilir.
+enum { EXPR_LIT, EXPR_VAR, EXPR_PRIMARY, EXPR_UNARY, EXPR_BINARY, EXPR_AND, EXPR_OR, EXPR_LOGIC_END };
+
+// İkili operatör öncelikleri (0: ikili operatör değil). Tekli '!' ve '-' hepsinden sıkı bağlanır.
+static const unsigned char binary_precedence[TOKEN_NOT + 1] = {
+    [TOKEN_OR] = 1, [TOKEN_AND] = 2, [TOKEN_EQ] = 3, [TOKEN_NEQ] = 3,
+    [TOKEN_GT] = 4, [TOKEN_LT] = 4, [TOKEN_GTE] = 4, [TOKEN_LTE] = 4,
+    [TOKEN_PLUS] = 5, [TOKEN_MINUS] = 5, [TOKEN_MULTIPLY] = 6, [TOKEN_DIVIDE] = 6, [TOKEN_MODULO] = 6,
+};
+
+int emit_expr_node(int kind, int op, int tok) {
+    ExprBuilder* b = nur->expr_builder;
+    if (b->count == b->cap) {
+        b->cap = b->cap ? b->cap * 2 : 16;
+        b->nodes = realloc(b->nodes, (size_t)b->cap * sizeof(ExprNode));
+        if (!b->nodes) error("İfade düğümleri için bellek ayrılamadı.");
+    }
+    b->nodes[b->count] = (ExprNode){ (unsigned char)kind, (unsigned char)op, tok, -1 };
+    return b->count++;
+}
+static inline TokenType peek_token_type() { return nur->current_token_idx < nur->num_tokens ? nur->tokens[nur->current_token_idx].type : TOKEN_EOF; }
+void compile_expression_prec(int min_prec);
+// Derinlik sayacı iç içe çağrı argümanlarında da artar: f(f(f(...))) de aynı sınıra tabidir.
+void compile_prefix_expression() {
+    if (++nur->expr_depth > MAX_EXPR_DEPTH) error("İfade çok derin iç içe geçmiş.");
+    TokenType type = peek_token_type();
+    int idx = nur->current_token_idx;
+    switch (type) {
+        case TOKEN_NOT: case TOKEN_MINUS:
+            consume_token(type); compile_prefix_expression(); emit_expr_node(EXPR_UNARY, type, idx); break;
+        case TOKEN_LPAREN:
+            consume_token(TOKEN_LPAREN); compile_expression_prec(0); consume_token(TOKEN_RPAREN); break;
+        case TOKEN_INT_LITERAL: case TOKEN_FLOAT_LITERAL: case TOKEN_STRING_LITERAL: case TOKEN_TRUE: case TOKEN_FALSE:
+            consume_token(type); emit_expr_node(EXPR_LIT, type, idx); break;
+        case TOKEN_IDENTIFIER: {
+            TokenType next = idx + 1 < nur->num_tokens ? nur->tokens[idx + 1].type : TOKEN_EOF;
+            bool spawn_expr = next == TOKEN_IDENTIFIER && is_keyword(nur->tokens[idx].lexeme, "spawn");
+            if (next != TOKEN_LPAREN && next != TOKEN_LBRACKET && next != TOKEN_DOT && !spawn_expr) { consume_token(TOKEN_IDENTIFIER); emit_expr_node(EXPR_VAR, 0, idx); break; }
+        } // fall through
+        default:
+            parse_primary_expression(false); // Yalnızca token'ları geçer (ve iç ifadeleri derler)
+            emit_expr_node(EXPR_PRIMARY, 0, idx);
+    }
+    nur->expr_depth--;
+}
+void compile_expression_prec(int min_prec) {
+    compile_prefix_expression();
+    for (;;) {
+        TokenType op = peek_token_type();
+        int prec = op <= TOKEN_NOT ? binary_precedence[op] : 0;
+        if (prec <= min_prec) return;
+        int op_idx = nur->current_token_idx;
+        consume_token(op);
+        if (op == TOKEN_AND || op == TOKEN_OR) { // Kısa devre: sol taraf sonucu belirliyorsa sağ taraf atlanır
+            int jump = emit_expr_node(op == TOKEN_AND ? EXPR_AND : EXPR_OR, op, op_idx);
+            compile_expression_prec(prec);
+            emit_expr_node(EXPR_LOGIC_END, op, op_idx);
+            nur->expr_builder->nodes[jump].jump = nur->expr_builder->count;
         } else {
-            l=create_value_null(); /* For !execute */
+            compile_expression_prec(prec); // Sol birleşmeli: sağ tarafa yalnızca daha sıkı operatörler girer
+            emit_expr_node(EXPR_BINARY, op, op_idx);
         }
-    } return l;
+    }
 }
-Value parse_logical_or_expression(bool execute) { 
-    Value l=parse_logical_and_expression(execute);while(peek_token().type==TOKEN_OR){
-        consume_token(TOKEN_OR);
-        bool execute_rhs = execute;
-        if(execute && l.type==VAL_BOOLEAN && l.as.bool_val) { // Short-circuit: if LHS is true, no need to eval RHS
-            execute_rhs = false;
+
+// String birleştirmede sayı, boolean ve null metne çevrilir.
+void value_to_concat_text(Value v, char* buf, const char* side) {
+    switch (v.type) {
+        case VAL_STRING: strcpy(buf, v.as.string_val); break;
+        case VAL_INT: format_int(buf, v.as.int_val); break;
+        case VAL_I64: format_int(buf, v.as.i64_val); break;
+        case VAL_FLOAT: format_double_ex(buf, v.as.float_val, v.f32); break;
+        case VAL_BOOLEAN: strcpy(buf, v.as.bool_val ? "true" : "false"); break;
+        case VAL_NULL: strcpy(buf, "null"); break;
+        default: { char e[200]; sprintf(e, "String ile '+' operatörünün %s tarafı birleştirilemeyen tipte: %s", side, value_type_to_string(v.type)); error(e); }
+    }
+}
+bool values_equal(Value l, Value r) {
+    if (l.type == r.type) {
+        switch (l.type) {
+            case VAL_INT: return l.as.int_val == r.as.int_val;
+            case VAL_I64: return l.as.i64_val == r.as.i64_val;
+            case VAL_HANDLE: return l.as.handle == r.as.handle;
+            case VAL_CHANNEL: return l.as.channel == r.as.channel;
+            case VAL_GENERATOR: return l.as.generator == r.as.generator;
+            case VAL_FLOAT: return fabs(l.as.float_val - r.as.float_val) < 1e-9; // Epsilon comparison for floats
+            case VAL_STRING: return strcmp(l.as.string_val, r.as.string_val) == 0;
+            case VAL_BOOLEAN: return l.as.bool_val == r.as.bool_val;
+            case VAL_NULL: return true; // null == null is true
+            case VAL_ARRAY_REF: return l.as.array_var == r.as.array_var; // Array comparison by reference
+            case VAL_STRUCT_REF: return l.as.struct_ref.var == r.as.struct_ref.var && l.as.struct_ref.index == r.as.struct_ref.index; // By reference, like arrays
+            default: return false;
         }
-        Value r=parse_logical_and_expression(execute_rhs);
-        if(execute){
-            if(l.type!=VAL_BOOLEAN||r.type!=VAL_BOOLEAN)error("'||' (OR) operatörü mantıksal (boolean) operandlar bekler.");
-            if(!execute_rhs) { // if RHS was short-circuited
-                l=create_value_bool(true); // Result is true
-            } else {
-                l=create_value_bool(l.as.bool_val||r.as.bool_val);
+    }
+    if (value_is_integer(l) && value_is_integer(r)) return value_as_i64(l) == value_as_i64(r); // int/i64 kesin karşılaştırılır
+    if (value_is_numeric(l) && value_is_numeric(r)) return fabs(value_as_double(l) - value_as_double(r)) < 1e-9;
+    return false; // null ve diğer farklı tipler eşit değildir
+}
+// l yığındaki sol operand; sonuç onun yerine yazılır (string birleştirme ek kopya yapmaz).
+void apply_binary_operator(TokenType op, const char* lexeme, Value* l, const Value* r) {
+    switch (op) {
+        case TOKEN_PLUS:
+            if (l->type == VAL_STRING || r->type == VAL_STRING) {
+                char rb[MAX_STRING_LEN];
+                if (l->type != VAL_STRING) { char lb[MAX_STRING_LEN]; value_to_concat_text(*l, lb, "sol"); strcpy(l->as.string_val, lb); l->type = VAL_STRING; }
+                value_to_concat_text(*r, rb, "sağ");
+                size_t ln = strlen(l->as.string_val), rn = strlen(rb);
+                if (ln + rn >= MAX_STRING_LEN) error("String birleştirme sonucu MAX_STRING_LEN sınırını aşıyor.");
+                memcpy(l->as.string_val + ln, rb, rn + 1);
+                return;
+            } // fall through
+        case TOKEN_MINUS: case TOKEN_MULTIPLY: case TOKEN_DIVIDE: case TOKEN_MODULO:
+            if (!(value_is_numeric(*l) && value_is_numeric(*r))) {
+                char e[250];
+                if (op == TOKEN_PLUS || op == TOKEN_MINUS) sprintf(e, "'%s' operatörü uyumsuz tiplerle (%s, %s) kullanılamaz (sayısal veya string birleştirme bekleniyor).", lexeme, value_type_to_string(l->type), value_type_to_string(r->type));
+                else sprintf(e, "'%s' operatörü sayısal olmayan operandlarla (%s, %s) kullanılamaz.", lexeme, value_type_to_string(l->type), value_type_to_string(r->type));
+                error(e);
             }
-        } else {
-            l=create_value_null(); /* For !execute */
+            *l = apply_numeric_operator(op, *l, *r);
+            return;
+        case TOKEN_GT: case TOKEN_LT: case TOKEN_GTE: case TOKEN_LTE: {
+            int cr;
+            if (value_is_numeric(*l) && value_is_numeric(*r)) cr = compare_numeric_values(*l, *r);
+            else if (l->type == VAL_STRING && r->type == VAL_STRING) cr = strcmp(l->as.string_val, r->as.string_val);
+            else { char e[250]; sprintf(e, "Karşılaştırma operatörleri ('%s') sayısal veya metin tipleri arasında uygulanabilir. Alınan: %s ve %s.", lexeme, value_type_to_string(l->type), value_type_to_string(r->type)); error(e); return; }
+            *l = create_value_bool(op == TOKEN_GT ? cr > 0 : op == TOKEN_LT ? cr < 0 : op == TOKEN_GTE ? cr >= 0 : cr <= 0);
+            return;
+        }
+        case TOKEN_EQ: case TOKEN_NEQ: *l = create_value_bool(values_equal(*l, *r) == (op == TOKEN_EQ)); return;
+        default: error("Bilinmeyen ikili operatör.");
+    }
+}
+Value literal_token_value(const Token* t) {
+    switch (t->type) {
+        case TOKEN_INT_LITERAL: return (t->int_value > INT_MAX) ? create_value_i64(t->int_value) : create_value_int((int)t->int_value);
+        case TOKEN_FLOAT_LITERAL: return create_value_float(t->float_value);
+        case TOKEN_STRING_LITERAL: return create_value_string(t->string_value);
+        default: return create_value_bool(t->type == TOKEN_TRUE);
+    }
+}
+static inline Value* eval_push() {
+    if (nur->eval_sp >= MAX_EXPR_STACK) error("İfade değerlendirme yığını taştı.");
+    return &nur->eval_stack[nur->eval_sp++];
+}
+// Düğüm ve ifade tabloları PRIMARY değerlendirmesi sırasında (iç ifadeler ilk kez derlenirken) büyüyebilir;
+// bu yüzden düğümlere her adımda indisle erişilir.
+Value run_compiled_expression(int expr_idx) {
+    int first = nur->exprs[expr_idx].first, end = first + nur->exprs[expr_idx].count, end_token = nur->exprs[expr_idx].end_token;
+    int base = nur->eval_sp;
+    for (int i = first; i < end; ) {
+        ExprNode n = nur->expr_nodes[i++];
+        switch (n.kind) {
+            case EXPR_LIT: *eval_push() = literal_token_value(&nur->tokens[n.tok]); break;
+            case EXPR_VAR: {
+                Variable* var = find_variable(nur->tokens[n.tok].lexeme);
+                if (!var) { nur->current_token_idx = n.tok; char msg[150]; sprintf(msg, "'%s' adlı değişken/dizi bulunamadı", nur->tokens[n.tok].lexeme); error(msg); }
+                *eval_push() = load_variable_value(var);
+                break;
+            }
+            case EXPR_PRIMARY: { nur->current_token_idx = n.tok; Value v = parse_primary_expression(true); *eval_push() = v; break; }
+            case EXPR_UNARY: {
+                Value* o = &nur->eval_stack[nur->eval_sp - 1];
+                nur->current_token_idx = n.tok;
+                if (n.op == TOKEN_NOT) {
+                    if (o->type != VAL_BOOLEAN) error("'!' (NOT) operatörü mantıksal (boolean) bir değer bekler.");
+                    o->as.bool_val = !o->as.bool_val;
+                } else if (value_is_integer(*o)) *o = apply_numeric_operator(TOKEN_MINUS, o->type == VAL_I64 ? create_value_i64(0) : create_value_int(0), *o);
+                else if (o->type == VAL_FLOAT) o->as.float_val = -o->as.float_val;
+                else error("'-' (unary minus) operatörü sayısal bir değer (int veya float) bekler.");
+                break;
+            }
+            case EXPR_BINARY:
+                nur->current_token_idx = n.tok;
+                apply_binary_operator((TokenType)n.op, nur->tokens[n.tok].lexeme, &nur->eval_stack[nur->eval_sp - 2], &nur->eval_stack[nur->eval_sp - 1]);
+                nur->eval_sp--;
+                break;
+            case EXPR_AND: case EXPR_OR: {
+                Value* l = &nur->eval_stack[nur->eval_sp - 1];
+                nur->current_token_idx = n.tok;
+                if (l->type != VAL_BOOLEAN) error(n.kind == EXPR_AND ? "'&&' (AND) operatörü mantıksal (boolean) operandlar bekler." : "'||' (OR) operatörü mantıksal (boolean) operandlar bekler.");
+                if (l->as.bool_val == (n.kind == EXPR_OR)) i = first + n.jump; // Sonuç belli: sol değer kalır
+                else nur->eval_sp--; // Sonuç sağ tarafın değeri olur
+                break;
+            }
+            case EXPR_LOGIC_END:
+                nur->current_token_idx = n.tok;
+                if (nur->eval_stack[nur->eval_sp - 1].type != VAL_BOOLEAN) error(n.op == TOKEN_AND ? "'&&' (AND) operatörü mantıksal (boolean) operandlar bekler." : "'||' (OR) operatörü mantıksal (boolean) operandlar bekler.");
+                break;
+        }
+    }
+    nur->current_token_idx = end_token;
+    nur->eval_sp = base;
+    return nur->eval_stack[base];
+}
+Value evaluate_expression(bool execute) {
+    int start = nur->current_token_idx;
+    if (start >= nur->num_tokens) error("İfade bekleniyordu.");
+    int cached = nur->tokens[start].expr_cache;
+    if (cached < 0) {
+        ExprBuilder b = {0}, *saved_builder = nur->expr_builder;
+        nur->expr_builder = &b;
+        compile_expression_prec(0);
+        nur->expr_builder = saved_builder;
+        if (nur->num_expr_nodes + b.count > nur->expr_nodes_cap) {
+            while (nur->num_expr_nodes + b.count > nur->expr_nodes_cap) nur->expr_nodes_cap = nur->expr_nodes_cap ? nur->expr_nodes_cap * 2 : 1024;
+            nur->expr_nodes = realloc(nur->expr_nodes, (size_t)nur->expr_nodes_cap * sizeof(ExprNode));
+        }
+        if (nur->num_exprs == nur->exprs_cap) {
+            nur->exprs_cap = nur->exprs_cap ? nur->exprs_cap * 2 : 256;
+            nur->exprs = realloc(nur->exprs, (size_t)nur->exprs_cap * sizeof(CompiledExpr));
         }
-    }return l;
+        if (!nur->expr_nodes || !nur->exprs) error("İfade önbelleği için bellek ayrılamadı.");
+        memcpy(nur->expr_nodes + nur->num_expr_nodes, b.nodes, (size_t)b.count * sizeof(ExprNode));
+        free(b.nodes);
+        nur->exprs[nur->num_exprs] = (CompiledExpr){ nur->num_expr_nodes, b.count, nur->current_token_idx };
+        nur->num_expr_nodes += b.count;
+        cached = nur->tokens[start].expr_cache = nur->num_exprs++;
+        if (!execute) return create_value_null();
+        nur->current_token_idx = start;
+    } else if (!execute) { nur->current_token_idx = nur->exprs[cached].end_token; return create_value_null(); }
+    return run_compiled_expression(cached);
 }
-Value evaluate_expression(bool execute) { return parse_logical_or_expression(execute); }
 
 // --- Deyim Çözümleyicileri ---
 Value parse_assignment_rhs(VarType expected_lhs_type, bool execute) { 
     Value rhs_val=evaluate_expression(execute);
     if(execute){
-        bool types_compatible=false;
-        if(expected_lhs_type==VAR_INT && rhs_val.type==VAL_INT) types_compatible=true;
-        else if(expected_lhs_type==VAR_FLOAT && rhs_val.type==VAL_FLOAT) types_compatible=true;
-        else if(expected_lhs_type==VAR_FLOAT && rhs_val.type==VAL_INT){rhs_val=create_value_float((double)rhs_val.as.int_val);types_compatible=true;} // Auto-promote int to float
-        else if(expected_lhs_type==VAR_STRING && rhs_val.type==VAL_STRING) types_compatible=true;
-        else if(expected_lhs_type==VAR_BOOLEAN && rhs_val.type==VAL_BOOLEAN) types_compatible=true;
-        else if(expected_lhs_type==VAR_NULL_TYPE) types_compatible=true; // Internal use, e.g. when LHS type isn't known yet during parsing phase
+        bool types_compatible=coerce_value_to_var_type(expected_lhs_type,&rhs_val); // Auto-promotes int to float, checks integer ranges
         
         if(!types_compatible){
             char err_msg[250];
@@ -927,25 +5384,87 @@ Value parse_assignment_rhs(VarType expected_lhs_type, bool execute) {
     return rhs_val;
 }
 
-VarType parse_type_specifier() {
+// resolve_struct false: struct adı burada aranmaz (last_type_struct_idx -1 olur), deyim çalıştırıldığında çözülür.
+// Çalıştırılmayan ayrıştırma (1. geçiş, atlanan dallar) içe aktarılan modülde bildirilen struct'ları henüz göremez.
+VarType parse_type_specifier_ex(bool resolve_struct) {
     Token type_token = peek_token();
     if (type_token.type == TOKEN_INT_TYPE) { consume_token(TOKEN_INT_TYPE); return VAR_INT; }
     if (type_token.type == TOKEN_STRING_TYPE) { consume_token(TOKEN_STRING_TYPE); return VAR_STRING; }
     if (type_token.type == TOKEN_FLOAT_TYPE) { consume_token(TOKEN_FLOAT_TYPE); return VAR_FLOAT; }
     if (type_token.type == TOKEN_BOOLEAN_TYPE) { consume_token(TOKEN_BOOLEAN_TYPE); return VAR_BOOLEAN; }
     if (type_token.type == TOKEN_VOID_TYPE) { consume_token(TOKEN_VOID_TYPE); return VAR_VOID; } 
+    if (type_token.type == TOKEN_I64_TYPE) { consume_token(TOKEN_I64_TYPE); return VAR_I64; }
+    if (type_token.type == TOKEN_F32_TYPE) { consume_token(TOKEN_F32_TYPE); return VAR_F32; }
+    if (type_token.type == TOKEN_U8_TYPE) { consume_token(TOKEN_U8_TYPE); return VAR_U8; }
+    if (type_token.type == TOKEN_HANDLE_TYPE) { consume_token(TOKEN_HANDLE_TYPE); return VAR_HANDLE; }
+    if (type_token.type == TOKEN_IDENTIFIER && is_keyword(type_token.lexeme, "chan") && peek_next_token().type == TOKEN_LT) { // chan<T>
+        consume_token(TOKEN_IDENTIFIER); consume_token(TOKEN_LT);
+        VarType elem = parse_type_specifier();
+        if (!channel_element_type_ok(elem)) error("Kanal eleman tipi int, i64, u8, float, f32, string veya boolean olmalıdır.");
+        consume_token(TOKEN_GT);
+        nur->last_type_elem = elem;
+        return VAR_CHANNEL;
+    }
+    if (type_token.type == TOKEN_IDENTIFIER && is_keyword(type_token.lexeme, "gen") && peek_next_token().type == TOKEN_LT) { // gen<T>
+        consume_token(TOKEN_IDENTIFIER); consume_token(TOKEN_LT);
+        VarType elem = parse_type_specifier();
+        if (!channel_element_type_ok(elem)) error("Üreteç eleman tipi int, i64, u8, float, f32, string veya boolean olmalıdır.");
+        consume_token(TOKEN_GT);
+        nur->last_type_elem = elem;
+        return VAR_GENERATOR;
+    }
+    if (type_token.type == TOKEN_IDENTIFIER) { // Kullanıcı tanımlı struct tipi
+        int sidx = resolve_struct ? find_struct(type_token.lexeme) : -1;
+        if (resolve_struct && sidx < 0) { char err[MAX_STRING_LEN + 100]; sprintf(err, "'%s' adlı tip (struct) tanımlı değil.", type_token.lexeme); error(err); }
+        consume_token(TOKEN_IDENTIFIER);
+        nur->last_type_struct_idx = sidx;
+        return VAR_STRUCT;
+    }
     error("Geçersiz veya beklenmeyen tip belirteci.");
     return VAR_NULL_TYPE; // Should not be reached due to error
 }
+VarType parse_type_specifier() { return parse_type_specifier_ex(true); }
 
 void parse_var_declaration(bool execute, bool is_in_for_initializer) {
     consume_token(TOKEN_VAR); Token name_token=consume_token(TOKEN_IDENTIFIER); consume_token(TOKEN_COLON);
-    VarType declared_base_type = parse_type_specifier(); 
+    VarType declared_base_type = parse_type_specifier_ex(execute); 
+    int struct_idx = (declared_base_type == VAR_STRUCT) ? nur->last_type_struct_idx : -1;
+    VarType chan_elem = nur->last_type_elem;
     if(declared_base_type == VAR_VOID && !is_in_for_initializer) { // Allow void for function return type, not var decl. For initializer could be part of function-like construct (not standard C*).
         error("Değişken 'void' tipinde olamaz.");
     }
     
     int array_size=0; VarType final_type = declared_base_type;
+    if(peek_token().type==TOKEN_LBRACKET && nur->tokens[nur->current_token_idx+1].type==TOKEN_RBRACKET){ // 'var a: T[] = map_file(...)'
+        consume_token(TOKEN_LBRACKET); consume_token(TOKEN_RBRACKET);
+        if(declared_base_type!=VAR_INT && declared_base_type!=VAR_I64 && declared_base_type!=VAR_U8 && declared_base_type!=VAR_FLOAT && declared_base_type!=VAR_F32)
+            error("Dosya destekli diziler yalnızca sayısal eleman tipleriyle (int/i32, i64, u8, float, f32) tanımlanabilir.");
+        if(is_in_for_initializer) error("Dosya destekli dizi 'for' başlatıcısında tanımlanamaz.");
+        if(peek_token().type!=TOKEN_ASSIGN) error("Boyutsuz dizi ('T[]') bir map_file(...) ile başlatılmalıdır.");
+        consume_token(TOKEN_ASSIGN);
+        // Başlatıcının kendisi map_file çağrısı olmalı: eşleme bağlanmadan bir ifadenin içinde kaybolmasın
+        if(peek_token().type!=TOKEN_IDENTIFIER || !is_keyword(peek_token().lexeme,"map_file") || peek_next_token().type!=TOKEN_LPAREN)
+            error("Boyutsuz dizi ('T[]') bir map_file(...) ile başlatılmalıdır.");
+        consume_token(TOKEN_IDENTIFIER); consume_token(TOKEN_LPAREN);
+        Value args[3]; int num_args = 0;
+        if(peek_token().type!=TOKEN_RPAREN) {
+            do {
+                if(num_args >= 3) error("'map_file' 1-3 argüman bekler (yol, kip, erişim ipucu).");
+                args[num_args++] = evaluate_expression(execute); // İç içe map_file burada reddedilir
+                if(peek_token().type==TOKEN_COMMA) consume_token(TOKEN_COMMA); else break;
+            } while(true);
+        }
+        consume_token(TOKEN_RPAREN);
+        if(peek_token().type!=TOKEN_SEMICOLON) error("Boyutsuz dizi ('T[]') bir map_file(...) ile başlatılmalıdır.");
+        if(execute){
+            nur->mapping_allowed = true;
+            Value mapping = native_map_file(args, num_args);
+            nur->mapping_allowed = false;
+            declare_mapped_array(name_token.lexeme, declared_base_type, mapping, false);
+        }
+        consume_token(TOKEN_SEMICOLON);
+        return;
+    }
     if(peek_token().type==TOKEN_LBRACKET){
         if (declared_base_type == VAR_VOID) error("Void tipinde dizi tanımlanamaz.");
         consume_token(TOKEN_LBRACKET);
@@ -961,15 +5480,22 @@ void parse_var_declaration(bool execute, bool is_in_for_initializer) {
             array_size=1; // Dummy size for parsing when not executing
         }
     }
+    // İsteğe bağlı yerleşim notu: 'var ps: Nokta[n] soa;' struct dizisini alan başına bir sütun olarak saklar
+    bool soa_layout = false;
+    if(final_type==VAR_ARRAY && peek_token().type==TOKEN_IDENTIFIER && is_keyword(peek_token().lexeme,"soa")){
+        consume_token(TOKEN_IDENTIFIER);
+        if(declared_base_type!=VAR_STRUCT) error("'soa' yerleşimi yalnızca struct dizilerinde kullanılabilir.");
+        soa_layout = true;
+    }
     
     Variable* var_ptr=NULL; 
     if(execute){
-        var_ptr=declare_variable(name_token.lexeme,final_type,is_in_for_initializer, (final_type == VAR_ARRAY ? declared_base_type : VAR_NULL_TYPE), array_size);
+        var_ptr=declare_variable(name_token.lexeme,final_type,is_in_for_initializer, (final_type == VAR_ARRAY ? declared_base_type : VAR_NULL_TYPE), array_size, struct_idx);
+        if(soa_layout) var_ptr->value.array.soa = true;
     } else if(is_in_for_initializer){ // If not executing but it's a for loop initializer, still track the var name for later removal
-        if(for_loop_var_stack_ptr+1<MAX_LOOP_NESTING){
-            for_loop_var_stack_ptr++;
-            strncpy(for_loop_vars_stack[for_loop_var_stack_ptr],name_token.lexeme,MAX_IDENT_LEN-1);
-            for_loop_vars_stack[for_loop_var_stack_ptr][MAX_IDENT_LEN-1]='\0';
+        if(nur->for_loop_var_stack_ptr+1<MAX_LOOP_NESTING){
+            nur->for_loop_var_stack_ptr++;
+            copy_bounded(nur->for_loop_vars_stack[nur->for_loop_var_stack_ptr], name_token.lexeme, MAX_IDENT_LEN);
         } else {
             error("For döngüsü değişken yığını taştı (MAX_LOOP_NESTING).");
         }
@@ -982,16 +5508,18 @@ void parse_var_declaration(bool execute, bool is_in_for_initializer) {
         Value rhs_val=parse_assignment_rhs(declared_base_type,execute); // Use declared_base_type for RHS check
         if(execute && var_ptr){ // var_ptr should be non-NULL if execute is true
             var_ptr->is_defined=true;
-            switch(declared_base_type){ // Assignment to non-array variable
-                case VAR_INT:var_ptr->value.int_value=rhs_val.as.int_val;break;
-                case VAR_FLOAT:var_ptr->value.float_value=rhs_val.as.float_val;break;
-                case VAR_STRING:strncpy(var_ptr->value.string_value,rhs_val.as.string_val,MAX_STRING_LEN-1);var_ptr->value.string_value[MAX_STRING_LEN-1]='\0';break;
-                case VAR_BOOLEAN:var_ptr->value.bool_value=rhs_val.as.bool_val;break;
-                default: /* Should be caught by type check or VAR_VOID check */ break;
+            if(declared_base_type==VAR_STRUCT && struct_idx_of_ref(rhs_val)!=struct_idx){
+                char err_msg[2*MAX_IDENT_LEN+100]; sprintf(err_msg,"Tip uyuşmazlığı: '%s' tipindeki değişkene '%s' struct'ı atanamaz.",nur->struct_table[struct_idx].name,nur->struct_table[struct_idx_of_ref(rhs_val)].name); error(err_msg);
             }
+            if(declared_base_type==VAR_STRUCT) copy_struct_value(var_ptr,-1,rhs_val);
+            else store_typed_slot(declared_base_type,scalar_variable_slot(var_ptr),rhs_val); // Assignment to non-array variable
+            if(declared_base_type==VAR_CHANNEL) channel_bind(resolve_channel("chan", rhs_val), chan_elem); // channel(n) ile oluşturulan kanalın tipini sabitler
         }
+    } else if(execute && var_ptr && final_type==VAR_CHANNEL) { // 'var c: chan<int>;' varsayılan kapasiteli bir kanal oluşturur
+        store_typed_slot(VAR_CHANNEL, scalar_variable_slot(var_ptr), channel_create(CHANNEL_DEFAULT_CAPACITY, chan_elem));
+        var_ptr->is_defined=true;
     } else { // No assignment
-        if(execute && var_ptr && final_type!=VAR_ARRAY) {
+        if(execute && var_ptr && final_type!=VAR_ARRAY && final_type!=VAR_STRUCT) {
             // Non-array variables are marked as undefined if not initialized.
             // Arrays are considered "defined" (memory allocated, elements default-initialized) upon declaration.
             var_ptr->is_defined=false; 
@@ -1005,17 +5533,18 @@ void parse_assignment(bool execute) {
     Variable* target_var = execute ? find_variable(ident_token.lexeme) : NULL;
     
     if(execute && !target_var){
-        char msg[100+MAX_IDENT_LEN];
+        char msg[100+MAX_STRING_LEN];
         sprintf(msg,"Atama yapılacak '%s' değişkeni bulunamadı.",ident_token.lexeme);
         error(msg);
     }
     
     VarType effective_lhs_type = VAR_NULL_TYPE; // Type of the actual L-value (var or var[idx])
     void* array_element_target_ptr = NULL;    // If L-value is an array element, points to it
+    int element_idx = -1;                     // Struct dizisi elemanı hedefleniyorsa indisi
     
     if(peek_token().type==TOKEN_LBRACKET){ // Array element assignment: ident[expr] = ...
         if(execute && target_var->type != VAR_ARRAY) {
-            char msg[150]; sprintf(msg, "'%s' bir dizi değil, indisle atama yapılamaz.", ident_token.lexeme); error(msg);
+            char msg[MAX_STRING_LEN + 100]; sprintf(msg, "'%s' bir dizi değil, indisle atama yapılamaz.", ident_token.lexeme); error(msg);
         }
         consume_token(TOKEN_LBRACKET);
         Value index_val = evaluate_expression(execute);
@@ -1032,63 +5561,90 @@ void parse_assignment(bool execute) {
                 sprintf(err_msg,"Dizi sınırları dışında atama: '%s[%d]' (boyut: %d)",target_var->name,idx, target_var->value.array.size);
                 error(err_msg);
             }
-            size_t element_s = get_sizeof_element_type(target_var->value.array.element_type);
-            if(element_s == 0) error("Dizi eleman boyutu sıfır (atama).");
-            array_element_target_ptr = (char*)target_var->value.array.data + idx * element_s;
+            element_idx = idx;
+            if(target_var->value.array.read_only){ char err_msg[100+MAX_IDENT_LEN]; sprintf(err_msg,"'%s' salt okunur eşlenmiş bir dizi; elemanlarına atama yapılamaz.",target_var->name); error(err_msg); }
+            if(effective_lhs_type != VAR_STRUCT){
+                size_t element_s = get_sizeof_element_type(target_var->value.array.element_type);
+                if(element_s == 0) error("Dizi eleman boyutu sıfır (atama).");
+                array_element_target_ptr = (char*)target_var->value.array.data + idx * element_s;
+            }
         }
     } else { // Simple variable assignment: ident = ...
         if(target_var) effective_lhs_type = target_var->type;
         // else if !execute, effective_lhs_type remains VAR_NULL_TYPE
     }
     
+    if(peek_token().type==TOKEN_DOT){ // Struct alanı ataması: p.alan = ... veya arr[i].alan = ...
+        consume_token(TOKEN_DOT);
+        int field_token_idx = nur->current_token_idx;
+        consume_token(TOKEN_IDENTIFIER);
+        if(execute && target_var){
+            if(effective_lhs_type != VAR_STRUCT){ char msg[MAX_STRING_LEN + 100]; sprintf(msg, "'%s' bir struct değil, '.' ile alan ataması yapılamaz.", ident_token.lexeme); error(msg); }
+            int sidx = (target_var->type == VAR_STRUCT) ? target_var->value.record.struct_idx : target_var->value.array.struct_idx;
+            int field_idx = resolve_struct_field(sidx, field_token_idx);
+            effective_lhs_type = nur->struct_table[sidx].fields[field_idx].type;
+            array_element_target_ptr = struct_field_ptr(target_var, element_idx, field_idx);
+        }
+    }
+    
     consume_token(TOKEN_ASSIGN);
     Value rhs_val = parse_assignment_rhs(effective_lhs_type, execute);
     
     if(execute && target_var){ // target_var must be non-null
-        if(array_element_target_ptr){ // Assigning to array element
-            switch(effective_lhs_type){ // which is target_var->value.array.element_type
-                case VAR_INT:    *((int*)array_element_target_ptr) = rhs_val.as.int_val; break;
-                case VAR_FLOAT:  *((double*)array_element_target_ptr) = rhs_val.as.float_val; break;
-                case VAR_BOOLEAN:*((bool*)array_element_target_ptr) = rhs_val.as.bool_val; break;
-                case VAR_STRING: strncpy((char*)array_element_target_ptr, rhs_val.as.string_val, MAX_STRING_LEN-1);
-                ((char*)array_element_target_ptr)[MAX_STRING_LEN-1] = '\0'; break;
-                default: error("Dizi elemanına bilinmeyen veya desteklenmeyen tipte atama yapıldı.");
+        if(array_element_target_ptr){ // Assigning to array element or struct field
+            store_typed_slot(effective_lhs_type, array_element_target_ptr, rhs_val);
+        } else if(effective_lhs_type == VAR_STRUCT){ // Bütün struct kopyası: p = q; veya arr[i] = q;
+            int sidx = (target_var->type == VAR_STRUCT) ? target_var->value.record.struct_idx : target_var->value.array.struct_idx;
+            if(struct_idx_of_ref(rhs_val) != sidx){
+                char err_msg[2*MAX_IDENT_LEN+100]; sprintf(err_msg,"Tip uyuşmazlığı: '%s' tipindeki hedefe '%s' struct'ı atanamaz.",nur->struct_table[sidx].name,nur->struct_table[struct_idx_of_ref(rhs_val)].name); error(err_msg);
             }
+            copy_struct_value(target_var, element_idx, rhs_val);
         } else { // Assigning to a simple variable
             target_var->is_defined = true;
-            switch(target_var->type){ // which is effective_lhs_type
-                case VAR_INT:    target_var->value.int_value = rhs_val.as.int_val; break;
-                case VAR_FLOAT:  target_var->value.float_value = rhs_val.as.float_val; break;
-                case VAR_STRING: strncpy(target_var->value.string_value, rhs_val.as.string_val, MAX_STRING_LEN-1);
-                target_var->value.string_value[MAX_STRING_LEN-1] = '\0'; break;
-                case VAR_BOOLEAN:target_var->value.bool_value = rhs_val.as.bool_val; break;
-                case VAR_ARRAY:  error("Bir dizi değişkenine doğrudan atama yapılamaz (örn: arr1 = arr2)."); break;
-                default: error("Değişkene bilinmeyen veya desteklenmeyen tipte atama yapıldı.");
-            }
+            if(target_var->type == VAR_ARRAY) error("Bir dizi değişkenine doğrudan atama yapılamaz (örn: arr1 = arr2).");
+            store_typed_slot(target_var->type, scalar_variable_slot(target_var), rhs_val); // which is effective_lhs_type
         }
     }
     consume_token(TOKEN_SEMICOLON);
 }
 void print_value_recursive(Value val) { 
-    switch(val.type){case VAL_INT:printf("%d",val.as.int_val);break;case VAL_FLOAT:printf("%g",val.as.float_val);break;
-        case VAL_STRING:printf("%s",val.as.string_val);break; // Removed extra quotes for display consistency with user input strings
-        case VAL_BOOLEAN:printf("%s",val.as.bool_val?"true":"false");break;
-        case VAL_ARRAY_REF:{Variable*av=val.as.array_var;printf("[");for(int k=0;k<av->value.array.size;++k){
-            
-            size_t element_s = get_sizeof_element_type(av->value.array.element_type);
-            if(element_s == 0) { printf("<?>"); continue; } // Should not happen
-            void*ep=(char*)av->value.array.data+k*element_s;
-            Value et=create_value_null();
-            
-            switch(av->value.array.element_type){case VAR_INT:et=create_value_int(*(int*)ep);break;case VAR_FLOAT:et=create_value_float(*(double*)ep);break;
-                case VAR_BOOLEAN:et=create_value_bool(*(bool*)ep);break; case VAR_STRING:et=create_value_string((char*)ep);break;default:printf("<?>");break;}
-                print_value_recursive(et);if(k<av->value.array.size-1)printf(", ");}printf("]");break;}
-                case VAL_NULL:printf("null");break;default:printf("<bilinmeyen_tip_yazdirma>");}
+    switch(val.type){case VAL_INT:out_int(val.as.int_val);break;case VAL_I64:out_int(val.as.i64_val);break;case VAL_FLOAT:out_double(val.as.float_val,val.f32);break;
+        case VAL_STRING:out_str(val.as.string_val);break; // Removed extra quotes for display consistency with user input strings
+        case VAL_BOOLEAN:out_str(val.as.bool_val?"true":"false");break;
+        case VAL_ARRAY_REF:{Variable*av=val.as.array_var;int n=av->value.array.size;const void*d=av->value.array.data;out_char('[');
+            // Sayısal diziler doğrudan tampona biçimlendirilir (eleman başına Value oluşturulmaz)
+            switch(av->value.array.element_type){
+                case VAR_INT: for(int k=0;k<n;++k){if(k)out_write(", ",2);out_int(((const int*)d)[k]);} break;
+                case VAR_I64: for(int k=0;k<n;++k){if(k)out_write(", ",2);out_int(((const long long*)d)[k]);} break;
+                case VAR_U8: for(int k=0;k<n;++k){if(k)out_write(", ",2);out_int(((const unsigned char*)d)[k]);} break;
+                case VAR_FLOAT: for(int k=0;k<n;++k){if(k)out_write(", ",2);out_double(((const double*)d)[k],false);} break;
+                case VAR_F32: for(int k=0;k<n;++k){if(k)out_write(", ",2);out_double(((const float*)d)[k],true);} break;
+                case VAR_STRUCT: for(int k=0;k<n;++k){if(k)out_write(", ",2);print_value_recursive(create_value_struct_ref(av,k));} break;
+                default: {
+                    size_t element_s = get_sizeof_element_type(av->value.array.element_type);
+                    for(int k=0;k<n;++k){if(k)out_write(", ",2);print_value_recursive(load_typed_slot(av->value.array.element_type,(const char*)d+k*element_s));}
+                }
+            }
+            out_char(']');break;}
+        case VAL_STRUCT_REF:{const StructDefinition*sd=&nur->struct_table[struct_idx_of_ref(val)];out_char('{');for(int f=0;f<sd->num_fields;++f){
+            out_str(sd->fields[f].name);out_write(": ",2);
+            print_value_recursive(load_typed_slot(sd->fields[f].type,struct_field_ptr(val.as.struct_ref.var,val.as.struct_ref.index,f)));
+            if(f<sd->num_fields-1)out_write(", ",2);}out_char('}');break;}
+        case VAL_HANDLE:out_str("<handle #");out_int(val.as.handle&0xff);out_char('>');break;
+        case VAL_CHANNEL:out_str("<chan #");out_int(val.as.channel);out_char('>');break;
+        case VAL_GENERATOR:out_str("<gen #");out_int(val.as.generator&0xff);out_char('>');break;
+                case VAL_NULL:out_str("null");break;default:out_str("<bilinmeyen_tip_yazdirma>");}
 }
 void parse_out_display(bool execute) { 
-    consume_token(TOKEN_OUT);consume_token(TOKEN_DOT);consume_token(TOKEN_DISPLAY);consume_token(TOKEN_LPAREN);
+    consume_token(TOKEN_OUT);consume_token(TOKEN_DOT);
+    if(peek_token().type==TOKEN_IDENTIFIER&&is_keyword(peek_token().lexeme,"flush")){ // out.flush();
+        consume_token(TOKEN_IDENTIFIER);consume_token(TOKEN_LPAREN);consume_token(TOKEN_RPAREN);consume_token(TOKEN_SEMICOLON);
+        if(execute)flush_output();
+        return;
+    }
+    consume_token(TOKEN_DISPLAY);consume_token(TOKEN_LPAREN);
     Value vtd=evaluate_expression(execute);consume_token(TOKEN_RPAREN);consume_token(TOKEN_SEMICOLON);
-    if(execute){print_value_recursive(vtd);printf("\n");fflush(stdout);}
+    if(execute){print_value_recursive(vtd);out_newline();}
 }
 
 void parse_if_statement(bool execute, bool* break_flag, bool* continue_flag, bool in_function_body) {
@@ -1103,7 +5659,7 @@ void parse_if_statement(bool execute, bool* break_flag, bool* continue_flag, boo
     bool execute_then_block = execute && actual_condition_result;
     parse_block(execute_then_block, break_flag, continue_flag, in_function_body); 
     
-    if(g_return_flag || (*break_flag && execute_then_block) || (*continue_flag && execute_then_block) ) return; // If block caused jump, don't process else
+    if(nur->return_flag || (*break_flag && execute_then_block) || (*continue_flag && execute_then_block) ) return; // If block caused jump, don't process else
     
     if(peek_token().type==TOKEN_ELSE){
         consume_token(TOKEN_ELSE);
@@ -1112,19 +5668,19 @@ void parse_if_statement(bool execute, bool* break_flag, bool* continue_flag, boo
     }
 }
 void parse_while_statement(bool execute, bool* break_flag_outer, bool* continue_flag_outer, bool in_function_body) {
+    (void)continue_flag_outer; // continue döngünün kendisinde tüketilir, dışarı taşınmaz
     consume_token(TOKEN_WHILE); 
-    int condition_start_token_idx = current_token_idx; // Start of (condition)
-    loop_depth++;
+    int condition_start_token_idx = nur->current_token_idx; // Start of (condition)
+    nur->loop_depth++;
     
     bool local_break_flag=false, local_continue_flag=false; 
     
     if(execute){
         while(true){
-            current_token_idx = condition_start_token_idx; // Rewind to parse condition
+            nur->current_token_idx = condition_start_token_idx; // Rewind to parse condition
             consume_token(TOKEN_LPAREN);
             Value cond_val=evaluate_expression(true); // Condition is always evaluated if loop executes
             consume_token(TOKEN_RPAREN);
-            int body_start_token_idx = current_token_idx; // Save start of block
             
             if(cond_val.type!=VAL_BOOLEAN)error("While koşulu mantıksal (boolean) bir değer olmalıdır.");
             if(!cond_val.as.bool_val)break; // Condition is false, exit loop
@@ -1132,7 +5688,7 @@ void parse_while_statement(bool execute, bool* break_flag_outer, bool* continue_
             local_continue_flag=false; local_break_flag=false;
             parse_block(true, &local_break_flag, &local_continue_flag, in_function_body);
             
-            if(g_return_flag){loop_depth--;return;} // Function returned from loop
+            if(nur->return_flag){nur->loop_depth--;return;} // Function returned from loop
             if(local_break_flag)break; // Break statement executed
             if(local_continue_flag)continue; // Continue statement executed (loop will re-eval condition)
         }
@@ -1140,31 +5696,31 @@ void parse_while_statement(bool execute, bool* break_flag_outer, bool* continue_
     
     // If not executing, or after loop finishes, skip parsing the condition and body once
     // to advance current_token_idx correctly.
-    current_token_idx = condition_start_token_idx;
+    nur->current_token_idx = condition_start_token_idx;
     consume_token(TOKEN_LPAREN);
     evaluate_expression(false); // Parse condition (don't execute)
     consume_token(TOKEN_RPAREN);
     bool dummy_b=false, dummy_c=false;
     parse_block(false, &dummy_b, &dummy_c, in_function_body); // Parse block (don't execute)
     
-    loop_depth--;
+    nur->loop_depth--;
     if (execute && local_break_flag && break_flag_outer) *break_flag_outer = true; // Propagate break if needed
 }
 void parse_for_statement(bool execute, bool* break_flag_outer, bool* continue_flag_outer, bool in_function_body) { 
+    (void)continue_flag_outer; // continue döngünün kendisinde tüketilir, dışarı taşınmaz
     consume_token(TOKEN_FOR);consume_token(TOKEN_LPAREN);
     
     char declared_loop_var_name[MAX_IDENT_LEN]="";
     bool loop_var_declared_here=false;
-    int original_for_loop_var_stack_ptr = for_loop_var_stack_ptr;
+    int original_for_loop_var_stack_ptr = nur->for_loop_var_stack_ptr;
     
     // 1. Initializer
     if(execute) enter_scope(); // Scope for loop variable if declared here
     if(peek_token().type==TOKEN_VAR){
         parse_var_declaration(execute,true); // is_in_for_initializer = true
         loop_var_declared_here=true;
-        if(execute && for_loop_var_stack_ptr > original_for_loop_var_stack_ptr){ // If a var was pushed
-            strncpy(declared_loop_var_name, for_loop_vars_stack[for_loop_var_stack_ptr], MAX_IDENT_LEN-1);
-            declared_loop_var_name[MAX_IDENT_LEN-1]='\0';
+        if(execute && nur->for_loop_var_stack_ptr > original_for_loop_var_stack_ptr){ // If a var was pushed
+            copy_bounded(declared_loop_var_name, nur->for_loop_vars_stack[nur->for_loop_var_stack_ptr], MAX_IDENT_LEN);
         }
     } else if(peek_token().type!=TOKEN_SEMICOLON){ // Assignment or expression
         evaluate_expression(execute); // e.g. i = 0
@@ -1174,23 +5730,23 @@ void parse_for_statement(bool execute, bool* break_flag_outer, bool* continue_fl
     else if (!loop_var_declared_here) error("For döngüsü başlatıcısında ';' bekleniyor.");
     
     
-    int condition_expr_start_idx = current_token_idx;
+    int condition_expr_start_idx = nur->current_token_idx;
     bool condition_is_empty = (peek_token().type==TOKEN_SEMICOLON);
     if(!condition_is_empty) evaluate_expression(false); // Parse condition to find its end
     consume_token(TOKEN_SEMICOLON);
     
-    int increment_expr_start_idx = current_token_idx;
-    int temp_parser_idx = current_token_idx;
+    int increment_expr_start_idx = nur->current_token_idx;
+    int temp_parser_idx = nur->current_token_idx;
     int paren_balance = 0; // To find the closing parenthesis of for header
-    while(temp_parser_idx < num_tokens) {
-        if(tokens[temp_parser_idx].type == TOKEN_LPAREN) paren_balance++;
-        else if(tokens[temp_parser_idx].type == TOKEN_RPAREN) {
+    while(temp_parser_idx < nur->num_tokens) {
+        if(nur->tokens[temp_parser_idx].type == TOKEN_LPAREN) paren_balance++;
+        else if(nur->tokens[temp_parser_idx].type == TOKEN_RPAREN) {
             if (paren_balance == 0) break; // This is the RPAREN for the FOR's LPAREN
             paren_balance--;
         }
         temp_parser_idx++;
     }
-    if(temp_parser_idx >= num_tokens || tokens[temp_parser_idx].type != TOKEN_RPAREN) {
+    if(temp_parser_idx >= nur->num_tokens || nur->tokens[temp_parser_idx].type != TOKEN_RPAREN) {
         error("For döngüsü başlığında kapatma parantezi ')' bulunamadı.");
     }
     int increment_expr_end_idx = temp_parser_idx; // Points to RPAREN
@@ -1198,7 +5754,7 @@ void parse_for_statement(bool execute, bool* break_flag_outer, bool* continue_fl
     
     if(!increment_is_empty) {
         // Temporarily parse increment to correctly position current_token_idx for body parsing
-        current_token_idx = increment_expr_start_idx;
+        nur->current_token_idx = increment_expr_start_idx;
         // Check if it's an assignment like i = i + 1, or general expression
         // This is complex, simply use evaluate_expression(false) to parse it.
         // It's not perfect but parse_assignment_rhs is also not directly usable here.
@@ -1211,17 +5767,17 @@ void parse_for_statement(bool execute, bool* break_flag_outer, bool* continue_fl
         }
     }
     
-    current_token_idx = increment_expr_end_idx; // current_token_idx is now at RPAREN
+    nur->current_token_idx = increment_expr_end_idx; // current_token_idx is now at RPAREN
     consume_token(TOKEN_RPAREN); // Consumes the ')'
-    int body_start_token_idx = current_token_idx; // Start of the for loop's block
+    int body_start_token_idx = nur->current_token_idx; // Start of the for loop's block
     
-    loop_depth++;
+    nur->loop_depth++;
     bool local_break_flag=false, local_continue_flag=false;
     
     if(execute){
         while(true){
             // 2. Condition
-            current_token_idx = condition_expr_start_idx;
+            nur->current_token_idx = condition_expr_start_idx;
             bool condition_result = true; // Empty condition is true
             if(!condition_is_empty){
                 Value cond_val = evaluate_expression(true);
@@ -1231,35 +5787,30 @@ void parse_for_statement(bool execute, bool* break_flag_outer, bool* continue_fl
             if(!condition_result) break; // Exit loop if condition is false
             
             // 3. Body
-            current_token_idx = body_start_token_idx;
+            nur->current_token_idx = body_start_token_idx;
             local_continue_flag=false; local_break_flag=false;
             parse_block(true, &local_break_flag, &local_continue_flag, in_function_body);
             
-            if(g_return_flag){ // Function returned from loop body
+            if(nur->return_flag){ // Function returned from loop body
                 if(loop_var_declared_here) exit_scope(); // Clean up loop-declared var's scope
-                loop_depth--;
+                nur->loop_depth--;
                 return;
             }
             if(local_break_flag) break; // Break from loop
             
             // 4. Increment (executes even if continue was hit)
-            current_token_idx = increment_expr_start_idx;
+            nur->current_token_idx = increment_expr_start_idx;
             if(!increment_is_empty){
                 // Re-evaluate the increment logic here
                 if(peek_next_token().type==TOKEN_ASSIGN && peek_token().type==TOKEN_IDENTIFIER){
                     Token nit_token = consume_token(TOKEN_IDENTIFIER);
                     consume_token(TOKEN_ASSIGN);
                     Variable* v_for_inc = find_variable(nit_token.lexeme);
-                    if(!v_for_inc){char e[100+MAX_IDENT_LEN];sprintf(e,"For döngüsü artırımında '%s' değişkeni tanımsız.",nit_token.lexeme);error(e);}
+                    if(!v_for_inc){char e[100+MAX_STRING_LEN];sprintf(e,"For döngüsü artırımında '%s' değişkeni tanımsız.",nit_token.lexeme);error(e);}
                     Value rhs_inc_val = parse_assignment_rhs(v_for_inc->type, true);
                     v_for_inc->is_defined = true;
-                    switch(v_for_inc->type){
-                        case VAR_INT: v_for_inc->value.int_value = rhs_inc_val.as.int_val; break;
-                        case VAR_FLOAT: v_for_inc->value.float_value = rhs_inc_val.as.float_val; break;
-                        case VAR_STRING: strncpy(v_for_inc->value.string_value, rhs_inc_val.as.string_val, MAX_STRING_LEN-1); v_for_inc->value.string_value[MAX_STRING_LEN-1]='\0'; break;
-                        case VAR_BOOLEAN: v_for_inc->value.bool_value = rhs_inc_val.as.bool_val; break;
-                        default: /* Should not happen */ break;
-                    }
+                    if(v_for_inc->type == VAR_ARRAY || v_for_inc->type == VAR_STRUCT) error("For döngüsü artırımında dizi/struct değişkenine atama yapılamaz.");
+                    store_typed_slot(v_for_inc->type, scalar_variable_slot(v_for_inc), rhs_inc_val);
                 } else {
                     evaluate_expression(true); // For other increment forms like function_call()
                 }
@@ -1270,28 +5821,186 @@ void parse_for_statement(bool execute, bool* break_flag_outer, bool* continue_fl
     }
     
     // If not executing, or after loop execution, set current_token_idx past the body
-    current_token_idx = body_start_token_idx;
+    nur->current_token_idx = body_start_token_idx;
     bool dummy_b=false, dummy_c=false;
     parse_block(false, &dummy_b, &dummy_c, in_function_body); // Parse body (don't execute)
     
-    loop_depth--;
+    nur->loop_depth--;
     if(execute && loop_var_declared_here) exit_scope(); // Clean up scope if var was declared in this for
     
     if(loop_var_declared_here && strlen(declared_loop_var_name)>0){
         // This remove is for the for_loop_vars_stack, not symbol_table if scope handled it.
         // Symbol table cleanup is handled by exit_scope if 'execute' was true.
         // If 'execute' was false, declare_variable wasn't called, but name might be on stack.
-        if(for_loop_var_stack_ptr >= 0 && strcmp(for_loop_vars_stack[for_loop_var_stack_ptr], declared_loop_var_name)==0){
-            for_loop_var_stack_ptr--;
+        if(nur->for_loop_var_stack_ptr >= 0 && strcmp(nur->for_loop_vars_stack[nur->for_loop_var_stack_ptr], declared_loop_var_name)==0){
+            nur->for_loop_var_stack_ptr--;
         }
     }
     if (execute && local_break_flag && break_flag_outer) *break_flag_outer = true;
 }
+// parallel for (var i: int = a; i < b; i = i + adım) [reduce s: +, m: max] { ... }
+// Yinelemeler iş çalan işçilere dağıtılır (bkz. Paralel Yürütme). Sınır ve adım bir kez hesaplanır.
+// Gövdedeki değişkenler ve skaler atamalar işçiye özeldir; dışarıya sonuç dizi elemanları veya
+// reduce değişkenleriyle çıkar. reduce değişkeni her blokta +: 0, *: 1, min/max: döngü öncesi değerle başlar;
+// blok sonuçları blok sırasıyla birleştirilir, bu yüzden sonuç işçi sayısından bağımsızdır.
+typedef enum { REDUCE_SUM, REDUCE_PRODUCT, REDUCE_MIN, REDUCE_MAX } ReduceOp;
+typedef struct { ValueType type; long long i; double f; } ReducePartial; // Yalnızca sayısal; Value'dan çok daha küçük
+typedef struct {
+    char var_name[MAX_IDENT_LEN]; VarType var_type;
+    long long start, step;
+    int body_start;
+    int num_reduce;
+    char reduce_names[MAX_PARALLEL_REDUCE][MAX_IDENT_LEN];
+    ReduceOp reduce_ops[MAX_PARALLEL_REDUCE];
+    Value reduce_initial[MAX_PARALLEL_REDUCE];
+    ReducePartial partials[PARALLEL_BLOCKS * MAX_PARALLEL_REDUCE]; // [blok * num_reduce + k]
+} ParallelForCtx;
+
+void parallel_for_block(ParallelJob* job, int block, long long lo, long long hi) {
+    ParallelForCtx* c = job->ctx;
+    int reduce_idx[MAX_PARALLEL_REDUCE]; // Gövde çağrıları sembol tablosunu değiştirir; işaretçi değil indis tutulur
+    for (int k = 0; k < c->num_reduce; ++k) {
+        Variable* rv = find_variable(c->reduce_names[k]);
+        reduce_idx[k] = (int)(rv - nur->symbol_table);
+        Value init = c->reduce_ops[k] == REDUCE_SUM ? create_value_int(0) : c->reduce_ops[k] == REDUCE_PRODUCT ? create_value_int(1) : c->reduce_initial[k];
+        coerce_value_to_var_type(rv->type, &init);
+        store_typed_slot(rv->type, scalar_variable_slot(rv), init);
+    }
+    enter_scope();
+    Variable* iv = declare_variable(c->var_name, c->var_type, false, VAR_NULL_TYPE, 0, -1);
+    iv->is_defined = true;
+    int iv_idx = (int)(iv - nur->symbol_table);
+    nur->loop_depth++;
+    for (long long n = lo; n < hi && !parallel_stopped(job); ++n) {
+        long long i = c->start + n * c->step;
+        Variable* v = &nur->symbol_table[iv_idx];
+        if (c->var_type == VAR_I64) v->value.i64_value = i; else v->value.int_value = (int)i;
+        nur->current_token_idx = c->body_start;
+        bool brk = false, cont = false;
+        parse_block(true, &brk, &cont, false);
+        if (brk) error("'parallel for' gövdesinde 'break' kullanılamaz.");
+        if (nur->return_flag) error("'parallel for' gövdesinde 'return' kullanılamaz.");
+    }
+    nur->loop_depth--;
+    exit_scope();
+    for (int k = 0; k < c->num_reduce; ++k) {
+        Value v = load_typed_slot(nur->symbol_table[reduce_idx[k]].type, scalar_variable_slot(&nur->symbol_table[reduce_idx[k]]));
+        c->partials[block * c->num_reduce + k] = (ReducePartial){ v.type, v.type == VAL_I64 ? v.as.i64_val : v.as.int_val, v.as.float_val };
+    }
+}
+
+void parse_parallel_for(bool execute, bool in_function_body) {
+    consume_token(TOKEN_IDENTIFIER); // parallel
+    consume_token(TOKEN_FOR); consume_token(TOKEN_LPAREN);
+    ParallelForCtx c; memset(&c, 0, sizeof c);
+    consume_token(TOKEN_VAR);
+    Token name_token = consume_token(TOKEN_IDENTIFIER);
+    strcpy(c.var_name, name_token.lexeme);
+    consume_token(TOKEN_COLON);
+    c.var_type = parse_type_specifier();
+    if (c.var_type != VAR_INT && c.var_type != VAR_I64) error("'parallel for' döngü değişkeni int veya i64 olmalıdır.");
+    consume_token(TOKEN_ASSIGN);
+    Value start_val = evaluate_expression(execute);
+    consume_token(TOKEN_SEMICOLON);
+    Token cond_var = consume_token(TOKEN_IDENTIFIER);
+    Token cmp = peek_token();
+    if (strcmp(cond_var.lexeme, c.var_name) != 0 || (cmp.type != TOKEN_LT && cmp.type != TOKEN_LTE))
+        error("'parallel for' koşulu 'i < sınır' veya 'i <= sınır' biçiminde olmalıdır.");
+    consume_token(cmp.type);
+    Value limit_val = evaluate_expression(execute);
+    consume_token(TOKEN_SEMICOLON);
+    Token inc_var = consume_token(TOKEN_IDENTIFIER); consume_token(TOKEN_ASSIGN);
+    Token inc_src = consume_token(TOKEN_IDENTIFIER); consume_token(TOKEN_PLUS);
+    if (strcmp(inc_var.lexeme, c.var_name) != 0 || strcmp(inc_src.lexeme, c.var_name) != 0)
+        error("'parallel for' artırımı 'i = i + adım' biçiminde olmalıdır.");
+    Value step_val = evaluate_expression(execute);
+    consume_token(TOKEN_RPAREN);
+    
+    if (peek_token().type == TOKEN_IDENTIFIER && is_keyword(peek_token().lexeme, "reduce")) {
+        consume_token(TOKEN_IDENTIFIER);
+        do {
+            if (c.num_reduce > 0) consume_token(TOKEN_COMMA);
+            if (c.num_reduce >= MAX_PARALLEL_REDUCE) error("'reduce' listesinde çok fazla değişken var.");
+            Token rv = consume_token(TOKEN_IDENTIFIER);
+            consume_token(TOKEN_COLON);
+            Token op = peek_token();
+            ReduceOp rop;
+            if (op.type == TOKEN_PLUS) rop = REDUCE_SUM;
+            else if (op.type == TOKEN_MULTIPLY) rop = REDUCE_PRODUCT;
+            else if (op.type == TOKEN_IDENTIFIER && is_keyword(op.lexeme, "min")) rop = REDUCE_MIN;
+            else if (op.type == TOKEN_IDENTIFIER && is_keyword(op.lexeme, "max")) rop = REDUCE_MAX;
+            else { char e[100 + MAX_STRING_LEN]; sprintf(e, "Bilinmeyen reduce işlemi: '%s' (+, *, min, max bekleniyor).", op.lexeme); error(e); return; }
+            consume_token(op.type);
+            strcpy(c.reduce_names[c.num_reduce], rv.lexeme);
+            c.reduce_ops[c.num_reduce++] = rop;
+        } while (peek_token().type == TOKEN_COMMA);
+    }
+    c.body_start = nur->current_token_idx;
+    bool dummy_b = false, dummy_c = false;
+    if (!execute) { parse_block(false, &dummy_b, &dummy_c, in_function_body); return; }
+    
+    if (!value_is_integer(start_val) || !value_is_integer(limit_val) || !value_is_integer(step_val))
+        error("'parallel for' başlangıç, sınır ve adım değerleri tamsayı olmalıdır.");
+    c.start = value_as_i64(start_val);
+    c.step = value_as_i64(step_val);
+    long long limit = value_as_i64(limit_val);
+    if (c.step <= 0) error("'parallel for' adımı pozitif olmalıdır.");
+    if (cmp.type == TOKEN_LTE) {
+        if (limit == LLONG_MAX) error("'parallel for' sınırı çok büyük.");
+        limit++;
+    }
+    long long count = limit > c.start ? (long long)(((unsigned long long)limit - (unsigned long long)c.start + (unsigned long long)c.step - 1) / (unsigned long long)c.step) : 0;
+    if (count > 0 && c.var_type == VAR_INT && (c.start < INT_MIN || c.start + (count - 1) * c.step > INT_MAX))
+        error("'parallel for' döngü değişkeni int sınırlarını aşıyor (i64 kullanın).");
+    
+    Variable* reduce_vars[MAX_PARALLEL_REDUCE];
+    for (int k = 0; k < c.num_reduce; ++k) {
+        reduce_vars[k] = find_variable(c.reduce_names[k]);
+        if (!reduce_vars[k]) { char e[100 + MAX_IDENT_LEN]; sprintf(e, "reduce değişkeni '%s' tanımsız.", c.reduce_names[k]); error(e); }
+        VarType t = reduce_vars[k]->type;
+        if (t != VAR_INT && t != VAR_I64 && t != VAR_FLOAT && t != VAR_F32 && t != VAR_U8) {
+            char e[100 + MAX_IDENT_LEN]; sprintf(e, "reduce değişkeni '%s' sayısal bir skaler olmalıdır.", c.reduce_names[k]); error(e);
+        }
+        c.reduce_initial[k] = load_typed_slot(t, scalar_variable_slot(reduce_vars[k]));
+    }
+    
+    if (count > 0) {
+        ParallelJob job; memset(&job, 0, sizeof job);
+        job.count = count;
+        job.grain = (count + PARALLEL_BLOCKS - 1) / PARALLEL_BLOCKS;
+        job.run_block = parallel_for_block;
+        job.ctx = &c;
+        int saved_idx = nur->current_token_idx;
+        parallel_start(&job);
+        parallel_finish(&job);
+        nur->current_token_idx = saved_idx;
+        for (int k = 0; k < c.num_reduce; ++k) {
+            Variable* rv = find_variable(c.reduce_names[k]); // Tek işçide gövde sembol tablosunu değiştirmiş olabilir
+            Value acc = c.reduce_initial[k];
+            for (int b = 0; b < job.num_blocks; ++b) {
+                const ReducePartial* p = &c.partials[b * c.num_reduce + k];
+                Value part = p->type == VAL_FLOAT ? create_value_float(p->f) : p->type == VAL_I64 ? create_value_i64(p->i) : create_value_int((int)p->i);
+                switch (c.reduce_ops[k]) {
+                    case REDUCE_SUM: apply_binary_operator(TOKEN_PLUS, "+", &acc, &part); break;
+                    case REDUCE_PRODUCT: apply_binary_operator(TOKEN_MULTIPLY, "*", &acc, &part); break;
+                    case REDUCE_MIN: if (compare_numeric_values(part, acc) < 0) acc = part; break;
+                    case REDUCE_MAX: if (compare_numeric_values(part, acc) > 0) acc = part; break;
+                }
+            }
+            if (!coerce_value_to_var_type(rv->type, &acc)) error("reduce sonucu değişken tipine dönüştürülemedi.");
+            store_typed_slot(rv->type, scalar_variable_slot(rv), acc);
+        }
+    }
+    parse_block(false, &dummy_b, &dummy_c, in_function_body); // Gövdeyi atla
+}
 void parse_block(bool execute, bool* break_flag, bool* continue_flag, bool in_function_body) {
     // A block introduces a new scope *unless* it's the direct body of a function,
-    // in which case the function call setup (execute_function_call) already created the scope.
+    // in which case the function call setup (invoke_function) already created the scope.
+    // in_function_body yalnızca 'return'ün geçerliliğini taşır; fonksiyon içindeki if/while/for gövdeleri de kapsam açar.
+    bool function_body_block = in_function_body && nur->call_stack_ptr >= 0 &&
+        nur->call_stack[nur->call_stack_ptr].func_def->body_start_token_idx == nur->current_token_idx;
     bool local_scope_created_here = false; 
-    if(!in_function_body) { // If it's a generic block (if, else, while, for, or standalone { })
+    if(!function_body_block) { // If it's a generic block (if, else, while, for, or standalone { })
         if (execute) { // Only enter/exit scope if the block is actually part of execution path
             enter_scope();
         }
@@ -1307,31 +6016,70 @@ void parse_block(bool execute, bool* break_flag, bool* continue_flag, bool in_fu
     }
 }
 
+// struct Ad { alan: tip; ... }
+// Alan ofsetleri burada, bir kez hesaplanır; çalışma anında alan erişimi yalnızca ofset eklemesidir.
+void parse_struct_declaration(bool register_struct) {
+    consume_token(TOKEN_STRUCT);
+    Token name_token = consume_token(TOKEN_IDENTIFIER);
+    StructDefinition sd; memset(&sd, 0, sizeof(sd));
+    copy_bounded(sd.name, name_token.lexeme, MAX_IDENT_LEN);
+    sd.align = 1;
+    
+    if (register_struct) {
+        if (find_struct(sd.name) >= 0) { char err[150]; sprintf(err, "'%s' adlı struct zaten tanımlı.", sd.name); error(err); }
+        if (nur->num_structs >= MAX_STRUCTS) error("Maksimum struct sayısına ulaşıldı.");
+    }
+    
+    consume_token(TOKEN_LBRACE);
+    while (peek_token().type != TOKEN_RBRACE) {
+        if (sd.num_fields >= MAX_STRUCT_FIELDS) error("Struct tanımında maksimum alan sayısı aşıldı.");
+        Token field_token = consume_token(TOKEN_IDENTIFIER);
+        consume_token(TOKEN_COLON);
+        VarType field_type = parse_type_specifier();
+        if (field_type == VAR_VOID || field_type == VAR_STRUCT) error("Struct alanı void veya struct tipinde olamaz.");
+        if (peek_token().type == TOKEN_LBRACKET) error("Struct alanı dizi olamaz (bunun yerine struct dizisi kullanın).");
+        consume_token(TOKEN_SEMICOLON);
+        for (int k = 0; k < sd.num_fields; ++k) {
+            if (strcmp(sd.fields[k].name, field_token.lexeme) == 0) {
+                char err[MAX_STRING_LEN + 100]; sprintf(err, "'%s' alanı struct tanımında zaten mevcut.", field_token.lexeme); error(err);
+            }
+        }
+        StructField* f = &sd.fields[sd.num_fields++];
+        copy_bounded(f->name, field_token.lexeme, MAX_IDENT_LEN);
+        f->type = field_type;
+        f->size = get_sizeof_element_type(field_type);
+        size_t a = get_alignof_element_type(field_type);
+        sd.size = (sd.size + a - 1) / a * a;
+        f->offset = sd.size;
+        sd.size += f->size;
+        if (a > sd.align) sd.align = a;
+    }
+    consume_token(TOKEN_RBRACE);
+    if (sd.num_fields == 0) error("Struct en az bir alan içermelidir.");
+    sd.size = (sd.size + sd.align - 1) / sd.align * sd.align;
+    
+    if (register_struct) nur->struct_table[nur->num_structs++] = sd;
+}
+
 void parse_fun_declaration() {
     consume_token(TOKEN_FUN);
     Token func_name_token = consume_token(TOKEN_IDENTIFIER);
     
     if (find_function(func_name_token.lexeme) != NULL) {
-        char err[150]; sprintf(err, "'%s' adlı fonksiyon zaten tanımlı.", func_name_token.lexeme); error(err);
+        char err[MAX_STRING_LEN + 100]; sprintf(err, "'%s' adlı fonksiyon zaten tanımlı.", func_name_token.lexeme); error(err);
     }
     // Check for built-in name conflict
-    const char* builtins[] = {"length", "int_to_string", "concat", "sqrt", "to_upper", "to_lower", 
-        "read_file_text", "write_file_text", "substring", "string_to_int", 
-        "string_to_float", "type_of", "pow", NULL};
-        for(int i=0; builtins[i] != NULL; ++i) {
-            if(is_keyword(func_name_token.lexeme, builtins[i])) {
-                char err[MAX_IDENT_LEN + 100];
-                sprintf(err, "'%s' bir dahili komut adıdır, fonksiyon adı olarak kullanılamaz.", func_name_token.lexeme);
-                error(err);
-            }
+        if (find_native(func_name_token.lexeme) >= 0) {
+            char err[MAX_IDENT_LEN + 100];
+            sprintf(err, "'%s' bir dahili komut adıdır, fonksiyon adı olarak kullanılamaz.", func_name_token.lexeme);
+            error(err);
         }
         
         
-        if (num_functions >= MAX_FUNCTIONS) error("Maksimum fonksiyon sayısına ulaşıldı.");
+        if (nur->num_functions >= MAX_FUNCTIONS) error("Maksimum fonksiyon sayısına ulaşıldı.");
         
-        FunctionDefinition* new_func = &function_table[num_functions];
-    strncpy(new_func->name, func_name_token.lexeme, MAX_IDENT_LEN - 1);
-    new_func->name[MAX_IDENT_LEN-1] = '\0';
+        FunctionDefinition* new_func = &nur->function_table[nur->num_functions];
+    copy_bounded(new_func->name, func_name_token.lexeme, MAX_IDENT_LEN);
     new_func->num_params = 0;
     
     consume_token(TOKEN_LPAREN);
@@ -1340,20 +6088,25 @@ void parse_fun_declaration() {
             if (new_func->num_params >= MAX_PARAMETERS) error("Fonksiyon tanımında maksimum parametre sayısı aşıldı.");
             Token param_name_token = consume_token(TOKEN_IDENTIFIER);
             consume_token(TOKEN_COLON);
-            VarType param_type = parse_type_specifier();
+            Token param_type_token = peek_token();
+            VarType param_type = parse_type_specifier_ex(false); // İçe aktarılan struct adı da struct hatasını alır
+            if(param_type == VAR_STRUCT) {
+                char err[2 * sizeof param_type_token.lexeme + 150];
+                snprintf(err, sizeof err, "'%s' parametresi '%s' struct tipinde olamaz: struct'lar fonksiyonlara geçirilemez, alanlarını ayrı parametreler olarak verin.", param_name_token.lexeme, param_type_token.lexeme);
+                error(err);
+            }
             if(param_type == VAR_ARRAY || param_type == VAR_VOID) { // Arrays not passed by value, void invalid param type
                 error("Fonksiyon parametresi void veya doğrudan array tipinde olamaz (array referansları ileride desteklenebilir).");
             }
             // Check for duplicate parameter names
             for(int k=0; k < new_func->num_params; ++k) {
                 if(strcmp(new_func->params[k].name, param_name_token.lexeme) == 0) {
-                    char err_param[MAX_IDENT_LEN + 100];
+                    char err_param[MAX_STRING_LEN + 100];
                     sprintf(err_param, "'%s' parametresi fonksiyon tanımında zaten mevcut.", param_name_token.lexeme);
                     error(err_param);
                 }
             }
-            strncpy(new_func->params[new_func->num_params].name, param_name_token.lexeme, MAX_IDENT_LEN -1);
-            new_func->params[new_func->num_params].name[MAX_IDENT_LEN-1]='\0';
+            copy_bounded(new_func->params[new_func->num_params].name, param_name_token.lexeme, MAX_IDENT_LEN);
             new_func->params[new_func->num_params].type = param_type;
             new_func->num_params++;
             if (peek_token().type == TOKEN_COMMA) consume_token(TOKEN_COMMA); else break;
@@ -1363,13 +6116,16 @@ void parse_fun_declaration() {
     
     if (peek_token().type == TOKEN_COLON) { 
         consume_token(TOKEN_COLON);
-        new_func->return_type = parse_type_specifier();
+        Token return_type_token = peek_token();
+        new_func->return_type = parse_type_specifier_ex(false);
+        if (new_func->return_type == VAR_STRUCT) { char err[sizeof return_type_token.lexeme + 100]; snprintf(err, sizeof err, "Fonksiyonlar struct ('%s') döndüremez.", return_type_token.lexeme); error(err); }
+        if (new_func->return_type == VAR_GENERATOR) new_func->yield_type = nur->last_type_elem;
     } else { 
         new_func->return_type = VAR_VOID; // Default return type is void
     }
     
     if (peek_token().type != TOKEN_LBRACE) error("Fonksiyon tanımında gövde ('{...}') bekleniyor.");
-    new_func->body_start_token_idx = current_token_idx; // This will be the index of LBRACE
+    new_func->body_start_token_idx = nur->current_token_idx; // This will be the index of LBRACE
     
     bool dummy_b=false, dummy_c=false;
     // When parsing function declaration, we are NOT in a function body yet.
@@ -1378,7 +6134,7 @@ void parse_fun_declaration() {
     // handled during actual execution by execute_function_call.
     parse_block(false, &dummy_b, &dummy_c, true); // Skip body by parsing with execute=false.
     // 'true' for in_function_body is for the block's internal logic.
-    num_functions++;
+    nur->num_functions++;
 }
 
 void parse_statement(bool execute, bool* break_flag, bool* continue_flag, bool in_function_body) {
@@ -1387,20 +6143,20 @@ void parse_statement(bool execute, bool* break_flag, bool* continue_flag, bool i
         case TOKEN_VAR: parse_var_declaration(execute, false); break;
         case TOKEN_IDENTIFIER: { 
             // Lookahead to distinguish assignment from expression statement (e.g. function call)
-            int initial_idx = current_token_idx;
+            int initial_idx = nur->current_token_idx;
             int lookahead_idx = initial_idx + 1; // After IDENTIFIER
             
-            if (lookahead_idx < num_tokens && tokens[lookahead_idx].type == TOKEN_LBRACKET) { // ident [ ...
+            if (lookahead_idx < nur->num_tokens && nur->tokens[lookahead_idx].type == TOKEN_LBRACKET) { // ident [ ...
                 int bracket_nesting = 1;
                 lookahead_idx++; // Move past LBRACKET
-                while(lookahead_idx < num_tokens && bracket_nesting > 0) {
-                    if (tokens[lookahead_idx].type == TOKEN_LBRACKET || tokens[lookahead_idx].type == TOKEN_LPAREN) bracket_nesting++;
-                    else if (tokens[lookahead_idx].type == TOKEN_RBRACKET || tokens[lookahead_idx].type == TOKEN_RPAREN) bracket_nesting--;
+                while(lookahead_idx < nur->num_tokens && bracket_nesting > 0) {
+                    if (nur->tokens[lookahead_idx].type == TOKEN_LBRACKET || nur->tokens[lookahead_idx].type == TOKEN_LPAREN) bracket_nesting++;
+                    else if (nur->tokens[lookahead_idx].type == TOKEN_RBRACKET || nur->tokens[lookahead_idx].type == TOKEN_RPAREN) bracket_nesting--;
                     
-                    if (bracket_nesting == 0 && tokens[lookahead_idx].type == TOKEN_RBRACKET) break; // Found matching RBRACKET for array index
+                    if (bracket_nesting == 0 && nur->tokens[lookahead_idx].type == TOKEN_RBRACKET) break; // Found matching RBRACKET for array index
                     lookahead_idx++;
                 }
-                if (bracket_nesting == 0 && lookahead_idx < num_tokens) { // Successfully found matching RBRACKET
+                if (bracket_nesting == 0 && lookahead_idx < nur->num_tokens) { // Successfully found matching RBRACKET
                     lookahead_idx++; // Move to token *after* RBRACKET
                 } else {
                     // Malformed array access or complex expression, assume not assignment for this simple check.
@@ -1409,8 +6165,17 @@ void parse_statement(bool execute, bool* break_flag, bool* continue_flag, bool i
                     lookahead_idx = initial_idx + 1; 
                 }
             }
+            // Struct alanı: ident.alan = ... veya ident[...].alan = ...
+            if (lookahead_idx + 1 < nur->num_tokens && nur->tokens[lookahead_idx].type == TOKEN_DOT && nur->tokens[lookahead_idx + 1].type == TOKEN_IDENTIFIER) {
+                lookahead_idx += 2;
+            }
             
-            if (lookahead_idx < num_tokens && tokens[lookahead_idx].type == TOKEN_ASSIGN) {
+            TokenType after = initial_idx + 1 < nur->num_tokens ? nur->tokens[initial_idx + 1].type : TOKEN_EOF;
+            if (after == TOKEN_FOR && is_keyword(t.lexeme, "parallel")) {
+                parse_parallel_for(execute, in_function_body);
+            } else if (is_keyword(t.lexeme, "yield") && after != TOKEN_ASSIGN && after != TOKEN_LBRACKET && after != TOKEN_DOT && after != TOKEN_SEMICOLON) {
+                parse_yield_statement(execute);
+            } else if (lookahead_idx < nur->num_tokens && nur->tokens[lookahead_idx].type == TOKEN_ASSIGN) {
                 parse_assignment(execute);
             } else {
                 // Not an assignment, so it's an expression statement (e.g., function call, var access)
@@ -1429,7 +6194,7 @@ void parse_statement(bool execute, bool* break_flag, bool* continue_flag, bool i
             consume_token(TOKEN_BREAK);
             consume_token(TOKEN_SEMICOLON);
             if(execute){
-                if(loop_depth<=0)error("'break' ifadesi sadece bir döngü içinde kullanılabilir.");
+                if(nur->loop_depth<=0)error("'break' ifadesi sadece bir döngü içinde kullanılabilir.");
                 *break_flag=true;
             }
             break;
@@ -1437,14 +6202,15 @@ void parse_statement(bool execute, bool* break_flag, bool* continue_flag, bool i
             consume_token(TOKEN_CONTINUE);
             consume_token(TOKEN_SEMICOLON);
             if(execute){
-                if(loop_depth<=0)error("'continue' ifadesi sadece bir döngü içinde kullanılabilir.");
+                if(nur->loop_depth<=0)error("'continue' ifadesi sadece bir döngü içinde kullanılabilir.");
                 *continue_flag=true;
             }
             break;
         case TOKEN_FUN: error("Fonksiyon tanımı ('fun') sadece en üst düzeyde (global kapsamda) yapılabilir, bir ifade bloğu içinde yapılamaz."); break; 
+        case TOKEN_STRUCT: error("Struct tanımı sadece en üst düzeyde (global kapsamda) yapılabilir."); break;
         case TOKEN_RETURN:
             consume_token(TOKEN_RETURN);
-            if (!in_function_body && call_stack_ptr < 0) { // Not in a function body context (call_stack_ptr check for safety)
+            if (!in_function_body && nur->call_stack_ptr < 0) { // Not in a function body context (call_stack_ptr check for safety)
                 error("'return' ifadesi sadece bir fonksiyon gövdesi içinde kullanılabilir.");
             }
             
@@ -1455,19 +6221,19 @@ void parse_statement(bool execute, bool* break_flag, bool* continue_flag, bool i
             consume_token(TOKEN_SEMICOLON);
             
             if (execute) { // Only set return flag if the return statement itself is in an executing path
-                g_return_value_holder = ret_val;
-                g_return_flag = true;
+                nur->return_value_holder = ret_val;
+                nur->return_flag = true;
             }
             break;
         case TOKEN_SEMICOLON: consume_token(TOKEN_SEMICOLON); break; // Empty statement
-        default: {char err[150]; sprintf(err,"Deyim başında beklenmedik token: %s ('%s')",token_type_names[t.type],t.lexeme);error(err);}}
+        default: {char err[MAX_STRING_LEN + 100]; sprintf(err,"Deyim başında beklenmedik token: %s ('%s')",token_type_names[t.type],t.lexeme);error(err);}}
 }
 void parse_statement_list(bool execute, bool* break_flag, bool* continue_flag, bool in_function_body_context) {
     while (peek_token().type != TOKEN_RBRACE && peek_token().type != TOKEN_EOF) {
         parse_statement(execute, break_flag, continue_flag, in_function_body_context);
         
         // If a return, break, or continue was triggered AND we are executing this list
-        if (execute && (g_return_flag || *break_flag || *continue_flag)) {
+        if (execute && (nur->return_flag || *break_flag || *continue_flag)) {
             // Skip remaining statements in this block by parsing them with execute=false
             while (peek_token().type != TOKEN_RBRACE && peek_token().type != TOKEN_EOF) {
                 bool dummy_b=false, dummy_c=false; 
@@ -1478,123 +6244,595 @@ void parse_statement_list(bool execute, bool* break_flag, bool* continue_flag, b
         }
     }
 }
+// --- Modül Önbelleği ---
+// --batch işçileri arasında paylaşılır. Aynı yoldaki dosya bir kez okunup sözcüklere ayrılır; ana betik
+// olarak derlendiğinde 1. geçişin sonucu da (token'lar, fonksiyon/struct tabloları, derlenmiş ifadeler)
+// saklanır ve sonraki çalıştırmalar bunları kopyalar. Yayımlanan girdilerin içeriği bir daha değişmez.
+// Token'lar tokenize() çıktısı olarak saklanır ve içe aktarmada token dizisinin sonuna kopyalanır; ifade
+// önbellek indisleri yeni durumun ifade havuzuna göre yeniden oluşur.
+// --serve'de (revalidate) anahtar mutlak yoldur ve her kullanımda dosyanın zaman damgası ile boyutuna bakılır;
+// ikisinden biri değiştiyse ve içerik özeti de tutmuyorsa girdi atılır.
+typedef struct CachedModule {
+    char path[2 * MAX_FILENAME_LEN];
+    struct timespec mtime; off_t size; unsigned long long hash; // Yalnızca revalidate'te doldurulur
+    Token* lexed; int num_tokens;
+    Token* compiled_tokens; // NULL: 1. geçiş sonucu henüz yok
+    FunctionDefinition* functions; int num_functions;
+    StructDefinition* structs; int num_structs;
+    ExprNode* expr_nodes; int num_expr_nodes;
+    CompiledExpr* exprs; int num_exprs;
+    struct CachedModule* next;
+} CachedModule;
+struct ModuleCache { pthread_rwlock_t lock; CachedModule* buckets[MODULE_CACHE_BUCKETS]; bool revalidate; };
+
+unsigned module_path_hash(const char* path) {
+    unsigned h = 2166136261u;
+    for (; *path; ++path) h = (h ^ (unsigned char)*path) * 16777619u;
+    return h & (MODULE_CACHE_BUCKETS - 1);
+}
+// Kilit altında çağrılmalı.
+CachedModule* module_cache_find(ModuleCache* mc, const char* path) {
+    for (CachedModule* m = mc->buckets[module_path_hash(path)]; m; m = m->next) if (strcmp(m->path, path) == 0) return m;
+    return NULL;
+}
+void* module_dup(const void* src, size_t n) {
+    void* p = malloc(n ? n : 1);
+    if (!p) error("Modül önbelleği için bellek ayrılamadı.");
+    memcpy(p, src, n);
+    return p;
+}
+void module_free(CachedModule* m) {
+    free(m->lexed); free(m->compiled_tokens);
+    free(m->functions); free(m->structs); free(m->expr_nodes); free(m->exprs); free(m);
+}
+unsigned long long source_hash(const char* text) {
+    unsigned long long h = 14695981039346656037ULL; // FNV-1a 64
+    for (; *text; ++text) h = (h ^ (unsigned char)*text) * 1099511628211ULL;
+    return h;
+}
+
+// Göreli yollar revalidate'te çalışma dizinine göre mutlak yapılır (istekler farklı dizinlerden gelir).
+// false: anahtar sığmıyor; modül önbelleğe alınmaz.
+bool module_cache_key(const ModuleCache* mc, const char* path, char* key) {
+    size_t cap = sizeof ((CachedModule*)0)->path;
+    if (!mc->revalidate || path[0] == '/') { if (strlen(path) >= cap) return false; strcpy(key, path); return true; }
+    if (!getcwd(key, cap)) return false;
+    size_t n = strlen(key);
+    return (size_t)snprintf(key + n, cap - n, "/%s", path) < cap - n;
+}
+// Dosya girdi yayımlandıktan sonra değiştiyse girdiyi atar. Yalnızca zaman damgası değiştiyse (ör. touch)
+// içerik yeniden okunur ve özeti tutuyorsa girdi korunur.
+void module_cache_revalidate(ModuleCache* mc, const char* key) {
+    struct stat sb;
+    bool exists = stat(key, &sb) == 0;
+    pthread_rwlock_rdlock(&mc->lock);
+    CachedModule* m = module_cache_find(mc, key);
+    bool fresh = !m || (exists && sb.st_size == m->size && sb.st_mtim.tv_sec == m->mtime.tv_sec && sb.st_mtim.tv_nsec == m->mtime.tv_nsec);
+    unsigned long long hash = m ? m->hash : 0;
+    bool same_size = m && exists && sb.st_size == m->size;
+    pthread_rwlock_unlock(&mc->lock);
+    if (fresh) return;
+    bool same_content = false;
+    if (same_size) {
+        char text[MAX_SOURCE_SIZE];
+        FILE* f = fopen(key, "r");
+        if (f) { size_t n = fread(text, 1, MAX_SOURCE_SIZE - 1, f); text[n] = '\0'; fclose(f); same_content = source_hash(text) == hash; }
+    }
+    pthread_rwlock_wrlock(&mc->lock);
+    CachedModule** link = &mc->buckets[module_path_hash(key)];
+    while (*link && strcmp((*link)->path, key) != 0) link = &(*link)->next;
+    if (*link && (*link)->hash == hash) { // Bu arada başka bir işçi yenilemediyse
+        if (same_content) (*link)->mtime = sb.st_mtim;
+        else { CachedModule* stale = *link; *link = stale->next; module_free(stale); }
+    }
+    pthread_rwlock_unlock(&mc->lock);
+}
+
+// Önbellekte varsa token'lar dizinin sonuna kopyalanır (dosya okunmaz, tokenize edilmez).
+bool module_cache_copy_lexed(const char* file_path) {
+    ModuleCache* mc = nur->module_cache;
+    char path[sizeof ((CachedModule*)0)->path];
+    if (!mc || !module_cache_key(mc, file_path, path)) return false;
+    if (mc->revalidate) module_cache_revalidate(mc, path);
+    pthread_rwlock_rdlock(&mc->lock);
+    CachedModule* m = module_cache_find(mc, path);
+    bool fits = m && nur->num_tokens + m->num_tokens <= MAX_TOKENS;
+    if (fits) {
+        memcpy(nur->tokens + nur->num_tokens, m->lexed, (size_t)m->num_tokens * sizeof(Token));
+        nur->num_tokens += m->num_tokens;
+    }
+    pthread_rwlock_unlock(&mc->lock);
+    if (m && !fits) error("Token sınırı ('MAX_TOKENS') aşıldı.");
+    return m != NULL;
+}
+// tokenize(source) hemen ardından çağrılır; dosyanın token'ları first_token'dan başlar.
+void module_cache_publish_lexed(const char* file_path, const char* source, int first_token) {
+    ModuleCache* mc = nur->module_cache;
+    char path[sizeof ((CachedModule*)0)->path];
+    if (!mc || !module_cache_key(mc, file_path, path)) return;
+    struct stat sb;
+    if (mc->revalidate && stat(path, &sb) != 0) return;
+    CachedModule* m = calloc(1, sizeof(CachedModule));
+    if (!m) error("Modül önbelleği için bellek ayrılamadı.");
+    strcpy(m->path, path);
+    if (mc->revalidate) { m->mtime = sb.st_mtim; m->size = sb.st_size; m->hash = source_hash(source); }
+    m->num_tokens = nur->num_tokens - first_token;
+    m->lexed = module_dup(nur->tokens + first_token, (size_t)m->num_tokens * sizeof(Token));
+    pthread_rwlock_wrlock(&mc->lock);
+    unsigned b = module_path_hash(path);
+    if (module_cache_find(mc, path)) { free(m->lexed); free(m); } // Başka bir işçi önce yayımladı
+    else { m->next = mc->buckets[b]; mc->buckets[b] = m; }
+    pthread_rwlock_unlock(&mc->lock);
+}
+// Boş bir program durumuna 1. geçiş sonucunu kopyalar (kaynak metin zaten yüklenmiştir).
+bool module_cache_copy_compiled(const char* file_path) {
+    ModuleCache* mc = nur->module_cache;
+    char path[sizeof ((CachedModule*)0)->path];
+    if (!mc || !module_cache_key(mc, file_path, path)) return false;
+    if (mc->revalidate) module_cache_revalidate(mc, path);
+    pthread_rwlock_rdlock(&mc->lock);
+    CachedModule* m = module_cache_find(mc, path);
+    bool found = m && m->compiled_tokens;
+    if (found) {
+        memcpy(nur->tokens, m->compiled_tokens, (size_t)m->num_tokens * sizeof(Token));
+        nur->num_tokens = m->num_tokens;
+        memcpy(nur->function_table, m->functions, (size_t)m->num_functions * sizeof(FunctionDefinition));
+        nur->num_functions = m->num_functions;
+        memcpy(nur->struct_table, m->structs, (size_t)m->num_structs * sizeof(StructDefinition));
+        nur->num_structs = m->num_structs;
+        if (nur->expr_nodes_cap < m->num_expr_nodes) {
+            nur->expr_nodes_cap = m->num_expr_nodes;
+            nur->expr_nodes = realloc(nur->expr_nodes, (size_t)nur->expr_nodes_cap * sizeof(ExprNode));
+        }
+        if (nur->exprs_cap < m->num_exprs) {
+            nur->exprs_cap = m->num_exprs;
+            nur->exprs = realloc(nur->exprs, (size_t)nur->exprs_cap * sizeof(CompiledExpr));
+        }
+        if ((m->num_expr_nodes && !nur->expr_nodes) || (m->num_exprs && !nur->exprs)) { pthread_rwlock_unlock(&mc->lock); error("İfade önbelleği için bellek ayrılamadı."); }
+        if (m->num_expr_nodes) memcpy(nur->expr_nodes, m->expr_nodes, (size_t)m->num_expr_nodes * sizeof(ExprNode));
+        if (m->num_exprs) memcpy(nur->exprs, m->exprs, (size_t)m->num_exprs * sizeof(CompiledExpr));
+        nur->num_expr_nodes = m->num_expr_nodes; nur->num_exprs = m->num_exprs;
+    }
+    pthread_rwlock_unlock(&mc->lock);
+    return found;
+}
+// register_file_declarations başarıyla bittikten sonra çağrılır; girdi tokenize sırasında yayımlanmıştır.
+// revalidate'te girdi bu arada yenilenmiş olabilir; yalnızca aynı kaynağınkine eklenir.
+void module_cache_publish_compiled(const char* file_path) {
+    ModuleCache* mc = nur->module_cache;
+    char path[sizeof ((CachedModule*)0)->path];
+    if (!mc || !module_cache_key(mc, file_path, path)) return;
+    unsigned long long hash = mc->revalidate ? source_hash(nur->source_code) : 0;
+    Token* tokens = module_dup(nur->tokens, (size_t)nur->num_tokens * sizeof(Token));
+    FunctionDefinition* functions = module_dup(nur->function_table, (size_t)nur->num_functions * sizeof(FunctionDefinition));
+    StructDefinition* structs = module_dup(nur->struct_table, (size_t)nur->num_structs * sizeof(StructDefinition));
+    ExprNode* nodes = module_dup(nur->expr_nodes, (size_t)nur->num_expr_nodes * sizeof(ExprNode));
+    CompiledExpr* exprs = module_dup(nur->exprs, (size_t)nur->num_exprs * sizeof(CompiledExpr));
+    pthread_rwlock_wrlock(&mc->lock);
+    CachedModule* m = module_cache_find(mc, path);
+    if (m && !m->compiled_tokens && m->hash == hash) {
+        m->functions = functions; m->num_functions = nur->num_functions;
+        m->structs = structs; m->num_structs = nur->num_structs;
+        m->expr_nodes = nodes; m->num_expr_nodes = nur->num_expr_nodes;
+        m->exprs = exprs; m->num_exprs = nur->num_exprs;
+        m->compiled_tokens = tokens; // Son atanır: okuyucular bu alana bakar
+        tokens = NULL; functions = NULL; structs = NULL; nodes = NULL; exprs = NULL;
+    }
+    pthread_rwlock_unlock(&mc->lock);
+    free(tokens); free(functions); free(structs); free(nodes); free(exprs);
+}
+void module_cache_free(ModuleCache* mc) {
+    for (int b = 0; b < MODULE_CACHE_BUCKETS; ++b)
+        for (CachedModule* m = mc->buckets[b], *next; m; m = next) { next = m->next; module_free(m); }
+    pthread_rwlock_destroy(&mc->lock);
+}
+
+// --- Modül Kaydı ---
+// Anahtar dosyanın gerçek yoludur: farklı yazılan aynı dosya (ör. "a.cstar" ve "./a.cstar") bir kez yüklenir.
+void module_registry_key(const char* path, char* key) {
+    char resolved[PATH_MAX];
+    size_t cap = sizeof ((LoadedModule*)0)->key;
+    if (realpath(path, resolved) && strlen(resolved) < cap) strcpy(key, resolved);
+    else { copy_bounded(key, path, cap); }
+}
+LoadedModule* module_registry_find(const char* key) {
+    for (int i = 0; i < nur->num_modules; ++i) if (strcmp(nur->modules[i].key, key) == 0) return &nur->modules[i];
+    return NULL;
+}
+bool module_registry_full() { return nur->num_modules >= (int)(sizeof nur->modules / sizeof nur->modules[0]); }
+// Dosya sözcüklere ayrıldıktan sonra çağrılır: token aralığı [first_token, num_tokens).
+LoadedModule* module_registry_add(const char* name, const char* key, int first_token) {
+    if (module_registry_full()) error("Maksimum import sayısına ('MAX_IMPORTS') ulaşıldı.");
+    LoadedModule* m = &nur->modules[nur->num_modules++];
+    program_changed();
+    copy_bounded(m->name, name, MAX_FILENAME_LEN);
+    strcpy(m->key, key);
+    m->first_token = first_token; m->end_token = nur->num_tokens;
+    return m;
+}
+// Dosyayı token dizisinin sonuna sözcüklere ayırır (--batch / --serve: paylaşılan önbellekten kopyalanır).
+// Yalnızca bu dosyanın kaynağı okunur; içe aktaran dosyanın token'larına dokunulmaz.
+void module_lex_file(const char* path) {
+    if (module_cache_copy_lexed(path)) return;
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        char err_msg[MAX_STRING_LEN + 100];
+        snprintf(err_msg, sizeof err_msg, "İçe aktarılacak dosya ('%s') bulunamadı veya okunamadı.", path);
+        error(err_msg);
+    }
+    char text[MAX_SOURCE_SIZE];
+    size_t len = fread(text, 1, MAX_SOURCE_SIZE - 1, f);
+    text[len] = '\0';
+    fclose(f);
+    int first_token = nur->num_tokens;
+    nur->current_token_idx = first_token; // Sözcük hataları bu dosyanın satırıyla bildirilir
+    tokenize(text);
+    module_cache_publish_lexed(path, text, first_token);
+}
+
+// --- Derlenmiş Modül Dosyası (.nbc) ---
+// nur --compile lib.cstar [-o lib.nbc] 1. geçişin sonucunu yazar; import "lib.cstar" aynı dizinde güncel bir
+// lib.nbc varsa dosyayı sözcüklere ayırmak ve bildirimleri yeniden ayrıştırmak yerine onu yükler.
+// Düzen: başlık, sabit havuzu (NUL ile biten lexeme / string değerleri), token kayıtları, satır tablosu,
+// fonksiyon ve struct tabloları, derlenmiş ifade düğümleri ve ifadeler. Tüm token, düğüm ve ifade indisleri
+// modüle göredir; yükleme dosyayı salt okunur eşler ve kayıtları durumun dizilerinin sonuna taşır.
+// Kaynak dosya da varsa içeriğinin özeti başlıktakiyle tutmalıdır; tutmuyorsa (ya da dosya başka bir
+// yorumlayıcı sürümünün düzenindeyse) kaynak kullanılır.
+#define NBC_MAGIC 0x4342554eu // "NUBC"
+#define NBC_VERSION 1
+typedef struct {
+    unsigned magic, version, layout;
+    unsigned num_tokens, num_functions, num_structs, num_expr_nodes, num_exprs, pool_size;
+    unsigned long long source_hash;
+} NbcHeader;
+typedef struct {
+    long long int_value;
+    double float_value;
+    unsigned lexeme, string; // Sabit havuzu ofsetleri
+    int expr; // Modüle göre ifade indisi; -1 yok
+    unsigned short type;
+    bool bool_value;
+} NbcToken;
+
+// Kayıt boyutları ve token tipi sayısı: yorumlayıcı değiştiyse eski dosyalar kullanılmaz.
+unsigned nbc_layout() {
+    unsigned parts[] = { sizeof(NbcToken), sizeof(FunctionDefinition), sizeof(StructDefinition), sizeof(ExprNode), sizeof(CompiledExpr), TOKEN_NOT + 1, VAR_GENERATOR + 1 };
+    unsigned h = 2166136261u;
+    for (size_t i = 0; i < sizeof parts / sizeof parts[0]; ++i) h = (h ^ parts[i]) * 16777619u;
+    return h;
+}
+static inline size_t nbc_align8(size_t n) { return (n + 7) & ~(size_t)7; }
+// Bölüm ofsetleri başlıktaki sayılardan hesaplanır; dönüş değeri beklenen dosya boyutudur.
+size_t nbc_sections(const NbcHeader* h, size_t off[7]) {
+    size_t sizes[7] = { h->pool_size, (size_t)h->num_tokens * sizeof(NbcToken), (size_t)h->num_tokens * sizeof(int),
+        (size_t)h->num_functions * sizeof(FunctionDefinition), (size_t)h->num_structs * sizeof(StructDefinition),
+        (size_t)h->num_expr_nodes * sizeof(ExprNode), (size_t)h->num_exprs * sizeof(CompiledExpr) };
+    size_t pos = nbc_align8(sizeof(NbcHeader));
+    for (int i = 0; i < 7; ++i) { off[i] = pos; pos = nbc_align8(pos + sizes[i]); }
+    return pos;
+}
+// ".cstar" gibi uzantı ".nbc" ile değiştirilir; uzantı yoksa eklenir. false: yol sığmıyor.
+bool nbc_path_for(const char* source_path, char* out, size_t cap) {
+    const char* slash = strrchr(source_path, '/');
+    const char* dot = strrchr(source_path, '.');
+    size_t stem = dot && (!slash || dot > slash) ? (size_t)(dot - source_path) : strlen(source_path);
+    return (size_t)snprintf(out, cap, "%.*s.nbc", (int)stem, source_path) < cap;
+}
+static inline bool nbc_has_extension(const char* path) {
+    size_t n = strlen(path);
+    return n >= 4 && strcmp(path + n - 4, ".nbc") == 0;
+}
+
+// Sabit havuzu: aynı metin bir kez saklanır (açık adresli özet tablosu).
+typedef struct { char* data; size_t len, cap; unsigned* slots; size_t num_slots; } NbcPool;
+unsigned nbc_pool_add(NbcPool* p, const char* s) {
+    size_t n = strlen(s) + 1;
+    unsigned h = 2166136261u;
+    for (const char* c = s; *c; ++c) h = (h ^ (unsigned char)*c) * 16777619u;
+    size_t i = h & (p->num_slots - 1);
+    for (; p->slots[i]; i = (i + 1) & (p->num_slots - 1))
+        if (strcmp(p->data + p->slots[i] - 1, s) == 0) return p->slots[i] - 1;
+    if (p->len + n > p->cap) {
+        while (p->len + n > p->cap) p->cap *= 2;
+        char* grown = realloc(p->data, p->cap);
+        if (!grown) error("Derlenmiş modül için bellek ayrılamadı.");
+        p->data = grown;
+    }
+    memcpy(p->data + p->len, s, n);
+    p->slots[i] = (unsigned)p->len + 1; // 0: boş yuva
+    p->len += n;
+    return (unsigned)(p->len - n);
+}
+
+// Derlenmiş durumun (nur_compile sonrası, tek dosya) token, fonksiyon, struct ve ifade tablolarını yazar.
+void nbc_write(const char* out_path) {
+    NbcHeader h;
+    memset(&h, 0, sizeof h); // Dolgu baytları da belirli olsun
+    h.magic = NBC_MAGIC; h.version = NBC_VERSION; h.layout = nbc_layout();
+    h.num_tokens = (unsigned)nur->num_tokens; h.num_functions = (unsigned)nur->num_functions; h.num_structs = (unsigned)nur->num_structs;
+    h.num_expr_nodes = (unsigned)nur->num_expr_nodes; h.num_exprs = (unsigned)nur->num_exprs;
+    h.source_hash = source_hash(nur->source_code);
+    NbcPool pool = { malloc(4096), 0, 4096, NULL, 1 };
+    while (pool.num_slots < 4 * (size_t)nur->num_tokens + 2) pool.num_slots *= 2;
+    pool.slots = calloc(pool.num_slots, sizeof(unsigned));
+    NbcToken* records = calloc((size_t)nur->num_tokens + 1, sizeof(NbcToken));
+    int* lines = malloc(((size_t)nur->num_tokens + 1) * sizeof(int));
+    if (!pool.data || !pool.slots || !records || !lines) { free(pool.data); free(pool.slots); free(records); free(lines); error("Derlenmiş modül için bellek ayrılamadı."); }
+    nbc_pool_add(&pool, ""); // Ofset 0: boş metin
+    for (int i = 0; i < nur->num_tokens; ++i) {
+        const Token* t = &nur->tokens[i];
+        NbcToken* r = &records[i];
+        r->type = (unsigned short)t->type; r->bool_value = t->bool_value;
+        r->int_value = t->int_value; r->float_value = t->float_value;
+        r->lexeme = nbc_pool_add(&pool, t->lexeme);
+        r->string = nbc_pool_add(&pool, t->string_value);
+        r->expr = t->expr_cache;
+        lines[i] = t->line;
+    }
+    h.pool_size = (unsigned)pool.len;
+    size_t off[7];
+    size_t total = nbc_sections(&h, off);
+    const void* data[7] = { pool.data, records, lines, nur->function_table, nur->struct_table, nur->expr_nodes, nur->exprs };
+    size_t sizes[7] = { pool.len, (size_t)h.num_tokens * sizeof(NbcToken), (size_t)h.num_tokens * sizeof(int),
+        (size_t)h.num_functions * sizeof(FunctionDefinition), (size_t)h.num_structs * sizeof(StructDefinition),
+        (size_t)h.num_expr_nodes * sizeof(ExprNode), (size_t)h.num_exprs * sizeof(CompiledExpr) };
+    char* image = calloc(1, total);
+    if (image) {
+        memcpy(image, &h, sizeof h);
+        for (int i = 0; i < 7; ++i) if (sizes[i] && i != 5) memcpy(image + off[i], data[i], sizes[i]);
+        ExprNode* nodes = (ExprNode*)(image + off[5]); // Alan alan: dolgu baytları sıfır kalır, çıktı her derlemede aynıdır
+        for (int i = 0; i < nur->num_expr_nodes; ++i) {
+            const ExprNode* n = &nur->expr_nodes[i];
+            nodes[i].kind = n->kind; nodes[i].op = n->op; nodes[i].tok = n->tok; nodes[i].jump = n->jump;
+        }
+    }
+    free(pool.data); free(pool.slots); free(records); free(lines);
+    if (!image) error("Derlenmiş modül için bellek ayrılamadı.");
+    // Geçici dosyaya yazılıp yeniden adlandırılır: dosyayı eşlemiş süreçler eski içeriği görmeye devam eder
+    char tmp[2 * MAX_FILENAME_LEN + 32];
+    snprintf(tmp, sizeof tmp, "%s.%d.tmp", out_path, (int)getpid());
+    FILE* f = fopen(tmp, "wb");
+    bool ok = f && fwrite(image, 1, total, f) == total;
+    if (f && fclose(f) != 0) ok = false;
+    free(image);
+    if (ok && rename(tmp, out_path) == 0) return;
+    char err[sizeof tmp + 128];
+    snprintf(err, sizeof err, "'%s' yazılamadı: %s", out_path, strerror(errno));
+    unlink(tmp);
+    error(err);
+}
+
+// Ad alanı MAX_IDENT_LEN içinde sonlanmalı; dosyadan gelen tip değerleri enum aralığında olmalı.
+static bool nbc_name_ok(const char* name) { return memchr(name, '\0', MAX_IDENT_LEN) != NULL; }
+static bool nbc_scalar_type_ok(VarType type) { // struct alanı ve parametre olabilen tipler
+    return (type >= VAR_INT && type <= VAR_BOOLEAN) || (type >= VAR_I64 && type <= VAR_GENERATOR);
+}
+
+// Eşlenen dosyanın tüm indis ve ofsetlerini sınırlarla karşılaştırır. Struct düzeni alan tiplerinden
+// yeniden hesaplanır ve dosyadakiyle birebir eşleşmelidir (ofsetler doğrudan bellek erişiminde kullanılır).
+bool nbc_valid(const char* base, size_t size) {
+    const NbcHeader* h = (const NbcHeader*)base;
+    if (size < sizeof *h || h->magic != NBC_MAGIC || h->version != NBC_VERSION || h->layout != nbc_layout()) return false;
+    size_t off[7];
+    if (nbc_sections(h, off) != size || h->num_tokens == 0 || h->pool_size == 0) return false;
+    const char* pool = base + off[0];
+    const NbcToken* tokens = (const NbcToken*)(base + off[1]);
+    const FunctionDefinition* functions = (const FunctionDefinition*)(base + off[3]);
+    const StructDefinition* structs = (const StructDefinition*)(base + off[4]);
+    const ExprNode* nodes = (const ExprNode*)(base + off[5]);
+    const CompiledExpr* exprs = (const CompiledExpr*)(base + off[6]);
+    if (pool[h->pool_size - 1] != '\0' || h->num_functions > MAX_FUNCTIONS || h->num_structs > MAX_STRUCTS) return false;
+    for (unsigned i = 0; i < h->num_tokens; ++i) {
+        const NbcToken* t = &tokens[i];
+        if (t->type > TOKEN_NOT || t->lexeme >= h->pool_size || t->string >= h->pool_size) return false;
+        if (strlen(pool + t->lexeme) >= MAX_STRING_LEN || strlen(pool + t->string) >= MAX_STRING_LEN) return false;
+        if (t->expr < -1 || t->expr >= (int)h->num_exprs) return false;
+    }
+    if (tokens[h->num_tokens - 1].type != TOKEN_EOF) return false;
+    for (unsigned i = 0; i < h->num_functions; ++i) {
+        const FunctionDefinition* f = &functions[i];
+        if (!nbc_name_ok(f->name) || f->num_params < 0 || f->num_params > MAX_PARAMETERS) return false;
+        for (int k = 0; k < f->num_params; ++k) if (!nbc_name_ok(f->params[k].name) || !nbc_scalar_type_ok(f->params[k].type)) return false;
+        if (f->return_type < VAR_NULL_TYPE || f->return_type > VAR_GENERATOR || f->return_type == VAR_STRUCT) return false;
+        if (f->return_type == VAR_GENERATOR && !nbc_scalar_type_ok(f->yield_type)) return false;
+        if (f->body_start_token_idx < 0 || f->body_start_token_idx >= (int)h->num_tokens
+            || tokens[f->body_start_token_idx].type != TOKEN_LBRACE) return false;
+    }
+    for (unsigned i = 0; i < h->num_structs; ++i) {
+        const StructDefinition* sd = &structs[i];
+        if (!nbc_name_ok(sd->name) || sd->num_fields < 1 || sd->num_fields > MAX_STRUCT_FIELDS) return false;
+        size_t expect_size = 0, expect_align = 1;
+        for (int k = 0; k < sd->num_fields; ++k) {
+            const StructField* f = &sd->fields[k];
+            if (!nbc_name_ok(f->name) || !nbc_scalar_type_ok(f->type)) return false;
+            size_t a = get_alignof_element_type(f->type);
+            expect_size = (expect_size + a - 1) / a * a;
+            if (f->offset != expect_size || f->size != get_sizeof_element_type(f->type)) return false;
+            expect_size += f->size;
+            if (a > expect_align) expect_align = a;
+        }
+        if (sd->align != expect_align || sd->size != (expect_size + expect_align - 1) / expect_align * expect_align) return false;
+    }
+    for (unsigned i = 0; i < h->num_expr_nodes; ++i)
+        if (nodes[i].kind > EXPR_LOGIC_END || nodes[i].op > TOKEN_NOT || nodes[i].tok < 0 || nodes[i].tok >= (int)h->num_tokens) return false;
+    for (unsigned i = 0; i < h->num_exprs; ++i) {
+        const CompiledExpr* e = &exprs[i];
+        if (e->first < 0 || e->count < 0 || (unsigned)e->first + (unsigned)e->count > h->num_expr_nodes
+            || e->end_token < 0 || e->end_token >= (int)h->num_tokens) return false;
+        for (int k = e->first; k < e->first + e->count; ++k) if (nodes[k].jump < -1 || nodes[k].jump > e->count) return false; // -1: atlama yok
+    }
+    return true;
+}
+
+// Eşlenmiş modülü token dizisinin sonuna ekler, fonksiyon ve struct bildirimlerini kaydeder (1. geçiş yapılmış sayılır).
+// false: bildirim çakışması veya sınır aşımı; ileti err'e yazılır, durum değişmez.
+bool nbc_load(const char* base, char* err, size_t err_cap) {
+    const NbcHeader* h = (const NbcHeader*)base;
+    size_t off[7];
+    nbc_sections(h, off);
+    const char* pool = base + off[0];
+    const NbcToken* records = (const NbcToken*)(base + off[1]);
+    const int* lines = (const int*)(base + off[2]);
+    const FunctionDefinition* functions = (const FunctionDefinition*)(base + off[3]);
+    const StructDefinition* structs = (const StructDefinition*)(base + off[4]);
+    const ExprNode* nodes = (const ExprNode*)(base + off[5]);
+    const CompiledExpr* exprs = (const CompiledExpr*)(base + off[6]);
+    int first_token = nur->num_tokens;
+    if (first_token + (long long)h->num_tokens > MAX_TOKENS) { snprintf(err, err_cap, "Token sınırı ('MAX_TOKENS') aşıldı."); return false; }
+    for (unsigned i = 0; i < h->num_structs; ++i) {
+        if (find_struct(structs[i].name) >= 0) { snprintf(err, err_cap, "'%s' adlı struct zaten tanımlı.", structs[i].name); return false; }
+        if (nur->num_structs + (int)i >= MAX_STRUCTS) { snprintf(err, err_cap, "Maksimum struct sayısına ulaşıldı."); return false; }
+    }
+    for (unsigned i = 0; i < h->num_functions; ++i) {
+        nur->current_line = lines[functions[i].body_start_token_idx]; // Hata iletisi için
+        if (find_function(functions[i].name)) { snprintf(err, err_cap, "'%s' adlı fonksiyon zaten tanımlı.", functions[i].name); return false; }
+        if (find_native(functions[i].name) >= 0) { snprintf(err, err_cap, "'%s' bir dahili komut adıdır, fonksiyon adı olarak kullanılamaz.", functions[i].name); return false; }
+        if (nur->num_functions + (int)i >= MAX_FUNCTIONS) { snprintf(err, err_cap, "Maksimum fonksiyon sayısına ulaşıldı."); return false; }
+    }
+    if (nur->expr_nodes_cap < nur->num_expr_nodes + (int)h->num_expr_nodes) {
+        nur->expr_nodes_cap = nur->num_expr_nodes + (int)h->num_expr_nodes;
+        nur->expr_nodes = realloc(nur->expr_nodes, (size_t)nur->expr_nodes_cap * sizeof(ExprNode));
+    }
+    if (nur->exprs_cap < nur->num_exprs + (int)h->num_exprs) {
+        nur->exprs_cap = nur->num_exprs + (int)h->num_exprs;
+        nur->exprs = realloc(nur->exprs, (size_t)nur->exprs_cap * sizeof(CompiledExpr));
+    }
+    if ((nur->expr_nodes_cap && !nur->expr_nodes) || (nur->exprs_cap && !nur->exprs)) { snprintf(err, err_cap, "İfade önbelleği için bellek ayrılamadı."); return false; }
+    int node_base = nur->num_expr_nodes, expr_base = nur->num_exprs;
+    for (unsigned i = 0; i < h->num_tokens; ++i) {
+        const NbcToken* r = &records[i];
+        Token* t = &nur->tokens[first_token + i];
+        t->type = (TokenType)r->type; t->bool_value = r->bool_value;
+        t->int_value = r->int_value; t->float_value = r->float_value;
+        strcpy(t->lexeme, pool + r->lexeme);
+        strcpy(t->string_value, pool + r->string);
+        t->line = lines[i];
+        t->cache_struct_idx = -1; t->cache_field_idx = -1; t->cache_native_idx = -2;
+        t->expr_cache = r->expr < 0 ? -1 : expr_base + r->expr;
+    }
+    for (unsigned i = 0; i < h->num_expr_nodes; ++i) {
+        ExprNode n = nodes[i];
+        n.tok += first_token;
+        nur->expr_nodes[node_base + i] = n;
+    }
+    for (unsigned i = 0; i < h->num_exprs; ++i)
+        nur->exprs[expr_base + i] = (CompiledExpr){ node_base + exprs[i].first, exprs[i].count, first_token + exprs[i].end_token };
+    for (unsigned i = 0; i < h->num_structs; ++i) nur->struct_table[nur->num_structs++] = structs[i];
+    for (unsigned i = 0; i < h->num_functions; ++i) {
+        FunctionDefinition* f = &nur->function_table[nur->num_functions++];
+        *f = functions[i];
+        f->body_start_token_idx += first_token;
+    }
+    nur->num_expr_nodes += (int)h->num_expr_nodes; nur->num_exprs += (int)h->num_exprs;
+    nur->num_tokens += (int)h->num_tokens;
+    return true;
+}
+
+// İçe aktarılan dosya için güncel bir .nbc varsa onu yükler. Yol ".nbc" ile bitiyorsa kaynak aranmaz.
+// false: derlenmiş dosya yok veya eski; çağıran kaynağı sözcüklere ayırır.
+bool module_load_precompiled(const char* path) {
+    char nbc_path[2 * MAX_FILENAME_LEN];
+    bool direct = nbc_has_extension(path);
+    if (direct) snprintf(nbc_path, sizeof nbc_path, "%s", path);
+    else if (!nbc_path_for(path, nbc_path, sizeof nbc_path)) return false;
+    int fd = open(nbc_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (!direct) return false;
+        char err[sizeof nbc_path + 100]; snprintf(err, sizeof err, "İçe aktarılacak dosya ('%s') bulunamadı veya okunamadı.", path); error(err);
+    }
+    struct stat sb;
+    void* base = fstat(fd, &sb) == 0 && sb.st_size > 0 ? mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    bool usable = base != MAP_FAILED && nbc_valid(base, (size_t)sb.st_size);
+    if (usable && !direct) { // Kaynak varsa derlenmiş dosya onun bugünkü içeriğinden üretilmiş olmalı
+        FILE* f = fopen(path, "r");
+        if (f) {
+            char text[MAX_SOURCE_SIZE];
+            size_t n = fread(text, 1, MAX_SOURCE_SIZE - 1, f); text[n] = '\0'; fclose(f);
+            usable = source_hash(text) == ((const NbcHeader*)base)->source_hash;
+        }
+    }
+    if (!usable) {
+        if (base != MAP_FAILED) munmap(base, (size_t)sb.st_size);
+        if (!direct) return false;
+        char err[sizeof nbc_path + 100]; snprintf(err, sizeof err, "'%s' bu yorumlayıcı sürümüyle uyumlu bir derlenmiş modül değil.", path); error(err);
+    }
+    char err[MAX_IDENT_LEN + 100];
+    bool loaded = nbc_load(base, err, sizeof err);
+    munmap(base, (size_t)sb.st_size);
+    if (!loaded) { nur->current_token_idx = nur->num_tokens; error(err); } // Bu dosyanın adı ve satırıyla bildirilir
+    return true;
+}
+
 void parse_import_statement(bool execute) { 
     consume_token(TOKEN_IMPORT); Token file_token =consume_token(TOKEN_STRING_LITERAL); consume_token(TOKEN_SEMICOLON);
     if(execute){
-        // Check if already imported
-        for(int i=0;i<num_imported_files;++i)if(strcmp(imported_files[i],file_token.string_value)==0)return; // Already imported, do nothing
-        
-        if(num_imported_files>=MAX_IMPORTS)error("Maksimum import sayısına ('MAX_IMPORTS') ulaşıldı.");
-        strncpy(imported_files[num_imported_files++],file_token.string_value,MAX_FILENAME_LEN-1);
-        imported_files[num_imported_files-1][MAX_FILENAME_LEN-1]='\0';
-        
-        // Save current interpreter state
-        char* saved_src_code_backup = strdup(source_code); 
-        if(!saved_src_code_backup) error("strdup bellek hatası (import için kaynak kod yedekleme).");
-        
-        Token* saved_tokens_backup = (Token*)malloc(sizeof(Token)*MAX_TOKENS); // MAX_TOKENS should be current num_tokens capacity
-        if(!saved_tokens_backup) {free(saved_src_code_backup); error("Import için token belleği ayrılamadı (yedekleme).");}
-        memcpy(saved_tokens_backup, tokens, sizeof(Token)*num_tokens); // Save current tokens
+        // Zaten yüklenmiş modül (yeniden içe aktarma, iki modülün ortak bağımlılığı) tekrar çalıştırılmaz
+        char key[sizeof ((LoadedModule*)0)->key];
+        module_registry_key(file_token.string_value, key);
+        if (module_registry_find(key)) return;
+        if (module_registry_full()) error("Maksimum import sayısına ('MAX_IMPORTS') ulaşıldı.");
         
-        int saved_num_tokens = num_tokens;
-        int saved_current_token_idx = current_token_idx;
-        int saved_current_line = current_line;
+        int saved_current_token_idx = nur->current_token_idx;
+        int saved_current_line = nur->current_line;
         char prev_file_path_for_errors_backup[MAX_FILENAME_LEN]; 
-        strncpy(prev_file_path_for_errors_backup, current_file_path_for_errors, MAX_FILENAME_LEN);
-        prev_file_path_for_errors_backup[MAX_FILENAME_LEN-1] = '\0';
+        strcpy(prev_file_path_for_errors_backup, nur->current_file_path_for_errors);
         
-        // Set global pointers for potential cleanup in error() during import
-        g_importer_saved_source_code = saved_src_code_backup;
-        g_importer_saved_tokens = saved_tokens_backup;
+        // Modülün token'ları dizinin sonuna eklenir: fonksiyon gövdeleri içe aktarma bittikten sonra da geçerli kalır
+        int first_token = nur->num_tokens;
+        copy_bounded(nur->current_file_path_for_errors, file_token.string_value, MAX_FILENAME_LEN);
+        bool precompiled = module_load_precompiled(file_token.string_value); // Güncel .nbc: bildirimler kaydedildi
+        if (!precompiled) module_lex_file(file_token.string_value);
+        LoadedModule* m = module_registry_add(file_token.string_value, key, first_token); // Döngüsel içe aktarma da artık bulur
+        nur->current_token_idx = first_token;
         
-        // Load and tokenize the new file
-        FILE* import_file_ptr =fopen(file_token.string_value,"r");
-        if(!import_file_ptr){
-            char err_msg[MAX_STRING_LEN+100];
-            sprintf(err_msg,"İçe aktarılacak dosya ('%s') bulunamadı veya okunamadı.",file_token.string_value);
-            // Cleanup allocated memory before erroring
-            free(g_importer_saved_source_code); g_importer_saved_source_code = NULL;
-            free(g_importer_saved_tokens); g_importer_saved_tokens = NULL;
-            error(err_msg);
-        }
-        size_t len_read_import =fread(source_code,1,MAX_SOURCE_SIZE-1,import_file_ptr);
-        source_code[len_read_import]='\0';
-        fclose(import_file_ptr);
-        
-        // Note: Global variables like num_functions, num_variables are NOT saved/restored here.
-        // Imports modify the global state (add functions, potentially global vars if allowed by language spec).
-        // If imports should be isolated, more complex state management is needed.
-        // Current model: imports merge their definitions into the global namespace.
-        
-        tokenize(); // Tokenize the new source_code
-        current_token_idx=0; 
+        // Imports merge their definitions into the global namespace.
+        interpret_current_file_tokens(m->name, !precompiled);
         
-        interpret_current_file_tokens(file_token.string_value); // Interpret the new tokens
-        
-        // Restore interpreter state for the original file
-        strncpy(source_code,saved_src_code_backup,MAX_SOURCE_SIZE-1);source_code[MAX_SOURCE_SIZE-1]='\0';
-        free(saved_src_code_backup); g_importer_saved_source_code = NULL;
-        
-        memcpy(tokens,saved_tokens_backup,sizeof(Token)*saved_num_tokens); // Restore original tokens
-        free(saved_tokens_backup); g_importer_saved_tokens = NULL;
-        
-        num_tokens = saved_num_tokens;
-        current_token_idx = saved_current_token_idx;
-        current_line = saved_current_line;
-        strncpy(current_file_path_for_errors, prev_file_path_for_errors_backup, MAX_FILENAME_LEN);
+        nur->current_token_idx = saved_current_token_idx;
+        nur->current_line = saved_current_line;
+        strcpy(nur->current_file_path_for_errors, prev_file_path_for_errors_backup);
     }
 }
 
-void interpret_current_file_tokens(const char* filepath_display_name) {
-    char previous_filepath_for_errors[MAX_FILENAME_LEN]; 
-    strncpy(previous_filepath_for_errors,current_file_path_for_errors,MAX_FILENAME_LEN-1);
-    previous_filepath_for_errors[MAX_FILENAME_LEN-1]='\0';
-    strncpy(current_file_path_for_errors,filepath_display_name,MAX_FILENAME_LEN-1);
-    current_file_path_for_errors[MAX_FILENAME_LEN-1]='\0';
-    
-    bool top_level_break_flag=false, top_level_continue_flag=false; 
-    int previous_loop_depth = loop_depth; loop_depth=0; // Reset loop depth for this file context
-    int previous_scope_stack_ptr = scope_stack_ptr; // Save current scope stack state
-    // Note: call_stack_ptr is NOT reset here, as imports can happen within function calls.
-    
-    int initial_token_idx_for_file = current_token_idx; 
+// 1. geçiş: dosyadaki fonksiyon ve struct bildirimlerini kaydeder; token konumu geri alınır.
+void register_file_declarations() {
+    int initial_token_idx_for_file = nur->current_token_idx; 
     
     // 1. Pass: Parse all top-level function declarations in the current token stream
-    while(tokens[current_token_idx].type != TOKEN_EOF) { // Use tokens[idx] to avoid issues if num_tokens changes due to error
-        if (tokens[current_token_idx].type == TOKEN_FUN) {
+    while(nur->tokens[nur->current_token_idx].type != TOKEN_EOF) { // Use tokens[idx] to avoid issues if num_tokens changes due to error
+        if (nur->tokens[nur->current_token_idx].type == TOKEN_FUN) {
             parse_fun_declaration(); // This advances current_token_idx past the function
+        } else if (nur->tokens[nur->current_token_idx].type == TOKEN_STRUCT) {
+            parse_struct_declaration(true);
         } else {
             // To skip other top-level statements robustly, parse them with execute=false
             // This ensures current_token_idx advances correctly over them.
-            int temp_idx_before_skip = current_token_idx;
+            int temp_idx_before_skip = nur->current_token_idx;
             bool dummy_b=false, dummy_c=false;
             // false for in_function_body because these are top-level statements
             parse_statement(false, &dummy_b, &dummy_c, false); 
-            if (current_token_idx == temp_idx_before_skip && tokens[current_token_idx].type != TOKEN_EOF) {
+            if (nur->current_token_idx == temp_idx_before_skip && nur->tokens[nur->current_token_idx].type != TOKEN_EOF) {
                 // If parse_statement didn't advance (e.g., on an error token it couldn't handle, or empty statement ";"),
                 // force advancement to prevent infinite loop.
-                current_token_idx++; 
+                nur->current_token_idx++; 
             }
         }
     }
     
-    current_token_idx = initial_token_idx_for_file; // Reset for execution pass
-    
-    bool global_scope_opened_for_this_file = false;
-    // A file's top-level execution should have its own global-like scope
-    // IF it's the main file or an import NOT happening inside a function call's context.
-    // If call_stack_ptr > -1, we are inside a function call, global scope is already established by main or outer file.
-    // Top level of a file IS a scope.
-    if(call_stack_ptr == -1) { // If not currently executing inside any function
-        enter_scope(); 
-        global_scope_opened_for_this_file = true;
-    }
-    
-    g_return_flag = false; // Reset global return flag before executing statements of this file
+    nur->current_token_idx = initial_token_idx_for_file;
+}
+
+// 2. geçiş: en üst düzey deyimleri çalıştırır (bildirimler atlanır). Kapsamı çağıran yönetir.
+void execute_file_statements() {
+    bool top_level_break_flag=false, top_level_continue_flag=false; 
+    nur->return_flag = false; // Reset global return flag before executing statements of this file
     
     // 2. Pass: Execute all statements (function definitions are skipped by their parsing logic)
-    while(tokens[current_token_idx].type != TOKEN_EOF) { 
-        if (tokens[current_token_idx].type == TOKEN_FUN) {
+    while(nur->tokens[nur->current_token_idx].type != TOKEN_EOF) { 
+        if (nur->tokens[nur->current_token_idx].type == TOKEN_STRUCT) {
+            parse_struct_declaration(false); // Registered in pass 1, just skip
+        } else if (nur->tokens[nur->current_token_idx].type == TOKEN_FUN) {
             // Skip already parsed function definition. parse_fun_declaration (called in pass 1)
             // already advanced current_token_idx past the function.
             // So, we need a robust way to skip it again here.
@@ -1604,40 +6842,67 @@ void interpret_current_file_tokens(const char* filepath_display_name) {
             consume_token(TOKEN_IDENTIFIER); 
             consume_token(TOKEN_LPAREN);
             int paren_level = 1; // For parameters
-            while(paren_level > 0 && tokens[current_token_idx].type != TOKEN_EOF) {
-                if(tokens[current_token_idx].type == TOKEN_LPAREN) paren_level++;
-                else if(tokens[current_token_idx].type == TOKEN_RPAREN) paren_level--;
+            while(paren_level > 0 && nur->tokens[nur->current_token_idx].type != TOKEN_EOF) {
+                if(nur->tokens[nur->current_token_idx].type == TOKEN_LPAREN) paren_level++;
+                else if(nur->tokens[nur->current_token_idx].type == TOKEN_RPAREN) paren_level--;
                 
-                if (tokens[current_token_idx].type != TOKEN_EOF) consume_token(tokens[current_token_idx].type); // Consume whatever token it is
+                if (nur->tokens[nur->current_token_idx].type != TOKEN_EOF) consume_token(nur->tokens[nur->current_token_idx].type); // Consume whatever token it is
                 else break; // EOF reached unexpectedly
             }
             // if (paren_level != 0) error("Fonksiyon tanımı atlarken eşleşmeyen parantez."); // Should be caught by parser
             
-            if(tokens[current_token_idx].type == TOKEN_COLON){ // Optional return type
+            if(nur->tokens[nur->current_token_idx].type == TOKEN_COLON){ // Optional return type
                 consume_token(TOKEN_COLON);
                 parse_type_specifier(); // Consumes the type token
             } 
-            if(tokens[current_token_idx].type==TOKEN_LBRACE){ // Function body
+            if(nur->tokens[nur->current_token_idx].type==TOKEN_LBRACE){ // Function body
                 bool dummy_b=false,dummy_c=false; 
                 parse_block(false,&dummy_b,&dummy_c,true); // Parse block with execute=false, true for in_function_body context
-            } else if (tokens[current_token_idx].type != TOKEN_EOF) { // Should be LBRACE or EOF
+            } else if (nur->tokens[nur->current_token_idx].type != TOKEN_EOF) { // Should be LBRACE or EOF
                 error("Fonksiyon gövdesi ('{') bekleniyordu (ikinci geçişte fonksiyon tanımı atlarken).");
             }
             
         } else { // Not a function definition, so it's a statement to execute
             parse_statement(true, &top_level_break_flag, &top_level_continue_flag, false); // false for in_function_body
             
-            if(g_return_flag) { // A return statement was executed at top level
+            if(nur->return_flag) { // A return statement was executed at top level
                 error("'return' ifadesi sadece bir fonksiyon gövdesi içinde kullanılabilir (en üst düzeyde 'return' bulundu).");
             }
             if(top_level_break_flag || top_level_continue_flag){
-                char err_msg[200];
-                sprintf(err_msg,"'break' veya 'continue' ifadeleri '%s' dosyasının en üst düzeyinde (bir döngü dışında) kullanılamaz.",current_file_path_for_errors);
+                char err_msg[MAX_FILENAME_LEN + 150];
+                sprintf(err_msg,"'break' veya 'continue' ifadeleri '%s' dosyasının en üst düzeyinde (bir döngü dışında) kullanılamaz.",nur->current_file_path_for_errors);
                 error(err_msg);
             }
         }
     }
     
+}
+
+// register_declarations false: 1. geçiş yapılmış (derlenmiş modül), yalnızca deyimler çalıştırılır.
+void interpret_current_file_tokens(const char* filepath_display_name, bool register_declarations) {
+    char previous_filepath_for_errors[MAX_FILENAME_LEN]; 
+    copy_bounded(previous_filepath_for_errors, nur->current_file_path_for_errors, MAX_FILENAME_LEN);
+    if (filepath_display_name != nur->current_file_path_for_errors) copy_bounded(nur->current_file_path_for_errors, filepath_display_name, MAX_FILENAME_LEN);
+    
+    int previous_loop_depth = nur->loop_depth; nur->loop_depth=0; // Reset loop depth for this file context
+    int previous_scope_stack_ptr = nur->scope_stack_ptr; // Save current scope stack state
+    // Note: call_stack_ptr is NOT reset here, as imports can happen within function calls.
+    
+    if (register_declarations) register_file_declarations();
+    
+    bool global_scope_opened_for_this_file = false;
+    // A file's top-level execution should have its own global-like scope
+    // IF it's the main file or an import NOT happening inside a function call's context.
+    // If call_stack_ptr > -1, we are inside a function call, global scope is already established by main or outer file.
+    // Top level of a file IS a scope.
+    if(nur->call_stack_ptr == -1) { // If not currently executing inside any function
+        enter_scope(); 
+        global_scope_opened_for_this_file = true;
+    }
+    
+    execute_file_statements();
+    if (previous_scope_stack_ptr == -1) spawn_wait_all(); // Ana dosya: iş parçacıkları global değişkenler bırakılmadan biter
+    
     if (global_scope_opened_for_this_file) {
         exit_scope(); // Close the top-level scope for this file
     }
@@ -1650,15 +6915,645 @@ void interpret_current_file_tokens(const char* filepath_display_name) {
     // If `global_scope_opened_for_this_file` was true, `scope_stack_ptr` should now be `previous_scope_stack_ptr`.
     // If it was false, `scope_stack_ptr` should not have been changed by this function's direct enter/exit.
     
-    loop_depth = previous_loop_depth; // Restore loop depth for the calling context
-    strncpy(current_file_path_for_errors,previous_filepath_for_errors,MAX_FILENAME_LEN-1); 
+    nur->loop_depth = previous_loop_depth; // Restore loop depth for the calling context
+    copy_bounded(nur->current_file_path_for_errors, previous_filepath_for_errors, MAX_FILENAME_LEN); 
+}
+
+// --- Gömülü Kullanım (nur.h) ---
+// API fonksiyonları verilen durumu çağrı boyunca etkin yapar ve gövdeyi nur_protected içinde çalıştırır:
+// gövdede error() çağrılırsa denetim setjmp noktasına döner, kapsamlar ve yığınlar geri sarılır.
+static pthread_once_t nur_process_once = PTHREAD_ONCE_INIT;
+static void nur_process_init() { init_simd_kernels(); register_core_natives(); }
+
+NurState* nur_create(void) {
+    pthread_once(&nur_process_once, nur_process_init);
+    NurState* st = calloc(1, sizeof(NurState)); // ~12 MB; büyük tablolar dokunulana kadar sıfır sayfa olarak kalır
+    if (!st) return NULL;
+    st->current_line = 1; st->last_type_struct_idx = -1;
+    st->call_stack_ptr = -1; st->scope_stack_ptr = -1; st->for_loop_var_stack_ptr = -1;
+    st->out = stdout; st->in_fd = STDIN_FILENO;
+    st->symbol_table = st->symbol_storage; st->call_stack = st->call_storage; st->scope_stack = st->scope_storage;
+    st->for_loop_vars_stack = st->loop_var_storage; st->eval_stack = st->eval_storage;
+    return st;
+}
+
+// Hata sonrası: scope_base üstündeki kapsamlar (ve dizi bellekleri) bırakılır, çağrı ve ifade yığınları sıfırlanır.
+static void nur_unwind(int scope_base) {
+    while (nur->scope_stack_ptr > scope_base) exit_scope();
+    nur->call_stack_ptr = -1; nur->loop_depth = 0; nur->for_loop_var_stack_ptr = -1;
+    nur->return_flag = false; nur->eval_sp = 0; nur->expr_depth = 0; nur->expr_builder = NULL;
+    nur->mapping_allowed = false;
+}
+
+static int nur_protected(NurState* st, void (*body)(void*), void* ctx) {
+    NurState* prev_state = nur;
+    jmp_buf* prev_jmp = st->error_jmp;
+    jmp_buf env;
+    volatile int rc = NUR_OK;
+    nur = st;
+    int scope_base = st->scope_stack_ptr;
+    st->error_message[0] = '\0';
+    if (setjmp(env) == 0) {
+        st->error_jmp = &env;
+        body(ctx);
+        flush_output();
+    } else {
+        nur_unwind(scope_base);
+        rc = NUR_ERROR;
+    }
+    st->error_jmp = prev_jmp;
+    nur = prev_state;
+    return rc;
+}
+
+// Yeni kaynak yüklenirken önceki programın global kapsamı, fonksiyonları, açık dosyaları ve derlenmiş
+// ifadeleri atılır; büyük tablolar yeniden sıfırlanmaz (--batch işçileri durumu betikler arasında yeniden kullanır).
+static void nur_reset_program() {
+    spawn_group_free(nur); // İş parçacıkları global dizileri kullanıyor olabilir; önce onlar biter
+    generator_table_free(nur);
+    event_loop_free(nur);
+    while (nur->scope_stack_ptr >= 0) exit_scope();
+    nur_unwind(-1);
+    nur->num_variables = 0;
+    close_all_handles();
+    for (int i = 0; i < nur->num_regex; ++i) regex_free(nur->regex_cache[i]);
+    nur->num_regex = 0;
+    nur->num_tokens = 0; nur->current_token_idx = 0; nur->current_line = 1;
+    nur->num_functions = 0; nur->num_structs = 0; nur->num_modules = 0;
+    nur->num_exprs = 0; nur->num_expr_nodes = 0;
+    program_changed();
+    nur->in_pos = nur->in_len = 0; nur->in_eof = false;
+    nur->source_from_file = nur->compiled = nur->ran = false;
+}
+static void nur_set_file_name(const char* name) {
+    copy_bounded(nur->current_file_path_for_errors, name, MAX_FILENAME_LEN);
+}
+
+static void nur_load_file_body(void* ctx) {
+    const char* path = ctx;
+    nur_reset_program();
+    nur_set_file_name(path);
+    nur->source_from_file = true;
+    FILE* file = fopen(path, "r");
+    if (!file) { char err[MAX_FILENAME_LEN + 64]; snprintf(err, sizeof err, "'%s' dosyası açılamadı: %s", path, strerror(errno)); error(err); }
+    size_t len_read = fread(nur->source_code, 1, MAX_SOURCE_SIZE - 1, file);
+    nur->source_code[len_read] = '\0';
+    fclose(file);
+}
+int nur_load_file(NurState* st, const char* path) { return nur_protected(st, nur_load_file_body, (void*)path); }
+
+struct NurLoadString { const char* name; const char* source; };
+static void nur_load_string_body(void* ctx) {
+    const struct NurLoadString* a = ctx;
+    nur_reset_program();
+    nur_set_file_name(a->name);
+    if (strlen(a->source) >= MAX_SOURCE_SIZE) error("Kaynak kod 'MAX_SOURCE_SIZE' sınırını aşıyor.");
+    strcpy(nur->source_code, a->source);
+}
+int nur_load_string(NurState* st, const char* name, const char* source) {
+    struct NurLoadString a = { name, source };
+    return nur_protected(st, nur_load_string_body, &a);
+}
+
+static void nur_compile_body(void* ctx) {
+    (void)ctx;
+    if (nur->compiled) error("Kaynak zaten derlendi; yeniden derlemek için önce yeniden yükleyin.");
+    const char* path = nur->current_file_path_for_errors;
+    bool cacheable = nur->source_from_file && nur->module_cache;
+    nur->current_token_idx = 0;
+    char key[sizeof ((LoadedModule*)0)->key];
+    module_registry_key(path, key);
+    if (cacheable && module_cache_copy_compiled(path)) { module_registry_add(path, key, 0); nur->compiled = true; return; }
+    if (!cacheable || !module_cache_copy_lexed(path)) {
+        tokenize(nur->source_code);
+        if (cacheable) module_cache_publish_lexed(path, nur->source_code, 0);
+    }
+    module_registry_add(path, key, 0);
+    register_file_declarations();
+    nur->current_token_idx = 0;
+    nur->compiled = true;
+    if (cacheable) module_cache_publish_compiled(path);
+}
+int nur_compile(NurState* st) { return nur_protected(st, nur_compile_body, NULL); }
+
+static void nur_check_runnable() {
+    if (!nur->compiled) error("Önce nur_compile çağrılmalı.");
+}
+static void nur_run_body(void* ctx) {
+    (void)ctx;
+    nur_check_runnable();
+    if (nur->ran) error("En üst düzey deyimler zaten çalıştırıldı.");
+    nur->ran = true;
+    nur->current_token_idx = 0;
+    enter_scope(); // Global kapsam: nur_call çağrıları için durumda açık kalır
+    execute_file_statements();
+    spawn_wait_all(); // Beklenmemiş iş parçacıkları; hataları nur_run'ın hatası olur
+}
+int nur_run(NurState* st) { return nur_protected(st, nur_run_body, NULL); }
+
+struct NurCall { const char* function; const NurValue* args; int num_args; NurValue* result; };
+static void nur_call_body(void* ctx) {
+    struct NurCall* c = ctx;
+    nur_check_runnable();
+    const FunctionDefinition* f = find_function(c->function);
+    char err[MAX_IDENT_LEN + 100];
+    if (!f) { snprintf(err, sizeof err, "'%s' adlı fonksiyon tanımlı değil.", c->function); error(err); }
+    if (c->num_args < 0 || c->num_args > MAX_PARAMETERS) error("Geçersiz argüman sayısı.");
+    Value args[MAX_PARAMETERS];
+    for (int i = 0; i < c->num_args; ++i) args[i] = value_from_nur(&c->args[i]);
+    nur->current_token_idx = nur->num_tokens - 1; // Hata iletileri çağrılan fonksiyonun token'larını gösterir
+    Value r = execute_function_call(f, args, c->num_args);
+    if (!c->result) return;
+    if (!value_to_nur(&r, c->result)) {
+        snprintf(err, sizeof err, "'%s' dönüş değeri (%s) gömülü çağrıya aktarılamaz.", c->function, value_type_to_string(r.type)); error(err);
+    }
+    if (c->result->type == NUR_VAL_STRING) { strcpy(nur->result_text, r.as.string_val); c->result->s = nur->result_text; }
+}
+int nur_call(NurState* st, const char* function, const NurValue* args, int num_args, NurValue* result) {
+    struct NurCall c = { function, args, num_args, result };
+    return nur_protected(st, nur_call_body, &c);
+}
+
+const char* nur_last_error(const NurState* st) { return st->error_message; }
+void nur_set_output(NurState* st, FILE* out) { st->out = out; }
+void nur_set_input(NurState* st, int fd) { st->in_fd = fd; st->in_pos = st->in_len = 0; st->in_eof = false; }
+
+void nur_destroy(NurState* st) {
+    if (!st) return;
+    NurState* prev_state = nur;
+    nur = st;
+    spawn_group_free(st);
+    parallel_pool_free(st);
+    generator_table_free(st);
+    event_loop_free(st);
+    flush_output();
+    while (st->scope_stack_ptr >= 0) exit_scope();
+    close_all_handles();
+    for (int i = 0; i < st->num_regex; ++i) regex_free(st->regex_cache[i]);
+    free(st->expr_nodes); free(st->exprs);
+    nur = prev_state == st ? NULL : prev_state;
+    free(st);
+}
+
+#ifndef NUR_LIBRARY
+// --- Toplu Çalıştırma (--batch) ---
+// Betikler bir iş parçacığı havuzunda çalışır. Her işçinin tek bir NurState'i vardır ve betikler arasında
+// yeniden kullanılır (tablolar yeniden ayrılıp sıfırlanmaz); tüm işçiler modül önbelleğini paylaşır.
+// Her betik için <betik>.out (çıktı), <betik>.err (hata iletisi; başarılıysa boş) ve <betik>.status
+// (0 veya 1) yazılır. --out-dir verilirse dosyalar orada, yoldaki '/' "%2F" ve '%' "%25" olarak kodlanıp
+// adlandırılır; kodlama geri çözülebilir olduğundan farklı yollar aynı dosyaya yazmaz.
+typedef struct {
+    char** scripts; int count, cap;
+    const char* out_dir;
+    int next, failed; // __atomic ile güncellenir
+    ModuleCache cache;
+} BatchRun;
+
+void batch_add_script(BatchRun* b, const char* path) {
+    if (b->count == b->cap) {
+        b->cap = b->cap ? b->cap * 2 : 64;
+        b->scripts = realloc(b->scripts, (size_t)b->cap * sizeof(char*));
+        if (!b->scripts) { fprintf(stderr, "Betik listesi için bellek ayrılamadı.\n"); exit(1); }
+    }
+    b->scripts[b->count] = strdup(path);
+    if (!b->scripts[b->count++]) { fprintf(stderr, "Betik listesi için bellek ayrılamadı.\n"); exit(1); }
+}
+// Bildirim dosyası: satır başına bir betik yolu; boş satırlar ve '#' ile başlayanlar atlanır.
+bool batch_read_manifest(BatchRun* b, const char* manifest) {
+    FILE* f = fopen(manifest, "r");
+    if (!f) { fprintf(stderr, "Bildirim dosyası ('%s') açılamadı: %s\n", manifest, strerror(errno)); return false; }
+    char line[MAX_FILENAME_LEN];
+    while (fgets(line, sizeof line, f)) {
+        str_trim_in_place(line);
+        if (line[0] != '\0' && line[0] != '#') batch_add_script(b, line);
+    }
+    fclose(f);
+    return true;
+}
+
+#define BATCH_PATH_CAP (4 * MAX_FILENAME_LEN)
+// false: yol sığmadı (kısaltılmış bir ad başka bir betiğinkiyle çakışabileceği için kullanılmaz).
+bool batch_output_path(char* buf, size_t cap, const BatchRun* b, const char* script, const char* ext) {
+    if (!b->out_dir) return (size_t)snprintf(buf, cap, "%s.%s", script, ext) < cap;
+    size_t n = (size_t)snprintf(buf, cap, "%s/", b->out_dir);
+    for (const char* p = script; *p && n < cap; ++p)
+        if (*p == '/' || *p == '%') n += (size_t)snprintf(buf + n, cap - n, "%%%02X", (unsigned char)*p);
+        else buf[n++] = *p;
+    return n < cap && (size_t)snprintf(buf + n, cap - n, ".%s", ext) < cap - n;
+}
+bool batch_write_file(const char* path, const char* text) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fputs(text, f);
+    return fclose(f) == 0;
+}
+
+void* batch_worker(void* arg) {
+    BatchRun* b = arg;
+    NurState* st = nur_create();
+    if (!st) { fprintf(stderr, "Yorumlayıcı durumu için bellek ayrılamadı.\n"); return NULL; } // Kalan betikleri diğer işçiler alır
+    st->module_cache = &b->cache;
+    nur_set_input(st, -1); // Toplu çalıştırmada user.in* girdi görmez
+    char path[BATCH_PATH_CAP], err[sizeof st->error_message + 1]; // Yolların sığdığını run_batch denetler
+    for (;;) {
+        int i = __atomic_fetch_add(&b->next, 1, __ATOMIC_RELAXED);
+        if (i >= b->count) break;
+        const char* script = b->scripts[i];
+        batch_output_path(path, sizeof path, b, script, "out");
+        FILE* out = fopen(path, "w");
+        int rc = NUR_ERROR;
+        if (!out) snprintf(err, sizeof err, "Çıktı dosyası ('%.400s') açılamadı: %s\n", path, strerror(errno));
+        else {
+            nur_set_output(st, out);
+            rc = nur_load_file(st, script);
+            if (rc == NUR_OK) rc = nur_compile(st);
+            if (rc == NUR_OK) rc = nur_run(st);
+            snprintf(err, sizeof err, rc == NUR_OK ? "" : "%s\n", nur_last_error(st));
+            // Betiğin açtığı dosyalar şimdi kapanır, global diziler bırakılır
+            NurState* prev_state = nur; nur = st; nur_reset_program(); nur = prev_state;
+            nur_set_output(st, stdout);
+            if (fclose(out) != 0 && rc == NUR_OK) { snprintf(err, sizeof err, "Çıktı dosyası ('%.400s') yazılamadı.\n", path); rc = NUR_ERROR; }
+        }
+        batch_output_path(path, sizeof path, b, script, "err");
+        bool written = batch_write_file(path, err);
+        batch_output_path(path, sizeof path, b, script, "status");
+        written = batch_write_file(path, rc == NUR_OK ? "0\n" : "1\n") && written;
+        if (!written) fprintf(stderr, "'%s' için sonuç dosyaları yazılamadı.\n", script);
+        if (rc != NUR_OK || !written) __atomic_fetch_add(&b->failed, 1, __ATOMIC_RELAXED);
+    }
+    nur_destroy(st);
+    return NULL;
+}
+
+int run_batch(BatchRun* b, int jobs) {
+    if (b->count == 0) { fprintf(stderr, "--batch en az bir betik veya @bildirim dosyası bekler.\n"); return 1; }
+    char path[BATCH_PATH_CAP];
+    for (int i = 0; i < b->count; ++i)
+        if (!batch_output_path(path, sizeof path, b, b->scripts[i], "status")) { fprintf(stderr, "'%s' için çıktı yolu çok uzun.\n", b->scripts[i]); return 1; }
+    if (b->out_dir && mkdir(b->out_dir, 0777) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Çıktı dizini ('%s') oluşturulamadı: %s\n", b->out_dir, strerror(errno)); return 1;
+    }
+    if (jobs <= 0) { long cpus = sysconf(_SC_NPROCESSORS_ONLN); jobs = cpus < 1 ? 1 : (int)cpus; }
+    if (jobs > MAX_BATCH_JOBS) jobs = MAX_BATCH_JOBS;
+    if (jobs > b->count) jobs = b->count;
+    pthread_rwlock_init(&b->cache.lock, NULL);
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    pthread_t th[MAX_BATCH_JOBS];
+    int started = 0;
+    for (int i = 1; i < jobs; ++i) if (pthread_create(&th[started], NULL, batch_worker, b) == 0) started++;
+    batch_worker(b); // İlk işçi ana iş parçacığında
+    for (int i = 0; i < started; ++i) pthread_join(th[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    int unrun = b->next < b->count ? b->count - b->next : 0; // Hiçbir işçi durum ayıramadıysa
+    fprintf(stderr, "Toplu çalıştırma: %d betik, %d hatalı, %d iş parçacığı, %.3f sn\n", b->count, b->failed + unrun,
+            started + 1, (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9);
+    module_cache_free(&b->cache);
+    for (int i = 0; i < b->count; ++i) free(b->scripts[i]);
+    free(b->scripts);
+    return b->failed + unrun > 0 ? 1 : 0;
+}
+
+// --- Sunucu Kipi (--serve / --client) ---
+// nur --serve yol.sock: Unix soketinde istek bekleyen uzun ömürlü süreç. İşçiler --batch'teki gibi tek bir
+// NurState'i istekler arasında yeniden kullanır (her istek temiz bir programla başlar) ve modül önbelleğini
+// paylaşır; önbellek dosyalar değiştikçe kendini yeniler. nur --client yol.sock betik.cstar bir istek gönderir:
+// istemci standart girdi, çıktı ve hata tanımlayıcılarını SCM_RIGHTS ile aktarır, betik doğrudan onlara yazar
+// (çıktı akarak gelir, user.in* istemcinin girdisini okur) ve sunucu yalnızca çıkış durumunu geri yollar.
+// Her işçinin kendi çalışma dizini vardır (Linux'ta unshare(CLONE_FS)); istek istemcinin dizininde çalışır.
+// Betik derlendikten sonra çatallanan bir alt süreçte çalışır: çöken ya da süreci sonlandıran bir betik
+// yalnızca kendi isteğini düşürür. Önbellek güncellemeleri alt süreçte kalacağından betik ve içe aktardığı
+// dosyalar çatallanmadan önce işçide sözcüklenir.
+#define SERVE_MAGIC 0x3152554eu // "NUR1"; istemci ve sunucu aynı sürümden olmalı
+#define SERVE_PAYLOAD_SIZE (sizeof(ServeRequest) + 4096 + MAX_FILENAME_LEN)
+enum { SERVE_NO_PROMPT = 1 };
+typedef struct { unsigned magic, flags; } ServeRequest; // Ardından: çalışma dizini '\0' betik yolu '\0'
+typedef struct { int listen_fd; ModuleCache cache; } ServeRun;
+static const char* serve_socket_path; // Sinyal işleyicisi soket dosyasını siler
+static ServeRun* serve_run; // Çatallama sırasında önbellek kilidi tutulur: alt süreç yarım kalmış bir kayıt görmesin
+
+static void serve_before_fork(void) { pthread_rwlock_wrlock(&serve_run->cache.lock); pthread_mutex_lock(&shared_storage_lock); }
+static void serve_after_fork(void) { pthread_mutex_unlock(&shared_storage_lock); pthread_rwlock_unlock(&serve_run->cache.lock); }
+static void serve_in_child(void) { // Alt sürecin iş parçacığı kimliği farklıdır; kilitler açılmak yerine yeniden kurulur
+    pthread_mutex_init(&shared_storage_lock, NULL); pthread_rwlock_init(&serve_run->cache.lock, NULL);
+}
+
+// İçe aktarılan dosyayı (ve onun içe aktardıklarını) önbelleğe sözcükler; token'lar çağıranda geri alınır.
+static void serve_lex_import_body(void* ctx) {
+    const char* path = ctx;
+    char key[sizeof ((LoadedModule*)0)->key];
+    module_registry_key(path, key);
+    if (module_registry_find(key) || module_registry_full()) return;
+    module_registry_add(path, key, nur->num_tokens);
+    copy_bounded(nur->current_file_path_for_errors, path, MAX_FILENAME_LEN);
+    module_lex_file(path);
+}
+// Hatalar yok sayılır (.nbc ile gelen ya da eksik dosya): asıl bildirimi alt süreçteki çalıştırma yapar.
+void serve_lex_imports(NurState* st) {
+    int num_tokens = st->num_tokens, num_modules = st->num_modules;
+    char file_path[MAX_FILENAME_LEN];
+    strcpy(file_path, st->current_file_path_for_errors);
+    for (int i = 0; i + 1 < st->num_tokens; ++i) // Yeni eklenen modüllerin içe aktarmaları da taranır
+        if (st->tokens[i].type == TOKEN_IMPORT && st->tokens[i + 1].type == TOKEN_STRING_LITERAL) {
+            char path[MAX_FILENAME_LEN];
+            copy_bounded(path, st->tokens[i + 1].string_value, sizeof path);
+            nur_protected(st, serve_lex_import_body, path);
+        }
+    st->num_tokens = num_tokens; st->num_modules = num_modules;
+    strcpy(st->current_file_path_for_errors, file_path);
+    st->current_token_idx = 0; st->current_line = 1;
+    st->error_message[0] = '\0';
+}
+
+// İstemcinin tanımlayıcılarıyla betiği çalıştırır. Dönüş: çıkış durumu.
+int serve_run_script(NurState* st, const char* script, const int fds[3], unsigned flags) {
+    int rc = nur_load_file(st, script), loaded = rc == NUR_OK;
+    if (rc == NUR_OK) rc = nur_compile(st);
+    if (rc == NUR_OK) serve_lex_imports(st);
+    pid_t pid = fork();
+    if (pid < 0) {
+        dprintf(fds[2], "İstek için süreç oluşturulamadı: %s\n", strerror(errno));
+        NurState* prev_state = nur; nur = st; nur_reset_program(); nur = prev_state;
+        return 1;
+    }
+    if (pid == 0) {
+        signal(SIGINT, SIG_DFL); signal(SIGTERM, SIG_DFL); // Sunucunun işleyicisi soketi silerdi
+        st->parallel_pool = NULL; // İşçi iş parçacıkları çatallamada kopyalanmaz; gerekirse yenisi açılır
+        FILE* out = fdopen(fds[1], "w");
+        if (!out) { dprintf(fds[2], "Çıktı açılamadı: %s\n", strerror(errno)); _exit(1); }
+        setvbuf(out, NULL, _IONBF, 0); // out.display kendi tamponunu boşaltır; ikinci bir kopya olmasın
+        st->out_is_tty = isatty(fds[1]);
+        st->show_prompts = isatty(fds[0]) && !(flags & SERVE_NO_PROMPT);
+        nur_set_output(st, out);
+        nur_set_input(st, fds[0]);
+        if (loaded) fprintf(out, "--- '%s' dosyası çalıştırılıyor ---\n", script);
+        if (rc == NUR_OK) { fprintf(out, "--- Program Çıktısı ---\n"); rc = nur_run(st); }
+        if (rc == NUR_OK) fprintf(out, "--- Program Çıktısı Sonu ---\n");
+        else dprintf(fds[2], "%s\n", nur_last_error(st));
+        nur = st; nur_reset_program(); // Betiğin dosyaları ve iş parçacıkları şimdi kapanır
+        fclose(out);
+        _exit(rc == NUR_OK ? 0 : 1);
+    }
+    NurState* prev_state = nur; nur = st; nur_reset_program(); nur = prev_state;
+    int wstatus;
+    while (waitpid(pid, &wstatus, 0) < 0) if (errno != EINTR) return 1;
+    if (WIFEXITED(wstatus)) return WEXITSTATUS(wstatus);
+    dprintf(fds[2], "Betik %d sinyaliyle sonlandı.\n", WTERMSIG(wstatus));
+    return 1;
+}
+
+// Bozuk bir istek durum yollanmadan kapatılır; istemci bunu bağlantı hatası olarak bildirir.
+void serve_connection(NurState* st, int conn) {
+    char payload[SERVE_PAYLOAD_SIZE + 1];
+    union { struct cmsghdr align; char buf[CMSG_SPACE(3 * sizeof(int))]; } control;
+    struct iovec iov = { payload, SERVE_PAYLOAD_SIZE };
+    struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1, .msg_control = control.buf, .msg_controllen = sizeof control.buf };
+    ssize_t n;
+    do n = recvmsg(conn, &msg, MSG_CMSG_CLOEXEC); while (n < 0 && errno == EINTR);
+    int fds[3] = { -1, -1, -1 }, num_fds = 0;
+    if (n > 0)
+        for (struct cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS) continue;
+            for (size_t i = 0; i < (c->cmsg_len - CMSG_LEN(0)) / sizeof(int); ++i) {
+                int fd; memcpy(&fd, CMSG_DATA(c) + i * sizeof(int), sizeof fd);
+                if (num_fds < 3) fds[num_fds++] = fd; else close(fd);
+            }
+        }
+    ServeRequest req;
+    const char* cwd = payload + sizeof req;
+    const char* script = NULL;
+    if (n > (ssize_t)sizeof req && num_fds == 3 && !(msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC))) {
+        memcpy(&req, payload, sizeof req);
+        payload[n] = '\0';
+        size_t cwd_len = strlen(cwd);
+        if (req.magic == SERVE_MAGIC && sizeof req + cwd_len + 1 < (size_t)n) script = cwd + cwd_len + 1;
+    }
+    int status = 1;
+    if (script) {
+        if (chdir(cwd) != 0) dprintf(fds[2], "Çalışma dizinine ('%s') geçilemedi: %s\n", cwd, strerror(errno));
+        else status = serve_run_script(st, script, fds, req.flags);
+    }
+    for (int i = 0; i < 3; ++i) if (fds[i] >= 0) close(fds[i]); // Önce kapatılır: istemci çıktığında boru okuyucusu EOF görsün
+    if (script) { ssize_t w = write(conn, &status, sizeof status); (void)w; } // İstemci gitmişse yapılacak bir şey yok
+}
+
+// Soket izinlerine ek olarak karşı tarafın kullanıcısı denetlenir: başka bir kullanıcı bu süreç adına betik çalıştıramaz.
+bool serve_peer_allowed(int conn) {
+#ifdef SO_PEERCRED
+    struct ucred cred;
+    socklen_t len = sizeof cred;
+    if (getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) { fprintf(stderr, "Bağlantının kimliği alınamadı: %s\n", strerror(errno)); return false; }
+    if (cred.uid != geteuid()) { fprintf(stderr, "Bağlantı reddedildi: kullanıcı %u (süreç %d) sunucunun sahibi değil.\n", (unsigned)cred.uid, (int)cred.pid); return false; }
+#else
+    (void)conn;
+#endif
+    return true;
+}
+
+void* serve_worker(void* arg) {
+    ServeRun* r = arg;
+#ifdef __linux__
+    if (unshare(CLONE_FS) != 0) { fprintf(stderr, "İşçi çalışma dizini ayrılamadı: %s\n", strerror(errno)); return NULL; }
+#endif
+    NurState* st = nur_create();
+    if (!st) { fprintf(stderr, "Yorumlayıcı durumu için bellek ayrılamadı.\n"); return NULL; }
+    st->module_cache = &r->cache;
+    nur_set_input(st, -1);
+    for (;;) {
+        int conn = accept4(r->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (conn < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno == EMFILE || errno == ENFILE) { struct timespec ts = { 0, 10000000 }; nanosleep(&ts, NULL); continue; } // Tanımlayıcılar boşalana kadar
+            fprintf(stderr, "Bağlantı kabul edilemedi: %s\n", strerror(errno));
+            break;
+        }
+        if (!serve_peer_allowed(conn)) { close(conn); continue; }
+        serve_connection(st, conn);
+        close(conn);
+    }
+    nur_destroy(st);
+    return NULL;
+}
+
+static void serve_on_signal(int sig) { (void)sig; if (serve_socket_path) unlink(serve_socket_path); _exit(0); }
+
+// Yol başka bir sunucudan kalmışsa (bağlanılamıyorsa) silinip yeniden bağlanır.
+int serve_listen(const char* path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof addr.sun_path) { fprintf(stderr, "Soket yolu çok uzun: %s\n", path); return -1; }
+    strcpy(addr.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) { fprintf(stderr, "Soket oluşturulamadı: %s\n", strerror(errno)); return -1; }
+    mode_t old_mask = umask(0177); // Soket 0600 oluşur: yalnızca sahibi bağlanabilir
+    int rc = bind(fd, (struct sockaddr*)&addr, sizeof addr);
+    if (rc != 0 && errno == EADDRINUSE) {
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool live = probe >= 0 && connect(probe, (struct sockaddr*)&addr, sizeof addr) == 0;
+        if (probe >= 0) close(probe);
+        if (live) { fprintf(stderr, "'%s' üzerinde zaten bir sunucu çalışıyor.\n", path); umask(old_mask); close(fd); return -1; }
+        unlink(path);
+        rc = bind(fd, (struct sockaddr*)&addr, sizeof addr);
+    }
+    umask(old_mask);
+    if (rc != 0 || listen(fd, SOMAXCONN) != 0) { fprintf(stderr, "'%s' dinlenemiyor: %s\n", path, strerror(errno)); close(fd); return -1; }
+    return fd;
+}
+
+int run_serve(const char* path, int jobs) {
+    ServeRun r = {0};
+    r.listen_fd = serve_listen(path);
+    if (r.listen_fd < 0) return 1;
+    serve_socket_path = path;
+    struct sigaction sa = {0};
+    sa.sa_handler = serve_on_signal;
+    sigaction(SIGINT, &sa, NULL); sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN); // İstemci erken çıkarsa yazma hatası betiğin hatası olur, sunucu ölmez
+    if (jobs <= 0) { long cpus = sysconf(_SC_NPROCESSORS_ONLN); jobs = cpus < 1 ? 1 : (int)cpus; }
+    if (jobs > MAX_BATCH_JOBS) jobs = MAX_BATCH_JOBS;
+#ifndef __linux__
+    jobs = 1; // İşçiler çalışma dizinini paylaşır
+#endif
+    r.cache.revalidate = true;
+    pthread_rwlock_init(&r.cache.lock, NULL);
+    serve_run = &r;
+    pthread_atfork(serve_before_fork, serve_after_fork, serve_in_child);
+    pthread_t th[MAX_BATCH_JOBS];
+    int started = 0;
+    for (int i = 1; i < jobs; ++i) if (pthread_create(&th[started], NULL, serve_worker, &r) == 0) started++;
+    fprintf(stderr, "Sunucu hazır: %s (%d iş parçacığı)\n", path, started + 1);
+    serve_worker(&r); // Yalnızca kabul hatasında döner
+    unlink(path);
+    return 1;
+}
+
+int run_client(const char* path, const char* script, bool no_prompt) {
+    char payload[SERVE_PAYLOAD_SIZE];
+    ServeRequest req = { SERVE_MAGIC, no_prompt ? SERVE_NO_PROMPT : 0 };
+    memcpy(payload, &req, sizeof req);
+    size_t n = sizeof req;
+    if (!getcwd(payload + n, 4096)) { fprintf(stderr, "Çalışma dizini alınamadı: %s\n", strerror(errno)); return 1; }
+    n += strlen(payload + n) + 1;
+    if (strlen(script) >= MAX_FILENAME_LEN) { fprintf(stderr, "Betik yolu çok uzun: %s\n", script); return 1; }
+    strcpy(payload + n, script);
+    n += strlen(script) + 1;
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof addr.sun_path) { fprintf(stderr, "Soket yolu çok uzun: %s\n", path); return 1; }
+    strcpy(addr.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof addr) != 0) { fprintf(stderr, "Sunucuya ('%s') bağlanılamadı: %s\n", path, strerror(errno)); return 1; }
+    const int fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+    union { struct cmsghdr align; char buf[CMSG_SPACE(sizeof fds)]; } control;
+    memset(&control, 0, sizeof control);
+    struct iovec iov = { payload, n };
+    struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1, .msg_control = control.buf, .msg_controllen = sizeof control.buf };
+    struct cmsghdr* c = CMSG_FIRSTHDR(&msg);
+    c->cmsg_level = SOL_SOCKET; c->cmsg_type = SCM_RIGHTS; c->cmsg_len = CMSG_LEN(sizeof fds);
+    memcpy(CMSG_DATA(c), fds, sizeof fds);
+    if (sendmsg(fd, &msg, MSG_NOSIGNAL) != (ssize_t)n) { fprintf(stderr, "İstek gönderilemedi: %s\n", strerror(errno)); close(fd); return 1; }
+    int status;
+    size_t got = 0;
+    while (got < sizeof status) {
+        ssize_t k = read(fd, (char*)&status + got, sizeof status - got);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) break;
+        got += (size_t)k;
+    }
+    close(fd);
+    if (got != sizeof status) { fprintf(stderr, "Sunucu isteği tamamlamadan bağlantıyı kapattı.\n"); return 1; }
+    return status;
+}
+
+// --- Modül Derleme (--compile) ---
+// Kaynak yüklenip 1. geçişten geçirilir ve .nbc olarak yazılır; en üst düzey deyimler çalıştırılmaz.
+// -o verilmezse çıktı kaynağın yanına, uzantısı .nbc yapılarak yazılır (import bu yolu arar).
+struct CompileRun { const char* source; const char* out; };
+static void compile_module_body(void* ctx) {
+    const struct CompileRun* c = ctx;
+    nur_load_file_body((void*)c->source);
+    nur_compile_body(NULL);
+    nbc_write(c->out);
+}
+int run_compile(const char* source, const char* out_path) {
+    char derived[2 * MAX_FILENAME_LEN];
+    if (!out_path && !nbc_path_for(source, derived, sizeof derived)) { fprintf(stderr, "Çıktı yolu çok uzun: %s\n", source); return 1; }
+    if (!out_path) out_path = derived;
+    if (strcmp(out_path, source) == 0) { fprintf(stderr, "Çıktı dosyası kaynakla aynı olamaz: %s\n", source); return 1; }
+    NurState* st = nur_create();
+    if (!st) { fprintf(stderr, "Yorumlayıcı durumu için bellek ayrılamadı.\n"); return 1; }
+    struct CompileRun c = { source, out_path };
+    int rc = nur_protected(st, compile_module_body, &c);
+    if (rc != NUR_OK) fprintf(stderr, "%s\n", nur_last_error(st));
+    nur_destroy(st);
+    return rc == NUR_OK ? 0 : 1;
 }
 
 int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        fprintf(stderr, "Kullanım: %s <dosya_adi.cstar>\n", argv[0]);
+    nur = nur_create();
+    if (!nur) { fprintf(stderr, "Yorumlayıcı durumu için bellek ayrılamadı.\n"); return 1; }
+    nur->out_is_tty = isatty(STDOUT_FILENO);
+    nur->show_prompts = isatty(STDIN_FILENO); // Borudan/dosyadan gelen girdi için istem yazılmaz
+    const char* script_path = NULL;
+    const char* serve_path = NULL;
+    const char* client_path = NULL;
+    const char* compile_path = NULL;
+    const char* output_path = NULL;
+    bool batch = false, no_prompt = false;
+    int jobs = 0;
+    BatchRun run = {0};
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--no-prompt") == 0) { nur->show_prompts = false; no_prompt = true; }
+        else if (strcmp(argv[i], "--ext") == 0) {
+            if (i + 1 >= argc) { fprintf(stderr, "--ext bir paylaşımlı kütüphane yolu bekler.\n"); return 1; }
+            load_extension(argv[++i]);
+        } else if (strcmp(argv[i], "--batch") == 0) batch = true;
+        else if (strcmp(argv[i], "--serve") == 0 || strcmp(argv[i], "--client") == 0) {
+            if (i + 1 >= argc) { fprintf(stderr, "%s bir Unix soketi yolu bekler.\n", argv[i]); return 1; }
+            if (strcmp(argv[i], "--serve") == 0) serve_path = argv[++i]; else client_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--compile") == 0 || strcmp(argv[i], "-o") == 0) {
+            if (i + 1 >= argc) { fprintf(stderr, "%s bir dosya yolu bekler.\n", argv[i]); return 1; }
+            if (strcmp(argv[i], "--compile") == 0) compile_path = argv[++i]; else output_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--jobs") == 0) {
+            if (i + 1 >= argc || (jobs = atoi(argv[++i])) <= 0) { fprintf(stderr, "--jobs pozitif bir iş parçacığı sayısı bekler.\n"); return 1; }
+        } else if (strcmp(argv[i], "--out-dir") == 0) {
+            if (i + 1 >= argc) { fprintf(stderr, "--out-dir bir dizin yolu bekler.\n"); return 1; }
+            run.out_dir = argv[++i];
+        } else if (batch) {
+            if (argv[i][0] == '@') { if (!batch_read_manifest(&run, argv[i] + 1)) return 1; }
+            else batch_add_script(&run, argv[i]);
+        } else if (!script_path) script_path = argv[i];
+        else { fprintf(stderr, "Beklenmeyen argüman: %s\n", argv[i]); return 1; }
+    }
+    if (output_path && !compile_path) { fprintf(stderr, "-o yalnızca --compile ile kullanılabilir.\n"); return 1; }
+    if (compile_path) {
+        if (script_path || batch || serve_path || client_path) { fprintf(stderr, "--compile betik veya başka bir kip ile birlikte verilemez.\n"); return 1; }
+        nur_destroy(nur);
+        return run_compile(compile_path, output_path);
+    }
+    if (serve_path) {
+        if (script_path || batch || client_path) { fprintf(stderr, "--serve betik veya başka bir kip ile birlikte verilemez.\n"); return 1; }
+        nur_destroy(nur);
+        return run_serve(serve_path, jobs);
+    }
+    if (client_path) {
+        if (!script_path || batch) { fprintf(stderr, "--client tek bir betik yolu bekler.\n"); return 1; }
+        nur_destroy(nur);
+        return run_client(client_path, script_path, no_prompt);
+    }
+    if (batch) {
+        if (script_path) batch_add_script(&run, script_path); // --batch'ten önce verilen betik
+        nur_destroy(nur);
+        return run_batch(&run, jobs);
+    }
+    if (!script_path) {
+        fprintf(stderr, "Kullanım: %s [--no-prompt] [--ext kutuphane.so]... <dosya_adi.cstar>\n"
+                        "          %s --batch [--jobs N] [--out-dir dizin] <betik.cstar | @liste.txt>...\n"
+                        "          %s --serve <soket> [--jobs N]\n"
+                        "          %s --client <soket> [--no-prompt] <dosya_adi.cstar>\n"
+                        "          %s --compile <modul.cstar> [-o modul.nbc]\n", argv[0], argv[0], argv[0], argv[0], argv[0]);
         printf("Dosya adı belirtilmedi. Dahili fonksiyon test örneği çalıştırılıyor.\n---\n");
-        strcpy(source_code,
+        strcpy(nur->source_code,
                "// --- C* Fonksiyon ve Dahili Komut Testi ---\n"
                "out.display(\"Dahili Fonksiyon Testleri:\");\n"
                "out.display(\"sqrt(16.0) = \" + sqrt(16.0));\n"
@@ -1738,8 +7633,7 @@ int main(int argc, char *argv[]) {
                
                "out.display(\"Testler tamamlandı.\");\n"
         );
-        strncpy(current_file_path_for_errors, "dahili_ornek.cstar", MAX_FILENAME_LEN-1);
-        current_file_path_for_errors[MAX_FILENAME_LEN-1] = '\0';
+        copy_bounded(nur->current_file_path_for_errors, "dahili_ornek.cstar", MAX_FILENAME_LEN);
         
         FILE* lib_file_func = fopen("math_lib_func.cstar", "w");
         if(lib_file_func){
@@ -1756,32 +7650,31 @@ int main(int argc, char *argv[]) {
         }
         
     } else {
-        FILE *file = fopen(argv[1], "r");
+        FILE *file = fopen(script_path, "r");
         if (!file) {perror("Dosya açma hatası"); return 1;}
-        size_t len_read = fread(source_code, 1, MAX_SOURCE_SIZE - 1, file); source_code[len_read] = '\0'; fclose(file);
-        printf("--- '%s' dosyası çalıştırılıyor ---\n", argv[1]);
-        strncpy(current_file_path_for_errors, argv[1], MAX_FILENAME_LEN-1); current_file_path_for_errors[MAX_FILENAME_LEN-1] = '\0';
+        size_t len_read = fread(nur->source_code, 1, MAX_SOURCE_SIZE - 1, file); nur->source_code[len_read] = '\0'; fclose(file);
+        printf("--- '%s' dosyası çalıştırılıyor ---\n", script_path);
+        copy_bounded(nur->current_file_path_for_errors, script_path, MAX_FILENAME_LEN);
     }
     
-    // Initialize global states before first interpretation
-    num_variables = 0; num_functions = 0;
-    for_loop_var_stack_ptr = -1; call_stack_ptr = -1; scope_stack_ptr = -1; 
-    num_imported_files = 0; 
-    g_importer_saved_source_code = NULL; g_importer_saved_tokens = NULL;
-    g_return_flag = false; 
-    
-    tokenize(); 
-    current_token_idx = 0; 
+    tokenize(nur->source_code); 
+    nur->current_token_idx = 0; 
+    char main_key[sizeof ((LoadedModule*)0)->key];
+    module_registry_key(nur->current_file_path_for_errors, main_key);
+    module_registry_add(nur->current_file_path_for_errors, main_key, 0);
     
     printf("--- Program Çıktısı ---\n");
-    interpret_current_file_tokens(current_file_path_for_errors); 
+    interpret_current_file_tokens(nur->current_file_path_for_errors, true); 
+    flush_output();
     printf("--- Program Çıktısı Sonu ---\n");
     
     // Final cleanup (mostly for arrays in the very last global scope if any remain)
     // exit_scope called by interpret_current_file_tokens should handle most.
-    while(scope_stack_ptr >=0) { // Ensure all scopes are exited
+    while(nur->scope_stack_ptr >=0) { // Ensure all scopes are exited
         exit_scope();
     }
+    close_all_handles();
     
     return 0;
 }
+#endif // NUR_LIBRARY
@@ -0,0 +1,87 @@
+// nur.h - Nur yorumlayıcısını C/C++ programlarına gömmek için arayüz.
+//
+// Kütüphane, yorumlayıcı kaynağının NUR_LIBRARY tanımıyla derlenmesiyle elde edilir (main dışarıda kalır):
+//   gcc -O2 -DNUR_LIBRARY -fPIC -fvisibility=hidden -shared -o libnur.so Nur-lang_v.0.1.c -lm -lpthread -ldl
+//   gcc -O2 -DNUR_LIBRARY -c -o nur.o Nur-lang_v.0.1.c && ar rcs libnur.a nur.o
+//
+// Her NurState bağımsız bir yorumlayıcıdır. Bir durum aynı anda yalnızca bir iş parçacığından kullanılabilir;
+// farklı durumlar farklı iş parçacıklarında eşzamanlı çalışabilir. Hatalar süreci sonlandırmaz: API
+// fonksiyonu NUR_ERROR döner ve ileti nur_last_error ile alınır.
+//
+// Tipik kullanım:
+//   NurState* st = nur_create();
+//   if (nur_load_file(st, "is.cstar") != NUR_OK || nur_compile(st) != NUR_OK || nur_run(st) != NUR_OK)
+//       fprintf(stderr, "%s\n", nur_last_error(st));
+//   NurValue arg = { .type = NUR_VAL_INT, .i = 42 }, sonuc;
+//   nur_call(st, "hesapla", &arg, 1, &sonuc);
+//   nur_destroy(st);
+#ifndef NUR_H
+#define NUR_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUR_API __attribute__((visibility("default")))
+#define NUR_OK 0
+#define NUR_ERROR (-1)
+
+typedef struct NurState NurState;
+
+typedef enum { NUR_VAL_NULL, NUR_VAL_INT, NUR_VAL_FLOAT, NUR_VAL_BOOL, NUR_VAL_STRING } NurValueType;
+
+// Fonksiyon argümanı / dönüş değeri. int ve i64 'i', float 'f', boolean 'b', string 's' alanındadır.
+// Dönüş değerindeki 's' duruma aittir ve aynı durumdaki bir sonraki nur_call'a kadar geçerlidir.
+typedef struct {
+    NurValueType type;
+    long long i;
+    double f;
+    bool b;
+    const char* s;
+} NurValue;
+
+NUR_API NurState* nur_create(void);                 // Bellek yetersizse NULL
+NUR_API void nur_destroy(NurState* st);             // Çıktıyı boşaltır, dosyaları kapatır, belleği bırakır
+
+NUR_API void nur_set_output(NurState* st, FILE* out); // out.display hedefi (varsayılan stdout)
+NUR_API void nur_set_input(NurState* st, int fd);     // user.in* kaynağı (varsayılan 0; -1: girdi yok)
+
+NUR_API int nur_load_file(NurState* st, const char* path);
+NUR_API int nur_load_string(NurState* st, const char* name, const char* source); // name: hata iletilerinde dosya adı
+NUR_API int nur_compile(NurState* st); // Sözcüklere ayırır, fonksiyon ve struct bildirimlerini kaydeder
+NUR_API int nur_run(NurState* st);     // En üst düzey deyimleri çalıştırır; global değişkenler durumda kalır
+NUR_API int nur_call(NurState* st, const char* function, const NurValue* args, int num_args, NurValue* result);
+
+NUR_API const char* nur_last_error(const NurState* st); // Son hatanın iletisi (yoksa "")
+
+// --- Yerel Eklentiler (nur --ext kutuphane.so) ---
+// Eklenti yalnızca bu başlığa bağlıdır; yorumlayıcının iç değer düzeni görünmez. Kütüphane şunları dışa aktarır:
+//   NUR_EXTENSION_ABI;                                  // derlendiği ABI sürümü; uyuşmazsa yüklenmez
+//   int nur_extension_init(const NurExtensionApi* api); // 0: başarılı
+// Argümanlar ve dönüş değeri NurValue'dur. Argümanlardaki 's' çağrı süresince geçerlidir; dönüş değerinin
+// 's'si dönüşte kopyalanır. 'result' NUR_VAL_NULL olarak başlar. Dizi, tutamaç ve kanal aktarılamaz.
+#define NUR_EXT_ABI_VERSION 2
+#define NUR_EXTENSION_ABI const int nur_extension_abi = NUR_EXT_ABI_VERSION
+
+typedef enum { NUR_ARG_ANY, NUR_ARG_INT, NUR_ARG_NUMBER, NUR_ARG_STRING, NUR_ARG_BOOL } NurArgType; // NUMBER: int veya float
+typedef void (*NurNativeFn)(const NurValue* args, int num_args, NurValue* result);
+
+typedef struct {
+    int abi_version; // NUR_EXT_ABI_VERSION
+    // arity -1: değişken sayıda argüman (tipler denetlenmez). <0 döner: ad kullanımda, geçersiz ya da tablo dolu
+    int (*register_native)(const char* name, int arity, const NurArgType* param_types, NurNativeFn fn);
+    void (*error)(const char* message); // Çağrıyı hatayla sonlandırır; dönmez
+} NurExtensionApi;
+
+// Eklentinin tanımladığı semboller (yorumlayıcı dlsym ile arar)
+NUR_API extern const int nur_extension_abi;
+NUR_API int nur_extension_init(const NurExtensionApi* api);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NUR_H
@@ -0,0 +1,42 @@
+// embed_api testi için gömme istemcisi: nur.h üzerinden iki bağımsız durum kullanır.
+#include <stdio.h>
+#include <string.h>
+#include "../nur.h"
+
+static void show(NurState* st, const char* fn, const NurValue* args, int n) {
+    NurValue r;
+    if (nur_call(st, fn, args, n, &r) != NUR_OK) { printf("%s: hata: %s\n", fn, nur_last_error(st)); return; }
+    switch (r.type) {
+        case NUR_VAL_INT: printf("%s: %lld\n", fn, r.i); break;
+        case NUR_VAL_STRING: printf("%s: %s\n", fn, r.s); break;
+        default: printf("%s: tip %d\n", fn, (int)r.type); break;
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* script = argv[argc - 1];
+    NurState* a = nur_create();
+    NurState* b = nur_create();
+    nur_set_output(a, stdout);
+    nur_set_output(b, stdout);
+    if (nur_load_file(a, script) != NUR_OK || nur_compile(a) != NUR_OK || nur_run(a) != NUR_OK) { printf("a: %s\n", nur_last_error(a)); return 1; }
+    fflush(stdout);
+    NurValue two[2] = { { .type = NUR_VAL_INT, .i = 2 }, { .type = NUR_VAL_INT, .i = 40 } };
+    show(a, "plus", two, 2);
+    show(a, "bump", NULL, 0);
+    show(a, "bump", NULL, 0);
+    NurValue name = { .type = NUR_VAL_STRING, .s = "dünya" };
+    show(a, "greet", &name, 1);
+    NurValue bad = { .type = NUR_VAL_INT, .i = 5 };
+    show(a, "fail", &bad, 1);
+    show(a, "missing", NULL, 0);
+    show(a, "bump", NULL, 0);
+    if (nur_load_string(b, "b.cstar", "var counter: int = 100;\nfun bump() : int { counter = counter + 10; return counter; }\n") != NUR_OK
+        || nur_compile(b) != NUR_OK || nur_run(b) != NUR_OK) { printf("b: %s\n", nur_last_error(b)); return 1; }
+    show(b, "bump", NULL, 0);
+    show(a, "bump", NULL, 0);
+    if (nur_load_string(b, "c.cstar", "fun broken( {") != NUR_OK || nur_compile(b) != NUR_OK) printf("c: %s\n", nur_last_error(b));
+    nur_destroy(a);
+    nur_destroy(b);
+    return 0;
+}
@@ -0,0 +1,17 @@
+#!/bin/sh
+# Regresyon betikleri: her tests/<ad>.cstar çalıştırılır, çıktısı (stdout + stderr) tests/<ad>.expected ile
+# karşılaştırılır. Varsa tests/<ad>.setup aynı alt kabukta önce çalıştırılır (ör. bir ortam değişkeni ayarı).
+# Kullanım: tests/run.sh [yorumlayıcı]   (varsayılan: ./nur)
+# Yeni beklenen çıktı: NUR_UPDATE=1 tests/run.sh
+NUR=${1:-./nur}
+case "$NUR" in /*) ;; *) NUR="$(pwd)/$NUR" ;; esac
+cd "$(dirname "$0")" || exit 1
+failed=0
+for script in *.cstar; do
+    name=${script%.cstar}
+    actual=$( [ -f "$name.setup" ] && . "./$name.setup"; "$NUR" --no-prompt "$script" </dev/null 2>&1)
+    if [ -n "$NUR_UPDATE" ]; then printf '%s\n' "$actual" > "$name.expected"; continue; fi
+    if [ "$actual" = "$(cat "$name.expected")" ]; then echo "ok   $name"
+    else echo "FAIL $name"; printf '%s\n' "$actual" | diff "$name.expected" - | head -20; failed=1; fi
+done
+exit $failed